@@ -0,0 +1,232 @@
+/*******************************************************************************************
+*
+*   rPBR [shader] - Prefiltered environment and irradiance (spherical harmonics) compute shader
+*
+*   Copyright (c) 2017 Victor Fisac
+*
+**********************************************************************************************/
+
+#version 430
+
+#define     MAX_SAMPLES             1024u
+#define     MAX_MIPMAP_LEVELS       5
+#define     TILE_SIZE               8
+#define     GROUP_THREADS           64
+#define     SH_SOURCE_SIZE          32
+#define     SH_COEFFICIENTS         9
+
+layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+// Input uniform values
+layout(binding = 0) uniform samplerCube environmentMap;
+uniform int tileOffsets[MAX_MIPMAP_LEVELS + 1];
+uniform int prefilterSize;
+uniform int irradianceSize;
+uniform float sourceSize;
+
+// Output prefilter mipmap levels and irradiance cubemaps
+layout(rgba16f, binding = 0) uniform writeonly imageCube prefilterMip0;
+layout(rgba16f, binding = 1) uniform writeonly imageCube prefilterMip1;
+layout(rgba16f, binding = 2) uniform writeonly imageCube prefilterMip2;
+layout(rgba16f, binding = 3) uniform writeonly imageCube prefilterMip3;
+layout(rgba16f, binding = 4) uniform writeonly imageCube prefilterMip4;
+layout(rgba16f, binding = 5) uniform writeonly imageCube irradianceMap;
+
+// Constant values
+const float PI = 3.14159265359;
+
+// Workgroup shared values
+shared vec4 samples[MAX_SAMPLES];               // GGX lobe light directions (tangent space) and source mip level
+shared vec4 partialSums[GROUP_THREADS];         // Spherical harmonics reduction values
+shared vec3 coefficients[SH_COEFFICIENTS];      // Reduced irradiance spherical harmonics
+
+float RadicalInverse_VdC(uint bits)
+{
+     bits = (bits << 16u) | (bits >> 16u);
+     bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+     bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+     bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+     bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+     return float(bits) * 2.3283064365386963e-10; // / 0x100000000
+}
+
+// Get GGX importance sample light direction in tangent space and its source mip level
+// NOTE: view direction equals normal, so samples only depend on roughness (same values than prefilter.fs)
+vec4 GetSample(uint i, float roughness)
+{
+    vec2 Xi = vec2(float(i)/float(MAX_SAMPLES), RadicalInverse_VdC(i));
+    float a = roughness*roughness;
+    float phi = 2.0*PI*Xi.x;
+    float cosTheta = sqrt((1.0 - Xi.y)/(1.0 + (a*a - 1.0)*Xi.y));
+    float sinTheta = sqrt(1.0 - cosTheta*cosTheta);
+
+    vec3 H = vec3(cos(phi)*sinTheta, sin(phi)*sinTheta, cosTheta);
+    vec3 L = 2.0*H.z*H - vec3(0.0, 0.0, 1.0);
+
+    // Sample from the environment's mip level based on roughness/pdf
+    float a2 = a*a;
+    float denom = H.z*H.z*(a2 - 1.0) + 1.0;
+    float pdf = a2/(PI*denom*denom)*0.25 + 0.0001;
+    float saTexel = 4.0*PI/(6.0*sourceSize*sourceSize);
+    float saSample = 1.0/(float(MAX_SAMPLES)*pdf + 0.0001);
+
+    return vec4(L, 0.5*log2(saSample/saTexel));
+}
+
+// Get cubemap face direction from texel coordinates in [-1, 1] range
+vec3 GetCubeDirection(int face, vec2 st)
+{
+    vec3 direction = vec3(0.0);
+
+    if (face == 0) direction = vec3(1.0, -st.y, -st.x);
+    else if (face == 1) direction = vec3(-1.0, -st.y, st.x);
+    else if (face == 2) direction = vec3(st.x, 1.0, st.y);
+    else if (face == 3) direction = vec3(st.x, -1.0, -st.y);
+    else if (face == 4) direction = vec3(st.x, -st.y, 1.0);
+    else direction = vec3(-st.x, -st.y, -1.0);
+
+    return normalize(direction);
+}
+
+// Get spherical harmonics basis values (3 bands)
+void GetBasisSH(vec3 n, out float basis[SH_COEFFICIENTS])
+{
+    basis[0] = 0.282095;
+    basis[1] = 0.488603*n.y;
+    basis[2] = 0.488603*n.z;
+    basis[3] = 0.488603*n.x;
+    basis[4] = 1.092548*n.x*n.y;
+    basis[5] = 1.092548*n.y*n.z;
+    basis[6] = 0.315392*(3.0*n.z*n.z - 1.0);
+    basis[7] = 1.092548*n.x*n.z;
+    basis[8] = 0.546274*(n.x*n.x - n.y*n.y);
+}
+
+void StorePrefilter(int mip, ivec3 coords, vec3 color)
+{
+    if (mip == 0) imageStore(prefilterMip0, coords, vec4(color, 1.0));
+    else if (mip == 1) imageStore(prefilterMip1, coords, vec4(color, 1.0));
+    else if (mip == 2) imageStore(prefilterMip2, coords, vec4(color, 1.0));
+    else if (mip == 3) imageStore(prefilterMip3, coords, vec4(color, 1.0));
+    else imageStore(prefilterMip4, coords, vec4(color, 1.0));
+}
+
+void main()
+{
+    int group = int(gl_WorkGroupID.x);
+    uint thread = gl_LocalInvocationIndex;
+
+    if (group < tileOffsets[MAX_MIPMAP_LEVELS])
+    {
+        // Get prefilter mip level, face and texel from flattened tiles index
+        int mip = 0;
+        while (group >= tileOffsets[mip + 1]) mip++;
+
+        int size = max(prefilterSize >> mip, 1);
+        int tilesPerRow = (size + TILE_SIZE - 1)/TILE_SIZE;
+        int tile = group - tileOffsets[mip];
+        int face = tile/(tilesPerRow*tilesPerRow);
+        tile -= face*tilesPerRow*tilesPerRow;
+        ivec2 texel = ivec2(tile%tilesPerRow, tile/tilesPerRow)*TILE_SIZE + ivec2(gl_LocalInvocationID.xy);
+        float roughness = float(mip)/float(MAX_MIPMAP_LEVELS - 1);
+
+        // Cache lobe samples once per workgroup (shared by all tile texels)
+        if (mip > 0)
+        {
+            for (uint i = thread; i < MAX_SAMPLES; i += GROUP_THREADS) samples[i] = GetSample(i, roughness);
+        }
+
+        barrier();
+
+        if (all(lessThan(texel, ivec2(size))))
+        {
+            vec3 N = GetCubeDirection(face, (vec2(texel) + 0.5)/float(size)*2.0 - 1.0);
+            vec3 prefilteredColor = vec3(0.0);
+
+            // Zero roughness lobe samples are all equal to normal direction
+            if (mip == 0) prefilteredColor = textureLod(environmentMap, N, 0.0).rgb;
+            else
+            {
+                vec3 up = ((abs(N.z) < 0.999) ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0));
+                vec3 tangent = normalize(cross(up, N));
+                vec3 bitangent = cross(N, tangent);
+                float totalWeight = 0.0;
+
+                for (uint i = 0u; i < MAX_SAMPLES; i++)
+                {
+                    vec4 s = samples[i];
+
+                    if (s.z > 0.0)
+                    {
+                        vec3 L = tangent*s.x + bitangent*s.y + N*s.z;
+                        prefilteredColor += textureLod(environmentMap, L, s.w).rgb*s.z;
+                        totalWeight += s.z;
+                    }
+                }
+
+                prefilteredColor = prefilteredColor/totalWeight;
+            }
+
+            StorePrefilter(mip, ivec3(texel, face), prefilteredColor);
+        }
+    }
+    else
+    {
+        // Project low resolution source texels into spherical harmonics weighted by texel solid angle
+        int count = 6*SH_SOURCE_SIZE*SH_SOURCE_SIZE;
+        float sourceLod = max(log2(sourceSize/float(SH_SOURCE_SIZE)), 0.0);
+        vec3 sh[SH_COEFFICIENTS];
+        float basis[SH_COEFFICIENTS];
+        float totalWeight = 0.0;
+
+        for (int c = 0; c < SH_COEFFICIENTS; c++) sh[c] = vec3(0.0);
+
+        for (int i = int(thread); i < count; i += GROUP_THREADS)
+        {
+            int face = i/(SH_SOURCE_SIZE*SH_SOURCE_SIZE);
+            int index = i - face*SH_SOURCE_SIZE*SH_SOURCE_SIZE;
+            vec2 st = (vec2(index%SH_SOURCE_SIZE, index/SH_SOURCE_SIZE) + 0.5)/float(SH_SOURCE_SIZE)*2.0 - 1.0;
+            float weight = 1.0/pow(1.0 + dot(st, st), 1.5);
+            vec3 n = GetCubeDirection(face, st);
+            vec3 radiance = textureLod(environmentMap, n, sourceLod).rgb*weight;
+
+            GetBasisSH(n, basis);
+            for (int c = 0; c < SH_COEFFICIENTS; c++) sh[c] += radiance*basis[c];
+            totalWeight += weight;
+        }
+
+        // Reduce threads coefficients in shared memory (total weight reduced with first coefficient)
+        for (int c = 0; c < SH_COEFFICIENTS; c++)
+        {
+            partialSums[thread] = vec4(sh[c], totalWeight);
+            barrier();
+
+            for (uint offset = GROUP_THREADS/2; offset > 0u; offset >>= 1u)
+            {
+                if (thread < offset) partialSums[thread] += partialSums[thread + offset];
+                barrier();
+            }
+
+            if (thread == 0u) coefficients[c] = partialSums[0].rgb*4.0*PI/partialSums[0].w;
+            barrier();
+        }
+
+        // Convolve with clamped cosine lobe and write irradiance (divided by PI like irradiance.fs)
+        const float bands[SH_COEFFICIENTS] = float[SH_COEFFICIENTS](1.0, 2.0/3.0, 2.0/3.0, 2.0/3.0, 0.25, 0.25, 0.25, 0.25, 0.25);
+        int irradianceCount = 6*irradianceSize*irradianceSize;
+
+        for (int i = int(thread); i < irradianceCount; i += GROUP_THREADS)
+        {
+            int face = i/(irradianceSize*irradianceSize);
+            int index = i - face*irradianceSize*irradianceSize;
+            ivec2 texel = ivec2(index%irradianceSize, index/irradianceSize);
+            vec3 n = GetCubeDirection(face, (vec2(texel) + 0.5)/float(irradianceSize)*2.0 - 1.0);
+            vec3 irradiance = vec3(0.0);
+
+            GetBasisSH(n, basis);
+            for (int c = 0; c < SH_COEFFICIENTS; c++) irradiance += coefficients[c]*bands[c]*basis[c];
+
+            imageStore(irradianceMap, ivec3(texel, face), vec4(max(irradiance, vec3(0.0)), 1.0));
+        }
+    }
+}
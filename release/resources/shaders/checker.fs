@@ -0,0 +1,110 @@
+/*******************************************************************************************
+*
+*   rPBR [shader] - Checkerboard rendering reconstruction fragment shader
+*
+*   Copyright (c) 2017 Victor Fisac
+*
+**********************************************************************************************/
+
+#version 330
+
+#define     HISTORY_CLAMP_MARGIN    0.02
+#define     GRADIENT_EPSILON        0.001
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform sampler2D depthTexture;
+uniform sampler2D historyTexture;
+uniform vec2 resolution;
+uniform int frame;
+uniform int validHistory;
+uniform mat4 invViewProj;
+uniform mat4 prevViewProj;
+
+// Output fragment color
+out vec4 finalColor;
+
+bool IsShaded(ivec2 pixel)
+{
+    ivec2 block = pixel/2;
+    return (((block.x + block.y + frame) & 1) == 0);
+}
+
+vec3 AveragePair(vec3 a, bool validA, vec3 b, bool validB)
+{
+    if (validA && validB) return (a + b)*0.5;
+    return (validA ? a : b);
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    // Keep pixels shaded in current frame
+    if (IsShaded(pixel))
+    {
+        finalColor = vec4(texelFetch(texture0, pixel, 0).rgb, 1.0);
+        return;
+    }
+
+    // Fetch shaded neighbours (adjacent blocks are always shaded in current frame)
+    ivec2 size = ivec2(resolution);
+    ivec2 offsets[4] = ivec2[4](ivec2(-2, 0), ivec2(2, 0), ivec2(0, -2), ivec2(0, 2));
+    vec3 colors[4];
+    bool valid[4];
+    vec3 minColor = vec3(1.0);
+    vec3 maxColor = vec3(0.0);
+    float depth = 1.0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 neighbour = pixel + offsets[i];
+        valid[i] = (all(greaterThanEqual(neighbour, ivec2(0))) && all(lessThan(neighbour, size)));
+        colors[i] = vec3(0.0);
+
+        if (valid[i])
+        {
+            colors[i] = texelFetch(texture0, neighbour, 0).rgb;
+            minColor = min(minColor, colors[i]);
+            maxColor = max(maxColor, colors[i]);
+
+            // Use closest neighbour depth to follow foreground edges
+            depth = min(depth, texelFetch(depthTexture, neighbour, 0).r);
+        }
+    }
+
+    // Interpolate neighbours along the direction with lower color gradient
+    vec3 horizontal = AveragePair(colors[0], valid[0], colors[1], valid[1]);
+    vec3 vertical = AveragePair(colors[2], valid[2], colors[3], valid[3]);
+    float horizontalWeight = 1.0/(((valid[0] && valid[1]) ? length(colors[0] - colors[1]) : 1.0) + GRADIENT_EPSILON);
+    float verticalWeight = 1.0/(((valid[2] && valid[3]) ? length(colors[2] - colors[3]) : 1.0) + GRADIENT_EPSILON);
+    vec3 spatial = (horizontal*horizontalWeight + vertical*verticalWeight)/(horizontalWeight + verticalWeight);
+
+    // Reproject pixel into previous frame using current camera and neighbours depth
+    if (validHistory == 1)
+    {
+        vec2 uv = (vec2(pixel) + 0.5)/resolution;
+        vec4 worldPos = invViewProj*vec4(vec3(uv, depth)*2.0 - 1.0, 1.0);
+        worldPos /= worldPos.w;
+
+        vec4 prevPos = prevViewProj*worldPos;
+        vec2 prevUv = (prevPos.xy/prevPos.w)*0.5 + 0.5;
+
+        if ((prevPos.w > 0.0) && all(greaterThanEqual(prevUv, vec2(0.0))) && all(lessThanEqual(prevUv, vec2(1.0))))
+        {
+            // Clamp previous frame color to neighbours range to reject disoccluded surfaces
+            vec3 history = texture(historyTexture, prevUv).rgb;
+            history = clamp(history, minColor - HISTORY_CLAMP_MARGIN, maxColor + HISTORY_CLAMP_MARGIN);
+
+            // Calculate final fragment color
+            finalColor = vec4(history, 1.0);
+            return;
+        }
+    }
+
+    // Calculate final fragment color
+    finalColor = vec4(spatial, 1.0);
+}
@@ -0,0 +1,28 @@
+/*******************************************************************************************
+*
+*   rPBR [shader] - Checkerboard rendering stencil mask fragment shader
+*
+*   Copyright (c) 2017 Victor Fisac
+*
+**********************************************************************************************/
+
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+
+// Input uniform values
+uniform int frame;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // Discard 2x2 pixels blocks not shaded in current frame
+    ivec2 block = ivec2(gl_FragCoord.xy)/2;
+    if (((block.x + block.y + frame) & 1) != 0) discard;
+
+    // Calculate final fragment color (just stencil is written)
+    finalColor = vec4(1.0);
+}
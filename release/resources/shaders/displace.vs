@@ -0,0 +1,33 @@
+/*******************************************************************************************
+*
+*   rPBR [shader] - Height map displacement tessellation vertex shader
+*
+*   Copyright (c) 2017 Victor Fisac
+*
+**********************************************************************************************/
+
+#version 400
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec3 vertexNormal;
+in vec3 vertexTangent;
+in float vertexVariance;
+
+// Output vertex attributes (to tessellation control shader)
+out vec3 controlPosition;
+out vec2 controlTexCoord;
+out vec3 controlNormal;
+out vec3 controlTangent;
+out float controlVariance;
+
+void main()
+{
+    // Send vertex attributes in model space to tessellation stages
+    controlPosition = vertexPosition;
+    controlTexCoord = vertexTexCoord;
+    controlNormal = vertexNormal;
+    controlTangent = vertexTangent;
+    controlVariance = vertexVariance;
+}
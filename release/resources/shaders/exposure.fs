@@ -0,0 +1,42 @@
+/*******************************************************************************************
+*
+*   rPBR [shader] - Exposure temporal adaptation fragment shader (auto exposure)
+*
+*   Copyright (c) 2017 Victor Fisac
+*
+**********************************************************************************************/
+
+#version 330
+
+#define     KEY_VALUE               0.18
+#define     MIN_EXPOSURE            0.05
+#define     MAX_EXPOSURE            8.0
+#define     ADAPTATION_SPEED        1.5
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+
+// Input uniform values
+uniform sampler2D luminanceMap;
+uniform sampler2D exposureMap;
+uniform float level;
+uniform float deltaTime;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // Get scene average luminance from last log luminance mipmap level
+    float averageLuminance = exp2(textureLod(luminanceMap, vec2(0.5), level).r);
+
+    // Calculate exposure that maps average luminance to middle gray
+    float targetExposure = clamp(KEY_VALUE/averageLuminance, MIN_EXPOSURE, MAX_EXPOSURE);
+
+    // Adapt previous exposure to target exposure with an exponential decay (frame rate independent)
+    float exposure = texelFetch(exposureMap, ivec2(0), 0).r;
+    exposure += (targetExposure - exposure)*(1.0 - exp(-deltaTime*ADAPTATION_SPEED));
+
+    // Calculate final fragment color
+    finalColor = vec4(exposure, 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,37 @@
+/*******************************************************************************************
+*
+*   rPBR [shader] - Scene log luminance fragment shader (auto exposure)
+*
+*   Copyright (c) 2017 Victor Fisac
+*
+**********************************************************************************************/
+
+#version 330
+
+#define     MAX_TONEMAPPED          0.995
+#define     MIN_LUMINANCE           0.0001
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform sampler2D exposureMap;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // Revert gamma correction and Reinhard tonemapping to get exposed scene color
+    vec3 color = pow(texture(texture0, fragTexCoord).rgb, vec3(2.2));
+    color = min(color, vec3(MAX_TONEMAPPED));
+    color = color/(vec3(1.0) - color);
+
+    // Remove exposure used to draw scene and store log luminance to be averaged by mipmaps
+    float exposure = texelFetch(exposureMap, ivec2(0), 0).r;
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722))/exposure;
+
+    // Calculate final fragment color
+    finalColor = vec4(log2(max(luminance, MIN_LUMINANCE)), 0.0, 0.0, 1.0);
+}
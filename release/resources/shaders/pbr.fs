@@ -14,6 +14,14 @@
 #define     MIN_DEPTH_LAYER         10
 #define     LIGHT_DIRECTIONAL       0
 #define     LIGHT_POINT             1
+#define     LIGHT_RECT              2
+#define     LIGHT_DISK              3
+#define     LTC_MAX_FORM_FACTOR     0.9999
+#define     WIRE_WIDTH              1.0
+#define     WIRE_COLOR              vec3(0.31)
+#define     HALF_ROUGHNESS          0.5
+#define     HALF_DEPTH_SIGMA        0.05
+#define     HALF_NORMAL_POWER       16.0
 
 struct MaterialProperty {
     vec3 color;
@@ -27,6 +35,7 @@ struct Light {
     vec3 position;
     vec3 target;
     vec4 color;
+    vec2 size;
 };
 
 // Input vertex attributes (from vertex shader)
@@ -35,6 +44,7 @@ in vec3 fragPos;
 in vec3 fragNormal;
 in vec3 fragTangent;
 in vec3 fragBinormal;
+in vec3 fragBarycentric;
 
 // Input material values
 uniform MaterialProperty albedo;
@@ -52,17 +62,35 @@ uniform Light lights[MAX_LIGHTS];
 uniform samplerCube irradianceMap;
 uniform samplerCube prefilterMap;
 uniform sampler2D brdfLUT;
+uniform sampler2DArray ltcTable;            // Area lights LTC table (layer 0: inverse matrix, layer 1: BRDF magnitude and Fresnel)
+
+// Input half resolution lighting values
+uniform sampler2D halfIrradiance;
+uniform sampler2D halfSpecular;
+uniform sampler2D halfGeometry;
+uniform int lightingMode;                   // 0: full rate lighting, 1: draw half resolution lighting, 2: upsample half resolution lighting
+
+// Input automatic exposure values
+uniform sampler2D exposureMap;
+uniform int autoExposure;
+
+// Input screen space ambient occlusion values
+uniform sampler2D ssaoMap;                  // Half resolution ambient occlusion (R: occlusion, G: view distance)
+uniform int ssaoMode;
 
 // Other uniform values
 uniform int renderMode;
+uniform int drawWire;
 uniform vec3 viewPos;
 vec2 texCoord;
 
 // Constant values
 const float PI = 3.14159265359;
 
-// Output fragment color
-out vec4 finalColor;
+// Output fragment color (and half resolution lighting values)
+layout(location = 0) out vec4 finalColor;
+layout(location = 1) out vec4 finalSpecular;
+layout(location = 2) out vec4 finalGeometry;
 
 vec3 ComputeMaterialProperty(MaterialProperty property);
 float DistributionGGX(vec3 N, vec3 H, float roughness);
@@ -71,6 +99,14 @@ float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness);
 vec3 fresnelSchlick(float cosTheta, vec3 F0);
 vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness);
 vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir);
+vec4 UpsampleLighting(sampler2D source, vec3 normal, float depth);
+float UpsampleOcclusion(float depth);
+vec3 IntegrateEdge(vec3 v1, vec3 v2);
+float SphereFormFactor(float formFactor, float cosTheta);
+vec3 SolveCubic(vec4 coefficients);
+float EvaluateRectLTC(vec3 N, vec3 V, vec3 P, mat3 Minv, vec3 points[4]);
+float EvaluateDiskLTC(vec3 N, vec3 V, vec3 P, mat3 Minv, vec3 center, vec3 axisX, vec3 axisY);
+mat3 GetShadingFrame(vec3 N, vec3 V);
 
 vec3 ComputeMaterialProperty(MaterialProperty property)
 {
@@ -166,6 +202,231 @@ vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir)
     return finalTexCoords;
 }
 
+vec4 UpsampleLighting(sampler2D source, vec3 normal, float depth)
+{
+    // Calculate half resolution texel position and bilinear weights of the 4 nearest texels
+    ivec2 size = textureSize(source, 0);
+    vec2 position = gl_FragCoord.xy*0.5 - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 f = fract(position);
+    vec4 bilinear = vec4((1.0 - f.x)*(1.0 - f.y), f.x*(1.0 - f.y), (1.0 - f.x)*f.y, f.x*f.y);
+
+    vec4 result = vec4(0.0);
+    float total = 0.0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 coord = clamp(base + ivec2(i%2, i/2), ivec2(0), size - 1);
+        vec4 geometry = texelFetch(halfGeometry, coord, 0);
+        vec4 value = texelFetch(source, coord, 0);
+
+        // Weight texels by depth and normal similarity to avoid leaking lighting across edges
+        float depthWeight = exp(-abs(geometry.w - depth)/(depth*HALF_DEPTH_SIGMA));
+        float normalWeight = pow(max(dot(normal, geometry.xyz), 0.0), HALF_NORMAL_POWER);
+        float weight = bilinear[i]*depthWeight*normalWeight*value.a;
+
+        result += vec4(value.rgb*weight, 0.0);
+        total += weight;
+    }
+
+    // Return alpha 0 if no texel is similar enough (lighting must be calculated at full rate)
+    if (total < 0.0001) return vec4(0.0);
+    else return vec4(result.rgb/total, 1.0);
+}
+
+float UpsampleOcclusion(float depth)
+{
+    // Calculate half resolution texel position and bilinear weights of the 4 nearest texels
+    ivec2 size = textureSize(ssaoMap, 0);
+    vec2 position = gl_FragCoord.xy*0.5 - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 f = fract(position);
+    vec4 bilinear = vec4((1.0 - f.x)*(1.0 - f.y), f.x*(1.0 - f.y), (1.0 - f.x)*f.y, f.x*f.y);
+
+    float result = 0.0;
+    float total = 0.0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        // Weight texels by view distance similarity to avoid leaking occlusion across edges
+        vec2 value = texelFetch(ssaoMap, clamp(base + ivec2(i%2, i/2), ivec2(0), size - 1), 0).rg;
+        float weight = bilinear[i]*exp(-abs(value.g - depth)/(depth*HALF_DEPTH_SIGMA));
+
+        result += value.r*weight;
+        total += weight;
+    }
+
+    // Return no occlusion if no texel belongs to same surface
+    if (total < 0.0001) return 1.0;
+    else return result/total;
+}
+
+vec3 IntegrateEdge(vec3 v1, vec3 v2)
+{
+    // Calculate edge vector form factor using a cubic fit of theta/sin(theta) (accurate for any edge angle)
+    float x = dot(v1, v2);
+    float y = abs(x);
+    float a = 0.8543985 + (0.4965155 + 0.0145206*y)*y;
+    float b = 3.4175940 + (4.1616724 + y)*y;
+    float v = a/b;
+    float thetaSinTheta = (x > 0.0) ? v : 0.5*inversesqrt(max(1.0 - x*x, 1e-7)) - v;
+
+    return cross(v1, v2)*thetaSinTheta;
+}
+
+float SphereFormFactor(float formFactor, float cosTheta)
+{
+    // Calculate horizon clipped form factor of a sphere with same vector form factor (avoids polygon clipping)
+    float sinSigmaSqr = min(formFactor, LTC_MAX_FORM_FACTOR);
+    float illuminance = 0.0;
+
+    if (cosTheta*cosTheta > sinSigmaSqr) illuminance = PI*sinSigmaSqr*clamp(cosTheta, 0.0, 1.0);
+    else
+    {
+        float sinTheta = sqrt(max(1.0 - cosTheta*cosTheta, 0.0));
+        float x = sqrt(1.0/sinSigmaSqr - 1.0);
+        float y = -x*(cosTheta/sinTheta);
+        float sinThetaSqrtY = sinTheta*sqrt(max(1.0 - y*y, 0.0));
+        illuminance = (cosTheta*acos(clamp(y, -1.0, 1.0)) - x*sinThetaSqrtY)*sinSigmaSqr + atan(sinThetaSqrtY/x);
+    }
+
+    return max(illuminance, 0.0)/PI;
+}
+
+vec3 SolveCubic(vec4 coefficients)
+{
+    // Blinn's stable cubic solver, returns roots sorted as (middle, smallest, largest) order used by ellipse integration
+    coefficients.xyz /= coefficients.w;
+    coefficients.yz /= 3.0;
+
+    float A = coefficients.w;
+    float B = coefficients.z;
+    float C = coefficients.y;
+    float D = coefficients.x;
+
+    // Compute the Hessian and the discriminant
+    vec3 delta = vec3(-coefficients.z*coefficients.z + coefficients.y, -coefficients.y*coefficients.z + coefficients.x, dot(vec2(coefficients.z, -coefficients.y), coefficients.xy));
+    float discriminant = dot(vec2(4.0*delta.x, -delta.y), delta.zy);
+
+    // Algorithm A (largest root)
+    float theta = atan(sqrt(discriminant), -(-2.0*B*delta.x + delta.y))/3.0;
+    float x1 = 2.0*sqrt(-delta.x)*cos(theta);
+    float x3 = 2.0*sqrt(-delta.x)*cos(theta + (2.0/3.0)*PI);
+    float xl = ((x1 + x3) > 2.0*B) ? x1 : x3;
+    vec2 xlc = vec2(xl - B, A);
+
+    // Algorithm D (smallest root)
+    theta = atan(D*sqrt(discriminant), -(-D*delta.y + 2.0*C*delta.z))/3.0;
+    x1 = 2.0*sqrt(-delta.z)*cos(theta);
+    x3 = 2.0*sqrt(-delta.z)*cos(theta + (2.0/3.0)*PI);
+    float xs = ((x1 + x3) < 2.0*C) ? x1 : x3;
+    vec2 xsc = vec2(-D, xs + C);
+
+    // Middle root from the other two
+    float E = xlc.y*xsc.y;
+    float F = -xlc.x*xsc.y - xlc.y*xsc.x;
+    float G = xlc.x*xsc.x;
+    vec2 xmc = vec2(C*F - B*G, -B*F + C*E);
+
+    vec3 root = vec3(xsc.x/xsc.y, xmc.x/xmc.y, xlc.x/xlc.y);
+    if ((root.x < root.y) && (root.x < root.z)) root.xyz = root.yxz;
+    else if ((root.z < root.x) && (root.z < root.y)) root.xyz = root.xzy;
+
+    return root;
+}
+
+mat3 GetShadingFrame(vec3 N, vec3 V)
+{
+    // Calculate orthonormal frame around normal with view vector in XZ plane (LTC table parametrization)
+    vec3 T1 = V - N*dot(V, N);
+    if (dot(T1, T1) < 1e-6) T1 = (abs(N.x) < 0.9) ? cross(N, vec3(1.0, 0.0, 0.0)) : cross(N, vec3(0.0, 1.0, 0.0));
+    T1 = normalize(T1);
+    vec3 T2 = cross(N, T1);
+
+    return transpose(mat3(T1, T2, N));
+}
+
+float EvaluateRectLTC(vec3 N, vec3 V, vec3 P, mat3 Minv, vec3 points[4])
+{
+    // Transform polygon to cosine distribution space
+    Minv = Minv*GetShadingFrame(N, V);
+
+    vec3 L[4];
+    for (int i = 0; i < 4; i++) L[i] = normalize(Minv*(points[i] - P));
+
+    // Integrate polygon edges to get its vector form factor
+    vec3 formFactor = IntegrateEdge(L[0], L[1]) + IntegrateEdge(L[1], L[2]) + IntegrateEdge(L[2], L[3]) + IntegrateEdge(L[3], L[0]);
+    float len = length(formFactor);
+    if (len <= 0.0) return 0.0;
+
+    // Note: polygon winding is clockwise as seen from lit side, so form factor points away from normal
+    return SphereFormFactor(len, -formFactor.z/len);
+}
+
+float EvaluateDiskLTC(vec3 N, vec3 V, vec3 P, mat3 Minv, vec3 center, vec3 axisX, vec3 axisY)
+{
+    // Transform ellipse center and axes to cosine distribution space
+    Minv = Minv*GetShadingFrame(N, V);
+    vec3 C = Minv*(center - P);
+    vec3 V1 = Minv*axisX;
+    vec3 V2 = Minv*axisY;
+
+    // Get transformed ellipse orthogonal axes using eigen decomposition
+    float a = 0.0;
+    float b = 0.0;
+    float d11 = dot(V1, V1);
+    float d22 = dot(V2, V2);
+    float d12 = dot(V1, V2);
+
+    if (abs(d12)/sqrt(d11*d22) > 0.0001)
+    {
+        float tr = d11 + d22;
+        float det = sqrt(-d12*d12 + d11*d22);
+        float u = 0.5*sqrt(tr - 2.0*det);
+        float v = 0.5*sqrt(tr + 2.0*det);
+        float eMax = (u + v)*(u + v);
+        float eMin = (u - v)*(u - v);
+
+        vec3 V1b = (d11 > d22) ? d12*V1 + (eMax - d11)*V2 : d12*V2 + (eMax - d22)*V1;
+        vec3 V2b = (d11 > d22) ? d12*V1 + (eMin - d11)*V2 : d12*V2 + (eMin - d22)*V1;
+
+        a = 1.0/eMax;
+        b = 1.0/eMin;
+        V1 = normalize(V1b);
+        V2 = normalize(V2b);
+    }
+    else
+    {
+        a = 1.0/d11;
+        b = 1.0/d22;
+        V1 *= sqrt(a);
+        V2 *= sqrt(b);
+    }
+
+    vec3 V3 = cross(V1, V2);
+    if (dot(C, V3) < 0.0) V3 *= -1.0;
+
+    // Project ellipse on unit distance plane and solve its cone eigenvalues
+    float L = dot(V3, C);
+    float x0 = dot(V1, C)/L;
+    float y0 = dot(V2, C)/L;
+    a *= L*L;
+    b *= L*L;
+
+    float c0 = a*b;
+    float c1 = a*b*(1.0 + x0*x0 + y0*y0) - a - b;
+    float c2 = 1.0 - a*(1.0 + x0*x0) - b*(1.0 + y0*y0);
+    vec3 roots = SolveCubic(vec4(c0, c1, c2, 1.0));
+
+    // Calculate cone average direction and form factor
+    vec3 avgDir = normalize(mat3(V1, V2, V3)*vec3(a*x0/(a - roots.y), b*y0/(b - roots.y), 1.0));
+    float L1 = sqrt(-roots.y/roots.z);
+    float L2 = sqrt(-roots.y/roots.x);
+    float formFactor = L1*L2*inversesqrt((1.0 + L1*L1)*(1.0 + L2*L2));
+
+    return SphereFormFactor(formFactor, avgDir.z);
+}
+
 void main()
 {
     // Calculate TBN and RM matrices
@@ -187,6 +448,9 @@ void main()
     vec3 emiss = ComputeMaterialProperty(emission);
     vec3 occlusion = ComputeMaterialProperty(ao);
 
+    // Use screen space ambient occlusion if material has no ambient occlusion map
+    if ((ao.useSampler == 0) && (ssaoMode == 1)) occlusion *= UpsampleOcclusion(length(viewPos - fragPos));
+
     // Check if normal mapping is enabled
     if (normals.useSampler == 1)
     {
@@ -199,17 +463,77 @@ void main()
         refl = normalize(reflect(-view, normal));
     }
 
+    // Draw low frequency image based lighting values to half resolution target
+    if (lightingMode == 1)
+    {
+        finalColor = vec4(texture(irradianceMap, fragNormal).rgb, 1.0);
+        if (rough.r >= HALF_ROUGHNESS) finalSpecular = vec4(textureLod(prefilterMap, refl, rough.r*MAX_REFLECTION_LOD).rgb, 1.0);
+        else finalSpecular = vec4(0.0);
+        finalGeometry = vec4(normalize(fragNormal), length(viewPos - fragPos));
+        return;
+    }
+
     // Calculate reflectance at normal incidence
     vec3 F0 = vec3(0.04);
     F0 = mix(F0, color, metal.r);
 
+    // Fetch area lights LTC inverse matrix and BRDF terms based on roughness and view angle
+    vec2 ltcSize = vec2(textureSize(ltcTable, 0).xy);
+    vec2 ltcCoord = vec2(rough.r, sqrt(1.0 - max(dot(normal, view), 0.0)))*(ltcSize - 1.0)/ltcSize + 0.5/ltcSize;
+    vec4 ltcMatrix = texture(ltcTable, vec3(ltcCoord, 0.0));
+    vec2 ltcTerms = texture(ltcTable, vec3(ltcCoord, 1.0)).xy;
+    mat3 ltcMinv = mat3(vec3(ltcMatrix.x, 0.0, ltcMatrix.y), vec3(0.0, 1.0, 0.0), vec3(ltcMatrix.z, 0.0, ltcMatrix.w));
+
     // Calculate lighting for all lights
     vec3 Lo = vec3(0.0);
     vec3 lightDot = vec3(0.0);
 
     for (int i = 0; i < MAX_LIGHTS; i++)
     {
-        if (lights[i].enabled == 1)
+        if ((lights[i].enabled == 1) && (lights[i].type >= LIGHT_RECT))
+        {
+            // Calculate area light frame facing its target
+            vec3 forward = normalize(lights[i].target - lights[i].position);
+            vec3 right = normalize(cross(forward, (abs(forward.y) < 0.99) ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+            vec3 up = cross(right, forward);
+            vec3 axisX = right*lights[i].size.x*0.5;
+            vec3 axisY = up*lights[i].size.y*0.5;
+
+            // Skip fragments behind one-sided area light
+            if (dot(fragPos - lights[i].position, forward) <= 0.0) continue;
+
+            // Evaluate diffuse (cosine distribution) and specular (fitted GGX distribution) form factors
+            float diffuseFactor = 0.0;
+            float specularFactor = 0.0;
+            float area = lights[i].size.x*lights[i].size.y;
+
+            if (lights[i].type == LIGHT_RECT)
+            {
+                vec3 points[4];
+                points[0] = lights[i].position - axisX - axisY;
+                points[1] = lights[i].position - axisX + axisY;
+                points[2] = lights[i].position + axisX + axisY;
+                points[3] = lights[i].position + axisX - axisY;
+
+                diffuseFactor = EvaluateRectLTC(normal, view, fragPos, mat3(1.0), points);
+                specularFactor = EvaluateRectLTC(normal, view, fragPos, ltcMinv, points);
+            }
+            else
+            {
+                diffuseFactor = EvaluateDiskLTC(normal, view, fragPos, mat3(1.0), lights[i].position, axisX, axisY);
+                specularFactor = EvaluateDiskLTC(normal, view, fragPos, ltcMinv, lights[i].position, axisX, axisY);
+                area *= PI*0.25;
+            }
+
+            // Emitted radiance keeps same power as a point light with same color when resized
+            vec3 radiance = lights[i].color.rgb*lights[i].color.a/max(area, 0.0001);
+            vec3 specular = specularFactor*(F0*ltcTerms.x + (1.0 - F0)*ltcTerms.y);
+            vec3 kD = (1.0 - F0)*(1.0 - metal.r);
+
+            Lo += (kD*color*diffuseFactor + specular)*radiance;
+            lightDot += (diffuseFactor + specular)*radiance;
+        }
+        else if (lights[i].enabled == 1)
         {
             // Calculate per-light radiance
             vec3 light = vec3(0.0);
@@ -255,12 +579,23 @@ void main()
     vec3 kD = 1.0 - kS;
     kD *= 1.0 - metal.r;
 
+    // Upsample half resolution lighting values if available
+    vec4 halfIrradianceColor = vec4(0.0);
+    vec4 halfPrefilterColor = vec4(0.0);
+
+    if (lightingMode == 2)
+    {
+        float depth = length(viewPos - fragPos);
+        halfIrradianceColor = UpsampleLighting(halfIrradiance, normalize(fragNormal), depth);
+        if (rough.r >= HALF_ROUGHNESS) halfPrefilterColor = UpsampleLighting(halfSpecular, normalize(fragNormal), depth);
+    }
+
     // Calculate indirect diffuse
-    vec3 irradiance = texture(irradianceMap, fragNormal).rgb;
+    vec3 irradiance = (halfIrradianceColor.a > 0.0) ? halfIrradianceColor.rgb : texture(irradianceMap, fragNormal).rgb;
     vec3 diffuse = color*irradiance;
 
     // Sample both the prefilter map and the BRDF lut and combine them together as per the Split-Sum approximation
-    vec3 prefilterColor = textureLod(prefilterMap, refl, rough.r*MAX_REFLECTION_LOD).rgb;
+    vec3 prefilterColor = (halfPrefilterColor.a > 0.0) ? halfPrefilterColor.rgb : textureLod(prefilterMap, refl, rough.r*MAX_REFLECTION_LOD).rgb;
     vec2 brdf = texture(brdfLUT, vec2(max(dot(normal, view), 0.0), rough.r)).rg;
     vec3 reflection = prefilterColor*(F*brdf.x + brdf.y);
 
@@ -280,12 +615,22 @@ void main()
     else if (renderMode == 9) fragmentColor = irradiance;                   // Irradiance
     else if (renderMode == 10) fragmentColor = reflection;                  // Reflection
 
+    // Apply automatic exposure calculated on GPU
+    if (autoExposure == 1) fragmentColor *= texelFetch(exposureMap, ivec2(0), 0).r;
+
     // Apply HDR tonemapping
     fragmentColor = fragmentColor/(fragmentColor + vec3(1.0));
 
     // Apply gamma correction
     fragmentColor = pow(fragmentColor, vec3(1.0/2.2));
 
+    // Draw triangle edges with constant screen-space width based on barycentric coordinates derivatives
+    if (drawWire == 1)
+    {
+        vec3 edge = smoothstep(vec3(0.0), fwidth(fragBarycentric)*WIRE_WIDTH, fragBarycentric);
+        fragmentColor = mix(WIRE_COLOR, fragmentColor, min(min(edge.x, edge.y), edge.z));
+    }
+
     // Calculate final fragment color
     finalColor = vec4(fragmentColor, 1.0);
 }
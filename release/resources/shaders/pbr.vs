@@ -24,6 +24,7 @@ out vec3 fragPos;
 out vec3 fragNormal;
 out vec3 fragTangent;
 out vec3 fragBinormal;
+out vec3 fragBarycentric;
 
 void main()
 {
@@ -44,6 +45,10 @@ void main()
     fragBinormal = normalize(normalMatrix*vertexBinormal);
     fragBinormal = cross(fragNormal, fragTangent);
 
+    // Calculate vertex barycentric coordinates for wireframe drawing (mesh triangles are not indexed)
+    int corner = gl_VertexID%3;
+    fragBarycentric = vec3(float(corner == 0), float(corner == 1), float(corner == 2));
+
     // Calculate final vertex position
     gl_Position = mvpMatrix*vec4(vertexPosition, 1.0);
 }
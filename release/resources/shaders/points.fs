@@ -0,0 +1,61 @@
+/*******************************************************************************************
+*
+*   rPBR [shader] - Point cloud splats fragment shader
+*
+*   Copyright (c) 2017 Victor Fisac
+*
+**********************************************************************************************/
+
+#version 330
+
+#define     MAX_REFLECTION_LOD      4.0
+
+// Input vertex attributes (from vertex shader)
+in vec3 fragPos;
+in vec3 fragNormal;
+in vec3 fragColor;
+
+// Input uniform values
+uniform samplerCube irradianceMap;
+uniform samplerCube prefilterMap;
+uniform sampler2D brdfLUT;
+
+// Other uniform values
+uniform vec3 viewPos;
+uniform float roughness;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // Discard splat corners to draw round points
+    vec2 coord = gl_PointCoord*2.0 - 1.0;
+    if (dot(coord, coord) > 1.0) discard;
+
+    // Calculate splat lighting vectors (normal faces the camera when points have no normals)
+    vec3 view = normalize(viewPos - fragPos);
+    vec3 normal = fragNormal;
+    if (dot(normal, view) < 0.0) normal = -normal;
+    vec3 refl = reflect(-view, normal);
+
+    // Calculate ambient lighting using IBL with a dielectric material
+    vec3 color = pow(fragColor, vec3(2.2));
+    float NdotV = max(dot(normal, view), 0.0);
+    vec3 F = vec3(0.04) + (max(vec3(1.0 - roughness), vec3(0.04)) - vec3(0.04))*pow(1.0 - NdotV, 5.0);
+    vec3 kD = 1.0 - F;
+
+    vec3 irradiance = texture(irradianceMap, normal).rgb;
+    vec3 prefilterColor = textureLod(prefilterMap, refl, roughness*MAX_REFLECTION_LOD).rgb;
+    vec2 brdf = texture(brdfLUT, vec2(NdotV, roughness)).rg;
+    vec3 fragmentColor = kD*color*irradiance + prefilterColor*(F*brdf.x + brdf.y);
+
+    // Apply HDR tonemapping
+    fragmentColor = fragmentColor/(fragmentColor + vec3(1.0));
+
+    // Apply gamma correction
+    fragmentColor = pow(fragmentColor, vec3(1.0/2.2));
+
+    // Calculate final fragment color
+    finalColor = vec4(fragmentColor, 1.0);
+}
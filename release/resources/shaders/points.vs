@@ -0,0 +1,42 @@
+/*******************************************************************************************
+*
+*   rPBR [shader] - Point cloud splats vertex shader
+*
+*   Copyright (c) 2017 Victor Fisac
+*
+**********************************************************************************************/
+
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexNormal;
+in vec4 vertexColor;
+
+// Input uniform values
+uniform mat4 mvpMatrix;
+uniform mat4 mMatrix;
+uniform float pointScale;
+uniform float splatSize;
+uniform int useNormals;
+
+// Output vertex attributes (to fragment shader)
+out vec3 fragPos;
+out vec3 fragNormal;
+out vec3 fragColor;
+
+void main()
+{
+    // Decode octahedron encoded normal
+    vec3 normal = vec3(vertexNormal, 1.0 - abs(vertexNormal.x) - abs(vertexNormal.y));
+    if (normal.z < 0.0) normal.xy = (1.0 - abs(normal.yx))*vec2((normal.x >= 0.0) ? 1.0 : -1.0, (normal.y >= 0.0) ? 1.0 : -1.0);
+
+    // Send vertex attributes to fragment shader
+    fragPos = vec3(mMatrix*vec4(vertexPosition, 1.0));
+    fragNormal = (useNormals == 1) ? normalize(normal) : vec3(0.0, 1.0, 0.0);
+    fragColor = vertexColor.rgb;
+
+    // Calculate final vertex position and splat size based on points spacing projected to screen
+    gl_Position = mvpMatrix*vec4(vertexPosition, 1.0);
+    gl_PointSize = clamp(splatSize*pointScale/gl_Position.w, 1.0, 64.0);
+}
@@ -13,6 +13,8 @@ in vec3 fragPos;
 
 // Input uniform values
 uniform samplerCube environmentMap;
+uniform sampler2D exposureMap;
+uniform int autoExposure;
 
 // Output fragment color
 out vec4 finalColor;
@@ -22,6 +24,9 @@ void main()
     // Fetch color from texture map
     vec3 color = texture(environmentMap, fragPos).rgb;
 
+    // Apply automatic exposure calculated on GPU
+    if (autoExposure == 1) color *= texelFetch(exposureMap, ivec2(0), 0).r;
+
     // Apply gamma correction
     color = color/(color + vec3(1.0));
     color = pow(color, vec3(1.0/2.2));
@@ -0,0 +1,143 @@
+/*******************************************************************************************
+*
+*   rPBR [shader] - Half resolution horizon based ambient occlusion fragment shader
+*
+*   Copyright (c) 2017 Victor Fisac
+*
+**********************************************************************************************/
+
+#version 330
+
+#define     SAMPLE_DIRECTIONS       2
+#define     SAMPLE_STEPS            4
+#define     OCCLUSION_RADIUS        0.35
+#define     OCCLUSION_INTENSITY     1.5
+#define     OCCLUSION_BIAS          0.1
+#define     MAX_RADIUS_PIXELS       48.0
+#define     BACKGROUND_DISTANCE     1000.0
+#define     HISTORY_WEIGHT          0.9
+#define     HISTORY_DEPTH_SIGMA     0.05
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+
+// Input uniform values
+uniform sampler2D depthTexture;
+uniform sampler2D historyTexture;
+uniform vec2 resolution;
+uniform float projScale;
+uniform int frame;
+uniform int validHistory;
+uniform mat4 invViewProj;
+uniform mat4 prevViewProj;
+uniform vec3 viewPos;
+uniform vec3 prevViewPos;
+
+// Constant values
+const float PI = 3.14159265359;
+
+// Output fragment color
+out vec4 finalColor;
+
+vec3 GetPosition(ivec2 pixel)
+{
+    // Reconstruct world position from depth buffer
+    pixel = clamp(pixel, ivec2(0), ivec2(resolution) - 1);
+    float depth = texelFetch(depthTexture, pixel, 0).r;
+    vec4 position = invViewProj*vec4(vec3((vec2(pixel) + 0.5)/resolution, depth)*2.0 - 1.0, 1.0);
+
+    return position.xyz/position.w;
+}
+
+vec3 GetNormal(ivec2 pixel, vec3 position)
+{
+    // Reconstruct normal using smallest position differences to avoid crossing geometry edges
+    vec3 right = GetPosition(pixel + ivec2(1, 0)) - position;
+    vec3 left = position - GetPosition(pixel - ivec2(1, 0));
+    vec3 up = GetPosition(pixel + ivec2(0, 1)) - position;
+    vec3 down = position - GetPosition(pixel - ivec2(0, 1));
+
+    vec3 dx = (dot(right, right) < dot(left, left)) ? right : left;
+    vec3 dy = (dot(up, up) < dot(down, down)) ? up : down;
+    vec3 normal = normalize(cross(dx, dy));
+
+    // Make sure normal faces camera
+    if (dot(normal, viewPos - position) < 0.0) normal = -normal;
+
+    return normal;
+}
+
+float InterleavedGradientNoise(vec2 position)
+{
+    return fract(52.9829189*fract(dot(position, vec2(0.06711056, 0.00583715))));
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    // Skip background pixels (no occlusion)
+    if (texelFetch(depthTexture, pixel, 0).r >= 1.0)
+    {
+        finalColor = vec4(1.0, BACKGROUND_DISTANCE, 0.0, 1.0);
+        return;
+    }
+
+    vec3 position = GetPosition(pixel);
+    vec3 normal = GetNormal(pixel, position);
+    float distance = length(viewPos - position);
+
+    // Calculate sampling radius in pixels based on view distance
+    float radius = min(OCCLUSION_RADIUS*projScale/distance, MAX_RADIUS_PIXELS);
+    float occlusion = 0.0;
+
+    if (radius >= 1.0)
+    {
+        // Rotate directions and jitter steps per pixel and frame (accumulated by temporal filter)
+        float noise = InterleavedGradientNoise(gl_FragCoord.xy + 5.588238*float(frame%64));
+        float jitter = fract(noise*7.0 + 0.618034*float(frame%64));
+
+        for (int i = 0; i < SAMPLE_DIRECTIONS; i++)
+        {
+            float angle = (float(i) + noise)*(2.0*PI/float(SAMPLE_DIRECTIONS));
+            vec2 direction = vec2(cos(angle), sin(angle));
+
+            for (int j = 0; j < SAMPLE_STEPS; j++)
+            {
+                // Calculate horizon vector and accumulate its elevation over tangent plane
+                vec2 offset = direction*max((float(j) + jitter)/float(SAMPLE_STEPS)*radius, 1.0);
+                vec3 horizon = GetPosition(ivec2(gl_FragCoord.xy + offset)) - position;
+                float lengthSqr = dot(horizon, horizon);
+
+                if (lengthSqr > 0.0)
+                {
+                    float elevation = dot(normal, horizon)*inversesqrt(lengthSqr);
+                    float falloff = clamp(1.0 - lengthSqr/(OCCLUSION_RADIUS*OCCLUSION_RADIUS), 0.0, 1.0);
+                    occlusion += max(elevation - OCCLUSION_BIAS, 0.0)*falloff;
+                }
+            }
+        }
+
+        occlusion /= float(SAMPLE_DIRECTIONS*SAMPLE_STEPS)*(1.0 - OCCLUSION_BIAS);
+    }
+
+    float visibility = clamp(1.0 - occlusion*OCCLUSION_INTENSITY, 0.0, 1.0);
+
+    // Accumulate reprojected previous frame occlusion if it belongs to same surface
+    if (validHistory == 1)
+    {
+        vec4 prevPos = prevViewProj*vec4(position, 1.0);
+        vec2 prevUv = (prevPos.xy/prevPos.w)*0.5 + 0.5;
+
+        if ((prevPos.w > 0.0) && all(greaterThanEqual(prevUv, vec2(0.0))) && all(lessThanEqual(prevUv, vec2(1.0))))
+        {
+            vec2 history = texture(historyTexture, prevUv).rg;
+            float prevDistance = length(prevViewPos - position);
+
+            if (abs(history.g - prevDistance) < prevDistance*HISTORY_DEPTH_SIGMA) visibility = mix(visibility, history.r, HISTORY_WEIGHT);
+        }
+    }
+
+    // Calculate final fragment color
+    finalColor = vec4(visibility, distance, 0.0, 1.0);
+}
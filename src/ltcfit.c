@@ -0,0 +1,582 @@
+/*******************************************************************************************
+*
+*   rPBR [ltcfit] - Linearly transformed cosines fitting tool for GGX area lights
+*
+*   FEATURES:
+*       - Fits a linearly transformed cosine (LTC) to GGX BRDF (Smith height-correlated masking)
+*         for each roughness and view angle pair (Nelder-Mead simplex minimization).
+*       - Computes BRDF magnitude and Fresnel terms used to scale area lights contribution.
+*       - Writes a table loaded by PBR environment into a 2 layers texture array.
+*
+*   NOTES:
+*       Table layout: header "LTC1", size (int), then 2 layers of size*size RGBA float texels.
+*           Layer 0: inverse LTC matrix elements (m00, m20, m02, m22) normalized by m11.
+*           Layer 1: BRDF magnitude, Fresnel magnitude, 0, 0.
+*       Texel x is roughness and texel y is sqrt(1 - cos(theta)) of view vector.
+*       Based on "Real-Time Polygonal-Light Shading with Linearly Transformed Cosines"
+*       (Eric Heitz, Jonathan Dupuy, Stephen Hill and David Neubelt, 2016).
+*
+*   Use the following line to compile (no dependencies):
+*
+*   gcc -o ltcfit ltcfit.c -O2 -lm -std=c99
+*
+*   Run it from release folder to update shipped table: ltcfit resources/tables/ltc_ggx.bin
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+**********************************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdio.h>                          // Required for: printf(), fopen(), fwrite(), fclose()
+#include <stdlib.h>                         // Required for: calloc(), free()
+#include <stdbool.h>                        // Required for: bool
+#include <math.h>                           // Required for: sqrtf(), cosf(), sinf(), acosf(), tanf(), powf(), fabsf()
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         LTC_SIZE                    64                                      // Table size per axis (roughness and view angle)
+#define         LTC_SAMPLES                 32                                      // Stratified samples per axis to compute fitting error
+#define         LTC_MIN_ALPHA               0.00001f                                // Min GGX alpha (avoids degenerated distributions)
+#define         LTC_FIT_DELTA               0.05f                                   // Nelder-Mead initial simplex size
+#define         LTC_FIT_TOLERANCE           0.00001f                                // Nelder-Mead convergence tolerance
+#define         LTC_FIT_ITERATIONS          100                                     // Nelder-Mead max iterations
+
+#define         PATH_LTC_TABLE              "resources/tables/ltc_ggx.bin"          // Default output table path
+
+#ifndef PI
+    #define     PI                          3.14159265358979323846f
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct Vec3 {
+    float x;
+    float y;
+    float z;
+} Vec3;
+
+typedef struct Mat3 {
+    float m[3][3];                          // Row-major matrix elements (applied to column vectors)
+} Mat3;
+
+typedef struct LTC {
+    float m11;                              // Distribution scale in X axis
+    float m22;                              // Distribution scale in Y axis
+    float m13;                              // Distribution skew in X axis
+    float magnitude;                        // BRDF integral over hemisphere
+    float fresnel;                          // BRDF integral weighted by Schlick Fresnel term
+    Vec3 x;                                 // Distribution frame X axis
+    Vec3 y;                                 // Distribution frame Y axis
+    Vec3 z;                                 // Distribution frame Z axis (BRDF average direction)
+    Mat3 transform;                         // Linear transformation from cosine distribution
+    Mat3 invTransform;
+    float detTransform;
+} LTC;
+
+typedef struct FitContext {
+    LTC *ltc;
+    Vec3 view;
+    float alpha;
+    bool isotropic;
+} FitContext;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+static Vec3 Vec3Normalize(Vec3 v);                                                          // Normalize a vector
+static Vec3 Mat3Transform(Mat3 mat, Vec3 v);                                                // Transform a vector by a matrix
+static Mat3 Mat3Multiply(Mat3 a, Mat3 b);                                                   // Multiply two matrices
+static float Mat3Determinant(Mat3 mat);                                                     // Calculate matrix determinant
+static Mat3 Mat3Invert(Mat3 mat);                                                           // Invert a matrix
+
+static float EvalGGX(Vec3 view, Vec3 light, float alpha, float *pdf);                       // Evaluate GGX BRDF times cosine and its sampling pdf
+static Vec3 SampleGGX(Vec3 view, float alpha, float u1, float u2);                          // Sample a light direction from GGX visible normals
+static void UpdateLTC(LTC *ltc);                                                            // Calculate LTC transformation from its parameters
+static float EvalLTC(LTC *ltc, Vec3 light);                                                 // Evaluate LTC distribution
+static Vec3 SampleLTC(LTC *ltc, float u1, float u2);                                        // Sample a light direction from LTC distribution
+
+static void ComputeAverageTerms(LTC *ltc, Vec3 view, float alpha, Vec3 *averageDir);        // Compute BRDF magnitude, Fresnel and average direction
+static float ComputeError(LTC *ltc, Vec3 view, float alpha);                                // Compute difference between LTC and BRDF
+static float FitError(FitContext *context, const float *params);                            // Set LTC parameters and compute its error
+static void FitLTC(LTC *ltc, Vec3 view, float alpha, bool isotropic);                       // Minimize LTC error with Nelder-Mead simplex
+
+//----------------------------------------------------------------------------------
+// Main entry point
+//----------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    const char *fileName = (argc > 1) ? argv[1] : PATH_LTC_TABLE;
+
+    LTC *fits = (LTC *)calloc(LTC_SIZE*LTC_SIZE, sizeof(LTC));
+    float *table = (float *)calloc(2*LTC_SIZE*LTC_SIZE*4, sizeof(float));
+
+    // Fit from rough to smooth distributions (previous fits are used as initial guess)
+    for (int a = LTC_SIZE - 1; a >= 0; a--)
+    {
+        for (int t = 0; t < LTC_SIZE; t++)
+        {
+            float x = (float)t/(LTC_SIZE - 1);
+            float theta = fminf(1.57f, acosf(1.0f - x*x));
+            Vec3 view = { sinf(theta), 0.0f, cosf(theta) };
+
+            float roughness = (float)a/(LTC_SIZE - 1);
+            float alpha = fmaxf(roughness*roughness, LTC_MIN_ALPHA);
+
+            LTC ltc = { 0 };
+            Vec3 averageDir = { 0 };
+            ComputeAverageTerms(&ltc, view, alpha, &averageDir);
+
+            bool isotropic = false;
+
+            if (t == 0)
+            {
+                // Normal incidence distribution is isotropic
+                ltc.x = (Vec3){ 1.0f, 0.0f, 0.0f };
+                ltc.y = (Vec3){ 0.0f, 1.0f, 0.0f };
+                ltc.z = (Vec3){ 0.0f, 0.0f, 1.0f };
+                ltc.m11 = (a == LTC_SIZE - 1) ? 1.0f : fits[(a + 1)*LTC_SIZE].m11;
+                ltc.m22 = (a == LTC_SIZE - 1) ? 1.0f : fits[(a + 1)*LTC_SIZE].m22;
+                ltc.m13 = 0.0f;
+                isotropic = true;
+            }
+            else
+            {
+                // Align distribution with BRDF average direction and start from previous view angle fit
+                ltc.x = (Vec3){ averageDir.z, 0.0f, -averageDir.x };
+                ltc.y = (Vec3){ 0.0f, 1.0f, 0.0f };
+                ltc.z = averageDir;
+                ltc.m11 = fits[a*LTC_SIZE + t - 1].m11;
+                ltc.m22 = fits[a*LTC_SIZE + t - 1].m22;
+                ltc.m13 = fits[a*LTC_SIZE + t - 1].m13;
+            }
+
+            UpdateLTC(&ltc);
+            FitLTC(&ltc, view, alpha, isotropic);
+            fits[a*LTC_SIZE + t] = ltc;
+
+            // Store inverse transformation normalized by its Y scale and BRDF terms
+            Mat3 inv = ltc.invTransform;
+            float *texel = &table[(t*LTC_SIZE + a)*4];
+            texel[0] = inv.m[0][0]/inv.m[1][1];
+            texel[1] = inv.m[2][0]/inv.m[1][1];
+            texel[2] = inv.m[0][2]/inv.m[1][1];
+            texel[3] = inv.m[2][2]/inv.m[1][1];
+
+            texel = &table[(LTC_SIZE*LTC_SIZE + t*LTC_SIZE + a)*4];
+            texel[0] = ltc.magnitude;
+            texel[1] = ltc.fresnel;
+        }
+
+        printf("Fitted roughness %i/%i\n", LTC_SIZE - a, LTC_SIZE);
+    }
+
+    FILE *file = fopen(fileName, "wb");
+
+    if (file == NULL)
+    {
+        printf("Table file %s could not be created\n", fileName);
+        return 1;
+    }
+
+    int size = LTC_SIZE;
+    fwrite("LTC1", 1, 4, file);
+    fwrite(&size, sizeof(int), 1, file);
+    fwrite(table, sizeof(float), 2*LTC_SIZE*LTC_SIZE*4, file);
+    fclose(file);
+
+    printf("Table saved to %s\n", fileName);
+
+    free(table);
+    free(fits);
+
+    return 0;
+}
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Normalize a vector
+static Vec3 Vec3Normalize(Vec3 v)
+{
+    float length = sqrtf(v.x*v.x + v.y*v.y + v.z*v.z);
+    if (length > 0.0f) return (Vec3){ v.x/length, v.y/length, v.z/length };
+    return v;
+}
+
+// Transform a vector by a matrix
+static Vec3 Mat3Transform(Mat3 mat, Vec3 v)
+{
+    return (Vec3){ mat.m[0][0]*v.x + mat.m[0][1]*v.y + mat.m[0][2]*v.z,
+                   mat.m[1][0]*v.x + mat.m[1][1]*v.y + mat.m[1][2]*v.z,
+                   mat.m[2][0]*v.x + mat.m[2][1]*v.y + mat.m[2][2]*v.z };
+}
+
+// Multiply two matrices
+static Mat3 Mat3Multiply(Mat3 a, Mat3 b)
+{
+    Mat3 result = { 0 };
+
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            for (int k = 0; k < 3; k++) result.m[i][j] += a.m[i][k]*b.m[k][j];
+        }
+    }
+
+    return result;
+}
+
+// Calculate matrix determinant
+static float Mat3Determinant(Mat3 mat)
+{
+    return mat.m[0][0]*(mat.m[1][1]*mat.m[2][2] - mat.m[1][2]*mat.m[2][1]) -
+           mat.m[0][1]*(mat.m[1][0]*mat.m[2][2] - mat.m[1][2]*mat.m[2][0]) +
+           mat.m[0][2]*(mat.m[1][0]*mat.m[2][1] - mat.m[1][1]*mat.m[2][0]);
+}
+
+// Invert a matrix
+static Mat3 Mat3Invert(Mat3 mat)
+{
+    Mat3 result = { 0 };
+    float invDet = 1.0f/Mat3Determinant(mat);
+
+    result.m[0][0] = (mat.m[1][1]*mat.m[2][2] - mat.m[1][2]*mat.m[2][1])*invDet;
+    result.m[0][1] = (mat.m[0][2]*mat.m[2][1] - mat.m[0][1]*mat.m[2][2])*invDet;
+    result.m[0][2] = (mat.m[0][1]*mat.m[1][2] - mat.m[0][2]*mat.m[1][1])*invDet;
+    result.m[1][0] = (mat.m[1][2]*mat.m[2][0] - mat.m[1][0]*mat.m[2][2])*invDet;
+    result.m[1][1] = (mat.m[0][0]*mat.m[2][2] - mat.m[0][2]*mat.m[2][0])*invDet;
+    result.m[1][2] = (mat.m[0][2]*mat.m[1][0] - mat.m[0][0]*mat.m[1][2])*invDet;
+    result.m[2][0] = (mat.m[1][0]*mat.m[2][1] - mat.m[1][1]*mat.m[2][0])*invDet;
+    result.m[2][1] = (mat.m[0][1]*mat.m[2][0] - mat.m[0][0]*mat.m[2][1])*invDet;
+    result.m[2][2] = (mat.m[0][0]*mat.m[1][1] - mat.m[0][1]*mat.m[1][0])*invDet;
+
+    return result;
+}
+
+// Evaluate GGX BRDF times cosine and its sampling pdf
+static float EvalGGX(Vec3 view, Vec3 light, float alpha, float *pdf)
+{
+    *pdf = 0.0f;
+    if ((view.z <= 0.0f) || (light.z <= 0.0f)) return 0.0f;
+
+    // Smith masking lambda terms
+    float a2 = alpha*alpha;
+    float lambdaV = 0.5f*(-1.0f + sqrtf(1.0f + a2*(1.0f - view.z*view.z)/(view.z*view.z)));
+    float lambdaL = 0.5f*(-1.0f + sqrtf(1.0f + a2*(1.0f - light.z*light.z)/(light.z*light.z)));
+    float G1 = 1.0f/(1.0f + lambdaV);
+    float G2 = 1.0f/(1.0f + lambdaV + lambdaL);
+
+    // Normal distribution term
+    Vec3 half = Vec3Normalize((Vec3){ view.x + light.x, view.y + light.y, view.z + light.z });
+    float slopeX = half.x/half.z;
+    float slopeY = half.y/half.z;
+    float D = 1.0f/(1.0f + (slopeX*slopeX + slopeY*slopeY)/a2);
+    D = D*D/(PI*a2*half.z*half.z*half.z*half.z);
+
+    // Visible normals sampling pdf
+    float VdotH = view.x*half.x + view.y*half.y + view.z*half.z;
+    *pdf = fabsf(D*G1*VdotH/view.z)/(4.0f*VdotH);
+
+    return D*G2/(4.0f*view.z);
+}
+
+// Sample a light direction from GGX visible normals
+static Vec3 SampleGGX(Vec3 view, float alpha, float u1, float u2)
+{
+    // Stretch view vector to unit roughness configuration
+    Vec3 stretched = Vec3Normalize((Vec3){ alpha*view.x, alpha*view.y, view.z });
+
+    // Build orthonormal basis around stretched view vector
+    float lengthSqr = stretched.x*stretched.x + stretched.y*stretched.y;
+    Vec3 t1 = (lengthSqr > 0.0f) ? (Vec3){ -stretched.y/sqrtf(lengthSqr), stretched.x/sqrtf(lengthSqr), 0.0f } : (Vec3){ 1.0f, 0.0f, 0.0f };
+    Vec3 t2 = { stretched.y*t1.z - stretched.z*t1.y, stretched.z*t1.x - stretched.x*t1.z, stretched.x*t1.y - stretched.y*t1.x };
+
+    // Sample projected disk area and project it back to hemisphere
+    float r = sqrtf(u1);
+    float phi = 2.0f*PI*u2;
+    float p1 = r*cosf(phi);
+    float p2 = r*sinf(phi);
+    float s = 0.5f*(1.0f + stretched.z);
+    p2 = (1.0f - s)*sqrtf(1.0f - p1*p1) + s*p2;
+    float p3 = sqrtf(fmaxf(0.0f, 1.0f - p1*p1 - p2*p2));
+
+    Vec3 normal = { p1*t1.x + p2*t2.x + p3*stretched.x, p1*t1.y + p2*t2.y + p3*stretched.y, p1*t1.z + p2*t2.z + p3*stretched.z };
+    normal = Vec3Normalize((Vec3){ alpha*normal.x, alpha*normal.y, fmaxf(0.0f, normal.z) });
+
+    // Reflect view vector around sampled normal
+    float VdotN = view.x*normal.x + view.y*normal.y + view.z*normal.z;
+
+    return (Vec3){ 2.0f*VdotN*normal.x - view.x, 2.0f*VdotN*normal.y - view.y, 2.0f*VdotN*normal.z - view.z };
+}
+
+// Calculate LTC transformation from its parameters
+static void UpdateLTC(LTC *ltc)
+{
+    Mat3 frame = { {
+        { ltc->x.x, ltc->y.x, ltc->z.x },
+        { ltc->x.y, ltc->y.y, ltc->z.y },
+        { ltc->x.z, ltc->y.z, ltc->z.z }
+    } };
+
+    Mat3 scale = { {
+        { ltc->m11, 0.0f, ltc->m13 },
+        { 0.0f, ltc->m22, 0.0f },
+        { 0.0f, 0.0f, 1.0f }
+    } };
+
+    ltc->transform = Mat3Multiply(frame, scale);
+    ltc->invTransform = Mat3Invert(ltc->transform);
+    ltc->detTransform = fabsf(Mat3Determinant(ltc->transform));
+}
+
+// Evaluate LTC distribution
+static float EvalLTC(LTC *ltc, Vec3 light)
+{
+    Vec3 original = Vec3Normalize(Mat3Transform(ltc->invTransform, light));
+    Vec3 transformed = Mat3Transform(ltc->transform, original);
+    float length = sqrtf(transformed.x*transformed.x + transformed.y*transformed.y + transformed.z*transformed.z);
+
+    // Cosine distribution value scaled by transformation jacobian
+    float jacobian = ltc->detTransform/(length*length*length);
+    float D = fmaxf(0.0f, original.z)/PI;
+
+    return ltc->magnitude*D/jacobian;
+}
+
+// Sample a light direction from LTC distribution
+static Vec3 SampleLTC(LTC *ltc, float u1, float u2)
+{
+    float theta = acosf(sqrtf(u1));
+    float phi = 2.0f*PI*u2;
+    Vec3 original = { sinf(theta)*cosf(phi), sinf(theta)*sinf(phi), cosf(theta) };
+
+    return Vec3Normalize(Mat3Transform(ltc->transform, original));
+}
+
+// Compute BRDF magnitude, Fresnel and average direction
+static void ComputeAverageTerms(LTC *ltc, Vec3 view, float alpha, Vec3 *averageDir)
+{
+    ltc->magnitude = 0.0f;
+    ltc->fresnel = 0.0f;
+    *averageDir = (Vec3){ 0.0f, 0.0f, 0.0f };
+
+    for (int j = 0; j < LTC_SAMPLES; j++)
+    {
+        for (int i = 0; i < LTC_SAMPLES; i++)
+        {
+            float u1 = ((float)i + 0.5f)/LTC_SAMPLES;
+            float u2 = ((float)j + 0.5f)/LTC_SAMPLES;
+
+            Vec3 light = SampleGGX(view, alpha, u1, u2);
+            float pdf = 0.0f;
+            float value = EvalGGX(view, light, alpha, &pdf);
+
+            if (pdf > 0.0f)
+            {
+                float weight = value/pdf;
+                Vec3 half = Vec3Normalize((Vec3){ view.x + light.x, view.y + light.y, view.z + light.z });
+                float VdotH = fmaxf(view.x*half.x + view.y*half.y + view.z*half.z, 0.0f);
+
+                ltc->magnitude += weight;
+                ltc->fresnel += weight*powf(1.0f - VdotH, 5.0f);
+                averageDir->x += weight*light.x;
+                averageDir->y += weight*light.y;
+                averageDir->z += weight*light.z;
+            }
+        }
+    }
+
+    ltc->magnitude /= (float)(LTC_SAMPLES*LTC_SAMPLES);
+    ltc->fresnel /= (float)(LTC_SAMPLES*LTC_SAMPLES);
+
+    // Average direction is in view plane (isotropic BRDF)
+    averageDir->y = 0.0f;
+    *averageDir = Vec3Normalize(*averageDir);
+}
+
+// Compute difference between LTC and BRDF
+// NOTE: both distributions are importance sampled and combined with balance heuristic
+static float ComputeError(LTC *ltc, Vec3 view, float alpha)
+{
+    double error = 0.0;
+
+    for (int j = 0; j < LTC_SAMPLES; j++)
+    {
+        for (int i = 0; i < LTC_SAMPLES; i++)
+        {
+            float u1 = ((float)i + 0.5f)/LTC_SAMPLES;
+            float u2 = ((float)j + 0.5f)/LTC_SAMPLES;
+
+            // Importance sample LTC distribution
+            {
+                Vec3 light = SampleLTC(ltc, u1, u2);
+                float pdfBRDF = 0.0f;
+                float valueBRDF = EvalGGX(view, light, alpha, &pdfBRDF);
+                float valueLTC = EvalLTC(ltc, light);
+                float pdfLTC = valueLTC/ltc->magnitude;
+                float difference = fabsf(valueBRDF - valueLTC);
+
+                if ((pdfLTC + pdfBRDF) > 0.0f) error += difference*difference*difference/(pdfLTC + pdfBRDF);
+            }
+
+            // Importance sample BRDF distribution
+            {
+                Vec3 light = SampleGGX(view, alpha, u1, u2);
+                float pdfBRDF = 0.0f;
+                float valueBRDF = EvalGGX(view, light, alpha, &pdfBRDF);
+                float valueLTC = EvalLTC(ltc, light);
+                float pdfLTC = valueLTC/ltc->magnitude;
+                float difference = fabsf(valueBRDF - valueLTC);
+
+                if ((pdfLTC + pdfBRDF) > 0.0f) error += difference*difference*difference/(pdfLTC + pdfBRDF);
+            }
+        }
+    }
+
+    return (float)(error/(double)(LTC_SAMPLES*LTC_SAMPLES*2));
+}
+
+// Set LTC parameters and compute its error
+static float FitError(FitContext *context, const float *params)
+{
+    LTC *ltc = context->ltc;
+
+    if (context->isotropic)
+    {
+        ltc->m11 = fmaxf(params[0], LTC_MIN_ALPHA);
+        ltc->m22 = ltc->m11;
+        ltc->m13 = 0.0f;
+    }
+    else
+    {
+        ltc->m11 = fmaxf(params[0], LTC_MIN_ALPHA);
+        ltc->m22 = fmaxf(params[1], LTC_MIN_ALPHA);
+        ltc->m13 = params[2];
+    }
+
+    UpdateLTC(ltc);
+
+    return ComputeError(ltc, context->view, context->alpha);
+}
+
+// Minimize LTC error with Nelder-Mead simplex
+static void FitLTC(LTC *ltc, Vec3 view, float alpha, bool isotropic)
+{
+    FitContext context = { ltc, view, alpha, isotropic };
+    float simplex[4][3] = { { ltc->m11, ltc->m22, ltc->m13 } };
+    float errors[4] = { 0 };
+
+    // Create initial simplex around start parameters
+    for (int i = 1; i < 4; i++)
+    {
+        for (int k = 0; k < 3; k++) simplex[i][k] = simplex[0][k];
+        simplex[i][i - 1] += LTC_FIT_DELTA;
+    }
+
+    for (int i = 0; i < 4; i++) errors[i] = FitError(&context, simplex[i]);
+
+    for (int iteration = 0; iteration < LTC_FIT_ITERATIONS; iteration++)
+    {
+        // Find lowest, highest and second highest simplex vertices
+        int lo = 0, hi = 0, nh = 0;
+
+        for (int i = 1; i < 4; i++)
+        {
+            if (errors[i] < errors[lo]) lo = i;
+            if (errors[i] > errors[hi]) hi = i;
+        }
+
+        nh = lo;
+        for (int i = 0; i < 4; i++) if ((i != hi) && (errors[i] > errors[nh])) nh = i;
+
+        if (fabsf(errors[hi] - errors[lo]) <= LTC_FIT_TOLERANCE*(fabsf(errors[hi]) + fabsf(errors[lo]) + 1e-10f)) break;
+
+        // Calculate centroid of all vertices except highest one
+        float centroid[3] = { 0 };
+        for (int i = 0; i < 4; i++) if (i != hi) for (int k = 0; k < 3; k++) centroid[k] += simplex[i][k]/3.0f;
+
+        // Reflect highest vertex through centroid
+        float reflected[3] = { 0 };
+        for (int k = 0; k < 3; k++) reflected[k] = centroid[k] + (centroid[k] - simplex[hi][k]);
+        float reflectedError = FitError(&context, reflected);
+
+        if (reflectedError < errors[lo])
+        {
+            // Try to expand simplex in reflection direction
+            float expanded[3] = { 0 };
+            for (int k = 0; k < 3; k++) expanded[k] = centroid[k] + 2.0f*(reflected[k] - centroid[k]);
+            float expandedError = FitError(&context, expanded);
+
+            if (expandedError < reflectedError)
+            {
+                for (int k = 0; k < 3; k++) simplex[hi][k] = expanded[k];
+                errors[hi] = expandedError;
+            }
+            else
+            {
+                for (int k = 0; k < 3; k++) simplex[hi][k] = reflected[k];
+                errors[hi] = reflectedError;
+            }
+        }
+        else if (reflectedError < errors[nh])
+        {
+            for (int k = 0; k < 3; k++) simplex[hi][k] = reflected[k];
+            errors[hi] = reflectedError;
+        }
+        else
+        {
+            // Contract simplex (outside or inside depending on reflected vertex error)
+            float contracted[3] = { 0 };
+            bool outside = (reflectedError < errors[hi]);
+            for (int k = 0; k < 3; k++) contracted[k] = centroid[k] + 0.5f*((outside ? reflected[k] : simplex[hi][k]) - centroid[k]);
+            float contractedError = FitError(&context, contracted);
+
+            if (contractedError < fminf(reflectedError, errors[hi]))
+            {
+                for (int k = 0; k < 3; k++) simplex[hi][k] = contracted[k];
+                errors[hi] = contractedError;
+            }
+            else
+            {
+                // Shrink simplex towards lowest vertex
+                for (int i = 0; i < 4; i++)
+                {
+                    if (i == lo) continue;
+                    for (int k = 0; k < 3; k++) simplex[i][k] = simplex[lo][k] + 0.5f*(simplex[i][k] - simplex[lo][k]);
+                    errors[i] = FitError(&context, simplex[i]);
+                }
+            }
+        }
+    }
+
+    // Keep best parameters
+    int best = 0;
+    for (int i = 1; i < 4; i++) if (errors[i] < errors[best]) best = i;
+
+    FitError(&context, simplex[best]);
+}
@@ -0,0 +1,863 @@
+/***********************************************************************************
+*
+*   rPBR [archive] - Memory mapped resources archive with loose files fallback
+*
+*   FEATURES:
+*       - Single archive file (written by rpbrarchive) mapped once at startup: a resource load is a hash
+*         table lookup and a pointer into mapped memory instead of open, seek and read calls.
+*       - Directory index hashed by normalized resource path (FNV-1a 64) with linear probing buckets.
+*       - Blobs aligned to ARCHIVE_ALIGNMENT bytes, stored uncompressed (images are already compressed)
+*         or compressed with LZ4 (shaders, models and text files).
+*       - Shaders, images, textures and models loaded by raylib functions are redirected to archive by macros
+*         at the end of this file, so existing PATH_* loads resolve through archive transparently.
+*       - Resources missing from archive (or every resource without archive) are loaded from loose files.
+*
+*   NOTES:
+*       Archive is opened by InitResourceArchive() before window creation, from --archive <file> option or
+*       PATH_ARCHIVE if it exists. Use --no-archive to load loose files only (e.g. while editing shaders).
+*       Archive has priority over loose files, so rebuild it after editing archived resources.
+*       LZ4 blobs save bandwidth on network drives, but decompression costs more than reading from a local SSD,
+*         so build archives for local installs with rpbrarchive --stored.
+*       Resources names are relative to working directory with '/' separators (e.g. resources/shaders/pbr.vs).
+*       Archived images are decoded with stb_image functions compiled inside raylib (same formats than LoadImage()).
+*       Archived shaders are linked with raylib default attributes locations and uniforms locations.
+*       Archived OBJ models are parsed like raylib 1.8 OBJ loader: triangles only, texture coordinates flipped
+*       vertically and flat normals calculated when model has no normals.
+*       Archive lookups are not synchronized, archive must be opened and closed from main thread while no
+*       worker thread loads resources.
+*
+*   DEPENDENCIES:
+*       raylib 1.8 for images, textures, models and shaders loading from loose files
+*       stb_image (Sean Barret) for archived images decoding (compiled inside raylib)
+*       glad.h for OpenGL API and pbrmemory.h for tracked allocations (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdio.h>                                      // Required for: FILE, fopen(), fread(), fseek(), ftell()
+#include <stdlib.h>                                     // Required for: malloc(), calloc(), free(), strtol(), strtof()
+#include <string.h>                                     // Required for: memcmp(), memcpy(), strcmp(), strrchr()
+#include <math.h>                                       // Required for: sqrtf()
+
+#include "external/raylib/src/external/stb_image.h"     // Required for: stbi_load_from_memory(), stbi_loadf_from_memory()
+
+#if defined(_WIN32)
+    // NOTE: windows.h conflicts with raylib names (Rectangle, LoadImage, CloseWindow...), so required functions are declared here
+    #if !defined(_WINDOWS_)
+        __declspec(dllimport) void *__stdcall CreateFileA(const char *name, unsigned long access, unsigned long share, void *security, unsigned long disposition, unsigned long flags, void *templateFile);
+        __declspec(dllimport) void *__stdcall CreateFileMappingA(void *file, void *security, unsigned long protect, unsigned long sizeHigh, unsigned long sizeLow, const char *name);
+        __declspec(dllimport) void *__stdcall MapViewOfFile(void *mapping, unsigned long access, unsigned long offsetHigh, unsigned long offsetLow, size_t size);
+        __declspec(dllimport) int __stdcall UnmapViewOfFile(const void *address);
+        __declspec(dllimport) int __stdcall GetFileSizeEx(void *file, long long *size);
+        __declspec(dllimport) int __stdcall CloseHandle(void *handle);
+    #endif
+#else
+    #include <fcntl.h>                                  // Required for: open()
+    #include <unistd.h>                                 // Required for: close()
+    #include <sys/mman.h>                               // Required for: mmap(), munmap()
+    #include <sys/stat.h>                               // Required for: fstat()
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         ARCHIVE_MAGIC               "RPA1"                                  // Archive file identifier
+#define         ARCHIVE_VERSION             1                                       // Archive layout version
+#define         ARCHIVE_ALIGNMENT           64                                      // Blobs alignment in bytes
+#define         ARCHIVE_EMPTY_BUCKET        0xffffffffu                             // Directory index empty bucket
+#define         ARCHIVE_MAX_NAME            256                                     // Max resource name length
+
+#define         PATH_ARCHIVE                "resources.rpa"                         // Default resources archive path (release folder)
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef enum ArchiveCompression {
+    ARCHIVE_STORED = 0,                     // Blob is resource data
+    ARCHIVE_LZ4                             // Blob is a LZ4 block (no frame)
+} ArchiveCompression;
+
+typedef struct ArchiveHeader {
+    char magic[4];                          // Archive file identifier (ARCHIVE_MAGIC)
+    unsigned int version;                   // Archive layout version (ARCHIVE_VERSION)
+    unsigned int entriesCount;              // Entries in directory
+    unsigned int bucketsCount;              // Directory index buckets (power of two, at least twice entries count)
+    unsigned int namesSize;                 // Names block size in bytes
+    unsigned int alignment;                 // Blobs alignment in bytes
+    unsigned long long size;                // Archive file size (detects truncated files)
+} ArchiveHeader;
+
+typedef struct ArchiveEntry {
+    unsigned long long hash;                // Normalized resource name hash
+    unsigned long long offset;              // Blob offset from archive start (aligned)
+    unsigned int size;                      // Blob size in bytes
+    unsigned int originalSize;              // Resource size in bytes
+    unsigned int nameOffset;                // Resource name offset in names block
+    unsigned int compression;               // Blob compression (ArchiveCompression)
+} ArchiveEntry;
+
+typedef struct MappedFile {
+    unsigned char *data;                    // Mapped file (NULL if file could not be mapped)
+    size_t size;                            // Mapped bytes
+#if defined(_WIN32)
+    void *file;                             // File handle
+    void *mapping;                          // File mapping handle
+#endif
+} MappedFile;
+
+typedef struct ResourceArchive {
+    MappedFile file;                        // Mapped archive file
+    ArchiveHeader *header;                  // Archive header (NULL if no archive is opened)
+    unsigned int *buckets;                  // Directory index buckets (entries indices)
+    ArchiveEntry *entries;                  // Directory entries
+    const char *names;                      // Resources names block
+    int archiveLoads;                       // Resources loaded from archive
+    int looseLoads;                         // Resources loaded from loose files while archive is opened
+} ResourceArchive;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static ResourceArchive archive = { 0 };     // Opened resources archive
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+void InitResourceArchive(int argc, char **argv);                                    // Check --archive and --no-archive options and open resources archive (before window creation)
+bool OpenResourceArchive(const char *fileName);                                     // Map resources archive and validate its directory
+void CloseResourceArchive(void);                                                    // Unmap resources archive and report loads
+bool IsResourceArchiveOpened(void);                                                 // Check if resources are loaded from an archive
+ArchiveEntry *FindArchiveEntry(const char *fileName);                               // Find a resource in archive directory (NULL if not archived)
+unsigned char *LoadResourceData(const char *fileName, int tag, unsigned int *size);  // Load resource data from archive or loose file (NUL terminated, NULL if missing)
+void UnloadResourceData(unsigned char *data);                                       // Unload resource data
+Image LoadImageResource(const char *fileName);                                      // Load image from archive or loose file (redirects LoadImage())
+Texture2D LoadTextureResource(const char *fileName);                                // Load texture from archive or loose file (redirects LoadTexture())
+Model LoadModelResource(const char *fileName);                                      // Load OBJ model from archive or loose file (redirects LoadModel())
+Mesh LoadMeshResource(const char *fileName);                                        // Load OBJ mesh CPU data from archive or loose file (not uploaded, no OpenGL context required)
+void UnloadMeshResource(Mesh mesh);                                                 // Unload OBJ mesh CPU data
+Shader LoadShaderResource(const char *vsFileName, const char *fsFileName);          // Load shader from archive or loose files (redirects LoadShader())
+MappedFile MapFile(const char *fileName);                                           // Map a file into memory for reading (also used by pbrpackage.h)
+void UnmapFile(MappedFile *file);                                                   // Unmap a mapped file
+unsigned long long HashResourceName(const char *fileName, char *name);              // Normalize a resource name and hash it (also used by rpbrarchive)
+int DecompressLZ4(const unsigned char *src, int srcSize, unsigned char *dst, int dstSize);  // Decompress a LZ4 block (returns decompressed size or -1 if corrupted)
+
+static unsigned char *GetArchiveData(ArchiveEntry *entry, int tag, bool *owned);    // Get entry data from mapped memory or decompressed into a new buffer (NULL if corrupted)
+static Mesh LoadMeshOBJ(const char *text, const char *fileName);                    // Parse an OBJ model text into a mesh (vertex count is 0 if not valid)
+static unsigned int LoadShaderProgram(const char *vsText, int vsSize, const char *fsText, int fsSize, const char *fileName);   // Compile and link a shader program with raylib attributes locations
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Check --archive and --no-archive options and open resources archive (before window creation)
+void InitResourceArchive(int argc, char **argv)
+{
+    const char *fileName = PATH_ARCHIVE;
+    bool required = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--archive") == 0) && (i + 1 < argc))
+        {
+            fileName = argv[++i];
+            required = true;
+        }
+        else if (strcmp(argv[i], "--no-archive") == 0) fileName = NULL;
+    }
+
+    if (fileName == NULL) return;
+
+    // Default archive is optional, loose files are used without it
+    FILE *file = fopen(fileName, "rb");
+
+    if (file != NULL)
+    {
+        fclose(file);
+        OpenResourceArchive(fileName);
+    }
+    else if (required) TraceLog(LOG_WARNING, "[%s] Resources archive not found, loading loose files", fileName);
+}
+
+// Map resources archive and validate its directory
+bool OpenResourceArchive(const char *fileName)
+{
+    CloseResourceArchive();
+
+    MappedFile file = MapFile(fileName);
+    if (file.data == NULL) return false;
+
+    // Validate header and directory tables (every blob and name must be inside mapped file)
+    ArchiveHeader *header = (ArchiveHeader *)file.data;
+    bool valid = (file.size >= sizeof(ArchiveHeader)) && (memcmp(header->magic, ARCHIVE_MAGIC, 4) == 0) && (header->version == ARCHIVE_VERSION) &&
+                 (header->size == file.size) && (header->bucketsCount > 0) && ((header->bucketsCount & (header->bucketsCount - 1)) == 0) &&
+                 (header->entriesCount < header->bucketsCount) && (sizeof(ArchiveHeader) + (unsigned long long)header->bucketsCount*sizeof(unsigned int) +
+                 (unsigned long long)header->entriesCount*sizeof(ArchiveEntry) + header->namesSize <= file.size);
+
+    if (valid)
+    {
+        archive.header = header;
+        archive.buckets = (unsigned int *)(file.data + sizeof(ArchiveHeader));
+        archive.entries = (ArchiveEntry *)(archive.buckets + header->bucketsCount);
+        archive.names = (const char *)(archive.entries + header->entriesCount);
+
+        for (unsigned int i = 0; (i < header->bucketsCount) && valid; i++) valid = ((archive.buckets[i] == ARCHIVE_EMPTY_BUCKET) || (archive.buckets[i] < header->entriesCount));
+
+        for (unsigned int i = 0; (i < header->entriesCount) && valid; i++)
+        {
+            ArchiveEntry *entry = &archive.entries[i];
+            valid = (entry->offset%ARCHIVE_ALIGNMENT == 0) && (entry->offset <= file.size) && (entry->size <= file.size - entry->offset) &&
+                    (entry->nameOffset < header->namesSize) && (memchr(archive.names + entry->nameOffset, '\0', header->namesSize - entry->nameOffset) != NULL) &&
+                    (entry->compression <= ARCHIVE_LZ4) && ((entry->compression == ARCHIVE_LZ4) || (entry->size == entry->originalSize));
+        }
+    }
+
+    if (!valid)
+    {
+        TraceLog(LOG_WARNING, "[%s] Resources archive is not valid or was built by a different version, loading loose files", fileName);
+        archive = (ResourceArchive){ 0 };
+        UnmapFile(&file);
+        return false;
+    }
+
+    archive.file = file;
+    TraceLog(LOG_INFO, "[%s] Resources archive opened (%i resources, %.2f MB)", fileName, header->entriesCount, file.size/1048576.0);
+
+    return true;
+}
+
+// Unmap resources archive and report loads
+void CloseResourceArchive(void)
+{
+    if (archive.header == NULL) return;
+
+    TraceLog(LOG_INFO, "Resources archive closed (%i resources loaded from archive, %i from loose files)", archive.archiveLoads, archive.looseLoads);
+    UnmapFile(&archive.file);
+    archive = (ResourceArchive){ 0 };
+}
+
+// Check if resources are loaded from an archive
+bool IsResourceArchiveOpened(void)
+{
+    return (archive.header != NULL);
+}
+
+// Find a resource in archive directory (NULL if not archived)
+ArchiveEntry *FindArchiveEntry(const char *fileName)
+{
+    if ((archive.header == NULL) || (fileName == NULL)) return NULL;
+
+    char name[ARCHIVE_MAX_NAME] = { 0 };
+    unsigned long long hash = HashResourceName(fileName, name);
+    unsigned int mask = archive.header->bucketsCount - 1;
+    unsigned int bucket = (unsigned int)hash & mask;
+
+    // Probe buckets until an empty one (names are compared to discard hash collisions)
+    for (unsigned int i = 0; i < archive.header->bucketsCount; i++)
+    {
+        unsigned int index = archive.buckets[bucket];
+        if (index == ARCHIVE_EMPTY_BUCKET) break;
+
+        ArchiveEntry *entry = &archive.entries[index];
+        if ((entry->hash == hash) && (strcmp(archive.names + entry->nameOffset, name) == 0)) return entry;
+
+        bucket = (bucket + 1) & mask;
+    }
+
+    return NULL;
+}
+
+// Load resource data from archive or loose file (NUL terminated, NULL if missing)
+// NOTE: data must be released with UnloadResourceData(), size doesn't include NUL terminator
+unsigned char *LoadResourceData(const char *fileName, int tag, unsigned int *size)
+{
+    unsigned char *data = NULL;
+    ArchiveEntry *entry = FindArchiveEntry(fileName);
+    *size = 0;
+
+    if (entry != NULL)
+    {
+        bool owned = false;
+        unsigned char *blob = GetArchiveData(entry, tag, &owned);
+
+        if (owned) data = blob;
+        else if (blob != NULL)
+        {
+            data = (unsigned char *)PBR_MALLOC(tag, entry->originalSize + 1);
+            memcpy(data, blob, entry->originalSize);
+            data[entry->originalSize] = '\0';
+        }
+
+        if (data != NULL)
+        {
+            *size = entry->originalSize;
+            archive.archiveLoads++;
+            return data;
+        }
+    }
+
+    // Load loose file if it is not archived (or archived data is corrupted)
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    data = (unsigned char *)PBR_MALLOC(tag, length + 1);
+    length = (long)fread(data, 1, length, file);
+    data[length] = '\0';
+    fclose(file);
+
+    *size = (unsigned int)length;
+    if (archive.header != NULL) archive.looseLoads++;
+
+    return data;
+}
+
+// Unload resource data
+void UnloadResourceData(unsigned char *data)
+{
+    if (data != NULL) PBR_FREE(data);
+}
+
+// Load image from archive or loose file (redirects LoadImage())
+// NOTE: decoded pixels are allocated by stb_image (released by raylib with free()), like LoadImage() images
+Image LoadImageResource(const char *fileName)
+{
+    Image image = { 0 };
+    ArchiveEntry *entry = FindArchiveEntry(fileName);
+    const char *extension = ((fileName != NULL) ? strrchr(fileName, '.') : NULL);
+    bool supported = (extension != NULL) && ((strcmp(extension, ".png") == 0) || (strcmp(extension, ".jpg") == 0) || (strcmp(extension, ".bmp") == 0) ||
+                     (strcmp(extension, ".tga") == 0) || (strcmp(extension, ".psd") == 0) || (strcmp(extension, ".gif") == 0) || (strcmp(extension, ".hdr") == 0));
+
+    if ((entry == NULL) || !supported)
+    {
+        if (archive.header != NULL) archive.looseLoads++;
+        return LoadImage(fileName);
+    }
+
+    // Decode stored images straight from mapped memory
+    bool owned = false;
+    unsigned char *data = GetArchiveData(entry, MEMORY_TEXTURES, &owned);
+    int components = 0;
+
+    if (data != NULL)
+    {
+        if (strcmp(extension, ".hdr") == 0)
+        {
+            image.data = stbi_loadf_from_memory(data, entry->originalSize, &image.width, &image.height, &components, 0);
+            image.format = UNCOMPRESSED_R32G32B32;
+        }
+        else
+        {
+            image.data = stbi_load_from_memory(data, entry->originalSize, &image.width, &image.height, &components, 0);
+
+            switch (components)
+            {
+                case 1: image.format = UNCOMPRESSED_GRAYSCALE; break;
+                case 2: image.format = UNCOMPRESSED_GRAY_ALPHA; break;
+                case 3: image.format = UNCOMPRESSED_R8G8B8; break;
+                case 4: image.format = UNCOMPRESSED_R8G8B8A8; break;
+                default: break;
+            }
+        }
+
+        if (owned) PBR_FREE(data);
+    }
+
+    image.mipmaps = 1;
+
+    if ((image.data != NULL) && (strcmp(extension, ".hdr") == 0) && (components != 3))
+    {
+        TraceLog(LOG_WARNING, "[%s] Image fileformat not supported", fileName);
+        UnloadImage(image);
+        image = (Image){ 0 };
+    }
+    else if (image.data != NULL)
+    {
+        TraceLog(LOG_INFO, "[%s] Image loaded from resources archive (%ix%i)", fileName, image.width, image.height);
+        archive.archiveLoads++;
+    }
+    else
+    {
+        // Load loose file if archived image is corrupted
+        TraceLog(LOG_WARNING, "[%s] Archived image could not be decoded, loading loose file", fileName);
+        archive.looseLoads++;
+        image = LoadImage(fileName);
+    }
+
+    return image;
+}
+
+// Load texture from archive or loose file (redirects LoadTexture())
+Texture2D LoadTextureResource(const char *fileName)
+{
+    Texture2D texture = { 0 };
+    Image image = LoadImageResource(fileName);
+
+    if (image.data != NULL)
+    {
+        texture = LoadTextureFromImage(image);
+        UnloadImage(image);
+    }
+    else TraceLog(LOG_WARNING, "Texture could not be created");
+
+    return texture;
+}
+
+// Load OBJ model from archive or loose file (redirects LoadModel())
+Model LoadModelResource(const char *fileName)
+{
+    ArchiveEntry *entry = FindArchiveEntry(fileName);
+    const char *extension = ((fileName != NULL) ? strrchr(fileName, '.') : NULL);
+
+    if ((entry != NULL) && (extension != NULL) && (strcmp(extension, ".obj") == 0))
+    {
+        unsigned int size = 0;
+        char *text = (char *)LoadResourceData(fileName, MEMORY_MODEL, &size);
+        Mesh mesh = LoadMeshOBJ(text, fileName);
+        UnloadResourceData((unsigned char *)text);
+
+        // Upload mesh and set up default material like LoadModel()
+        if (mesh.vertexCount > 0) return LoadModelFromMesh(mesh, false);
+
+        archive.archiveLoads--;
+    }
+
+    if (archive.header != NULL) archive.looseLoads++;
+
+    return LoadModel(fileName);
+}
+
+// Load OBJ mesh CPU data from archive or loose file (not uploaded, no OpenGL context required)
+// NOTE: used by software rendering (pbrsoft.h), vertex count is 0 if file is missing or not valid
+Mesh LoadMeshResource(const char *fileName)
+{
+    unsigned int size = 0;
+    char *text = (char *)LoadResourceData(fileName, MEMORY_MODEL, &size);
+    Mesh mesh = LoadMeshOBJ(text, fileName);
+    UnloadResourceData((unsigned char *)text);
+
+    if (mesh.vertexCount == 0) TraceLog(LOG_WARNING, "[%s] Mesh could not be loaded", fileName);
+
+    return mesh;
+}
+
+// Unload OBJ mesh CPU data
+void UnloadMeshResource(Mesh mesh)
+{
+    free(mesh.vertices);
+    free(mesh.texcoords);
+    free(mesh.normals);
+}
+
+// Load shader from archive or loose files (redirects LoadShader())
+Shader LoadShaderResource(const char *vsFileName, const char *fsFileName)
+{
+    if ((FindArchiveEntry(vsFileName) == NULL) && (FindArchiveEntry(fsFileName) == NULL))
+    {
+        if (archive.header != NULL) archive.looseLoads++;
+        return LoadShader((char *)vsFileName, (char *)fsFileName);
+    }
+
+    Shader shader = { 0 };
+    unsigned int vsSize = 0;
+    unsigned int fsSize = 0;
+    char *vsText = (char *)LoadResourceData(vsFileName, MEMORY_OTHER, &vsSize);
+    char *fsText = (char *)LoadResourceData(fsFileName, MEMORY_OTHER, &fsSize);
+
+    if ((vsText != NULL) && (fsText != NULL)) shader.id = LoadShaderProgram(vsText, vsSize, fsText, fsSize, fsFileName);
+
+    UnloadResourceData((unsigned char *)vsText);
+    UnloadResourceData((unsigned char *)fsText);
+
+    if (shader.id == 0)
+    {
+        TraceLog(LOG_WARNING, "Custom shader could not be loaded");
+        return GetDefaultShader();
+    }
+
+    // Get raylib default attributes and uniforms locations (same than LoadShader())
+    for (int i = 0; i < MAX_SHADER_LOCATIONS; i++) shader.locs[i] = -1;
+
+    shader.locs[LOC_VERTEX_POSITION] = glGetAttribLocation(shader.id, "vertexPosition");
+    shader.locs[LOC_VERTEX_TEXCOORD01] = glGetAttribLocation(shader.id, "vertexTexCoord");
+    shader.locs[LOC_VERTEX_TEXCOORD02] = glGetAttribLocation(shader.id, "vertexTexCoord2");
+    shader.locs[LOC_VERTEX_NORMAL] = glGetAttribLocation(shader.id, "vertexNormal");
+    shader.locs[LOC_VERTEX_TANGENT] = glGetAttribLocation(shader.id, "vertexTangent");
+    shader.locs[LOC_VERTEX_COLOR] = glGetAttribLocation(shader.id, "vertexColor");
+    shader.locs[LOC_MATRIX_MVP] = glGetUniformLocation(shader.id, "mvp");
+    shader.locs[LOC_COLOR_DIFFUSE] = glGetUniformLocation(shader.id, "colDiffuse");
+    shader.locs[LOC_MAP_DIFFUSE] = glGetUniformLocation(shader.id, "texture0");
+    shader.locs[LOC_MAP_NORMAL] = glGetUniformLocation(shader.id, "texture1");
+    shader.locs[LOC_MAP_SPECULAR] = glGetUniformLocation(shader.id, "texture2");
+
+    TraceLog(LOG_INFO, "[SHDR ID %i] Shader loaded from resources archive", shader.id);
+
+    return shader;
+}
+
+// Map a file into memory for reading (also used by pbrpackage.h)
+// NOTE: data is NULL if file could not be opened or is empty
+MappedFile MapFile(const char *fileName)
+{
+    MappedFile mapped = { 0 };
+
+#if defined(_WIN32)
+    long long size = 0;
+    mapped.file = CreateFileA(fileName, 0x80000000, 0x00000001, NULL, 3, 0x80, NULL);     // GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL
+
+    if (mapped.file == (void *)-1) mapped.file = NULL;
+    else if (GetFileSizeEx(mapped.file, &size) && (size > 0))
+    {
+        mapped.mapping = CreateFileMappingA(mapped.file, NULL, 0x02, 0, 0, NULL);         // PAGE_READONLY
+        if (mapped.mapping != NULL) mapped.data = (unsigned char *)MapViewOfFile(mapped.mapping, 0x0004, 0, 0, 0);   // FILE_MAP_READ
+        mapped.size = (size_t)size;
+    }
+#else
+    int file = open(fileName, O_RDONLY);
+    struct stat info = { 0 };
+
+    if ((file >= 0) && (fstat(file, &info) == 0) && (info.st_size > 0))
+    {
+        mapped.data = (unsigned char *)mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapped.data == MAP_FAILED) mapped.data = NULL;
+        mapped.size = (size_t)info.st_size;
+    }
+
+    // Mapping keeps file referenced, so descriptor is not needed anymore
+    if (file >= 0) close(file);
+#endif
+
+    if (mapped.data == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] File could not be mapped", fileName);
+        UnmapFile(&mapped);
+    }
+
+    return mapped;
+}
+
+// Unmap a mapped file
+void UnmapFile(MappedFile *file)
+{
+#if defined(_WIN32)
+    if (file->data != NULL) UnmapViewOfFile(file->data);
+    if (file->mapping != NULL) CloseHandle(file->mapping);
+    if (file->file != NULL) CloseHandle(file->file);
+#else
+    if (file->data != NULL) munmap(file->data, file->size);
+#endif
+
+    *file = (MappedFile){ 0 };
+}
+
+// Normalize a resource name and hash it (also used by rpbrarchive)
+// NOTE: backslashes are replaced by slashes and leading "./" is removed, name must have ARCHIVE_MAX_NAME bytes
+unsigned long long HashResourceName(const char *fileName, char *name)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    int length = 0;
+
+    while ((fileName[0] == '.') && ((fileName[1] == '/') || (fileName[1] == '\\'))) fileName += 2;
+
+    for (; (fileName[length] != '\0') && (length < (ARCHIVE_MAX_NAME - 1)); length++)
+    {
+        name[length] = ((fileName[length] == '\\') ? '/' : fileName[length]);
+        hash = (hash ^ (unsigned char)name[length])*1099511628211ull;
+    }
+
+    name[length] = '\0';
+
+    return hash;
+}
+
+// Decompress a LZ4 block (returns decompressed size or -1 if corrupted)
+// NOTE: every sequence is checked against source and destination bounds, so corrupted blocks can't overflow
+int DecompressLZ4(const unsigned char *src, int srcSize, unsigned char *dst, int dstSize)
+{
+    const unsigned char *ip = src;
+    const unsigned char *ipEnd = src + srcSize;
+    unsigned char *op = dst;
+    unsigned char *opEnd = dst + dstSize;
+
+    while (ip < ipEnd)
+    {
+        // Copy literals
+        unsigned int token = *ip++;
+        size_t length = token >> 4;
+
+        if (length == 15)
+        {
+            unsigned int value = 255;
+            while ((ip < ipEnd) && (value == 255)) { value = *ip++; length += value; }
+        }
+
+        if ((length > (size_t)(ipEnd - ip)) || (length > (size_t)(opEnd - op))) return -1;
+
+        // Short literals are copied with a fixed size copy when both buffers have room (overwritten by next sequence)
+        if ((length <= 16) && ((ipEnd - ip) >= 16) && ((opEnd - op) >= 16)) memcpy(op, ip, 16);
+        else memcpy(op, ip, length);
+
+        ip += length;
+        op += length;
+
+        // Last sequence has only literals
+        if (ip >= ipEnd) break;
+
+        // Copy match from already decompressed data (may overlap)
+        if ((ipEnd - ip) < 2) return -1;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        if ((offset == 0) || (offset > (size_t)(op - dst))) return -1;
+
+        length = token & 15;
+
+        if (length == 15)
+        {
+            unsigned int value = 255;
+            while ((ip < ipEnd) && (value == 255)) { value = *ip++; length += value; }
+        }
+
+        length += 4;
+        if (length > (size_t)(opEnd - op)) return -1;
+
+        // Overlapping matches repeat last offset bytes, so they are copied in chunks no longer than offset
+        const unsigned char *match = op - offset;
+
+        if ((offset >= 8) && ((size_t)(opEnd - op) >= length + 8))
+        {
+            for (size_t i = 0; i < length; i += 8) memcpy(op + i, match + i, 8);
+        }
+        else if (offset >= length) memcpy(op, match, length);
+        else for (size_t i = 0; i < length; i++) op[i] = match[i];
+
+        op += length;
+    }
+
+    return (int)(op - dst);
+}
+
+// Get entry data from mapped memory or decompressed into a new buffer (NULL if corrupted)
+// NOTE: decompressed buffers are NUL terminated and must be released by caller (owned is set)
+static unsigned char *GetArchiveData(ArchiveEntry *entry, int tag, bool *owned)
+{
+    unsigned char *blob = archive.file.data + entry->offset;
+    *owned = false;
+
+    if (entry->compression == ARCHIVE_STORED) return blob;
+
+    unsigned char *data = (unsigned char *)PBR_MALLOC(tag, entry->originalSize + 1);
+
+    if (DecompressLZ4(blob, entry->size, data, entry->originalSize) != (int)entry->originalSize)
+    {
+        TraceLog(LOG_WARNING, "[%s] Archived resource is corrupted", archive.names + entry->nameOffset);
+        PBR_FREE(data);
+        return NULL;
+    }
+
+    data[entry->originalSize] = '\0';
+    *owned = true;
+
+    return data;
+}
+
+// Parse an OBJ model text into a mesh (vertex count is 0 if not valid)
+// NOTE: same results than raylib OBJ loader, mesh arrays are allocated with malloc() because raylib releases them
+static Mesh LoadMeshOBJ(const char *text, const char *fileName)
+{
+    Mesh mesh = { 0 };
+    if (text == NULL) return mesh;
+
+    // Count positions, texture coordinates, normals and triangles
+    int positionsCount = 0, texcoordsCount = 0, normalsCount = 0, trianglesCount = 0;
+
+    for (const char *line = text; *line != '\0'; line = ((strchr(line, '\n') != NULL) ? strchr(line, '\n') + 1 : line + strlen(line)))
+    {
+        if ((line[0] == 'v') && (line[1] == ' ')) positionsCount++;
+        else if ((line[0] == 'v') && (line[1] == 't')) texcoordsCount++;
+        else if ((line[0] == 'v') && (line[1] == 'n')) normalsCount++;
+        else if ((line[0] == 'f') && (line[1] == ' ')) trianglesCount++;
+    }
+
+    if ((positionsCount == 0) || (trianglesCount == 0)) return mesh;
+
+    float *positions = (float *)PBR_MALLOC(MEMORY_MODEL, positionsCount*3*sizeof(float));
+    float *texcoords = (float *)PBR_MALLOC(MEMORY_MODEL, (texcoordsCount + 1)*2*sizeof(float));
+    float *normals = (float *)PBR_MALLOC(MEMORY_MODEL, (normalsCount + 1)*3*sizeof(float));
+    int counts[3] = { 0 };
+
+    mesh.vertexCount = trianglesCount*3;
+    mesh.triangleCount = trianglesCount;
+    mesh.vertices = (float *)malloc(mesh.vertexCount*3*sizeof(float));
+    mesh.texcoords = (float *)calloc(mesh.vertexCount*2, sizeof(float));
+    mesh.normals = (float *)malloc(mesh.vertexCount*3*sizeof(float));
+
+    bool valid = true;
+    int vertex = 0;
+
+    for (const char *line = text; (*line != '\0') && valid; line = ((strchr(line, '\n') != NULL) ? strchr(line, '\n') + 1 : line + strlen(line)))
+    {
+        // NOTE: values are parsed with strtof(), sscanf() measures whole remaining text on every call
+        char *cursor = (char *)line + (((line[1] != ' ') && (line[1] != '\0')) ? 2 : 1);
+
+        if ((line[0] == 'v') && (line[1] == ' ')) { for (int k = 0; k < 3; k++) positions[counts[0]*3 + k] = strtof(cursor, &cursor); counts[0]++; }
+        else if ((line[0] == 'v') && (line[1] == 't')) { for (int k = 0; k < 2; k++) texcoords[counts[1]*2 + k] = strtof(cursor, &cursor); counts[1]++; }
+        else if ((line[0] == 'v') && (line[1] == 'n')) { for (int k = 0; k < 3; k++) normals[counts[2]*3 + k] = strtof(cursor, &cursor); counts[2]++; }
+        else if ((line[0] == 'f') && (line[1] == ' '))
+        {
+            // Parse triangle vertices indices (v, v/vt, v//vn or v/vt/vn)
+            int indices[3][3] = { 0 };
+
+            for (int k = 0; k < 3; k++)
+            {
+                indices[k][0] = (int)strtol(cursor, &cursor, 10);
+
+                if (*cursor == '/')
+                {
+                    cursor++;
+                    if (*cursor != '/') indices[k][1] = (int)strtol(cursor, &cursor, 10);
+                    if (*cursor == '/') indices[k][2] = (int)strtol(cursor + 1, &cursor, 10);
+                }
+
+                valid = valid && (indices[k][0] >= 1) && (indices[k][0] <= positionsCount) && (indices[k][1] >= 0) && (indices[k][1] <= texcoordsCount) &&
+                        (indices[k][2] >= 0) && (indices[k][2] <= normalsCount) && ((normalsCount == 0) || (indices[k][2] >= 1));
+            }
+
+            if (!valid) break;
+
+            for (int k = 0; k < 3; k++)
+            {
+                memcpy(&mesh.vertices[(vertex + k)*3], &positions[(indices[k][0] - 1)*3], 3*sizeof(float));
+                if (normalsCount > 0) memcpy(&mesh.normals[(vertex + k)*3], &normals[(indices[k][2] - 1)*3], 3*sizeof(float));
+
+                // Texture coordinates are flipped vertically (images are loaded from top to bottom)
+                if (indices[k][1] > 0)
+                {
+                    mesh.texcoords[(vertex + k)*2] = texcoords[(indices[k][1] - 1)*2];
+                    mesh.texcoords[(vertex + k)*2 + 1] = 1.0f - texcoords[(indices[k][1] - 1)*2 + 1];
+                }
+            }
+
+            // Calculate flat normal if model has no normals (N = (V2 - V1) x (V3 - V1))
+            if (normalsCount == 0)
+            {
+                float *v = &mesh.vertices[vertex*3];
+                float e1[3] = { v[3] - v[0], v[4] - v[1], v[5] - v[2] };
+                float e2[3] = { v[6] - v[0], v[7] - v[1], v[8] - v[2] };
+                float n[3] = { e1[1]*e2[2] - e1[2]*e2[1], e1[2]*e2[0] - e1[0]*e2[2], e1[0]*e2[1] - e1[1]*e2[0] };
+                float length = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+                if (length > 0.0f) for (int c = 0; c < 3; c++) n[c] /= length;
+
+                for (int k = 0; k < 3; k++) memcpy(&mesh.normals[(vertex + k)*3], n, 3*sizeof(float));
+            }
+
+            vertex += 3;
+        }
+    }
+
+    PBR_FREE(positions);
+    PBR_FREE(texcoords);
+    PBR_FREE(normals);
+
+    if (!valid)
+    {
+        TraceLog(LOG_WARNING, "[%s] OBJ model has invalid faces", fileName);
+        free(mesh.vertices);
+        free(mesh.texcoords);
+        free(mesh.normals);
+        return (Mesh){ 0 };
+    }
+
+    TraceLog(LOG_INFO, "[%s] OBJ model parsed (%i vertices)", fileName, mesh.vertexCount);
+
+    return mesh;
+}
+
+// Compile and link a shader program with raylib attributes locations
+static unsigned int LoadShaderProgram(const char *vsText, int vsSize, const char *fsText, int fsSize, const char *fileName)
+{
+    const char *texts[2] = { vsText, fsText };
+    const int sizes[2] = { vsSize, fsSize };
+    const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+    unsigned int shaders[2] = { 0 };
+    unsigned int program = glCreateProgram();
+    int success = 0;
+    char log[1024] = { 0 };
+
+    for (int i = 0; i < 2; i++)
+    {
+        shaders[i] = glCreateShader(types[i]);
+        glShaderSource(shaders[i], 1, &texts[i], &sizes[i]);
+        glCompileShader(shaders[i]);
+        glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &success);
+
+        if (!success)
+        {
+            glGetShaderInfoLog(shaders[i], sizeof(log), NULL, log);
+            TraceLog(LOG_WARNING, "[%s] Archived shader failed to compile: %s", fileName, log);
+        }
+
+        glAttachShader(program, shaders[i]);
+    }
+
+    // Use same attributes locations than raylib meshes
+    glBindAttribLocation(program, 0, "vertexPosition");
+    glBindAttribLocation(program, 1, "vertexTexCoord");
+    glBindAttribLocation(program, 2, "vertexNormal");
+    glBindAttribLocation(program, 3, "vertexColor");
+    glBindAttribLocation(program, 4, "vertexTangent");
+    glBindAttribLocation(program, 5, "vertexTexCoord2");
+
+    glLinkProgram(program);
+
+    for (int i = 0; i < 2; i++)
+    {
+        glDetachShader(program, shaders[i]);
+        glDeleteShader(shaders[i]);
+    }
+
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    if (!success)
+    {
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        TraceLog(LOG_WARNING, "[SHDR ID %i] Archived shader failed to link: %s", program, log);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+//----------------------------------------------------------------------------------
+// raylib resources loading redirection (archived resources are loaded from archive, others from loose files)
+//----------------------------------------------------------------------------------
+#define LoadImage(fileName) LoadImageResource(fileName)
+#define LoadTexture(fileName) LoadTextureResource(fileName)
+#define LoadModel(fileName) LoadModelResource(fileName)
+#define LoadShader(vsFileName, fsFileName) LoadShaderResource(vsFileName, fsFileName)
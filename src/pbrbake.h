@@ -0,0 +1,225 @@
+/***********************************************************************************
+*
+*   rPBR [bake] - Compute shader image based lighting bake for raylib
+*
+*   FEATURES:
+*       - All prefilter faces and mipmap levels written in a single dispatch with image stores.
+*       - GGX lobe samples computed once per workgroup and cached in shared memory.
+*       - Irradiance projected into spherical harmonics (3 bands) and reduced in shared memory
+*         by an extra workgroup of the same dispatch.
+*       - No vertex processing, rasterization or depth buffer involved.
+*
+*   NOTES:
+*       Compute bake requires an OpenGL 4.3 context, LoadEnvironment falls back to rasterized passes otherwise.
+*       Define PBR_NO_COMPUTE_BAKE before including pbrcore.h to always use rasterized passes.
+*       Environment cubemap must have a complete mipmaps chain (source level selected per sample).
+*       Irradiance and prefilter textures must use RGBA16F format (RGB formats can't be used as images).
+*
+*   DEPENDENCIES:
+*       GLAD for OpenGL API (must be included before this file)
+*       GLFW for OpenGL 4.3 functions loading
+*       pbrmemory.h for tracked allocations (must be included before this file)
+*       pbrarchive.h for compute shader loading from resources archive (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         PATH_BAKE_CS                "resources/shaders/bake.cs"             // Path to prefilter and irradiance compute shader
+
+#define         BAKE_TILE_SIZE              8                                       // Prefilter texels per tile side (compute shader workgroup size)
+#define         BAKE_MAX_LEVELS             5                                       // Prefilter mipmap levels written by compute shader
+
+// OpenGL 4.3 compute values (not available in GLAD 3.3 Core profile)
+#ifndef GL_COMPUTE_SHADER
+    #define     GL_COMPUTE_SHADER                   0x91B9
+#endif
+#ifndef GL_TEXTURE_FETCH_BARRIER_BIT
+    #define     GL_TEXTURE_FETCH_BARRIER_BIT        0x00000008
+#endif
+#ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+    #define     GL_SHADER_IMAGE_ACCESS_BARRIER_BIT  0x00000020
+#endif
+
+#if !defined(_glfw3_h_) && !defined(PBR_GLFW_PROC_ADDRESS)
+    #define PBR_GLFW_PROC_ADDRESS
+    typedef void (*GLFWglproc)(void);
+    GLFWglproc glfwGetProcAddress(const char *procname);
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef void (APIENTRYP PFNDISPATCHCOMPUTEPROC)(GLuint x, GLuint y, GLuint z);
+typedef void (APIENTRYP PFNBINDIMAGETEXTUREPROC)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+typedef void (APIENTRYP PFNMEMORYBARRIERPROC)(GLbitfield barriers);
+
+typedef struct BakeCompute {
+    bool supported;                         // OpenGL 4.3 compute shaders available
+    PFNDISPATCHCOMPUTEPROC dispatchCompute;
+    PFNBINDIMAGETEXTUREPROC bindImageTexture;
+    PFNMEMORYBARRIERPROC memoryBarrier;
+
+    unsigned int program;                   // Prefilter and irradiance compute program
+    int tileOffsetsLoc;
+    int prefilterSizeLoc;
+    int irradianceSizeLoc;
+    int sourceSizeLoc;
+} BakeCompute;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+BakeCompute LoadBakeCompute(void);                                                  // Load bake compute shader if OpenGL 4.3 is available
+void BakeEnvironmentCompute(BakeCompute bake, unsigned int cubemapId, int cubemapSize, unsigned int irradianceId, int irradianceSize, unsigned int prefilterId, int prefilterSize);  // Bake irradiance and prefilter maps in a single dispatch
+void UnloadBakeCompute(BakeCompute bake);                                           // Unload bake compute shader
+
+static char *LoadBakeShaderText(const char *fileName);                              // Load compute shader text file (must be freed)
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Load bake compute shader if OpenGL 4.3 is available
+BakeCompute LoadBakeCompute(void)
+{
+    BakeCompute bake = { 0 };
+
+    int major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bake.dispatchCompute = (PFNDISPATCHCOMPUTEPROC)glfwGetProcAddress("glDispatchCompute");
+    bake.bindImageTexture = (PFNBINDIMAGETEXTUREPROC)glfwGetProcAddress("glBindImageTexture");
+    bake.memoryBarrier = (PFNMEMORYBARRIERPROC)glfwGetProcAddress("glMemoryBarrier");
+
+    if (((major*10 + minor) < 43) || (bake.dispatchCompute == NULL) || (bake.bindImageTexture == NULL) || (bake.memoryBarrier == NULL))
+    {
+        TraceLog(LOG_INFO, "Compute shaders require OpenGL 4.3, environment baked with rasterized passes");
+        return bake;
+    }
+
+    char *text = LoadBakeShaderText(PATH_BAKE_CS);
+
+    if (text == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] Bake compute shader file could not be opened", PATH_BAKE_CS);
+        return bake;
+    }
+
+    int success = 0;
+    char log[1024] = { 0 };
+    unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, (const char **)&text, NULL);
+    glCompileShader(shader);
+    PBR_FREE(text);
+
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+
+    if (!success)
+    {
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        TraceLog(LOG_WARNING, "[%s] Bake compute shader failed to compile: %s", PATH_BAKE_CS, log);
+        glDeleteShader(shader);
+        return bake;
+    }
+
+    bake.program = glCreateProgram();
+    glAttachShader(bake.program, shader);
+    glLinkProgram(bake.program);
+    glDetachShader(bake.program, shader);
+    glDeleteShader(shader);
+
+    glGetProgramiv(bake.program, GL_LINK_STATUS, &success);
+
+    if (!success)
+    {
+        glGetProgramInfoLog(bake.program, sizeof(log), NULL, log);
+        TraceLog(LOG_WARNING, "[SHDR ID %i] Bake compute shader failed to link: %s", bake.program, log);
+        glDeleteProgram(bake.program);
+        bake.program = 0;
+        return bake;
+    }
+
+    bake.supported = true;
+    bake.tileOffsetsLoc = glGetUniformLocation(bake.program, "tileOffsets");
+    bake.prefilterSizeLoc = glGetUniformLocation(bake.program, "prefilterSize");
+    bake.irradianceSizeLoc = glGetUniformLocation(bake.program, "irradianceSize");
+    bake.sourceSizeLoc = glGetUniformLocation(bake.program, "sourceSize");
+
+    return bake;
+}
+
+// Bake irradiance and prefilter maps in a single dispatch
+// NOTE: prefilter tiles of all faces and levels are flattened in X, last workgroup computes irradiance
+void BakeEnvironmentCompute(BakeCompute bake, unsigned int cubemapId, int cubemapSize, unsigned int irradianceId, int irradianceSize, unsigned int prefilterId, int prefilterSize)
+{
+    // Calculate first tile index of each prefilter level
+    int tileOffsets[BAKE_MAX_LEVELS + 1] = { 0 };
+
+    for (int i = 0; i < BAKE_MAX_LEVELS; i++)
+    {
+        int size = prefilterSize >> i;
+        if (size < 1) size = 1;
+
+        int tilesPerRow = (size + BAKE_TILE_SIZE - 1)/BAKE_TILE_SIZE;
+        tileOffsets[i + 1] = tileOffsets[i] + 6*tilesPerRow*tilesPerRow;
+    }
+
+    UseProgramGL(bake.program);
+    glUniform1iv(bake.tileOffsetsLoc, BAKE_MAX_LEVELS + 1, tileOffsets);
+    glUniform1i(bake.prefilterSizeLoc, prefilterSize);
+    glUniform1i(bake.irradianceSizeLoc, irradianceSize);
+    glUniform1f(bake.sourceSizeLoc, (float)cubemapSize);
+
+    BindTextureGL(0, GL_TEXTURE_CUBE_MAP, cubemapId);
+
+    // Bind all cube faces (layered) of each output level as images
+    for (int i = 0; i < BAKE_MAX_LEVELS; i++) bake.bindImageTexture(i, prefilterId, i, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    bake.bindImageTexture(BAKE_MAX_LEVELS, irradianceId, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    bake.dispatchCompute(tileOffsets[BAKE_MAX_LEVELS] + 1, 1, 1);
+
+    // Make image stores visible to texture fetches
+    bake.memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    for (int i = 0; i <= BAKE_MAX_LEVELS; i++) bake.bindImageTexture(i, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    TraceLog(LOG_INFO, "[SHDR ID %i] Environment baked with compute shader (%i workgroups)", bake.program, tileOffsets[BAKE_MAX_LEVELS] + 1);
+}
+
+// Unload bake compute shader
+void UnloadBakeCompute(BakeCompute bake)
+{
+    if (bake.program != 0) glDeleteProgram(bake.program);
+}
+
+// Load compute shader text file (must be freed)
+static char *LoadBakeShaderText(const char *fileName)
+{
+    unsigned int size = 0;
+
+    // Text is loaded from resources archive if available
+    return (char *)LoadResourceData(fileName, MEMORY_ENVIRONMENT, &size);
+}
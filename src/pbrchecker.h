@@ -0,0 +1,252 @@
+/***********************************************************************************
+*
+*   rPBR [checker] - Checkerboard rendering and reconstruction for raylib
+*
+*   FEATURES:
+*       - Scene shaded in alternating 2x2 pixels blocks each frame using a stencil mask.
+*       - Missing blocks reconstructed from camera reprojected previous frame.
+*       - Previous frame clamped to current spatial neighbours to reject disocclusions.
+*       - Spatial edge directed interpolation when previous frame is not available.
+*
+*   NOTES:
+*       Stencil mask uses 2x2 blocks instead of single pixels so discarded pixels
+*       skip full GPU quads and shading cost is really halved.
+*       Reconstructed frame is written into post-processing render texture, so it is
+*       used by post-processing effects as a regular full resolution frame.
+*
+*   DEPENDENCIES:
+*       pbrcore.h for OpenGL API and screen quad drawing (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         PATH_CHECKER_MASK_FS        "resources/shaders/checkermask.fs"      // Path to checkerboard stencil mask fragment shader
+#define         PATH_CHECKER_FS             "resources/shaders/checker.fs"          // Path to checkerboard reconstruction fragment shader
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct CheckerTarget {
+    unsigned int id;                        // Checkerboard framebuffer id
+    unsigned int colorId;                   // Current frame shaded blocks color texture id
+    unsigned int depthId;                   // Depth and stencil texture id (stencil stores checkerboard mask)
+    unsigned int historyId;                 // Previous reconstructed frame framebuffer id
+    unsigned int historyColorId;            // Previous reconstructed frame color texture id
+    int width;
+    int height;
+
+    int frame;                              // Current frame checkerboard pattern parity
+    bool validHistory;                      // Previous frame available to reconstruct missing blocks
+    Matrix prevViewProj;                    // Previous frame camera view-projection matrix
+
+    Shader maskShader;
+    Shader shader;
+    int maskFrameLoc;
+    int frameLoc;
+    int resolutionLoc;
+    int validHistoryLoc;
+    int invViewProjLoc;
+    int prevViewProjLoc;
+} CheckerTarget;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+CheckerTarget LoadCheckerTarget(int width, int height);                                         // Load checkerboard render target, history and reconstruction shaders
+void BeginCheckerMode(CheckerTarget target);                                                    // Draw current frame stencil mask and enable stencil test (call after BeginTextureMode)
+void EndCheckerMode(void);                                                                      // Disable checkerboard stencil test
+void ReconstructCheckerTarget(CheckerTarget *target, RenderTexture2D output, Camera camera);    // Reconstruct full frame into output texture and keep it as next frame history
+void UnloadCheckerTarget(CheckerTarget target);                                                 // Unload checkerboard render target and shaders from GPU
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Load checkerboard render target, history and reconstruction shaders
+CheckerTarget LoadCheckerTarget(int width, int height)
+{
+    CheckerTarget target = { 0 };
+    target.width = width;
+    target.height = height;
+
+    InvalidateStateGL();
+
+    // Create color and history textures (same format as post-processing render texture)
+    unsigned int *textures[2] = { &target.colorId, &target.historyColorId };
+
+    for (int i = 0; i < 2; i++)
+    {
+        glGenTextures(1, textures[i]);
+        BindTextureGL(0, GL_TEXTURE_2D, *textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (i == 0) ? GL_NEAREST : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (i == 0) ? GL_NEAREST : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    // Create depth and stencil texture (depth is read back to reproject missing blocks)
+    glGenTextures(1, &target.depthId);
+    BindTextureGL(0, GL_TEXTURE_2D, target.depthId);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+
+    // Attach textures to checkerboard framebuffer
+    glGenFramebuffers(1, &target.id);
+    BindFramebufferGL(GL_FRAMEBUFFER, target.id);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.colorId, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, target.depthId, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) TraceLog(LOG_WARNING, "[FBO ID %i] Checkerboard framebuffer object could not be created", target.id);
+    else TraceLog(LOG_INFO, "[FBO ID %i] Checkerboard framebuffer object created successfully", target.id);
+
+    // Attach history texture to its own framebuffer to copy reconstructed frames into it
+    glGenFramebuffers(1, &target.historyId);
+    BindFramebufferGL(GL_FRAMEBUFFER, target.historyId);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.historyColorId, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) TraceLog(LOG_WARNING, "[FBO ID %i] Checkerboard history framebuffer object could not be created", target.historyId);
+
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+
+    // Load stencil mask and reconstruction shaders (both drawn with a screen quad)
+    target.maskShader = LoadShader(PATH_BRDF_VS, PATH_CHECKER_MASK_FS);
+    target.maskFrameLoc = GetShaderLocation(target.maskShader, "frame");
+
+    target.shader = LoadShader(PATH_BRDF_VS, PATH_CHECKER_FS);
+    target.frameLoc = GetShaderLocation(target.shader, "frame");
+    target.resolutionLoc = GetShaderLocation(target.shader, "resolution");
+    target.validHistoryLoc = GetShaderLocation(target.shader, "validHistory");
+    target.invViewProjLoc = GetShaderLocation(target.shader, "invViewProj");
+    target.prevViewProjLoc = GetShaderLocation(target.shader, "prevViewProj");
+
+    // Set up reconstruction shader samplers units
+    SetShaderValuei(target.shader, GetShaderLocation(target.shader, "texture0"), (int[1]){ 0 }, 1);
+    SetShaderValuei(target.shader, GetShaderLocation(target.shader, "depthTexture"), (int[1]){ 1 }, 1);
+    SetShaderValuei(target.shader, GetShaderLocation(target.shader, "historyTexture"), (int[1]){ 2 }, 1);
+    SetShaderValue(target.shader, target.resolutionLoc, (float[2]){ (float)width, (float)height }, 2);
+
+    return target;
+}
+
+// Draw current frame stencil mask and enable stencil test (call after BeginTextureMode)
+void BeginCheckerMode(CheckerTarget target)
+{
+    InvalidateStateGL();
+
+    glClearStencil(0);
+    glClear(GL_STENCIL_BUFFER_BIT);
+
+    // Write current frame blocks into stencil buffer without touching color and depth
+    glEnable(GL_STENCIL_TEST);
+    glStencilFunc(GL_ALWAYS, 1, 0xff);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    DepthMaskGL(false);
+
+    SetShaderValuei(target.maskShader, target.maskFrameLoc, (int[1]){ target.frame }, 1);
+    UseProgramGL(target.maskShader.id);
+    RenderQuad();
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    DepthMaskGL(true);
+
+    // Draw scene just in masked blocks
+    glStencilFunc(GL_EQUAL, 1, 0xff);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+}
+
+// Disable checkerboard stencil test
+void EndCheckerMode(void)
+{
+    glDisable(GL_STENCIL_TEST);
+}
+
+// Reconstruct full frame into output texture and keep it as next frame history
+void ReconstructCheckerTarget(CheckerTarget *target, RenderTexture2D output, Camera camera)
+{
+    // Calculate current frame inverse view-projection to reproject missing blocks
+    Matrix viewProj = GetCameraMatrixPBR(camera, (float)GetScreenWidth()/(float)GetScreenHeight());
+    Matrix invViewProj = viewProj;
+    MatrixInvert(&invViewProj);
+
+    SetShaderValuei(target->shader, target->frameLoc, (int[1]){ target->frame }, 1);
+    SetShaderValuei(target->shader, target->validHistoryLoc, (int[1]){ target->validHistory }, 1);
+    SetShaderValueMatrix(target->shader, target->invViewProjLoc, invViewProj);
+    SetShaderValueMatrix(target->shader, target->prevViewProjLoc, target->prevViewProj);
+    InvalidateStateGL();
+
+    // Draw reconstructed frame into output render texture
+    BindFramebufferGL(GL_FRAMEBUFFER, output.id);
+    ViewportGL(0, 0, target->width, target->height);
+
+    BindTextureGL(0, GL_TEXTURE_2D, target->colorId);
+    BindTextureGL(1, GL_TEXTURE_2D, target->depthId);
+    BindTextureGL(2, GL_TEXTURE_2D, target->historyColorId);
+
+    UseProgramGL(target->shader.id);
+    RenderQuad();
+
+    BindTextureGL(2, GL_TEXTURE_2D, 0);
+    BindTextureGL(1, GL_TEXTURE_2D, 0);
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+
+    // Copy reconstructed frame as history for next frame
+    BindFramebufferGL(GL_READ_FRAMEBUFFER, output.id);
+    BindFramebufferGL(GL_DRAW_FRAMEBUFFER, target->historyId);
+    glBlitFramebuffer(0, 0, target->width, target->height, 0, 0, target->width, target->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+    ViewportGL(0, 0, GetScreenWidth(), GetScreenHeight());
+
+    // Swap checkerboard pattern for next frame
+    target->frame = 1 - target->frame;
+    target->validHistory = true;
+    target->prevViewProj = viewProj;
+}
+
+// Unload checkerboard render target and shaders from GPU
+void UnloadCheckerTarget(CheckerTarget target)
+{
+    ForgetFramebufferGL(target.id);
+    ForgetFramebufferGL(target.historyId);
+    ForgetTextureGL(target.colorId);
+    ForgetTextureGL(target.depthId);
+    ForgetTextureGL(target.historyColorId);
+
+    glDeleteFramebuffers(1, &target.id);
+    glDeleteFramebuffers(1, &target.historyId);
+    glDeleteTextures(1, &target.colorId);
+    glDeleteTextures(1, &target.depthId);
+    glDeleteTextures(1, &target.historyColorId);
+
+    UnloadShader(target.maskShader);
+    UnloadShader(target.shader);
+}
@@ -10,16 +10,24 @@
 *       - Simple and easy-to-use implementation code.
 *       - Multi-material scene supported.
 *       - Point and directional lights supported.
+*       - Rectangular and disk area lights using linearly transformed cosines (constant cost per light).
 *       - Internal shader values and locations points handled automatically.
+*       - Redundant OpenGL state changes skipped by a state tracker (pbrstate.h).
+*       - Irradiance and prefilter maps baked in a single compute dispatch on OpenGL 4.3 (pbrbake.h).
+*       - Environment bake passes recorded and submitted through a render device abstraction (pbrdevice.h).
 *
 *   NOTES:
 *       Physically based rendering shaders paths are set up by default
 *       Remember to call UnloadMaterialPBR and UnloadEnvironment to deallocate required memory and unload textures
 *       Physically based rendering requires OpenGL 3.3 or ES2
+*       Area lights fitted LTC table is generated offline by ltcfit tool (src/ltcfit.c)
+*       PBR shader values are set with SetShaderValuePBR so programs sharing PBR fragment shader (tessellation) receive them
+*       Mirrored values are kept until shared program is bound, so they are sent with a single program switch
 *
 *   DEPENDENCIES:
 *       stb_image (Sean Barret) for images loading (JPEG, PNG, BMP, HDR)
 *       GLAD for OpenGL extensions loading (3.3 Core profile)
+*       pbrmemory.h for tracked allocations (environment memory scope)
 *
 *   LICENSE: zlib/libpng
 *
@@ -48,16 +56,25 @@
 //----------------------------------------------------------------------------------
 // Includes
 //----------------------------------------------------------------------------------
+#include <string.h>                         // Required for: memcmp(), memcpy(), strlen(), strcmp()
+#include <stdio.h>                          // Required for: snprintf()
 #include <math.h>                           // Required for: powf()
 
 #include "external/raylib/src/raymath.h"    // Required for matrix, vectors and other math functions
 #include "external/glad.h"                  // Required for OpenGL API
+#include "pbrmemory.h"                      // Required for: PBR_MALLOC(), PBR_FREE(), BeginMemoryScope(), EndMemoryScope()
+#include "pbrarchive.h"                     // Required for: LoadResourceData(), resources loading from archive (redirects raylib loading functions)
+#include "pbrstate.h"                       // Required for: UseProgramGL(), BindTextureGL(), BindFramebufferGL()
+#include "pbrbake.h"                        // Required for: LoadBakeCompute(), BakeEnvironmentCompute()
+#include "pbrdevice.h"                      // Required for: LoadRenderDevice(), LoadCommandList(), CmdBeginPass()
 
 //----------------------------------------------------------------------------------
 // Defines
 //----------------------------------------------------------------------------------
 #define         MAX_LIGHTS                  4                                       // Max lights supported by shader
 #define         MAX_MIPMAP_LEVELS           5                                       // Max number of prefilter texture mipmaps
+#define         MAX_SHARED_LOCATIONS        256                                     // Max PBR shader uniform locations mirrored into shared program
+#define         BAKE_PASSES                 (MAX_MIPMAP_LEVELS + 3)                 // Environment bake command lists (cubemap, irradiance, prefilter levels and BRDF)
 
 #define         PATH_PBR_VS                 "resources/shaders/pbr.vs"              // Path to physically based rendering vertex shader
 #define         PATH_PBR_FS                 "resources/shaders/pbr.fs"              // Path to physically based rendering fragment shader
@@ -69,13 +86,16 @@
 #define         PATH_PREFILTER_FS           "resources/shaders/prefilter.fs"        // Path to reflection prefilter calculation fragment shader
 #define         PATH_BRDF_VS                "resources/shaders/brdf.vs"             // Path to bidirectional reflectance distribution function vertex shader 
 #define         PATH_BRDF_FS                "resources/shaders/brdf.fs"             // Path to bidirectional reflectance distribution function fragment shader
+#define         PATH_LTC_TABLE              "resources/tables/ltc_ggx.bin"          // Path to area lights linearly transformed cosines fitted table
 
 //----------------------------------------------------------------------------------
 // Structs and enums
 //----------------------------------------------------------------------------------
 typedef enum {
     LIGHT_DIRECTIONAL,
-    LIGHT_POINT
+    LIGHT_POINT,
+    LIGHT_RECT,
+    LIGHT_DISK
 } LightType;
 
 typedef struct {
@@ -84,11 +104,13 @@ typedef struct {
     Vector3 position;
     Vector3 target;
     Color color;
+    Vector2 size;                               // Area light width and height (rectangle sides or disk diameters)
     int enabledLoc;
     int typeLoc;
     int posLoc;
     int targetLoc;
     int colorLoc;
+    int sizeLoc;
 } Light;
 
 typedef struct Environment {
@@ -99,11 +121,21 @@ typedef struct Environment {
     unsigned int irradianceId;
     unsigned int prefilterId;
     unsigned int brdfId;
+    unsigned int ltcId;                         // Area lights LTC table texture array id (inverse matrices and BRDF magnitude layers)
+
+    bool computeBake;                           // Irradiance and prefilter maps baked with compute shader (OpenGL 4.3)
+    float cubemapTime;                          // Equirectangular to cubemap conversion GPU time in milliseconds
+    float bakeTime;                             // Irradiance and prefilter bake GPU time in milliseconds
+    float brdfTime;                             // BRDF LUT bake GPU time in milliseconds
 
     int modelMatrixLoc;
     int pbrViewLoc;
+    int pbrLightingModeLoc;
+    int pbrExposureLoc;
+    int pbrSSAOLoc;
     int skyViewLoc;
     int skyResolutionLoc;
+    int skyExposureLoc;
 } Environment;
 
 typedef struct PropertyPBR {
@@ -126,6 +158,25 @@ typedef struct MaterialPBR {
     Environment env;
 } MaterialPBR;
 
+typedef struct RenderTextureMSAA {
+    unsigned int id;                            // Multisampled framebuffer id
+    unsigned int colorId;                       // Multisampled color renderbuffer id
+    unsigned int depthId;                       // Multisampled depth renderbuffer id
+    int width;
+    int height;
+    int samples;
+} RenderTextureMSAA;
+
+typedef struct LightingTarget {
+    unsigned int id;                            // Half resolution lighting framebuffer id
+    unsigned int irradianceId;                  // Diffuse irradiance texture id
+    unsigned int specularId;                    // Rough surfaces prefiltered reflection texture id
+    unsigned int geometryId;                    // Normals and view distance texture id (used to upsample)
+    unsigned int depthId;                       // Depth renderbuffer id
+    int width;
+    int height;
+} LightingTarget;
+
 typedef enum TypePBR {
     PBR_ALBEDO,
     PBR_NORMALS,
@@ -136,11 +187,91 @@ typedef enum TypePBR {
     PBR_HEIGHT
 } TypePBR;
 
+typedef struct BakePasses {
+    DevicePass pass;                            // Capture framebuffer shared by all passes
+    DeviceBuffer cube;                          // Cube vertices drawn for each cubemap face
+    DeviceBuffer quad;                          // Quad vertices drawn for BRDF LUT
+    DeviceTexture sky;                          // Equirectangular environment texture
+    DeviceTexture cubemap;
+    DeviceTexture irradiance;
+    DeviceTexture prefilter;
+    DeviceTexture brdf;
+    DevicePipeline cubePipeline;
+    DevicePipeline irradiancePipeline;
+    DevicePipeline prefilterPipeline;
+    DevicePipeline brdfPipeline;
+    int projectionLocs[3];                      // Cubemap, irradiance and prefilter shaders projection locations
+    int viewLocs[3];                            // Cubemap, irradiance and prefilter shaders view locations
+    int roughnessLoc;                           // Prefilter shader roughness location
+    Matrix projection;                          // Capture projection (transposed)
+    Matrix views[6];                            // Capture views for each cubemap face
+} BakePasses;
+
+typedef struct SharedValue {
+    int size;                                   // Pending value components count (0 if already sent)
+    bool integer;                               // Value is sent as integers
+    float values[4];                            // Float value components
+    int ivalues[4];                             // Integer value components
+} SharedValue;
+
 //----------------------------------------------------------------------------------
 // Global Variables Definition
 //----------------------------------------------------------------------------------
 static int lightsCount = 0;                     // Current amount of created lights
 
+static unsigned int sharedSourceId = 0;         // PBR shader program which values are mirrored (0 if none)
+static unsigned int sharedProgramId = 0;        // Program linked with PBR fragment shader receiving PBR shader values (tessellation)
+static int sharedLocs[MAX_SHARED_LOCATIONS];    // Shared program location of each PBR shader location (-1 if not used)
+static SharedValue sharedValues[MAX_SHARED_LOCATIONS];  // Mirrored values waiting for shared program bind
+static bool sharedPending = false;              // Any mirrored value is waiting for shared program bind
+
+static const float cubeVertices[] = {           // Cube positions, normals and texture coords (36 vertices)
+    -1.0f, -1.0f, -1.0f,  0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
+    1.0f, 1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f,
+    1.0f, -1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f,
+    1.0f, 1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f,
+    -1.0f, -1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
+    -1.0f, 1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f,
+    -1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+    1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+    1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+    -1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
+    -1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+    -1.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+    -1.0f, 1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+    -1.0f, -1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+    -1.0f, -1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+    -1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+    -1.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+    1.0f, -1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+    1.0f, 1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+    1.0f, -1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+    1.0f, -1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+    -1.0f, -1.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f,
+    1.0f, -1.0f, -1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f,
+    1.0f, -1.0f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+    1.0f, -1.0f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+    -1.0f, -1.0f, 1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+    -1.0f, -1.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f,
+    -1.0f, 1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+    1.0f, 1.0f , 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
+    1.0f, 1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
+    -1.0f, 1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+    -1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f
+};
+
+static const float quadVertices[] = {           // Quad positions and texture coords (4 vertices, triangle strip)
+    // Positions        // Texture Coords
+    -1.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+    -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+    1.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+    1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+};
+
 //----------------------------------------------------------------------------------
 // Functions Declaration
 //----------------------------------------------------------------------------------
@@ -149,19 +280,45 @@ void SetMaterialTexturePBR(MaterialPBR *mat, TypePBR type, Texture2D texture);
 void UnsetMaterialTexturePBR(MaterialPBR *mat, TypePBR type);                                                                   // Unset texture to PBR material and unload it from GPU
 Light CreateLight(int type, Vector3 pos, Vector3 targ, Color color, Environment env);                                           // Defines a light and get locations from environment PBR shader
 Environment LoadEnvironment(const char *filename, int cubemapSize, int irradianceSize, int prefilterSize, int brdfSize);        // Load an environment cubemap, irradiance, prefilter and PBR scene
+void SetupEnvironmentShaders(Environment *env);                                                                                 // Load environment PBR and skybox shaders and set up their locations and rendering states
+unsigned int LoadTableLTC(const char *filename);                                                                                // Load area lights linearly transformed cosines table into a texture array
+static void RecordBakePass(CommandList *list, int index, const BakePasses *passes);                                             // Record an environment bake pass (cubemap, irradiance, prefilter level or BRDF)
 
 int GetLightsCount(void);                                                                                                       // Get the current amount of created lights
 void UpdateLightValues(Environment env, Light light);                                                                           // Send to environment PBR shader light values
 void UpdateEnvironmentValues(Environment env, Camera camera, Vector2 res);                                                      // Send to environment PBR shader camera view and resolution values
+void SetShaderValuePBR(Environment env, int uniformLoc, const float *value, int size);                                          // Set PBR shader float uniform value (mirrored into shared program)
+void SetShaderValueiPBR(Environment env, int uniformLoc, const int *value, int size);                                           // Set PBR shader integer uniform value (mirrored into shared program)
+void SetSharedProgramPBR(Environment env, unsigned int programId);                                                              // Mirror PBR shader values into a program linked with PBR fragment shader
+void UnsetSharedProgramPBR(unsigned int programId);                                                                             // Stop mirroring PBR shader values into a program (call before unloading it)
+bool IsSharedProgramPBR(Environment env, unsigned int programId);                                                               // Check if a program receives environment PBR shader values
+Matrix GetCameraMatrixPBR(Camera camera, float aspect);                                                                         // Get camera view-projection matrix (same conventions as 3D mode)
 
 void DrawModelPBR(Model model, MaterialPBR mat, Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale);    // Draw a model using physically based rendering
+void BindMaterialPBR(MaterialPBR mat, Matrix transform);                                                                        // Send material values and model matrix to PBR shader and bind its textures
+void BindSharedMaterialPBR(MaterialPBR mat, Matrix transform);                                                                  // Send material values and model matrix to shared program and bind its textures
+void UnbindMaterialPBR(void);                                                                                                   // Release material after drawing (textures are kept bound)
 void DrawSkybox(Environment environment, Camera camera);                                                                        // Draw a cube skybox using environment cube map
 void RenderCube(void);                                                                                                          // Renders a 1x1 3D cube in NDC
 void RenderQuad(void);                                                                                                          // Renders a 1x1 XY quad in NDC
 
+RenderTextureMSAA LoadRenderTextureMSAA(int width, int height, int samples);                                                    // Load a multisampled render target (color and depth renderbuffers)
+void ResolveRenderTextureMSAA(RenderTextureMSAA source, RenderTexture2D target);                                                // Resolve multisampled render target color into a render texture
+void UnloadRenderTextureMSAA(RenderTextureMSAA target);                                                                         // Unload multisampled render target from GPU
+
+LightingTarget LoadLightingTarget(int width, int height);                                                                       // Load a half resolution image based lighting render target
+void BeginLightingMode(Environment env, LightingTarget target);                                                                 // Begin drawing image based lighting to half resolution target
+void EndLightingMode(Environment env, LightingTarget target);                                                                   // End half resolution lighting drawing and bind it to be upsampled by PBR shader
+void DisableLightingTarget(Environment env);                                                                                    // Unbind half resolution lighting and return to full rate lighting
+void UnloadLightingTarget(LightingTarget target);                                                                               // Unload half resolution lighting render target from GPU
+
 void UnloadMaterialPBR(MaterialPBR mat);                                                                                        // Unload material PBR textures
 void UnloadEnvironment(Environment env);                                                                                        // Unload environment loaded shaders and dynamic textures
 
+static void SetMaterialValuesPBR(MaterialPBR mat, Matrix transform, bool shared);                                               // Send material values and model matrix to bound program and bind material textures
+static int GetSharedLocationPBR(int uniformLoc, bool shared);                                                                   // Get shared program location of a PBR shader location (same location if not shared)
+static void SendSharedValuesPBR(void);                                                                                          // Send pending mirrored values to shared program (must be bound)
+
 //----------------------------------------------------------------------------------
 // Functions Definition
 //----------------------------------------------------------------------------------
@@ -226,13 +383,13 @@ MaterialPBR SetupMaterialPBR(Environment env, Color albedo, int metalness, int r
     mat.height.colorLoc = GetShaderLocation(mat.env.pbrShader, "height.color");
 
     // Set up PBR shader material texture units
-    SetShaderValuei(mat.env.pbrShader, mat.albedo.bitmapLoc, (int[1]){ 3 }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.normals.bitmapLoc, (int[1]){ 4 }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.metalness.bitmapLoc, (int[1]){ 5 }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.roughness.bitmapLoc, (int[1]){ 6 }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.ao.bitmapLoc, (int[1]){ 7 }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.emission.bitmapLoc, (int[1]){ 8 }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.height.bitmapLoc, (int[1]){ 9 }, 1);
+    SetShaderValueiPBR(mat.env, mat.albedo.bitmapLoc, (int[1]){ 3 }, 1);
+    SetShaderValueiPBR(mat.env, mat.normals.bitmapLoc, (int[1]){ 4 }, 1);
+    SetShaderValueiPBR(mat.env, mat.metalness.bitmapLoc, (int[1]){ 5 }, 1);
+    SetShaderValueiPBR(mat.env, mat.roughness.bitmapLoc, (int[1]){ 6 }, 1);
+    SetShaderValueiPBR(mat.env, mat.ao.bitmapLoc, (int[1]){ 7 }, 1);
+    SetShaderValueiPBR(mat.env, mat.emission.bitmapLoc, (int[1]){ 8 }, 1);
+    SetShaderValueiPBR(mat.env, mat.height.bitmapLoc, (int[1]){ 9 }, 1);
 
     return mat;
 }
@@ -291,6 +448,7 @@ void UnsetMaterialTexturePBR(MaterialPBR *mat, TypePBR type)
             if (mat->albedo.useBitmap)
             {
                 mat->albedo.useBitmap = false;
+                ForgetTextureGL(mat->albedo.bitmap.id);
                 UnloadTexture(mat->albedo.bitmap);
                 mat->albedo.bitmap = (Texture2D){ 0 };
             }
@@ -300,6 +458,7 @@ void UnsetMaterialTexturePBR(MaterialPBR *mat, TypePBR type)
             if (mat->normals.useBitmap)
             {
                 mat->normals.useBitmap = false;
+                ForgetTextureGL(mat->normals.bitmap.id);
                 UnloadTexture(mat->normals.bitmap);
                 mat->normals.bitmap = (Texture2D){ 0 };
             }
@@ -309,6 +468,7 @@ void UnsetMaterialTexturePBR(MaterialPBR *mat, TypePBR type)
             if (mat->metalness.useBitmap)
             {
                 mat->metalness.useBitmap = false;
+                ForgetTextureGL(mat->metalness.bitmap.id);
                 UnloadTexture(mat->metalness.bitmap);
                 mat->metalness.bitmap = (Texture2D){ 0 };
             }
@@ -318,6 +478,7 @@ void UnsetMaterialTexturePBR(MaterialPBR *mat, TypePBR type)
             if (mat->roughness.useBitmap)
             {
                 mat->roughness.useBitmap = false;
+                ForgetTextureGL(mat->roughness.bitmap.id);
                 UnloadTexture(mat->roughness.bitmap);
                 mat->roughness.bitmap = (Texture2D){ 0 };
             }
@@ -327,6 +488,7 @@ void UnsetMaterialTexturePBR(MaterialPBR *mat, TypePBR type)
             if (mat->ao.useBitmap)
             {
                 mat->ao.useBitmap = false;
+                ForgetTextureGL(mat->ao.bitmap.id);
                 UnloadTexture(mat->ao.bitmap);
                 mat->ao.bitmap = (Texture2D){ 0 };
             }
@@ -336,6 +498,7 @@ void UnsetMaterialTexturePBR(MaterialPBR *mat, TypePBR type)
             if (mat->emission.useBitmap)
             {
                 mat->emission.useBitmap = false;
+                ForgetTextureGL(mat->emission.bitmap.id);
                 UnloadTexture(mat->emission.bitmap);
                 mat->emission.bitmap = (Texture2D){ 0 };
             }
@@ -345,6 +508,7 @@ void UnsetMaterialTexturePBR(MaterialPBR *mat, TypePBR type)
             if (mat->height.useBitmap)
             {
                 mat->height.useBitmap = false;
+                ForgetTextureGL(mat->height.bitmap.id);
                 UnloadTexture(mat->height.bitmap);
                 mat->height.bitmap = (Texture2D){ 0 };
             }
@@ -365,23 +529,27 @@ Light CreateLight(int type, Vector3 pos, Vector3 targ, Color color, Environment
         light.position = pos;
         light.target = targ;
         light.color = color;
+        light.size = (Vector2){ 1.0f, 1.0f };
 
         char enabledName[32] = "lights[x].enabled\0";
         char typeName[32] = "lights[x].type\0";
         char posName[32] = "lights[x].position\0";
         char targetName[32] = "lights[x].target\0";
         char colorName[32] = "lights[x].color\0";
+        char sizeName[32] = "lights[x].size\0";
         enabledName[7] = '0' + lightsCount;
         typeName[7] = '0' + lightsCount;
         posName[7] = '0' + lightsCount;
         targetName[7] = '0' + lightsCount;
         colorName[7] = '0' + lightsCount;
+        sizeName[7] = '0' + lightsCount;
 
         light.enabledLoc = GetShaderLocation(env.pbrShader, enabledName);
         light.typeLoc = GetShaderLocation(env.pbrShader, typeName);
         light.posLoc = GetShaderLocation(env.pbrShader, posName);
         light.targetLoc = GetShaderLocation(env.pbrShader, targetName);
         light.colorLoc = GetShaderLocation(env.pbrShader, colorName);
+        light.sizeLoc = GetShaderLocation(env.pbrShader, sizeName);
 
         UpdateLightValues(env, light);
         lightsCount++;
@@ -395,25 +563,22 @@ Environment LoadEnvironment(const char *filename, int cubemapSize, int irradianc
 {
     Environment env = { 0 };
 
-    // Load environment required shaders
-    env.pbrShader = LoadShader(PATH_PBR_VS, PATH_PBR_FS);
-    
+    // Attribute HDR decoding and baking allocations to environment
+    BeginMemoryScope(MEMORY_ENVIRONMENT);
+
+    // Load environment PBR and skybox shaders
+    SetupEnvironmentShaders(&env);
+
+    // Load bake required shaders
     Shader cubeShader = LoadShader(PATH_CUBE_VS, PATH_CUBE_FS);
     Shader irradianceShader = LoadShader(PATH_SKYBOX_VS, PATH_IRRADIANCE_FS);
     Shader prefilterShader = LoadShader(PATH_SKYBOX_VS, PATH_PREFILTER_FS);
     Shader brdfShader = LoadShader(PATH_BRDF_VS, PATH_BRDF_FS);
-    
-    env.skyShader = LoadShader(PATH_SKYBOX_VS, PATH_SKYBOX_FS);
 
     // Get cubemap shader locations
     int cubeProjectionLoc = GetShaderLocation(cubeShader, "projection");
     int cubeViewLoc = GetShaderLocation(cubeShader, "view");
 
-    // Get skybox shader locations
-    int skyProjectionLoc = GetShaderLocation(env.skyShader, "projection");
-    env.skyViewLoc = GetShaderLocation(env.skyShader, "view");
-    env.skyResolutionLoc = GetShaderLocation(env.skyShader, "resolution");
-
     // Get irradiance shader locations
     int irradianceProjectionLoc = GetShaderLocation(irradianceShader, "projection");
     int irradianceViewLoc = GetShaderLocation(irradianceShader, "view");
@@ -423,11 +588,6 @@ Environment LoadEnvironment(const char *filename, int cubemapSize, int irradianc
     int prefilterViewLoc = GetShaderLocation(prefilterShader, "view");
     int prefilterRoughnessLoc = GetShaderLocation(prefilterShader, "roughness");
 
-    // Set up environment shader texture units
-    SetShaderValuei(env.pbrShader, GetShaderLocation(env.pbrShader, "irradianceMap"), (int[1]){ 0 }, 1);
-    SetShaderValuei(env.pbrShader, GetShaderLocation(env.pbrShader, "prefilterMap"), (int[1]){ 1 }, 1);
-    SetShaderValuei(env.pbrShader, GetShaderLocation(env.pbrShader, "brdfLUT"), (int[1]){ 2 }, 1);
-
     // Set up cubemap shader constant values
     SetShaderValuei(cubeShader, GetShaderLocation(cubeShader, "equirectangularMap"), (int[1]){ 0 }, 1);
 
@@ -437,195 +597,289 @@ Environment LoadEnvironment(const char *filename, int cubemapSize, int irradianc
     // Set up prefilter shader constant values
     SetShaderValuei(prefilterShader, GetShaderLocation(prefilterShader, "environmentMap"), (int[1]){ 0 }, 1);
 
-    // Set up skybox shader constant values
-    SetShaderValuei(env.skyShader, GetShaderLocation(env.skyShader, "environmentMap"), (int[1]){ 0 }, 1);
-
-    // Set up depth face culling and cube map seamless
-    glDepthFunc(GL_LEQUAL);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-    glLineWidth(2);
-
     // Load HDR environment texture
     Texture2D skyTex = LoadTexture(filename);
-
-    // Set up framebuffer for skybox
-    unsigned int captureFBO, captureRBO;
-    glGenFramebuffers(1, &captureFBO);
-    glGenRenderbuffers(1, &captureRBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, cubemapSize, cubemapSize);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
-
-    // Set up cubemap to render and attach to framebuffer
-    // NOTE: faces are stored with 16 bit floating point values
-    glGenTextures(1, &env.cubemapId);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, env.cubemapId);
-    for (unsigned int i = 0; i < 6; i++) glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, cubemapSize, cubemapSize, 0, GL_RGB, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    InvalidateStateGL();
+
+    // Use compute shader bake for irradiance and prefilter if available
+#if !defined(PBR_NO_COMPUTE_BAKE)
+    BakeCompute bake = LoadBakeCompute();
+#else
+    BakeCompute bake = { 0 };
+#endif
+    env.computeBake = bake.supported;
+
+    // Load bake resources through render device
+    // NOTE: compute bake writes irradiance and prefilter as images, so RGBA format is required
+    RenderDevice device = LoadRenderDevice(DEVICE_BACKEND_GL);
+    DeviceFormat bakeFormat = (bake.supported ? DEVICE_FORMAT_RGBA16F : DEVICE_FORMAT_RGB16F);
+    int passSize = ((cubemapSize > prefilterSize) ? cubemapSize : prefilterSize);
+    if (brdfSize > passSize) passSize = brdfSize;
+    if (irradianceSize > passSize) passSize = irradianceSize;
+
+    BakePasses passes = { 0 };
+    passes.pass = device.loadPass(passSize);
+    passes.cube = device.loadBuffer(cubeVertices, 36, (int[3]){ 3, 3, 2 }, 3, DEVICE_PRIMITIVE_TRIANGLES);
+    passes.quad = device.loadBuffer(quadVertices, 4, (int[2]){ 3, 2 }, 2, DEVICE_PRIMITIVE_TRIANGLE_STRIP);
+    passes.sky = (DeviceTexture){ skyTex.id, DEVICE_TEXTURE_2D, DEVICE_FORMAT_RGB16F, skyTex.width, 1 };
+    passes.cubemap = device.loadTexture(DEVICE_TEXTURE_CUBE, DEVICE_FORMAT_RGB16F, cubemapSize, MAX_MIPMAP_LEVELS);
+    passes.irradiance = device.loadTexture(DEVICE_TEXTURE_CUBE, bakeFormat, irradianceSize, 1);
+    passes.prefilter = device.loadTexture(DEVICE_TEXTURE_CUBE, bakeFormat, prefilterSize, MAX_MIPMAP_LEVELS);
+    passes.brdf = device.loadTexture(DEVICE_TEXTURE_2D, DEVICE_FORMAT_RG16F, brdfSize, 1);
+    passes.cubePipeline = device.loadPipeline(cubeShader.id, false);
+    passes.irradiancePipeline = device.loadPipeline(irradianceShader.id, false);
+    passes.prefilterPipeline = device.loadPipeline(prefilterShader.id, false);
+    passes.brdfPipeline = device.loadPipeline(brdfShader.id, false);
+    passes.projectionLocs[0] = cubeProjectionLoc;
+    passes.projectionLocs[1] = irradianceProjectionLoc;
+    passes.projectionLocs[2] = prefilterProjectionLoc;
+    passes.viewLocs[0] = cubeViewLoc;
+    passes.viewLocs[1] = irradianceViewLoc;
+    passes.viewLocs[2] = prefilterViewLoc;
+    passes.roughnessLoc = prefilterRoughnessLoc;
+
+    env.cubemapId = passes.cubemap.id;
+    env.irradianceId = passes.irradiance.id;
+    env.prefilterId = passes.prefilter.id;
+    env.brdfId = passes.brdf.id;
 
     // Create projection (transposed) and different views for each face
-    Matrix captureProjection = MatrixPerspective(90.0f, 1.0f, 0.01, 1000.0);
-    MatrixTranspose(&captureProjection);
-    Matrix captureViews[6] = {
-        MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 1.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, -1.0f, 0.0f }),
-        MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ -1.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, -1.0f, 0.0f }),
-        MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 1.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, 1.0f }),
-        MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, -1.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, -1.0f }),
-        MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, 1.0f }, (Vector3){ 0.0f, -1.0f, 0.0f }),
-        MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, -1.0f }, (Vector3){ 0.0f, -1.0f, 0.0f })
-    };
-
-    // Convert HDR equirectangular environment map to cubemap equivalent
-    glUseProgram(cubeShader.id);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, skyTex.id);
-    SetShaderValueMatrix(cubeShader, cubeProjectionLoc, captureProjection);
-
-    // Note: don't forget to configure the viewport to the capture dimensions
-    glViewport(0, 0, cubemapSize, cubemapSize);
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-
-    for (unsigned int i = 0; i < 6; i++)
+    passes.projection = MatrixPerspective(90.0f, 1.0f, 0.01, 1000.0);
+    MatrixTranspose(&passes.projection);
+    passes.views[0] = MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 1.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, -1.0f, 0.0f });
+    passes.views[1] = MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ -1.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, -1.0f, 0.0f });
+    passes.views[2] = MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 1.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, 1.0f });
+    passes.views[3] = MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, -1.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, -1.0f });
+    passes.views[4] = MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, 1.0f }, (Vector3){ 0.0f, -1.0f, 0.0f });
+    passes.views[5] = MatrixLookAt((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 0.0f, -1.0f }, (Vector3){ 0.0f, -1.0f, 0.0f });
+
+    // Record all bake passes (irradiance and prefilter lists are skipped by compute bake)
+    CommandList lists[BAKE_PASSES] = { 0 };
+
+    for (int i = 0; i < BAKE_PASSES; i++)
     {
-        SetShaderValueMatrix(cubeShader, cubeViewLoc, captureViews[i]);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, env.cubemapId, 0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        RenderCube();
+        lists[i] = LoadCommandList();
+        RecordBakePass(&lists[i], i, &passes);
     }
 
-    // Unbind framebuffer and textures
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    // Create an irradiance cubemap, and re-scale capture FBO to irradiance scale
-    glGenTextures(1, &env.irradianceId);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, env.irradianceId);
-    for (unsigned int i = 0; i < 6; i++) glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, irradianceSize, irradianceSize, 0, GL_RGB, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, irradianceSize, irradianceSize);
-
-    // Solve diffuse integral by convolution to create an irradiance cubemap
-    glUseProgram(irradianceShader.id);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, env.cubemapId);
-    SetShaderValueMatrix(irradianceShader, irradianceProjectionLoc, captureProjection);
-
-    // Note: don't forget to configure the viewport to the capture dimensions
-    glViewport(0, 0, irradianceSize, irradianceSize);
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-
-    for (unsigned int i = 0; i < 6; i++)
-    {
-        SetShaderValueMatrix(irradianceShader, irradianceViewLoc, captureViews[i]);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, env.irradianceId, 0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        RenderCube();
-    }
+    // Set up GPU timer to report bake passes costs
+    unsigned int queryId = 0;
+    GLuint64 elapsed = 0;
+    glGenQueries(1, &queryId);
 
-    // Unbind framebuffer and textures
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    // Create a prefiltered HDR environment map
-    glGenTextures(1, &env.prefilterId);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, env.prefilterId);
-    for (unsigned int i = 0; i < 6; i++) glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, prefilterSize, prefilterSize, 0, GL_RGB, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    // Generate mipmaps for the prefiltered HDR texture
-    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
-
-    // Prefilter HDR and store data into mipmap levels
-    glUseProgram(prefilterShader.id);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, env.cubemapId);
-    SetShaderValueMatrix(prefilterShader, prefilterProjectionLoc, captureProjection);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-
-    for (unsigned int mip = 0; mip < MAX_MIPMAP_LEVELS; mip++)
-    {
-        // Resize framebuffer according to mip-level size.
-        unsigned int mipWidth  = prefilterSize*powf(0.5f, mip);
-        unsigned int mipHeight = prefilterSize*powf(0.5f, mip);
-        glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
-        glViewport(0, 0, mipWidth, mipHeight);
+    // Convert HDR equirectangular environment map to cubemap equivalent (with mipmaps as prefilter source levels)
+    glBeginQuery(GL_TIME_ELAPSED, queryId);
+    device.submit(lists[0]);
+    glEndQuery(GL_TIME_ELAPSED);
+    glGetQueryObjectui64v(queryId, GL_QUERY_RESULT, &elapsed);
+    env.cubemapTime = (float)elapsed/1000000.0f;
 
-        float roughness = (float)mip/(float)(MAX_MIPMAP_LEVELS - 1);
-        glUniform1f(prefilterRoughnessLoc, roughness);
+    // Solve diffuse integral by convolution and prefilter HDR into mipmap levels
+    glBeginQuery(GL_TIME_ELAPSED, queryId);
 
-        for (unsigned int i = 0; i < 6; ++i)
-        {
-            SetShaderValueMatrix(prefilterShader, prefilterViewLoc, captureViews[i]);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, env.prefilterId, mip);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            RenderCube();
-        }
+    if (bake.supported) BakeEnvironmentCompute(bake, env.cubemapId, cubemapSize, env.irradianceId, irradianceSize, env.prefilterId, prefilterSize);
+    else
+    {
+        for (int i = 1; i < (BAKE_PASSES - 1); i++) device.submit(lists[i]);
     }
 
-    // Unbind framebuffer and textures
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEndQuery(GL_TIME_ELAPSED);
+    glGetQueryObjectui64v(queryId, GL_QUERY_RESULT, &elapsed);
+    env.bakeTime = (float)elapsed/1000000.0f;
 
     // Generate BRDF convolution texture
-    glGenTextures(1, &env.brdfId);
-    glBindTexture(GL_TEXTURE_2D, env.brdfId);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, brdfSize, brdfSize, 0, GL_RG, GL_FLOAT, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    // Render BRDF LUT into a quad using default FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, brdfSize, brdfSize);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, env.brdfId, 0);
-
-    glViewport(0, 0, brdfSize, brdfSize);
-    glUseProgram(brdfShader.id);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    RenderQuad();
+    glBeginQuery(GL_TIME_ELAPSED, queryId);
+    device.submit(lists[BAKE_PASSES - 1]);
+    glEndQuery(GL_TIME_ELAPSED);
+    glGetQueryObjectui64v(queryId, GL_QUERY_RESULT, &elapsed);
+    env.brdfTime = (float)elapsed/1000000.0f;
+
+    TraceLog(LOG_INFO, "Environment baked (%s): cubemap %.2f ms, irradiance and prefilter %.2f ms, BRDF %.2f ms", (env.computeBake ? "compute" : "rasterized"), env.cubemapTime, env.bakeTime, env.brdfTime);
 
     // Unbind framebuffer and textures
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+    BindTextureGL(0, GL_TEXTURE_CUBE_MAP, 0);
+    UseProgramGL(0);
+
+    for (int i = 0; i < BAKE_PASSES; i++) UnloadCommandList(lists[i]);
+    device.unloadPass(passes.pass);
+    device.unloadBuffer(passes.cube);
+    device.unloadBuffer(passes.quad);
+    glDeleteQueries(1, &queryId);
+    UnloadBakeCompute(bake);
 
     // Then before rendering, configure the viewport to the actual screen dimensions
     Matrix defaultProjection = MatrixPerspective(60.0, (double)GetScreenWidth()/(double)GetScreenHeight(), 0.01, 1000.0);
     MatrixTranspose(&defaultProjection);
     SetShaderValueMatrix(cubeShader, cubeProjectionLoc, defaultProjection);
-    SetShaderValueMatrix(env.skyShader, skyProjectionLoc, defaultProjection);
     SetShaderValueMatrix(irradianceShader, irradianceProjectionLoc, defaultProjection);
     SetShaderValueMatrix(prefilterShader, prefilterProjectionLoc, defaultProjection);
-    env.pbrViewLoc = GetShaderLocation(env.pbrShader, "viewPos");
-    env.modelMatrixLoc = GetShaderLocation(env.pbrShader, "mMatrix");
 
     // Reset viewport dimensions to default
-    glViewport(0, 0, GetScreenWidth(), GetScreenHeight());
+    ViewportGL(0, 0, GetScreenWidth(), GetScreenHeight());
     
     UnloadShader(cubeShader);
     UnloadShader(irradianceShader);
     UnloadShader(prefilterShader);
     UnloadShader(brdfShader);
 
+    EndMemoryScope();
+
     return env;
 }
 
+// Load environment PBR and skybox shaders and set up their locations and rendering states
+// NOTE: shared by baked environments and cooked packages environments (pbrpackage.h), textures ids are not set
+void SetupEnvironmentShaders(Environment *env)
+{
+    env->pbrShader = LoadShader(PATH_PBR_VS, PATH_PBR_FS);
+    env->skyShader = LoadShader(PATH_SKYBOX_VS, PATH_SKYBOX_FS);
+
+    // Get skybox shader locations
+    int skyProjectionLoc = GetShaderLocation(env->skyShader, "projection");
+    env->skyViewLoc = GetShaderLocation(env->skyShader, "view");
+    env->skyResolutionLoc = GetShaderLocation(env->skyShader, "resolution");
+
+    // Set up environment shader texture units
+    SetShaderValuei(env->pbrShader, GetShaderLocation(env->pbrShader, "irradianceMap"), (int[1]){ 0 }, 1);
+    SetShaderValuei(env->pbrShader, GetShaderLocation(env->pbrShader, "prefilterMap"), (int[1]){ 1 }, 1);
+    SetShaderValuei(env->pbrShader, GetShaderLocation(env->pbrShader, "brdfLUT"), (int[1]){ 2 }, 1);
+    SetShaderValuei(env->pbrShader, GetShaderLocation(env->pbrShader, "halfIrradiance"), (int[1]){ 10 }, 1);
+    SetShaderValuei(env->pbrShader, GetShaderLocation(env->pbrShader, "halfSpecular"), (int[1]){ 11 }, 1);
+    SetShaderValuei(env->pbrShader, GetShaderLocation(env->pbrShader, "halfGeometry"), (int[1]){ 12 }, 1);
+    SetShaderValuei(env->pbrShader, GetShaderLocation(env->pbrShader, "ltcTable"), (int[1]){ 13 }, 1);
+    SetShaderValuei(env->pbrShader, GetShaderLocation(env->pbrShader, "exposureMap"), (int[1]){ 14 }, 1);
+    env->pbrLightingModeLoc = GetShaderLocation(env->pbrShader, "lightingMode");
+    env->pbrExposureLoc = GetShaderLocation(env->pbrShader, "autoExposure");
+    SetShaderValuei(env->pbrShader, GetShaderLocation(env->pbrShader, "ssaoMap"), (int[1]){ 15 }, 1);
+    env->pbrSSAOLoc = GetShaderLocation(env->pbrShader, "ssaoMode");
+    env->pbrViewLoc = GetShaderLocation(env->pbrShader, "viewPos");
+    env->modelMatrixLoc = GetShaderLocation(env->pbrShader, "mMatrix");
+
+    // Set up skybox shader constant values
+    SetShaderValuei(env->skyShader, GetShaderLocation(env->skyShader, "environmentMap"), (int[1]){ 0 }, 1);
+    SetShaderValuei(env->skyShader, GetShaderLocation(env->skyShader, "exposureMap"), (int[1]){ 14 }, 1);
+    env->skyExposureLoc = GetShaderLocation(env->skyShader, "autoExposure");
+
+    // Set up skybox default projection (viewer field of view and screen aspect ratio)
+    Matrix defaultProjection = MatrixPerspective(60.0, (double)GetScreenWidth()/(double)GetScreenHeight(), 0.01, 1000.0);
+    MatrixTranspose(&defaultProjection);
+    SetShaderValueMatrix(env->skyShader, skyProjectionLoc, defaultProjection);
+
+    // Set up depth face culling and cube map seamless
+    DepthFuncGL(GL_LEQUAL);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    glLineWidth(2);
+
+    // Load area lights fitted table (independent from environment map)
+    env->ltcId = LoadTableLTC(PATH_LTC_TABLE);
+}
+
+// Record an environment bake pass (cubemap, irradiance, prefilter level or BRDF)
+// NOTE: recording doesn't touch OpenGL, lists are submitted in index order
+static void RecordBakePass(CommandList *list, int index, const BakePasses *passes)
+{
+    if (index == 0)
+    {
+        // Render equirectangular map into each cubemap face and build its mipmaps
+        CmdBindPipeline(list, passes->cubePipeline);
+        CmdBindTexture(list, 0, passes->sky);
+        CmdSetMatrix(list, passes->projectionLocs[0], passes->projection);
+
+        for (int i = 0; i < 6; i++)
+        {
+            CmdBeginPass(list, passes->pass, passes->cubemap, i, 0);
+            CmdSetMatrix(list, passes->viewLocs[0], passes->views[i]);
+            CmdDraw(list, passes->cube);
+            CmdEndPass(list);
+        }
+
+        CmdBarrier(list, passes->cubemap, true);
+    }
+    else if (index == (BAKE_PASSES - 1))
+    {
+        // Render BRDF LUT into a quad
+        CmdBeginPass(list, passes->pass, passes->brdf, 0, 0);
+        CmdBindPipeline(list, passes->brdfPipeline);
+        CmdDraw(list, passes->quad);
+        CmdEndPass(list);
+        CmdBarrier(list, passes->brdf, false);
+    }
+    else
+    {
+        // Irradiance convolution or a prefilter mipmap level (roughness based on level)
+        bool irradiance = (index == 1);
+        int level = (irradiance ? 0 : (index - 2));
+        int shader = (irradiance ? 1 : 2);
+        DeviceTexture target = (irradiance ? passes->irradiance : passes->prefilter);
+
+        CmdBindPipeline(list, (irradiance ? passes->irradiancePipeline : passes->prefilterPipeline));
+        CmdBindTexture(list, 0, passes->cubemap);
+        CmdSetMatrix(list, passes->projectionLocs[shader], passes->projection);
+        if (!irradiance) CmdSetFloat(list, passes->roughnessLoc, (float)level/(float)(MAX_MIPMAP_LEVELS - 1));
+
+        for (int i = 0; i < 6; i++)
+        {
+            CmdBeginPass(list, passes->pass, target, i, level);
+            CmdSetMatrix(list, passes->viewLocs[shader], passes->views[i]);
+            CmdDraw(list, passes->cube);
+            CmdEndPass(list);
+        }
+
+        CmdBarrier(list, target, false);
+    }
+}
+
+// Load area lights linearly transformed cosines table into a texture array
+// NOTE: table file is written by ltcfit tool: "LTC1" header, size and 2 layers of size*size RGBA float texels
+unsigned int LoadTableLTC(const char *filename)
+{
+    unsigned int id = 0;
+    unsigned int length = 0;
+    unsigned char *file = LoadResourceData(filename, MEMORY_ENVIRONMENT, &length);
+
+    if (file == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] LTC table file could not be opened, area lights disabled", filename);
+        return id;
+    }
+
+    int size = 0;
+    if (length >= 8) memcpy(&size, file + 4, sizeof(int));
+
+    if ((length < 8) || (memcmp(file, "LTC1", 4) != 0) || (size <= 0) || (size > 1024))
+    {
+        TraceLog(LOG_WARNING, "[%s] LTC table file format not valid, area lights disabled", filename);
+        UnloadResourceData(file);
+        return id;
+    }
+
+    // Table floats start after 8 bytes header (resource data is allocated, so floats are aligned)
+    float *data = (float *)(file + 8);
+
+    if ((length - 8)/sizeof(float) >= (unsigned int)(2*size*size*4))
+    {
+        // Upload both layers with 32 bit floating point values (matrix elements need full precision at low roughness)
+        glGenTextures(1, &id);
+        BindTextureGL(0, GL_TEXTURE_2D_ARRAY, id);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA32F, size, size, 2, 0, GL_RGBA, GL_FLOAT, data);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        BindTextureGL(0, GL_TEXTURE_2D_ARRAY, 0);
+
+        TraceLog(LOG_INFO, "[TEX ID %i] LTC table loaded successfully (%ix%i)", id, size, size);
+    }
+    else TraceLog(LOG_WARNING, "[%s] LTC table file is incomplete, area lights disabled", filename);
+
+    UnloadResourceData(file);
+
+    return id;
+}
+
 // Get the current amount of created lights
 int GetLightsCount(void)
 {
@@ -633,23 +887,28 @@ int GetLightsCount(void)
 }
 
 // Send to environment PBR shader light values
+// NOTE: values are mirrored into shared program (tessellation) only when lights change, and sent on its next bind
 void UpdateLightValues(Environment env, Light light)
 {
     // Send to shader light enabled state and type
-    SetShaderValuei(env.pbrShader, light.enabledLoc, (int[1]){ light.enabled }, 1);
-    SetShaderValuei(env.pbrShader, light.typeLoc, (int[1]){ light.type }, 1);
+    SetShaderValueiPBR(env, light.enabledLoc, (int[1]){ light.enabled }, 1);
+    SetShaderValueiPBR(env, light.typeLoc, (int[1]){ light.type }, 1);
 
     // Send to shader light position values
     float position[3] = { light.position.x, light.position.y, light.position.z };
-    SetShaderValue(env.pbrShader, light.posLoc, position, 3);
+    SetShaderValuePBR(env, light.posLoc, position, 3);
 
     // Send to shader light target position values
     float target[3] = { light.target.x, light.target.y, light.target.z };
-    SetShaderValue(env.pbrShader, light.targetLoc, target, 3);
+    SetShaderValuePBR(env, light.targetLoc, target, 3);
 
     // Send to shader light color values
     float diff[4] = { (float)light.color.r/(float)255, (float)light.color.g/(float)255, (float)light.color.b/(float)255, (float)light.color.a/(float)255 };
-    SetShaderValue(env.pbrShader, light.colorLoc, diff, 4);
+    SetShaderValuePBR(env, light.colorLoc, diff, 4);
+
+    // Send to shader area light dimensions
+    float size[2] = { light.size.x, light.size.y };
+    SetShaderValuePBR(env, light.sizeLoc, size, 2);
 }
 
 // Send to environment PBR shader camera view and resolution values
@@ -657,168 +916,187 @@ void UpdateEnvironmentValues(Environment env, Camera camera, Vector2 res)
 {
     // Send to shader camera view position
     float cameraPos[3] = { camera.position.x, camera.position.y, camera.position.z };
-    SetShaderValue(env.pbrShader, env.pbrViewLoc, cameraPos, 3);
+    SetShaderValuePBR(env, env.pbrViewLoc, cameraPos, 3);
 
     // Send to shader screen resolution
     float resolution[2] = { res.x, res.y };
     SetShaderValue(env.skyShader, env.skyResolutionLoc, resolution, 2);
 }
 
-// Draw a model using physically based rendering
-void DrawModelPBR(Model model, MaterialPBR mat, Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale)
+// Set PBR shader float uniform value (mirrored into shared program)
+// NOTE: raylib shader values switch program, mirrored value is stored and sent when shared program is bound
+void SetShaderValuePBR(Environment env, int uniformLoc, const float *value, int size)
 {
-    // Switch to PBR shader
-    glUseProgram(mat.env.pbrShader.id);
+    SetShaderValue(env.pbrShader, uniformLoc, value, size);
+    ForgetProgramGL();
 
-    // Set up material uniforms and other constant values
-    float shaderAlbedo[3] = { (float)mat.albedo.color.r/(float)255, (float)mat.albedo.color.g/(float)255, (float)mat.albedo.color.b/(float)255 };
-    SetShaderValue(mat.env.pbrShader, mat.albedo.colorLoc, shaderAlbedo, 3);
-    float shaderNormals[3] = { (float)mat.normals.color.r/(float)255, (float)mat.normals.color.g/(float)255, (float)mat.normals.color.b/(float)255 };
-    SetShaderValue(mat.env.pbrShader, mat.normals.colorLoc, shaderNormals, 3);
-    float shaderMetalness[3] = { (float)mat.metalness.color.r/(float)255, (float)mat.metalness.color.g/(float)255, (float)mat.metalness.color.b/(float)255 };
-    SetShaderValue(mat.env.pbrShader, mat.metalness.colorLoc, shaderMetalness, 3);
-    float shaderRoughness[3] = { 1.0f - (float)mat.roughness.color.r/(float)255, 1.0f - (float)mat.roughness.color.g/(float)255, 1.0f - (float)mat.roughness.color.b/(float)255 };
-    SetShaderValue(mat.env.pbrShader, mat.roughness.colorLoc, shaderRoughness, 3);
-    float shaderAo[3] = { (float)mat.ao.color.r/(float)255, (float)mat.ao.color.g/(float)255, (float)mat.ao.color.b/(float)255 };
-    SetShaderValue(mat.env.pbrShader, mat.ao.colorLoc, shaderAo, 3);
-    float shaderEmission[3] = { (float)mat.emission.color.r/(float)255, (float)mat.emission.color.g/(float)255, (float)mat.emission.color.b/(float)255 };
-    SetShaderValue(mat.env.pbrShader, mat.emission.colorLoc, shaderEmission, 3);
-    float shaderHeight[3] = { (float)mat.height.color.r/(float)255, (float)mat.height.color.g/(float)255, (float)mat.height.color.b/(float)255 };
-    SetShaderValue(mat.env.pbrShader, mat.height.colorLoc, shaderHeight, 3);
-
-    // Send sampler use state to PBR shader
-    SetShaderValuei(mat.env.pbrShader, mat.albedo.useBitmapLoc, (int[1]){ mat.albedo.useBitmap }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.normals.useBitmapLoc, (int[1]){ mat.normals.useBitmap }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.metalness.useBitmapLoc, (int[1]){ mat.metalness.useBitmap }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.roughness.useBitmapLoc, (int[1]){ mat.roughness.useBitmap }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.ao.useBitmapLoc, (int[1]){ mat.ao.useBitmap }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.emission.useBitmapLoc, (int[1]){ mat.emission.useBitmap }, 1);
-    SetShaderValuei(mat.env.pbrShader, mat.height.useBitmapLoc, (int[1]){ mat.height.useBitmap }, 1);
-
-    // Calculate and send to shader model matrix
-    Matrix matScale = MatrixScale(scale.x, scale.y, scale.z);
-    Matrix matRotation = MatrixRotate(rotationAxis, rotationAngle*DEG2RAD);
-    Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
-    Matrix transform = MatrixMultiply(MatrixMultiply(matScale, matRotation), matTranslation);
-    SetShaderValueMatrix(mat.env.pbrShader, mat.env.modelMatrixLoc, transform);
+    if ((sharedProgramId == 0) || (env.pbrShader.id != sharedSourceId)) return;
+    if ((size < 1) || (size > 4) || (GetSharedLocationPBR(uniformLoc, true) == -1)) return;
 
-    // Enable and bind irradiance map
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, mat.env.irradianceId);
+    SharedValue *shared = &sharedValues[uniformLoc];
+    shared->size = size;
+    shared->integer = false;
+    for (int i = 0; i < size; i++) shared->values[i] = value[i];
 
-    // Enable and bind prefiltered reflection map
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, mat.env.prefilterId);
+    sharedPending = true;
+}
 
-    // Enable and bind BRDF LUT map
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, mat.env.brdfId);
+// Set PBR shader integer uniform value (mirrored into shared program)
+// NOTE: raylib shader values switch program, mirrored value is stored and sent when shared program is bound
+void SetShaderValueiPBR(Environment env, int uniformLoc, const int *value, int size)
+{
+    SetShaderValuei(env.pbrShader, uniformLoc, value, size);
+    ForgetProgramGL();
 
-    if (mat.albedo.useBitmap)
-    {
-        // Enable and bind albedo map
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, mat.albedo.bitmap.id);
-    }
+    if ((sharedProgramId == 0) || (env.pbrShader.id != sharedSourceId)) return;
+    if ((size < 1) || (size > 4) || (GetSharedLocationPBR(uniformLoc, true) == -1)) return;
 
-    if (mat.normals.useBitmap)
-    {
-        // Enable and bind normals map
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, mat.normals.bitmap.id);
-    }
+    SharedValue *shared = &sharedValues[uniformLoc];
+    shared->size = size;
+    shared->integer = true;
+    for (int i = 0; i < size; i++) shared->ivalues[i] = value[i];
 
-    if (mat.metalness.useBitmap)
-    {
-        // Enable and bind metalness map
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, mat.metalness.bitmap.id);
-    }
+    sharedPending = true;
+}
 
-    if (mat.roughness.useBitmap)
-    {
-        // Enable and bind roughness map
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, mat.roughness.bitmap.id);
-    }
+// Mirror PBR shader values into a program linked with PBR fragment shader
+// NOTE: uniforms are matched by name (every array element), current values are copied once and later ones are sent by PBR setters
+void SetSharedProgramPBR(Environment env, unsigned int programId)
+{
+    int count = 0;
+    glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &count);
 
-    if (mat.ao.useBitmap)
-    {
-        // Enable and bind ambient occlusion map
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, mat.ao.bitmap.id);
-    }
+    sharedSourceId = env.pbrShader.id;
+    sharedProgramId = programId;
+    for (int i = 0; i < MAX_SHARED_LOCATIONS; i++) sharedLocs[i] = -1;
+    for (int i = 0; i < MAX_SHARED_LOCATIONS; i++) sharedValues[i].size = 0;
+    sharedPending = false;
 
-    if (mat.emission.useBitmap)
-    {
-        // Enable and bind emission map
-        glActiveTexture(GL_TEXTURE8);
-        glBindTexture(GL_TEXTURE_2D, mat.emission.bitmap.id);
-    }
+    InvalidateStateGL();
+    UseProgramGL(programId);
 
-    if (mat.height.useBitmap)
+    for (int i = 0; i < count; i++)
     {
-        // Enable and bind parallax height map
-        glActiveTexture(GL_TEXTURE9);
-        glBindTexture(GL_TEXTURE_2D, mat.height.bitmap.id);
-    }
+        char name[256] = { 0 };
+        int size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(programId, i, sizeof(name), NULL, &size, &type, name);
 
-    // Draw model using PBR shader and textures maps
-    DrawModelEx(model, position, rotationAxis, rotationAngle, scale, WHITE);
+        // Arrays are reported by their first element name, every element has its own location
+        int length = strlen(name);
+        if ((size > 1) && (length > 3) && (strcmp(name + length - 3, "[0]") == 0)) name[length - 3] = '\0';
 
-    // Disable and unbind irradiance map
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+        for (int k = 0; k < size; k++)
+        {
+            char element[272] = { 0 };
+            if (size > 1) snprintf(element, sizeof(element), "%s[%i]", name, k);
+            else snprintf(element, sizeof(element), "%s", name);
 
-    // Disable and unbind prefiltered reflection map
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+            int srcLoc = glGetUniformLocation(env.pbrShader.id, element);
+            int dstLoc = glGetUniformLocation(programId, element);
+            if ((srcLoc == -1) || (dstLoc == -1)) continue;
 
-    // Disable and unbind BRDF LUT map
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, 0);
+            if (srcLoc >= MAX_SHARED_LOCATIONS)
+            {
+                TraceLog(LOG_WARNING, "[SHDR ID %i] Uniform %s location out of shared locations range", programId, element);
+                continue;
+            }
 
-    if (mat.albedo.useBitmap)
-    {
-        // Disable and bind albedo map
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+            sharedLocs[srcLoc] = dstLoc;
 
-    if (mat.normals.useBitmap)
-    {
-        // Disable and bind normals map
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+            float values[16] = { 0 };
+            int ivalues[4] = { 0 };
 
-    if (mat.metalness.useBitmap)
-    {
-        // Disable and bind metalness map
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, 0);
+            switch (type)
+            {
+                case GL_FLOAT: glGetUniformfv(env.pbrShader.id, srcLoc, values); glUniform1fv(dstLoc, 1, values); break;
+                case GL_FLOAT_VEC2: glGetUniformfv(env.pbrShader.id, srcLoc, values); glUniform2fv(dstLoc, 1, values); break;
+                case GL_FLOAT_VEC3: glGetUniformfv(env.pbrShader.id, srcLoc, values); glUniform3fv(dstLoc, 1, values); break;
+                case GL_FLOAT_VEC4: glGetUniformfv(env.pbrShader.id, srcLoc, values); glUniform4fv(dstLoc, 1, values); break;
+                case GL_FLOAT_MAT4: glGetUniformfv(env.pbrShader.id, srcLoc, values); glUniformMatrix4fv(dstLoc, 1, false, values); break;
+                case GL_INT:
+                case GL_BOOL:
+                case GL_SAMPLER_2D:
+                case GL_SAMPLER_2D_ARRAY:
+                case GL_SAMPLER_CUBE: glGetUniformiv(env.pbrShader.id, srcLoc, ivalues); glUniform1iv(dstLoc, 1, ivalues); break;
+                default: break;
+            }
+        }
     }
+}
 
-    if (mat.roughness.useBitmap)
-    {
-        // Disable and bind roughness map
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+// Stop mirroring PBR shader values into a program (call before unloading it)
+void UnsetSharedProgramPBR(unsigned int programId)
+{
+    if ((programId == 0) || (programId != sharedProgramId)) return;
 
-    if (mat.ao.useBitmap)
-    {
-        // Disable and bind ambient occlusion map
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+    sharedSourceId = 0;
+    sharedProgramId = 0;
+}
 
-    if (mat.height.useBitmap)
-    {
-        // Disable and bind parallax height map
-        glActiveTexture(GL_TEXTURE8);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+// Check if a program receives environment PBR shader values
+bool IsSharedProgramPBR(Environment env, unsigned int programId)
+{
+    return ((programId != 0) && (programId == sharedProgramId) && (env.pbrShader.id == sharedSourceId));
+}
+
+// Get camera view-projection matrix (same conventions as 3D mode)
+// NOTE: result is ready to be sent to shaders as mvpMatrix when model matrix is identity
+Matrix GetCameraMatrixPBR(Camera camera, float aspect)
+{
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection = MatrixPerspective(camera.fovy, aspect, 0.01, 1000.0);
+    MatrixTranspose(&projection);
+
+    return MatrixMultiply(view, projection);
+}
+
+// Draw a model using physically based rendering
+void DrawModelPBR(Model model, MaterialPBR mat, Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale)
+{
+    // Calculate model matrix
+    Matrix matScale = MatrixScale(scale.x, scale.y, scale.z);
+    Matrix matRotation = MatrixRotate(rotationAxis, rotationAngle*DEG2RAD);
+    Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
+    Matrix transform = MatrixMultiply(MatrixMultiply(matScale, matRotation), matTranslation);
+
+    BindMaterialPBR(mat, transform);
+
+    // Draw model using PBR shader and textures maps
+    // NOTE: raylib switches program and unbinds every material map unit after drawing
+    DrawModelEx(model, position, rotationAxis, rotationAngle, scale, WHITE);
+    InvalidateMeshStateGL();
+
+    UnbindMaterialPBR();
+}
+
+// Send material values and model matrix to PBR shader and bind its textures
+// NOTE: uniforms are set directly once program is bound (raylib shader values switch program on each call)
+void BindMaterialPBR(MaterialPBR mat, Matrix transform)
+{
+    // Switch to PBR shader (state changed by raylib since last bind is forgotten)
+    InvalidateStateGL();
+    UseProgramGL(mat.env.pbrShader.id);
+
+    SetMaterialValuesPBR(mat, transform, false);
+}
+
+// Send material values and model matrix to shared program and bind its textures
+// NOTE: material environment must be mirrored into program by SetSharedProgramPBR()
+void BindSharedMaterialPBR(MaterialPBR mat, Matrix transform)
+{
+    InvalidateStateGL();
+    UseProgramGL(sharedProgramId);
+
+    SendSharedValuesPBR();
+    SetMaterialValuesPBR(mat, transform, true);
+}
+
+// Release material after drawing
+// NOTE: textures are kept bound, next material only binds units with different textures
+void UnbindMaterialPBR(void)
+{
+    ActiveTextureGL(0);
 }
 
 // Draw a cube skybox using environment cube map
@@ -829,13 +1107,12 @@ void DrawSkybox(Environment env, Camera camera)
     Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
 
     // Send to shader view matrix and bind cubemap texture
-    // NOTE: Setting shader value also activates shader program but
-    // that activation could change in a future... active shader manually!
-    SetShaderValueMatrix(env.skyShader, env.skyViewLoc, view);
+    InvalidateStateGL();
+    UseProgramGL(env.skyShader.id);
+    glUniformMatrix4fv(env.skyViewLoc, 1, false, MatrixToFloat(view));
     
     // Skybox shader diffuse texture: cubemapId
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, env.cubemapId);
+    BindTextureGL(0, GL_TEXTURE_CUBE_MAP, env.cubemapId);
 
     // Render cube using skybox shader
     RenderCube();
@@ -849,52 +1126,13 @@ void RenderCube(void)
     // Initialize if it is not yet
     if (cubeVAO == 0)
     {
-        GLfloat vertices[] = {
-            -1.0f, -1.0f, -1.0f,  0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
-            1.0f, 1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f,
-            1.0f, -1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f,
-            1.0f, 1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f,
-            -1.0f, -1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
-            -1.0f, 1.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f,
-            -1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-            1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,
-            1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-            1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-            -1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-            -1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-            -1.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-            -1.0f, 1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
-            -1.0f, -1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
-            -1.0f, -1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
-            -1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-            -1.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-            1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-            1.0f, -1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
-            1.0f, 1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
-            1.0f, -1.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
-            1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-            1.0f, -1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-            -1.0f, -1.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f,
-            1.0f, -1.0f, -1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f,
-            1.0f, -1.0f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f,
-            1.0f, -1.0f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f,
-            -1.0f, -1.0f, 1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f,
-            -1.0f, -1.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f,
-            -1.0f, 1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-            1.0f, 1.0f , 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-            1.0f, 1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f,
-            1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-            -1.0f, 1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-            -1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f
-        };
-
         // Set up cube VAO
         glGenVertexArrays(1, &cubeVAO);
         glGenBuffers(1, &cubeVBO);
 
         // Fill buffer
         glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
 
         // Link vertex attributes
         glBindVertexArray(cubeVAO);
@@ -922,14 +1160,6 @@ void RenderQuad(void)
     // Initialize if it is not yet
     if (quadVAO == 0)
     {
-        GLfloat quadVertices[] = {
-            // Positions        // Texture Coords
-            -1.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-            -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
-            1.0f, 1.0f, 0.0f, 1.0f, 1.0f,
-            1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
-        };
-
         // Set up plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
@@ -937,7 +1167,7 @@ void RenderQuad(void)
 
         // Fill buffer
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
 
         // Link vertex attributes
         glEnableVertexAttribArray(0);
@@ -952,28 +1182,286 @@ void RenderQuad(void)
     glBindVertexArray(0);
 }
 
+// Load a multisampled render target (color and depth renderbuffers)
+// NOTE: samples are clamped to the max supported by the GPU
+RenderTextureMSAA LoadRenderTextureMSAA(int width, int height, int samples)
+{
+    RenderTextureMSAA target = { 0 };
+    int maxSamples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+
+    target.width = width;
+    target.height = height;
+    target.samples = (samples > maxSamples) ? maxSamples : samples;
+
+    // Create multisampled color and depth renderbuffers
+    glGenRenderbuffers(1, &target.colorId);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.colorId);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, target.samples, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &target.depthId);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depthId);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, target.samples, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    // Attach renderbuffers to a new framebuffer
+    glGenFramebuffers(1, &target.id);
+    BindFramebufferGL(GL_FRAMEBUFFER, target.id);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.colorId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depthId);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) TraceLog(LOG_WARNING, "[FBO ID %i] Multisampled framebuffer object could not be created", target.id);
+    else TraceLog(LOG_INFO, "[FBO ID %i] Multisampled framebuffer object created successfully (%ix)", target.id, target.samples);
+
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+
+    return target;
+}
+
+// Resolve multisampled render target color into a render texture
+// NOTE: shaders output tonemapped colors, so samples are averaged after tonemapping
+void ResolveRenderTextureMSAA(RenderTextureMSAA source, RenderTexture2D target)
+{
+    InvalidateStateGL();
+    BindFramebufferGL(GL_READ_FRAMEBUFFER, source.id);
+    BindFramebufferGL(GL_DRAW_FRAMEBUFFER, target.id);
+    glBlitFramebuffer(0, 0, source.width, source.height, 0, 0, target.texture.width, target.texture.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+}
+
+// Unload multisampled render target from GPU
+void UnloadRenderTextureMSAA(RenderTextureMSAA target)
+{
+    ForgetFramebufferGL(target.id);
+    glDeleteFramebuffers(1, &target.id);
+    glDeleteRenderbuffers(1, &target.colorId);
+    glDeleteRenderbuffers(1, &target.depthId);
+}
+
+// Load a half resolution image based lighting render target
+// NOTE: width and height must be half of the full resolution target rounded up
+LightingTarget LoadLightingTarget(int width, int height)
+{
+    LightingTarget target = { 0 };
+    target.width = width;
+    target.height = height;
+
+    // Create floating point textures to store HDR lighting and geometry values
+    unsigned int *textures[3] = { &target.irradianceId, &target.specularId, &target.geometryId };
+
+    for (int i = 0; i < 3; i++)
+    {
+        glGenTextures(1, textures[i]);
+        BindTextureGL(0, GL_TEXTURE_2D, *textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &target.depthId);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depthId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    // Attach textures as PBR shader outputs and depth renderbuffer to a new framebuffer
+    glGenFramebuffers(1, &target.id);
+    BindFramebufferGL(GL_FRAMEBUFFER, target.id);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.irradianceId, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, target.specularId, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, target.geometryId, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depthId);
+
+    unsigned int buffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, buffers);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) TraceLog(LOG_WARNING, "[FBO ID %i] Half resolution lighting framebuffer object could not be created", target.id);
+    else TraceLog(LOG_INFO, "[FBO ID %i] Half resolution lighting framebuffer object created successfully", target.id);
+
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+
+    return target;
+}
+
+// Begin drawing image based lighting to half resolution target
+void BeginLightingMode(Environment env, LightingTarget target)
+{
+    float clearColor[4] = { 0 };
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+    InvalidateStateGL();
+    BindFramebufferGL(GL_FRAMEBUFFER, target.id);
+    ViewportGL(0, 0, target.width, target.height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+    SetShaderValueiPBR(env, env.pbrLightingModeLoc, (int[1]){ 1 }, 1);
+}
+
+// End half resolution lighting drawing and bind it to be upsampled by PBR shader
+void EndLightingMode(Environment env, LightingTarget target)
+{
+    InvalidateStateGL();
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+    ViewportGL(0, 0, GetScreenWidth(), GetScreenHeight());
+
+    SetShaderValueiPBR(env, env.pbrLightingModeLoc, (int[1]){ 2 }, 1);
+
+    // Enable and bind half resolution lighting textures
+    BindTextureGL(10, GL_TEXTURE_2D, target.irradianceId);
+    BindTextureGL(11, GL_TEXTURE_2D, target.specularId);
+    BindTextureGL(12, GL_TEXTURE_2D, target.geometryId);
+    ActiveTextureGL(0);
+}
+
+// Unbind half resolution lighting and return to full rate lighting
+void DisableLightingTarget(Environment env)
+{
+    SetShaderValueiPBR(env, env.pbrLightingModeLoc, (int[1]){ 0 }, 1);
+
+    // Disable and unbind half resolution lighting textures
+    InvalidateStateGL();
+    BindTextureGL(10, GL_TEXTURE_2D, 0);
+    BindTextureGL(11, GL_TEXTURE_2D, 0);
+    BindTextureGL(12, GL_TEXTURE_2D, 0);
+    ActiveTextureGL(0);
+}
+
+// Unload half resolution lighting render target from GPU
+void UnloadLightingTarget(LightingTarget target)
+{
+    ForgetFramebufferGL(target.id);
+    ForgetTextureGL(target.irradianceId);
+    ForgetTextureGL(target.specularId);
+    ForgetTextureGL(target.geometryId);
+
+    glDeleteFramebuffers(1, &target.id);
+    glDeleteTextures(1, &target.irradianceId);
+    glDeleteTextures(1, &target.specularId);
+    glDeleteTextures(1, &target.geometryId);
+    glDeleteRenderbuffers(1, &target.depthId);
+}
+
 // Unload material PBR textures
 void UnloadMaterialPBR(MaterialPBR mat)
 {
-    if (mat.albedo.useBitmap) UnloadTexture(mat.albedo.bitmap);
-    if (mat.normals.useBitmap) UnloadTexture(mat.normals.bitmap);
-    if (mat.metalness.useBitmap) UnloadTexture(mat.metalness.bitmap);
-    if (mat.roughness.useBitmap) UnloadTexture(mat.roughness.bitmap);
-    if (mat.ao.useBitmap) UnloadTexture(mat.ao.bitmap);
-    if (mat.emission.useBitmap) UnloadTexture(mat.emission.bitmap);
-    if (mat.height.useBitmap) UnloadTexture(mat.height.bitmap);
+    PropertyPBR *maps[7] = { &mat.albedo, &mat.normals, &mat.metalness, &mat.roughness, &mat.ao, &mat.emission, &mat.height };
+
+    for (int i = 0; i < 7; i++)
+    {
+        if (maps[i]->useBitmap)
+        {
+            ForgetTextureGL(maps[i]->bitmap.id);
+            UnloadTexture(maps[i]->bitmap);
+        }
+    }
 }
 
 // Unload environment loaded shaders and dynamic textures
 void UnloadEnvironment(Environment env)
 {
+    // Stop mirroring values of unloaded PBR shader
+    if (env.pbrShader.id == sharedSourceId) UnsetSharedProgramPBR(sharedProgramId);
+
     // Unload used environment shaders
     UnloadShader(env.pbrShader);
     UnloadShader(env.skyShader);
 
     // Unload dynamic textures created in environment initialization
+    ForgetTextureGL(env.cubemapId);
+    ForgetTextureGL(env.irradianceId);
+    ForgetTextureGL(env.prefilterId);
+    ForgetTextureGL(env.brdfId);
+    ForgetTextureGL(env.ltcId);
+
     glDeleteTextures(1, &env.cubemapId);
     glDeleteTextures(1, &env.irradianceId);
     glDeleteTextures(1, &env.prefilterId);
     glDeleteTextures(1, &env.brdfId);
+    if (env.ltcId != 0) glDeleteTextures(1, &env.ltcId);
+}
+
+// Send material values and model matrix to bound program and bind material textures
+// NOTE: material locations are PBR shader ones, mapped to shared program locations if required
+static void SetMaterialValuesPBR(MaterialPBR mat, Matrix transform, bool shared)
+{
+    // Set up material uniforms and other constant values
+    glUniform3f(GetSharedLocationPBR(mat.albedo.colorLoc, shared), (float)mat.albedo.color.r/(float)255, (float)mat.albedo.color.g/(float)255, (float)mat.albedo.color.b/(float)255);
+    glUniform3f(GetSharedLocationPBR(mat.normals.colorLoc, shared), (float)mat.normals.color.r/(float)255, (float)mat.normals.color.g/(float)255, (float)mat.normals.color.b/(float)255);
+    glUniform3f(GetSharedLocationPBR(mat.metalness.colorLoc, shared), (float)mat.metalness.color.r/(float)255, (float)mat.metalness.color.g/(float)255, (float)mat.metalness.color.b/(float)255);
+    glUniform3f(GetSharedLocationPBR(mat.roughness.colorLoc, shared), 1.0f - (float)mat.roughness.color.r/(float)255, 1.0f - (float)mat.roughness.color.g/(float)255, 1.0f - (float)mat.roughness.color.b/(float)255);
+    glUniform3f(GetSharedLocationPBR(mat.ao.colorLoc, shared), (float)mat.ao.color.r/(float)255, (float)mat.ao.color.g/(float)255, (float)mat.ao.color.b/(float)255);
+    glUniform3f(GetSharedLocationPBR(mat.emission.colorLoc, shared), (float)mat.emission.color.r/(float)255, (float)mat.emission.color.g/(float)255, (float)mat.emission.color.b/(float)255);
+    glUniform3f(GetSharedLocationPBR(mat.height.colorLoc, shared), (float)mat.height.color.r/(float)255, (float)mat.height.color.g/(float)255, (float)mat.height.color.b/(float)255);
+
+    // Send sampler use state to shader
+    glUniform1i(GetSharedLocationPBR(mat.albedo.useBitmapLoc, shared), mat.albedo.useBitmap);
+    glUniform1i(GetSharedLocationPBR(mat.normals.useBitmapLoc, shared), mat.normals.useBitmap);
+    glUniform1i(GetSharedLocationPBR(mat.metalness.useBitmapLoc, shared), mat.metalness.useBitmap);
+    glUniform1i(GetSharedLocationPBR(mat.roughness.useBitmapLoc, shared), mat.roughness.useBitmap);
+    glUniform1i(GetSharedLocationPBR(mat.ao.useBitmapLoc, shared), mat.ao.useBitmap);
+    glUniform1i(GetSharedLocationPBR(mat.emission.useBitmapLoc, shared), mat.emission.useBitmap);
+    glUniform1i(GetSharedLocationPBR(mat.height.useBitmapLoc, shared), mat.height.useBitmap);
+
+    // Send to shader model matrix
+    glUniformMatrix4fv(GetSharedLocationPBR(mat.env.modelMatrixLoc, shared), 1, false, MatrixToFloat(transform));
+
+    // Bind material maps (units without sampler in use keep previous texture, shader does not read them)
+    if (mat.albedo.useBitmap) BindTextureGL(3, GL_TEXTURE_2D, mat.albedo.bitmap.id);
+    if (mat.normals.useBitmap) BindTextureGL(4, GL_TEXTURE_2D, mat.normals.bitmap.id);
+    if (mat.metalness.useBitmap) BindTextureGL(5, GL_TEXTURE_2D, mat.metalness.bitmap.id);
+    if (mat.roughness.useBitmap) BindTextureGL(6, GL_TEXTURE_2D, mat.roughness.bitmap.id);
+    if (mat.ao.useBitmap) BindTextureGL(7, GL_TEXTURE_2D, mat.ao.bitmap.id);
+    if (mat.emission.useBitmap) BindTextureGL(8, GL_TEXTURE_2D, mat.emission.bitmap.id);
+    if (mat.height.useBitmap) BindTextureGL(9, GL_TEXTURE_2D, mat.height.bitmap.id);
+
+    // Bind area lights LTC table, BRDF LUT, prefiltered reflection and irradiance maps
+    // NOTE: unit 0 is bound last so raylib finds it active
+    BindTextureGL(13, GL_TEXTURE_2D_ARRAY, mat.env.ltcId);
+    BindTextureGL(2, GL_TEXTURE_2D, mat.env.brdfId);
+    BindTextureGL(1, GL_TEXTURE_CUBE_MAP, mat.env.prefilterId);
+    BindTextureGL(0, GL_TEXTURE_CUBE_MAP, mat.env.irradianceId);
+    ActiveTextureGL(0);
+}
+
+// Get shared program location of a PBR shader location (same location if not shared)
+static int GetSharedLocationPBR(int uniformLoc, bool shared)
+{
+    if (!shared) return uniformLoc;
+
+    return ((uniformLoc >= 0) && (uniformLoc < MAX_SHARED_LOCATIONS)) ? sharedLocs[uniformLoc] : -1;
+}
+
+// Send pending mirrored values to shared program (must be bound)
+static void SendSharedValuesPBR(void)
+{
+    if (!sharedPending) return;
+
+    for (int i = 0; i < MAX_SHARED_LOCATIONS; i++)
+    {
+        SharedValue *shared = &sharedValues[i];
+        if (shared->size == 0) continue;
+
+        if (shared->integer)
+        {
+            if (shared->size == 1) glUniform1iv(sharedLocs[i], 1, shared->ivalues);
+            else if (shared->size == 2) glUniform2iv(sharedLocs[i], 1, shared->ivalues);
+            else if (shared->size == 3) glUniform3iv(sharedLocs[i], 1, shared->ivalues);
+            else glUniform4iv(sharedLocs[i], 1, shared->ivalues);
+        }
+        else
+        {
+            if (shared->size == 1) glUniform1fv(sharedLocs[i], 1, shared->values);
+            else if (shared->size == 2) glUniform2fv(sharedLocs[i], 1, shared->values);
+            else if (shared->size == 3) glUniform3fv(sharedLocs[i], 1, shared->values);
+            else glUniform4fv(sharedLocs[i], 1, shared->values);
+        }
+
+        shared->size = 0;
+    }
+
+    sharedPending = false;
 }
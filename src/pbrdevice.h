@@ -0,0 +1,491 @@
+/***********************************************************************************
+*
+*   rPBR [device] - Render device abstraction for raylib
+*
+*   FEATURES:
+*       - Backend independent buffers, textures, pipelines and render passes created through a device.
+*       - Commands (passes, pipeline and texture bindings, uniforms, draws and barriers) recorded
+*         into command lists without touching the graphics API, then submitted in order.
+*       - OpenGL 3.3 backend (commands replayed through the state tracker).
+*
+*   NOTES:
+*       Recording doesn't need a graphics context, only submission and resources creation must happen
+*       in the thread that owns the context. Lists are recorded by the caller thread.
+*       Pipelines don't own their shader, shaders are still loaded and unloaded with raylib.
+*       Backends fill RenderDevice functions table, new backends only need to implement it.
+*       Only the OpenGL backend is implemented (raylib creates a GL context), there is no Vulkan backend.
+*
+*   DEPENDENCIES:
+*       GLAD for OpenGL API (must be included before this file)
+*       pbrstate.h for OpenGL state tracking (must be included before this file)
+*       pbrmemory.h for tracked allocations (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         DEVICE_MAX_ATTRIBUTES       4                                       // Vertex attributes per buffer
+#define         DEVICE_COMMANDS_CAPACITY    64                                      // Command list initial capacity (doubled when full)
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef enum {
+    DEVICE_BACKEND_GL = 0
+} DeviceBackend;
+
+typedef enum {
+    DEVICE_TEXTURE_2D = 0,
+    DEVICE_TEXTURE_CUBE
+} DeviceTextureType;
+
+typedef enum {
+    DEVICE_FORMAT_RG16F = 0,
+    DEVICE_FORMAT_RGB16F,
+    DEVICE_FORMAT_RGBA16F
+} DeviceFormat;
+
+typedef enum {
+    DEVICE_PRIMITIVE_TRIANGLES = 0,
+    DEVICE_PRIMITIVE_TRIANGLE_STRIP
+} DevicePrimitive;
+
+typedef enum {
+    DEVICE_CMD_BEGIN_PASS = 0,
+    DEVICE_CMD_END_PASS,
+    DEVICE_CMD_BIND_PIPELINE,
+    DEVICE_CMD_BIND_TEXTURE,
+    DEVICE_CMD_SET_MATRIX,
+    DEVICE_CMD_SET_FLOAT,
+    DEVICE_CMD_DRAW,
+    DEVICE_CMD_BARRIER
+} DeviceCommandType;
+
+typedef struct DeviceBuffer {
+    unsigned int id;                        // Vertex buffer id
+    unsigned int layoutId;                  // Vertex layout id (vertex array object)
+    int vertexCount;                        // Vertices to draw
+    DevicePrimitive primitive;              // Vertices primitive topology
+} DeviceBuffer;
+
+typedef struct DeviceTexture {
+    unsigned int id;                        // Texture id
+    DeviceTextureType type;                 // Texture type (2D or cube)
+    DeviceFormat format;                    // Texels format
+    int size;                               // Texture width and height (faces are square)
+    int levels;                             // Mipmap levels allocated
+} DeviceTexture;
+
+typedef struct DevicePipeline {
+    unsigned int shaderId;                  // Linked shader program id
+    bool depthTest;                         // Depth test enabled (less or equal comparison)
+} DevicePipeline;
+
+typedef struct DevicePass {
+    unsigned int id;                        // Framebuffer id
+    unsigned int depthId;                   // Depth attachment id
+    int size;                               // Max target dimensions
+} DevicePass;
+
+typedef struct DeviceCommand {
+    DeviceCommandType type;
+    union {
+        struct { DevicePass pass; DeviceTexture target; int face; int level; } begin;   // Face is ignored by 2D targets
+        struct { DevicePipeline pipeline; } pipeline;
+        struct { int unit; DeviceTexture texture; } texture;
+        struct { int location; float value[16]; } matrix;
+        struct { int location; float value; } value;
+        struct { DeviceBuffer buffer; } draw;
+        struct { DeviceTexture texture; bool updateMipmaps; } barrier;                  // Written texture is going to be sampled
+    };
+} DeviceCommand;
+
+typedef struct CommandList {
+    DeviceCommand *commands;                // Recorded commands
+    int count;                              // Recorded commands count
+    int capacity;                           // Allocated commands
+} CommandList;
+
+typedef struct RenderDevice {
+    DeviceBackend backend;                  // Device backend type
+    const char *name;                       // Device backend name
+
+    DeviceBuffer (*loadBuffer)(const float *vertices, int vertexCount, const int *attributes, int attributesCount, DevicePrimitive primitive);
+    DeviceTexture (*loadTexture)(DeviceTextureType type, DeviceFormat format, int size, int levels);
+    DevicePipeline (*loadPipeline)(unsigned int shaderId, bool depthTest);
+    DevicePass (*loadPass)(int size);
+    void (*submit)(CommandList list);
+    void (*unloadBuffer)(DeviceBuffer buffer);
+    void (*unloadTexture)(DeviceTexture texture);
+    void (*unloadPass)(DevicePass pass);
+} RenderDevice;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+RenderDevice LoadRenderDevice(DeviceBackend backend);                                           // Load a render device functions table for a backend
+
+CommandList LoadCommandList(void);                                                              // Load an empty command list
+void ResetCommandList(CommandList *list);                                                       // Clear recorded commands (keeps allocated memory)
+void UnloadCommandList(CommandList list);                                                       // Unload command list memory
+
+void CmdBeginPass(CommandList *list, DevicePass pass, DeviceTexture target, int face, int level);   // Record a pass to a texture face and level (cleared)
+void CmdEndPass(CommandList *list);                                                             // Record end of current pass
+void CmdBindPipeline(CommandList *list, DevicePipeline pipeline);                               // Record a pipeline binding
+void CmdBindTexture(CommandList *list, int unit, DeviceTexture texture);                        // Record a texture binding to a sampler unit
+void CmdSetMatrix(CommandList *list, int location, Matrix mat);                                 // Record a matrix uniform value (must be transposed like shader values)
+void CmdSetFloat(CommandList *list, int location, float value);                                 // Record a float uniform value
+void CmdDraw(CommandList *list, DeviceBuffer buffer);                                           // Record a draw of all buffer vertices
+void CmdBarrier(CommandList *list, DeviceTexture texture, bool updateMipmaps);                  // Record a barrier to sample a written texture (mipmaps rebuilt from first level)
+
+static DeviceCommand *PushCommand(CommandList *list, DeviceCommandType type);                   // Append a command to a command list
+
+static DeviceBuffer LoadBufferGL(const float *vertices, int vertexCount, const int *attributes, int attributesCount, DevicePrimitive primitive);  // Load a vertex buffer and its layout
+static DeviceTexture LoadTextureGL(DeviceTextureType type, DeviceFormat format, int size, int levels);  // Load a 2D or cube texture with empty levels
+static DevicePipeline LoadPipelineGL(unsigned int shaderId, bool depthTest);                    // Load a pipeline from a linked shader program
+static DevicePass LoadPassGL(int size);                                                         // Load a render pass framebuffer with depth attachment
+static void SubmitGL(CommandList list);                                                         // Replay recorded commands
+static void UnloadBufferGL(DeviceBuffer buffer);                                                // Unload vertex buffer and its layout
+static void UnloadTextureGL(DeviceTexture texture);                                             // Unload texture
+static void UnloadPassGL(DevicePass pass);                                                      // Unload render pass framebuffer and depth attachment
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Load a render device functions table for a backend
+RenderDevice LoadRenderDevice(DeviceBackend backend)
+{
+    RenderDevice device = { 0 };
+
+    switch (backend)
+    {
+        case DEVICE_BACKEND_GL:
+        default:
+        {
+            device.backend = DEVICE_BACKEND_GL;
+            device.name = "OpenGL 3.3";
+            device.loadBuffer = LoadBufferGL;
+            device.loadTexture = LoadTextureGL;
+            device.loadPipeline = LoadPipelineGL;
+            device.loadPass = LoadPassGL;
+            device.submit = SubmitGL;
+            device.unloadBuffer = UnloadBufferGL;
+            device.unloadTexture = UnloadTextureGL;
+            device.unloadPass = UnloadPassGL;
+        } break;
+    }
+
+    TraceLog(LOG_INFO, "Render device loaded: %s", device.name);
+
+    return device;
+}
+
+// Load an empty command list
+CommandList LoadCommandList(void)
+{
+    CommandList list = { 0 };
+
+    list.capacity = DEVICE_COMMANDS_CAPACITY;
+    list.commands = (DeviceCommand *)PBR_MALLOC(MEMORY_ENVIRONMENT, list.capacity*sizeof(DeviceCommand));
+
+    return list;
+}
+
+// Clear recorded commands (keeps allocated memory)
+void ResetCommandList(CommandList *list)
+{
+    list->count = 0;
+}
+
+// Unload command list memory
+void UnloadCommandList(CommandList list)
+{
+    PBR_FREE(list.commands);
+}
+
+// Record a pass to a texture face and level (cleared)
+void CmdBeginPass(CommandList *list, DevicePass pass, DeviceTexture target, int face, int level)
+{
+    DeviceCommand *cmd = PushCommand(list, DEVICE_CMD_BEGIN_PASS);
+    cmd->begin.pass = pass;
+    cmd->begin.target = target;
+    cmd->begin.face = face;
+    cmd->begin.level = level;
+}
+
+// Record end of current pass
+void CmdEndPass(CommandList *list)
+{
+    PushCommand(list, DEVICE_CMD_END_PASS);
+}
+
+// Record a pipeline binding
+void CmdBindPipeline(CommandList *list, DevicePipeline pipeline)
+{
+    DeviceCommand *cmd = PushCommand(list, DEVICE_CMD_BIND_PIPELINE);
+    cmd->pipeline.pipeline = pipeline;
+}
+
+// Record a texture binding to a sampler unit
+void CmdBindTexture(CommandList *list, int unit, DeviceTexture texture)
+{
+    DeviceCommand *cmd = PushCommand(list, DEVICE_CMD_BIND_TEXTURE);
+    cmd->texture.unit = unit;
+    cmd->texture.texture = texture;
+}
+
+// Record a matrix uniform value (must be transposed like shader values)
+// NOTE: values are copied by hand, MatrixToFloat() returns a static buffer overwritten by next call
+void CmdSetMatrix(CommandList *list, int location, Matrix mat)
+{
+    DeviceCommand *cmd = PushCommand(list, DEVICE_CMD_SET_MATRIX);
+    float *value = cmd->matrix.value;
+
+    cmd->matrix.location = location;
+    value[0] = mat.m0; value[1] = mat.m1; value[2] = mat.m2; value[3] = mat.m3;
+    value[4] = mat.m4; value[5] = mat.m5; value[6] = mat.m6; value[7] = mat.m7;
+    value[8] = mat.m8; value[9] = mat.m9; value[10] = mat.m10; value[11] = mat.m11;
+    value[12] = mat.m12; value[13] = mat.m13; value[14] = mat.m14; value[15] = mat.m15;
+}
+
+// Record a float uniform value
+void CmdSetFloat(CommandList *list, int location, float value)
+{
+    DeviceCommand *cmd = PushCommand(list, DEVICE_CMD_SET_FLOAT);
+    cmd->value.location = location;
+    cmd->value.value = value;
+}
+
+// Record a draw of all buffer vertices
+void CmdDraw(CommandList *list, DeviceBuffer buffer)
+{
+    DeviceCommand *cmd = PushCommand(list, DEVICE_CMD_DRAW);
+    cmd->draw.buffer = buffer;
+}
+
+// Record a barrier to sample a written texture (mipmaps rebuilt from first level)
+void CmdBarrier(CommandList *list, DeviceTexture texture, bool updateMipmaps)
+{
+    DeviceCommand *cmd = PushCommand(list, DEVICE_CMD_BARRIER);
+    cmd->barrier.texture = texture;
+    cmd->barrier.updateMipmaps = updateMipmaps;
+}
+
+// Append a command to a command list
+static DeviceCommand *PushCommand(CommandList *list, DeviceCommandType type)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = ((list->capacity > 0) ? list->capacity*2 : DEVICE_COMMANDS_CAPACITY);
+        list->commands = (DeviceCommand *)PBR_REALLOC(MEMORY_ENVIRONMENT, list->commands, list->capacity*sizeof(DeviceCommand));
+    }
+
+    DeviceCommand *cmd = &list->commands[list->count++];
+    cmd->type = type;
+
+    return cmd;
+}
+
+// Load a vertex buffer and its layout
+// NOTE: attributes are interleaved floats, attributes array contains each attribute components count
+static DeviceBuffer LoadBufferGL(const float *vertices, int vertexCount, const int *attributes, int attributesCount, DevicePrimitive primitive)
+{
+    DeviceBuffer buffer = { 0 };
+    int stride = 0;
+
+    for (int i = 0; i < attributesCount; i++) stride += attributes[i];
+
+    buffer.vertexCount = vertexCount;
+    buffer.primitive = primitive;
+
+    glGenVertexArrays(1, &buffer.layoutId);
+    glGenBuffers(1, &buffer.id);
+    glBindVertexArray(buffer.layoutId);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.id);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount*stride*sizeof(float), vertices, GL_STATIC_DRAW);
+
+    for (int i = 0, offset = 0; (i < attributesCount) && (i < DEVICE_MAX_ATTRIBUTES); i++)
+    {
+        glEnableVertexAttribArray(i);
+        glVertexAttribPointer(i, attributes[i], GL_FLOAT, GL_FALSE, stride*sizeof(float), (GLvoid *)(offset*sizeof(float)));
+        offset += attributes[i];
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    return buffer;
+}
+
+// Load a 2D or cube texture with empty levels
+// NOTE: levels above 1 allocate the full mipmaps chain and use trilinear filtering
+static DeviceTexture LoadTextureGL(DeviceTextureType type, DeviceFormat format, int size, int levels)
+{
+    DeviceTexture texture = { 0 };
+    GLenum target = ((type == DEVICE_TEXTURE_CUBE) ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D);
+    GLenum internalFormat = GL_RGB16F;
+    GLenum dataFormat = GL_RGB;
+
+    switch (format)
+    {
+        case DEVICE_FORMAT_RG16F: internalFormat = GL_RG16F; dataFormat = GL_RG; break;
+        case DEVICE_FORMAT_RGBA16F: internalFormat = GL_RGBA16F; dataFormat = GL_RGBA; break;
+        default: break;
+    }
+
+    texture.type = type;
+    texture.format = format;
+    texture.size = size;
+    texture.levels = levels;
+
+    glGenTextures(1, &texture.id);
+    BindTextureGL(0, target, texture.id);
+
+    if (type == DEVICE_TEXTURE_CUBE)
+    {
+        for (unsigned int i = 0; i < 6; i++) glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internalFormat, size, size, 0, dataFormat, GL_FLOAT, NULL);
+        glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    }
+    else glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size, size, 0, dataFormat, GL_FLOAT, NULL);
+
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, ((levels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    if (levels > 1) glGenerateMipmap(target);
+
+    return texture;
+}
+
+// Load a pipeline from a linked shader program
+static DevicePipeline LoadPipelineGL(unsigned int shaderId, bool depthTest)
+{
+    return (DevicePipeline){ shaderId, depthTest };
+}
+
+// Load a render pass framebuffer with depth attachment
+// NOTE: smaller levels are rendered using a part of depth attachment
+static DevicePass LoadPassGL(int size)
+{
+    DevicePass pass = { 0 };
+    pass.size = size;
+
+    glGenFramebuffers(1, &pass.id);
+    glGenRenderbuffers(1, &pass.depthId);
+    BindFramebufferGL(GL_FRAMEBUFFER, pass.id);
+    glBindRenderbuffer(GL_RENDERBUFFER, pass.depthId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, pass.depthId);
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+
+    return pass;
+}
+
+// Replay recorded commands
+static void SubmitGL(CommandList list)
+{
+    for (int i = 0; i < list.count; i++)
+    {
+        DeviceCommand *cmd = &list.commands[i];
+
+        switch (cmd->type)
+        {
+            case DEVICE_CMD_BEGIN_PASS:
+            {
+                DeviceTexture target = cmd->begin.target;
+                GLenum face = ((target.type == DEVICE_TEXTURE_CUBE) ? (GL_TEXTURE_CUBE_MAP_POSITIVE_X + cmd->begin.face) : GL_TEXTURE_2D);
+                int size = target.size >> cmd->begin.level;
+                if (size < 1) size = 1;
+
+                BindFramebufferGL(GL_FRAMEBUFFER, cmd->begin.pass.id);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, face, target.id, cmd->begin.level);
+                ViewportGL(0, 0, size, size);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            } break;
+            case DEVICE_CMD_END_PASS: break;
+            case DEVICE_CMD_BIND_PIPELINE:
+            {
+                UseProgramGL(cmd->pipeline.pipeline.shaderId);
+                DepthTestGL(cmd->pipeline.pipeline.depthTest);
+                if (cmd->pipeline.pipeline.depthTest) DepthFuncGL(GL_LEQUAL);
+            } break;
+            case DEVICE_CMD_BIND_TEXTURE:
+            {
+                DeviceTexture texture = cmd->texture.texture;
+                BindTextureGL(cmd->texture.unit, ((texture.type == DEVICE_TEXTURE_CUBE) ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D), texture.id);
+            } break;
+            case DEVICE_CMD_SET_MATRIX: glUniformMatrix4fv(cmd->matrix.location, 1, false, cmd->matrix.value); break;
+            case DEVICE_CMD_SET_FLOAT: glUniform1f(cmd->value.location, cmd->value.value); break;
+            case DEVICE_CMD_DRAW:
+            {
+                DeviceBuffer buffer = cmd->draw.buffer;
+                glBindVertexArray(buffer.layoutId);
+                glDrawArrays(((buffer.primitive == DEVICE_PRIMITIVE_TRIANGLE_STRIP) ? GL_TRIANGLE_STRIP : GL_TRIANGLES), 0, buffer.vertexCount);
+                glBindVertexArray(0);
+            } break;
+            case DEVICE_CMD_BARRIER:
+            {
+                // OpenGL orders render to texture and sampling, only mipmaps need to be updated
+                DeviceTexture texture = cmd->barrier.texture;
+
+                if (cmd->barrier.updateMipmaps && (texture.levels > 1))
+                {
+                    GLenum target = ((texture.type == DEVICE_TEXTURE_CUBE) ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D);
+                    BindTextureGL(0, target, texture.id);
+                    glGenerateMipmap(target);
+                }
+            } break;
+            default: break;
+        }
+    }
+
+    // Leave texture unit 0 active for raylib
+    ActiveTextureGL(0);
+}
+
+// Unload vertex buffer and its layout
+static void UnloadBufferGL(DeviceBuffer buffer)
+{
+    glDeleteBuffers(1, &buffer.id);
+    glDeleteVertexArrays(1, &buffer.layoutId);
+}
+
+// Unload texture
+static void UnloadTextureGL(DeviceTexture texture)
+{
+    ForgetTextureGL(texture.id);
+    glDeleteTextures(1, &texture.id);
+}
+
+// Unload render pass framebuffer and depth attachment
+static void UnloadPassGL(DevicePass pass)
+{
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+    ForgetFramebufferGL(pass.id);
+    glDeleteRenderbuffers(1, &pass.depthId);
+    glDeleteFramebuffers(1, &pass.id);
+}
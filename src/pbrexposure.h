@@ -0,0 +1,250 @@
+/***********************************************************************************
+*
+*   rPBR [exposure] - Automatic exposure computed on GPU for raylib
+*
+*   FEATURES:
+*       - Scene log-average luminance reduced on GPU with a mipmaps chain (no compute shaders required).
+*       - Exposure adapted temporally on GPU into a 1x1 texture read by PBR and skybox shaders.
+*       - Exposure value never goes back to CPU, so there is no pipeline stall.
+*       - GPU cost measured with timer queries read when available (one or more frames later).
+*
+*   NOTES:
+*       Scene render texture stores tonemapped and gamma corrected colors, so luminance pass reverts
+*       both operations and current exposure to measure scene radiance.
+*       Exposure calculated from a frame is applied to next frame (one frame latency).
+*
+*   DEPENDENCIES:
+*       pbrcore.h for OpenGL API and screen quad drawing (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         PATH_LUMINANCE_FS           "resources/shaders/luminance.fs"        // Path to scene log luminance fragment shader
+#define         PATH_EXPOSURE_FS            "resources/shaders/exposure.fs"         // Path to exposure adaptation fragment shader
+
+#define         EXPOSURE_LUMINANCE_SIZE     256                                     // Log luminance texture size (power of two, reduced to 1x1 by mipmaps)
+#define         EXPOSURE_TEXTURE_UNIT       14                                      // Exposure texture unit used by PBR and skybox shaders
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct AutoExposure {
+    unsigned int luminanceId;               // Log luminance framebuffer id
+    unsigned int luminanceTexId;            // Log luminance texture id (last mipmap level stores scene average)
+    unsigned int exposureIds[2];            // Exposure framebuffers ids (previous exposure is read while next is written)
+    unsigned int exposureTexIds[2];         // Exposure 1x1 textures ids
+    int current;                            // Current exposure texture index (applied to scene)
+    int levels;                             // Log luminance texture mipmap levels count
+
+    unsigned int queryId;                   // GPU time elapsed query id
+    bool queryPending;                      // Query result not available yet
+    float gpuTime;                          // Last measured GPU time in milliseconds
+
+    Shader luminanceShader;
+    Shader shader;
+    int levelLoc;
+    int deltaTimeLoc;
+} AutoExposure;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+AutoExposure LoadAutoExposure(void);                                                            // Load auto exposure luminance and exposure textures and shaders
+void EnableAutoExposure(AutoExposure exposure, Environment env);                                // Bind current exposure texture and enable it in PBR and skybox shaders
+void DisableAutoExposure(Environment env);                                                      // Disable auto exposure in PBR and skybox shaders (fixed exposure)
+void UpdateAutoExposure(AutoExposure *exposure, RenderTexture2D source, float deltaTime);       // Measure scene luminance and adapt exposure for next frame
+void UnloadAutoExposure(AutoExposure exposure);                                                 // Unload auto exposure textures, framebuffers and shaders from GPU
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Load auto exposure luminance and exposure textures and shaders
+AutoExposure LoadAutoExposure(void)
+{
+    AutoExposure exposure = { 0 };
+    exposure.levels = (int)floorf(log2f(EXPOSURE_LUMINANCE_SIZE)) + 1;
+
+    InvalidateStateGL();
+
+    // Create log luminance texture with full mipmaps chain
+    // NOTE: 16 bit floating point is required to store negative log values
+    glGenTextures(1, &exposure.luminanceTexId);
+    BindTextureGL(0, GL_TEXTURE_2D, exposure.luminanceTexId);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, EXPOSURE_LUMINANCE_SIZE, EXPOSURE_LUMINANCE_SIZE, 0, GL_RED, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glGenFramebuffers(1, &exposure.luminanceId);
+    BindFramebufferGL(GL_FRAMEBUFFER, exposure.luminanceId);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, exposure.luminanceTexId, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) TraceLog(LOG_WARNING, "[FBO ID %i] Luminance framebuffer object could not be created", exposure.luminanceId);
+    else TraceLog(LOG_INFO, "[FBO ID %i] Luminance framebuffer object created successfully", exposure.luminanceId);
+
+    // Create exposure textures initialized to fixed exposure
+    float initial = 1.0f;
+
+    for (int i = 0; i < 2; i++)
+    {
+        glGenTextures(1, &exposure.exposureTexIds[i]);
+        BindTextureGL(0, GL_TEXTURE_2D, exposure.exposureTexIds[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, 1, 1, 0, GL_RED, GL_FLOAT, &initial);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glGenFramebuffers(1, &exposure.exposureIds[i]);
+        BindFramebufferGL(GL_FRAMEBUFFER, exposure.exposureIds[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, exposure.exposureTexIds[i], 0);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) TraceLog(LOG_WARNING, "[FBO ID %i] Exposure framebuffer object could not be created", exposure.exposureIds[i]);
+    }
+
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+
+    // Load luminance and adaptation shaders (both drawn with a screen quad)
+    exposure.luminanceShader = LoadShader(PATH_BRDF_VS, PATH_LUMINANCE_FS);
+    SetShaderValuei(exposure.luminanceShader, GetShaderLocation(exposure.luminanceShader, "texture0"), (int[1]){ 0 }, 1);
+    SetShaderValuei(exposure.luminanceShader, GetShaderLocation(exposure.luminanceShader, "exposureMap"), (int[1]){ 1 }, 1);
+
+    exposure.shader = LoadShader(PATH_BRDF_VS, PATH_EXPOSURE_FS);
+    exposure.levelLoc = GetShaderLocation(exposure.shader, "level");
+    exposure.deltaTimeLoc = GetShaderLocation(exposure.shader, "deltaTime");
+    SetShaderValuei(exposure.shader, GetShaderLocation(exposure.shader, "luminanceMap"), (int[1]){ 0 }, 1);
+    SetShaderValuei(exposure.shader, GetShaderLocation(exposure.shader, "exposureMap"), (int[1]){ 1 }, 1);
+    SetShaderValue(exposure.shader, exposure.levelLoc, (float[1]){ (float)(exposure.levels - 1) }, 1);
+
+    glGenQueries(1, &exposure.queryId);
+
+    return exposure;
+}
+
+// Bind current exposure texture and enable it in PBR and skybox shaders
+void EnableAutoExposure(AutoExposure exposure, Environment env)
+{
+    SetShaderValueiPBR(env, env.pbrExposureLoc, (int[1]){ 1 }, 1);
+    SetShaderValuei(env.skyShader, env.skyExposureLoc, (int[1]){ 1 }, 1);
+    InvalidateStateGL();
+
+    BindTextureGL(EXPOSURE_TEXTURE_UNIT, GL_TEXTURE_2D, exposure.exposureTexIds[exposure.current]);
+    ActiveTextureGL(0);
+}
+
+// Disable auto exposure in PBR and skybox shaders (fixed exposure)
+void DisableAutoExposure(Environment env)
+{
+    SetShaderValueiPBR(env, env.pbrExposureLoc, (int[1]){ 0 }, 1);
+    SetShaderValuei(env.skyShader, env.skyExposureLoc, (int[1]){ 0 }, 1);
+    InvalidateStateGL();
+
+    BindTextureGL(EXPOSURE_TEXTURE_UNIT, GL_TEXTURE_2D, 0);
+    ActiveTextureGL(0);
+}
+
+// Measure scene luminance and adapt exposure for next frame
+void UpdateAutoExposure(AutoExposure *exposure, RenderTexture2D source, float deltaTime)
+{
+    // Get previous measured GPU time if available (never waits for the result)
+    if (exposure->queryPending)
+    {
+        int available = 0;
+        glGetQueryObjectiv(exposure->queryId, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available)
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(exposure->queryId, GL_QUERY_RESULT, &elapsed);
+            exposure->gpuTime = (float)elapsed/1000000.0f;
+            exposure->queryPending = false;
+        }
+    }
+
+    if (!exposure->queryPending) glBeginQuery(GL_TIME_ELAPSED, exposure->queryId);
+
+    // Draw scene log luminance (scene exposed with current exposure)
+    InvalidateStateGL();
+    BindFramebufferGL(GL_FRAMEBUFFER, exposure->luminanceId);
+    ViewportGL(0, 0, EXPOSURE_LUMINANCE_SIZE, EXPOSURE_LUMINANCE_SIZE);
+
+    BindTextureGL(0, GL_TEXTURE_2D, source.texture.id);
+    BindTextureGL(1, GL_TEXTURE_2D, exposure->exposureTexIds[exposure->current]);
+
+    UseProgramGL(exposure->luminanceShader.id);
+    RenderQuad();
+
+    // Reduce log luminance to its average into last mipmap level
+    BindTextureGL(0, GL_TEXTURE_2D, exposure->luminanceTexId);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    // Adapt exposure from current to next exposure texture
+    int next = 1 - exposure->current;
+    BindFramebufferGL(GL_FRAMEBUFFER, exposure->exposureIds[next]);
+    ViewportGL(0, 0, 1, 1);
+
+    SetShaderValue(exposure->shader, exposure->deltaTimeLoc, (float[1]){ deltaTime }, 1);
+    UseProgramGL(exposure->shader.id);
+    RenderQuad();
+
+    BindTextureGL(1, GL_TEXTURE_2D, 0);
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+    ViewportGL(0, 0, GetScreenWidth(), GetScreenHeight());
+
+    if (!exposure->queryPending)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        exposure->queryPending = true;
+    }
+
+    exposure->current = next;
+}
+
+// Unload auto exposure textures, framebuffers and shaders from GPU
+void UnloadAutoExposure(AutoExposure exposure)
+{
+    ForgetFramebufferGL(exposure.luminanceId);
+    ForgetTextureGL(exposure.luminanceTexId);
+
+    for (int i = 0; i < 2; i++)
+    {
+        ForgetFramebufferGL(exposure.exposureIds[i]);
+        ForgetTextureGL(exposure.exposureTexIds[i]);
+    }
+
+    glDeleteFramebuffers(1, &exposure.luminanceId);
+    glDeleteFramebuffers(2, exposure.exposureIds);
+    glDeleteTextures(1, &exposure.luminanceTexId);
+    glDeleteTextures(2, exposure.exposureTexIds);
+    glDeleteQueries(1, &exposure.queryId);
+
+    UnloadShader(exposure.luminanceShader);
+    UnloadShader(exposure.shader);
+}
@@ -0,0 +1,397 @@
+/***********************************************************************************
+*
+*   rPBR [filter] - Specular antialiasing filtering of roughness textures for raylib
+*
+*   FEATURES:
+*       - Normal map variance per mipmap level folded into roughness mipmaps (Toksvig).
+*       - Filtering computed in background by worker threads while viewer keeps running.
+*       - Filtered mipmaps cached on disk by textures contents hash.
+*
+*   NOTES:
+*       Filtering keeps roughness texture id, so materials using it don't need to be updated.
+*       Without normal map roughness mipmaps are just box filtered.
+*       Remember to call StopSpecularFilter if roughness or normal textures change while filtering
+*
+*   DEPENDENCIES:
+*       pbrcore.h for OpenGL API and tracked allocations (must be included before this file)
+*       pthreads for filtering worker threads
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdio.h>                          // Required for: FILE, fopen(), fread(), fwrite(), snprintf()
+#include <stdlib.h>                         // Required for: free()
+#include <string.h>                         // Required for: memcmp()
+#include <pthread.h>                        // Required for: pthread_create(), pthread_join(), pthread_mutex_lock()
+
+#if defined(_WIN32)
+    #include <direct.h>                     // Required for: _mkdir()
+    #define     FILTER_MKDIR(path)          _mkdir(path)
+#else
+    #include <sys/stat.h>                   // Required for: mkdir()
+    #define     FILTER_MKDIR(path)          mkdir(path, 0755)
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         FILTER_THREADS              4                                       // Worker threads used to filter each mipmap level
+#define         FILTER_MAX_VARIANCE         0.18f                                   // Max normals variance added to roughness (avoids blurring everything)
+#define         FILTER_MAX_LEVELS           16                                      // Max roughness mipmap levels
+
+#define         PATH_FILTER_CACHE           "resources/cache"                       // Path to filtered roughness mipmaps cache folder
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct SpecularFilter {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    bool finished;                          // Filtered mipmaps ready to upload (protected by mutex)
+    bool cancel;                            // Filtering canceled by main thread (protected by mutex)
+    bool joined;                            // Filtering thread already joined
+
+    unsigned int textureId;                 // Roughness texture to upload filtered mipmaps
+    Image roughness;                        // Roughness texture data
+    Image normals;                          // Normal map texture data (data is NULL if there is no normal map)
+    unsigned int hash;                      // Textures contents hash used as cache key
+
+    int levelsCount;
+    int widths[FILTER_MAX_LEVELS];
+    int heights[FILTER_MAX_LEVELS];
+    unsigned char *levels[FILTER_MAX_LEVELS];   // Filtered roughness values per mipmap level
+    MemoryArena arena;                      // Filtered levels memory (owned by filtering thread until finished)
+    double startTime;                       // Filtering start time (import time report)
+} SpecularFilter;
+
+typedef struct SpecularFilterTask {
+    SpecularFilter *filter;
+    Color *roughness;
+    Color *normals;
+    int level;
+    int startRow;
+    int endRow;
+} SpecularFilterTask;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+SpecularFilter *StartSpecularFilter(Texture2D roughness, Texture2D normals);        // Start filtering roughness mipmaps with normal map variance in background
+bool UpdateSpecularFilter(SpecularFilter *filter);                                  // Upload filtered mipmaps when ready (returns true and unloads filter when finished)
+void StopSpecularFilter(SpecularFilter *filter);                                    // Cancel filtering and unload filter
+void FilterRoughnessRows(Color *roughness, int roughWidth, int roughHeight, Color *normals, int normalWidth, int normalHeight,
+                         unsigned char *level, int width, int height, int startRow, int endRow);    // Filter a range of rows of a roughness mipmap level (also used by rpbrcook)
+
+static void *SpecularFilterThread(void *arg);                                       // Filter all roughness mipmap levels or load them from cache
+static void *SpecularFilterTaskThread(void *arg);                                   // Filter a range of rows of a roughness mipmap level
+static unsigned int HashImageData(unsigned int hash, Color *pixels, int count);     // Accumulate image pixels into a FNV-1a hash
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Start filtering roughness mipmaps with normal map variance in background
+SpecularFilter *StartSpecularFilter(Texture2D roughness, Texture2D normals)
+{
+    SpecularFilter *filter = (SpecularFilter *)PBR_CALLOC(MEMORY_TEXTURES, 1, sizeof(SpecularFilter));
+
+    // Read textures data from GPU (textures can't be accessed from worker threads)
+    filter->startTime = GetTime();
+    filter->textureId = roughness.id;
+    filter->roughness = GetTextureData(roughness);
+    if (normals.id != 0) filter->normals = GetTextureData(normals);
+
+    // Calculate mipmap levels dimensions until 1x1 level
+    int width = roughness.width;
+    int height = roughness.height;
+
+    while (filter->levelsCount < FILTER_MAX_LEVELS)
+    {
+        filter->widths[filter->levelsCount] = width;
+        filter->heights[filter->levelsCount] = height;
+        filter->levelsCount++;
+
+        if ((width == 1) && (height == 1)) break;
+        width = (width > 1) ? width/2 : 1;
+        height = (height > 1) ? height/2 : 1;
+    }
+
+    pthread_mutex_init(&filter->mutex, NULL);
+    pthread_create(&filter->thread, NULL, SpecularFilterThread, filter);
+
+    return filter;
+}
+
+// Upload filtered mipmaps when ready (returns true and unloads filter when finished)
+bool UpdateSpecularFilter(SpecularFilter *filter)
+{
+    pthread_mutex_lock(&filter->mutex);
+    bool finished = filter->finished;
+    pthread_mutex_unlock(&filter->mutex);
+
+    if (!finished) return false;
+
+    pthread_join(filter->thread, NULL);
+    filter->joined = true;
+
+    // Replace roughness texture levels with filtered ones (same value in RGB channels)
+    InvalidateStateGL();
+    BindTextureGL(0, GL_TEXTURE_2D, filter->textureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Expand levels into a scratch arena sized for first (biggest) level and reset after each upload
+    MemoryArena scratch = LoadMemoryArena(MEMORY_TEXTURES, filter->widths[0]*filter->heights[0]*3);
+
+    for (int i = 0; i < filter->levelsCount; i++)
+    {
+        int count = filter->widths[i]*filter->heights[i];
+        unsigned char *pixels = (unsigned char *)PushArena(&scratch, count*3);
+
+        for (int k = 0; k < count; k++) pixels[k*3] = pixels[k*3 + 1] = pixels[k*3 + 2] = filter->levels[i][k];
+
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGB8, filter->widths[i], filter->heights[i], 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+        ResetArena(&scratch);
+    }
+
+    UnloadMemoryArena(&scratch);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, filter->levelsCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+
+    TraceLog(LOG_INFO, "[TEX ID %i] Roughness mipmaps filtered with normal map variance (%i levels) in %.2f ms (%u arena allocations from %u heap blocks)", filter->textureId,
+             filter->levelsCount, (GetTime() - filter->startTime)*1000.0, filter->arena.allocations + scratch.allocations, filter->arena.heapBlocks + scratch.heapBlocks);
+
+    StopSpecularFilter(filter);
+
+    return true;
+}
+
+// Cancel filtering and unload filter
+void StopSpecularFilter(SpecularFilter *filter)
+{
+    pthread_mutex_lock(&filter->mutex);
+    filter->cancel = true;
+    pthread_mutex_unlock(&filter->mutex);
+
+    if (!filter->joined) pthread_join(filter->thread, NULL);
+
+    pthread_mutex_destroy(&filter->mutex);
+
+    UnloadMemoryArena(&filter->arena);
+    UnloadImage(filter->roughness);
+    if (filter->normals.data != NULL) UnloadImage(filter->normals);
+    PBR_FREE(filter);
+}
+
+// Filter a range of rows of a roughness mipmap level with normal map variance
+// NOTE: GGX alpha is increased by the variance of normals covered by each texel (Toksvig), normals can be NULL
+void FilterRoughnessRows(Color *roughness, int roughWidth, int roughHeight, Color *normals, int normalWidth, int normalHeight,
+                         unsigned char *level, int width, int height, int startRow, int endRow)
+{
+    for (int y = startRow; y < endRow; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            // Average GGX alpha of base level texels covered by this texel
+            int x0 = x*roughWidth/width;
+            int y0 = y*roughHeight/height;
+            int x1 = ((x + 1)*roughWidth/width > x0) ? (x + 1)*roughWidth/width : x0 + 1;
+            int y1 = ((y + 1)*roughHeight/height > y0) ? (y + 1)*roughHeight/height : y0 + 1;
+            float alpha = 0.0f;
+
+            for (int j = y0; j < y1; j++)
+            {
+                for (int i = x0; i < x1; i++)
+                {
+                    float rough = roughness[j*roughWidth + i].r/255.0f;
+                    alpha += rough*rough;
+                }
+            }
+
+            alpha /= (float)((x1 - x0)*(y1 - y0));
+
+            // Average normal map unit normals covered by this texel and calculate variance from its length
+            float variance = 0.0f;
+
+            if (normals != NULL)
+            {
+                x0 = x*normalWidth/width;
+                y0 = y*normalHeight/height;
+                x1 = ((x + 1)*normalWidth/width > x0) ? (x + 1)*normalWidth/width : x0 + 1;
+                y1 = ((y + 1)*normalHeight/height > y0) ? (y + 1)*normalHeight/height : y0 + 1;
+                Vector3 average = { 0.0f, 0.0f, 0.0f };
+
+                for (int j = y0; j < y1; j++)
+                {
+                    for (int i = x0; i < x1; i++)
+                    {
+                        Color color = normals[j*normalWidth + i];
+                        Vector3 normal = { color.r/127.5f - 1.0f, color.g/127.5f - 1.0f, color.b/127.5f - 1.0f };
+                        float length = sqrtf(normal.x*normal.x + normal.y*normal.y + normal.z*normal.z);
+
+                        if (length > 0.0f)
+                        {
+                            average.x += normal.x/length;
+                            average.y += normal.y/length;
+                            average.z += normal.z/length;
+                        }
+                    }
+                }
+
+                float count = (float)((x1 - x0)*(y1 - y0));
+                float length = sqrtf(average.x*average.x + average.y*average.y + average.z*average.z)/count;
+                length = fminf(fmaxf(length, 0.0001f), 1.0f);
+                variance = fminf(2.0f*(1.0f - length)/length, FILTER_MAX_VARIANCE);
+            }
+
+            // Convert filtered alpha back to perceptual roughness stored in texture
+            float rough = sqrtf(sqrtf(alpha*alpha + variance));
+            level[y*width + x] = (unsigned char)(fminf(rough, 1.0f)*255.0f + 0.5f);
+        }
+    }
+}
+
+// Filter all roughness mipmap levels or load them from cache
+static void *SpecularFilterThread(void *arg)
+{
+    SpecularFilter *filter = (SpecularFilter *)arg;
+
+    Color *roughness = GetImageData(filter->roughness);
+    Color *normals = (filter->normals.data != NULL) ? GetImageData(filter->normals) : NULL;
+
+    // Calculate cache key from textures dimensions and contents
+    unsigned int dimensions[4] = { filter->roughness.width, filter->roughness.height, filter->normals.width, filter->normals.height };
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < (int)sizeof(dimensions); i++) hash = (hash ^ ((unsigned char *)dimensions)[i])*16777619u;
+    hash = HashImageData(hash, roughness, filter->roughness.width*filter->roughness.height);
+    if (normals != NULL) hash = HashImageData(hash, normals, filter->normals.width*filter->normals.height);
+    filter->hash = hash;
+
+    // Allocate all levels from a single arena owned by this thread until filtering finishes
+    size_t levelsSize = 0;
+    for (int i = 0; i < filter->levelsCount; i++) levelsSize += ((filter->widths[i]*filter->heights[i] + 15) & ~15);
+
+    filter->arena = LoadMemoryArena(MEMORY_TEXTURES, levelsSize);
+    for (int i = 0; i < filter->levelsCount; i++) filter->levels[i] = (unsigned char *)PushArena(&filter->arena, filter->widths[i]*filter->heights[i]);
+
+    // Try to load filtered mipmaps from cache
+    char cacheName[256] = { 0 };
+    snprintf(cacheName, sizeof(cacheName), "%s/roughness_%08x.rsf", PATH_FILTER_CACHE, hash);
+
+    bool cached = false;
+    FILE *file = fopen(cacheName, "rb");
+
+    if (file != NULL)
+    {
+        char magic[4] = { 0 };
+        int levelsCount = 0;
+        cached = (fread(magic, 1, 4, file) == 4) && (memcmp(magic, "RSF1", 4) == 0) &&
+                 (fread(&levelsCount, sizeof(int), 1, file) == 1) && (levelsCount == filter->levelsCount);
+
+        for (int i = 0; cached && (i < filter->levelsCount); i++)
+        {
+            size_t count = filter->widths[i]*filter->heights[i];
+            cached = (fread(filter->levels[i], 1, count, file) == count);
+        }
+
+        fclose(file);
+    }
+
+    // Filter each mipmap level splitting its rows between worker threads
+    for (int i = 0; !cached && (i < filter->levelsCount); i++)
+    {
+        pthread_mutex_lock(&filter->mutex);
+        bool cancel = filter->cancel;
+        pthread_mutex_unlock(&filter->mutex);
+
+        if (cancel) break;
+
+        pthread_t threads[FILTER_THREADS];
+        SpecularFilterTask tasks[FILTER_THREADS];
+
+        for (int k = 0; k < FILTER_THREADS; k++)
+        {
+            tasks[k] = (SpecularFilterTask){ filter, roughness, normals, i, filter->heights[i]*k/FILTER_THREADS, filter->heights[i]*(k + 1)/FILTER_THREADS };
+            pthread_create(&threads[k], NULL, SpecularFilterTaskThread, &tasks[k]);
+        }
+
+        for (int k = 0; k < FILTER_THREADS; k++) pthread_join(threads[k], NULL);
+
+        // Store filtered mipmaps in cache once all levels are filtered
+        if (i == (filter->levelsCount - 1))
+        {
+            FILTER_MKDIR(PATH_FILTER_CACHE);
+            file = fopen(cacheName, "wb");
+
+            if (file != NULL)
+            {
+                fwrite("RSF1", 1, 4, file);
+                fwrite(&filter->levelsCount, sizeof(int), 1, file);
+                for (int k = 0; k < filter->levelsCount; k++) fwrite(filter->levels[k], 1, filter->widths[k]*filter->heights[k], file);
+                fclose(file);
+            }
+        }
+    }
+
+    free(roughness);
+    free(normals);
+
+    pthread_mutex_lock(&filter->mutex);
+    filter->finished = !filter->cancel;
+    pthread_mutex_unlock(&filter->mutex);
+
+    return NULL;
+}
+
+// Filter a range of rows of a roughness mipmap level
+static void *SpecularFilterTaskThread(void *arg)
+{
+    SpecularFilterTask *task = (SpecularFilterTask *)arg;
+    SpecularFilter *filter = task->filter;
+
+    FilterRoughnessRows(task->roughness, filter->roughness.width, filter->roughness.height, task->normals, filter->normals.width, filter->normals.height,
+                        filter->levels[task->level], filter->widths[task->level], filter->heights[task->level], task->startRow, task->endRow);
+
+    return NULL;
+}
+
+// Accumulate image pixels into a FNV-1a hash
+static unsigned int HashImageData(unsigned int hash, Color *pixels, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        hash = (hash ^ pixels[i].r)*16777619u;
+        hash = (hash ^ pixels[i].g)*16777619u;
+        hash = (hash ^ pixels[i].b)*16777619u;
+        hash = (hash ^ pixels[i].a)*16777619u;
+    }
+
+    return hash;
+}
@@ -0,0 +1,371 @@
+/***********************************************************************************
+*
+*   rPBR [golden] - Golden images regression checks with performance budgets for raylib
+*
+*   FEATURES:
+*       - Rendered scenes compared against stored golden images with structural similarity (SSIM)
+*         on luminance and changed pixels ratio, missing golden images fail unless --golden-update is used.
+*       - GPU and CPU times checked against per-scene budgets (budgets.txt, scene name prefixes).
+*       - HTML report with golden, current and difference images and timings per scene.
+*       - Failed scenes count returned to be used as process exit code (CI friendly).
+*
+*   NOTES:
+*       Golden directory contents: <scene>.png golden images, budgets.txt and generated report.html and report/ images.
+*       Budget lines format: "<scene prefix> <GPU ms> <CPU ms>", "*" matches all scenes and later lines take precedence.
+*       A zero or missing budget disables that time check.
+*       Golden images depend on GPU and driver, so CPU-only CI must use its own golden directory
+*       (Mesa llvmpipe: LIBGL_ALWAYS_SOFTWARE=1 and a virtual display), filled by a --golden-update run on that runner.
+*
+*       Command line options:
+*           --golden <directory>    Render regression scenes and compare against directory golden images
+*           --golden-update         Store missing golden images and overwrite existing ones with current results
+*
+*   DEPENDENCIES:
+*       raylib for images loading and saving
+*       pbrmemory.h for tracked allocations (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdio.h>                          // Required for: FILE, fopen(), fgets(), fprintf(), sscanf(), snprintf()
+#include <stdlib.h>                         // Required for: free()
+#include <string.h>                         // Required for: strcmp(), strncmp(), strlen()
+#include <math.h>                           // Required for: fabsf(), fminf()
+
+#if defined(_WIN32)
+    #include <direct.h>                     // Required for: _mkdir()
+    #define MakeGoldenDirectory(path)       _mkdir(path)
+#else
+    #include <sys/stat.h>                   // Required for: mkdir()
+    #define MakeGoldenDirectory(path)       mkdir(path, 0755)
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         GOLDEN_MAX_BUDGETS          64                                      // Max budget lines
+#define         GOLDEN_MAX_NAME             64                                      // Max scene name length
+#define         GOLDEN_MAX_PATH             512                                     // Max golden files path length
+#define         GOLDEN_MIN_SSIM             0.98f                                   // Min mean structural similarity to pass
+#define         GOLDEN_MAX_CHANGED          0.01f                                   // Max ratio of visibly changed pixels to pass
+#define         GOLDEN_PIXEL_THRESHOLD      8.0f                                    // Luminance difference (0-255) for a pixel to count as changed
+#define         GOLDEN_SSIM_WINDOW          8                                       // SSIM window dimensions in pixels
+#define         GOLDEN_DIFF_SCALE           8.0f                                    // Difference image luminance amplification
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct GoldenBudget {
+    char prefix[GOLDEN_MAX_NAME];           // Scene names prefix ("*" for all scenes)
+    float gpuTime;                          // Max GPU time in milliseconds (0 to skip)
+    float cpuTime;                          // Max CPU time in milliseconds (0 to skip)
+} GoldenBudget;
+
+typedef struct GoldenResult {
+    char name[GOLDEN_MAX_NAME];             // Scene name (golden image file name without extension)
+    bool stored;                            // Golden image stored by this run (no comparison)
+    bool missing;                           // Golden image not found and not stored (failed)
+    bool passed;                            // Image and budgets checks passed
+    float ssim;                             // Mean structural similarity
+    float changed;                          // Visibly changed pixels ratio
+    float gpuTime;                          // Measured GPU time in milliseconds
+    float cpuTime;                          // Measured CPU time in milliseconds
+    GoldenBudget budget;                    // Budget applied to scene
+} GoldenResult;
+
+typedef struct GoldenSuite {
+    bool enabled;                           // Golden regression run requested
+    bool update;                            // Overwrite golden images
+    const char *directory;                  // Golden images directory
+    GoldenBudget budgets[GOLDEN_MAX_BUDGETS];
+    int budgetsCount;
+    GoldenResult *results;                  // Checked scenes results
+    int resultsCount;
+    int resultsCapacity;
+    int failures;                           // Failed scenes count
+} GoldenSuite;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+GoldenSuite InitGoldenSuite(int argc, char **argv);                                            // Parse golden command line options and load directory budgets
+bool CheckGoldenScene(GoldenSuite *suite, const char *name, Image image, float gpuTime, float cpuTime);    // Compare a rendered scene (RGBA8) with its golden image and budgets
+int EndGoldenSuite(GoldenSuite *suite);                                                         // Write HTML report and get failed scenes count
+
+static float CompareGoldenImages(Image golden, Image image, Image *diff, float *changed);       // Get mean SSIM and changed pixels ratio, generate difference image
+static GoldenBudget GetGoldenBudget(GoldenSuite *suite, const char *name);                      // Get last budget matching scene name
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Parse golden command line options and load directory budgets
+GoldenSuite InitGoldenSuite(int argc, char **argv)
+{
+    GoldenSuite suite = { 0 };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--golden") == 0) && (i + 1 < argc)) { suite.enabled = true; suite.directory = argv[++i]; }
+        else if (strcmp(argv[i], "--golden-update") == 0) suite.update = true;
+    }
+
+    if (!suite.enabled) return suite;
+
+    // Create report images directory (ignored if it already exists)
+    char path[GOLDEN_MAX_PATH] = { 0 };
+    snprintf(path, sizeof(path), "%s/report", suite.directory);
+    MakeGoldenDirectory(path);
+
+    snprintf(path, sizeof(path), "%s/budgets.txt", suite.directory);
+    FILE *file = fopen(path, "r");
+
+    if (file != NULL)
+    {
+        char line[256] = { 0 };
+
+        while ((fgets(line, sizeof(line), file) != NULL) && (suite.budgetsCount < GOLDEN_MAX_BUDGETS))
+        {
+            GoldenBudget *budget = &suite.budgets[suite.budgetsCount];
+            if ((line[0] != '#') && (sscanf(line, "%63s %f %f", budget->prefix, &budget->gpuTime, &budget->cpuTime) >= 2)) suite.budgetsCount++;
+        }
+
+        fclose(file);
+    }
+
+    TraceLog(LOG_INFO, "[%s] Golden images check%s (%i budgets)", suite.directory, (suite.update ? " and update" : ""), suite.budgetsCount);
+
+    return suite;
+}
+
+// Compare a rendered scene (RGBA8) with its golden image and budgets
+bool CheckGoldenScene(GoldenSuite *suite, const char *name, Image image, float gpuTime, float cpuTime)
+{
+    GoldenResult result = { 0 };
+    char path[GOLDEN_MAX_PATH] = { 0 };
+
+    snprintf(result.name, sizeof(result.name), "%s", name);
+    result.gpuTime = gpuTime;
+    result.cpuTime = cpuTime;
+    result.budget = GetGoldenBudget(suite, name);
+    result.ssim = 1.0f;
+    result.passed = true;
+
+    // Store current image as report image
+    snprintf(path, sizeof(path), "%s/report/%s.png", suite->directory, name);
+    SaveImageAs(path, image);
+
+    // Compare with golden image or store it if updating
+    snprintf(path, sizeof(path), "%s/%s.png", suite->directory, name);
+    FILE *file = fopen(path, "rb");
+
+    if (suite->update)
+    {
+        if (file != NULL) fclose(file);
+        SaveImageAs(path, image);
+        result.stored = true;
+    }
+    else if (file == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] Golden image not found (use --golden-update to store it)", path);
+        result.missing = true;
+        result.ssim = 0.0f;
+        result.changed = 1.0f;
+        result.passed = false;
+    }
+    else
+    {
+        fclose(file);
+        Image golden = LoadImage(path);
+        ImageFormat(&golden, UNCOMPRESSED_R8G8B8A8);
+
+        if ((golden.width != image.width) || (golden.height != image.height))
+        {
+            TraceLog(LOG_WARNING, "[%s] Golden image is %ix%i but scene is %ix%i", path, golden.width, golden.height, image.width, image.height);
+            result.ssim = 0.0f;
+            result.changed = 1.0f;
+        }
+        else
+        {
+            Image diff = { 0 };
+            result.ssim = CompareGoldenImages(golden, image, &diff, &result.changed);
+
+            snprintf(path, sizeof(path), "%s/report/%s_diff.png", suite->directory, name);
+            SaveImageAs(path, diff);
+            UnloadImage(diff);
+        }
+
+        UnloadImage(golden);
+        result.passed = ((result.ssim >= GOLDEN_MIN_SSIM) && (result.changed <= GOLDEN_MAX_CHANGED));
+    }
+
+    // Check performance budgets
+    if ((result.budget.gpuTime > 0.0f) && (gpuTime > result.budget.gpuTime)) result.passed = false;
+    if ((result.budget.cpuTime > 0.0f) && (cpuTime > result.budget.cpuTime)) result.passed = false;
+
+    if (!result.passed)
+    {
+        TraceLog(LOG_WARNING, "Golden scene %s failed: SSIM %.4f, %.2f%% changed, %.3f/%.3f ms GPU, %.3f/%.3f ms CPU", name, result.ssim,
+                 result.changed*100.0f, gpuTime, result.budget.gpuTime, cpuTime, result.budget.cpuTime);
+        suite->failures++;
+    }
+
+    if (suite->resultsCount == suite->resultsCapacity)
+    {
+        suite->resultsCapacity = ((suite->resultsCapacity > 0) ? suite->resultsCapacity*2 : 64);
+        suite->results = (GoldenResult *)PBR_REALLOC(MEMORY_UI, suite->results, suite->resultsCapacity*sizeof(GoldenResult));
+    }
+
+    suite->results[suite->resultsCount++] = result;
+
+    return result.passed;
+}
+
+// Write HTML report and get failed scenes count
+int EndGoldenSuite(GoldenSuite *suite)
+{
+    char path[GOLDEN_MAX_PATH] = { 0 };
+    snprintf(path, sizeof(path), "%s/report.html", suite->directory);
+    FILE *file = fopen(path, "w");
+
+    if (file != NULL)
+    {
+        fprintf(file, "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>rPBR golden images report</title>\n");
+        fprintf(file, "<style>body { font-family: sans-serif; } td { padding: 4px 8px; text-align: right; } img { width: 240px; } .fail { background: #f4c7c3; } .pass { background: #d9ead3; }</style>\n");
+        fprintf(file, "</head>\n<body>\n<h1>rPBR golden images report</h1>\n<p>%i scenes, %i failed</p>\n<table>\n", suite->resultsCount, suite->failures);
+        fprintf(file, "<tr><th>Scene</th><th>Result</th><th>SSIM</th><th>Changed</th><th>GPU ms</th><th>GPU budget</th><th>CPU ms</th><th>CPU budget</th><th>Golden</th><th>Current</th><th>Difference</th></tr>\n");
+
+        for (int i = 0; i < suite->resultsCount; i++)
+        {
+            GoldenResult *result = &suite->results[i];
+
+            fprintf(file, "<tr class=\"%s\"><td>%s</td><td>%s</td><td>%.4f</td><td>%.2f%%</td><td>%.3f</td><td>%.3f</td><td>%.3f</td><td>%.3f</td>",
+                    (result->passed ? "pass" : "fail"), result->name, (result->stored ? "stored" : (result->missing ? "missing" : (result->passed ? "passed" : "failed"))), result->ssim,
+                    result->changed*100.0f, result->gpuTime, result->budget.gpuTime, result->cpuTime, result->budget.cpuTime);
+            fprintf(file, "<td><img src=\"%s.png\"></td><td><img src=\"report/%s.png\"></td>", result->name, result->name);
+
+            if (!result->stored && !result->missing) fprintf(file, "<td><img src=\"report/%s_diff.png\"></td></tr>\n", result->name);
+            else fprintf(file, "<td></td></tr>\n");
+        }
+
+        fprintf(file, "</table>\n</body>\n</html>\n");
+        fclose(file);
+    }
+    else TraceLog(LOG_WARNING, "[%s] Golden images report could not be written", path);
+
+    TraceLog(LOG_INFO, "Golden images check finished: %i scenes, %i failed", suite->resultsCount, suite->failures);
+
+    int failures = suite->failures;
+    PBR_FREE(suite->results);
+    *suite = (GoldenSuite){ 0 };
+
+    return failures;
+}
+
+// Get mean SSIM and changed pixels ratio, generate difference image
+// NOTE: SSIM is computed on gamma encoded luminance in non overlapped windows (same constants as original paper)
+static float CompareGoldenImages(Image golden, Image image, Image *diff, float *changed)
+{
+    const float c1 = (0.01f*255.0f)*(0.01f*255.0f);
+    const float c2 = (0.03f*255.0f)*(0.03f*255.0f);
+    Color *pixelsA = GetImageData(golden);
+    Color *pixelsB = GetImageData(image);
+    Color *pixelsDiff = (Color *)PBR_MALLOC(MEMORY_UI, image.width*image.height*sizeof(Color));
+    int changedCount = 0;
+
+    // Calculate luminance difference image and changed pixels
+    for (int i = 0; i < image.width*image.height; i++)
+    {
+        float lumA = 0.2126f*pixelsA[i].r + 0.7152f*pixelsA[i].g + 0.0722f*pixelsA[i].b;
+        float lumB = 0.2126f*pixelsB[i].r + 0.7152f*pixelsB[i].g + 0.0722f*pixelsB[i].b;
+        float delta = fabsf(lumA - lumB);
+
+        if (delta > GOLDEN_PIXEL_THRESHOLD) changedCount++;
+
+        unsigned char value = (unsigned char)fminf(delta*GOLDEN_DIFF_SCALE, 255.0f);
+        pixelsDiff[i] = (Color){ value, (unsigned char)(lumB*0.25f), (unsigned char)(lumB*0.25f), 255 };
+    }
+
+    // Calculate windows structural similarity
+    double total = 0.0;
+    int windows = 0;
+
+    for (int y = 0; y + GOLDEN_SSIM_WINDOW <= image.height; y += GOLDEN_SSIM_WINDOW)
+    {
+        for (int x = 0; x + GOLDEN_SSIM_WINDOW <= image.width; x += GOLDEN_SSIM_WINDOW)
+        {
+            float sumA = 0.0f, sumB = 0.0f, sumAA = 0.0f, sumBB = 0.0f, sumAB = 0.0f;
+
+            for (int j = 0; j < GOLDEN_SSIM_WINDOW; j++)
+            {
+                for (int k = 0; k < GOLDEN_SSIM_WINDOW; k++)
+                {
+                    int index = (y + j)*image.width + x + k;
+                    float a = 0.2126f*pixelsA[index].r + 0.7152f*pixelsA[index].g + 0.0722f*pixelsA[index].b;
+                    float b = 0.2126f*pixelsB[index].r + 0.7152f*pixelsB[index].g + 0.0722f*pixelsB[index].b;
+
+                    sumA += a;
+                    sumB += b;
+                    sumAA += a*a;
+                    sumBB += b*b;
+                    sumAB += a*b;
+                }
+            }
+
+            float n = (float)(GOLDEN_SSIM_WINDOW*GOLDEN_SSIM_WINDOW);
+            float meanA = sumA/n, meanB = sumB/n;
+            float varA = sumAA/n - meanA*meanA;
+            float varB = sumBB/n - meanB*meanB;
+            float covariance = sumAB/n - meanA*meanB;
+
+            total += ((2.0f*meanA*meanB + c1)*(2.0f*covariance + c2))/((meanA*meanA + meanB*meanB + c1)*(varA + varB + c2));
+            windows++;
+        }
+    }
+
+    *changed = (float)changedCount/(float)(image.width*image.height);
+    *diff = LoadImageEx(pixelsDiff, image.width, image.height);
+
+    free(pixelsA);
+    free(pixelsB);
+    PBR_FREE(pixelsDiff);
+
+    return ((windows > 0) ? (float)(total/windows) : 1.0f);
+}
+
+// Get last budget matching scene name
+static GoldenBudget GetGoldenBudget(GoldenSuite *suite, const char *name)
+{
+    GoldenBudget budget = { 0 };
+
+    for (int i = 0; i < suite->budgetsCount; i++)
+    {
+        const char *prefix = suite->budgets[i].prefix;
+        if ((strcmp(prefix, "*") == 0) || (strncmp(name, prefix, strlen(prefix)) == 0)) budget = suite->budgets[i];
+    }
+
+    return budget;
+}
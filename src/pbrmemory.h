@@ -0,0 +1,676 @@
+/***********************************************************************************
+*
+*   rPBR [memory] - CPU heap allocations tracking per subsystem
+*
+*   FEATURES:
+*       - rPBR allocations routed through PBR_MALLOC(), PBR_CALLOC(), PBR_REALLOC() and PBR_FREE()
+*         tagged by subsystem (environment, model, textures, interface).
+*       - stb_image allocations hooks (StbMallocTracked(), StbReallocTracked() and StbFreeTracked()),
+*         attributed to current memory scope (BeginMemoryScope() and EndMemoryScope()).
+*       - Live bytes, peak bytes and allocation rate per tag (displayed in rPBR stats overlay).
+*       - Per tag summary and leaked allocations (file and line) reported on shutdown.
+*       - Linear arenas for import jobs temporary arrays (one heap block, O(1) reset).
+*       - Fixed size blocks pools for buffers allocated and released repeatedly (O(1) alloc, free and reset).
+*
+*   NOTES:
+*       Tracked blocks are prefixed with a header (size, tag, source location and list links),
+*       so memory allocated by PBR_MALLOC() must be released by PBR_FREE() and never by free(),
+*       and memory allocated by raylib (GetImageData(), LoadFileText()...) must keep using free().
+*       stb_image is compiled inside raylib, so its allocations are only tracked if raylib is built
+*       with: -DSTBI_MALLOC=StbMallocTracked -DSTBI_REALLOC=StbReallocTracked -DSTBI_FREE=StbFreeTracked
+*       (defining them in rPBR sources has no effect). stb bytes handed over to raylib are only reported
+*       once any hook was called, so a raylib built without hooks doesn't report empty stb attribution.
+*       stb blocks have no header because raylib releases decoded pixels with free(). They are kept
+*       in a small table while decoding and handed over to raylib (removed from live bytes) when
+*       their memory scope ends, so live bytes measure decode working set and peak includes it.
+*       Memory scopes are a main thread stack, worker threads must use explicitly tagged allocations.
+*       raylib 1.8 other allocations (OBJ parsing, meshes data) use malloc() directly and are not tracked.
+*       Arenas and pools are not thread safe: each job or worker thread owns its arena, and pools shared
+*       between threads must be used under the lock that already hands their blocks over.
+*       Arena allocations not fitting its capacity get their own heap block (released on reset), and pool
+*       allocations bigger than block size or with pool exhausted fall back to tracked heap allocations.
+*
+*   DEPENDENCIES:
+*       raylib 1.8                          // Required for: GetTime()
+*       pthreads for allocations from loading and filtering worker threads
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdio.h>                          // Required for: printf()
+#include <stdlib.h>                         // Required for: malloc(), realloc(), free()
+#include <string.h>                         // Required for: memset()
+#include <pthread.h>                        // Required for: pthread_mutex_lock(), pthread_mutex_unlock()
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         MEMORY_MAX_SCOPES           16                                      // Max nested memory scopes
+#define         MEMORY_STB_BLOCKS           64                                      // Max stb blocks alive at the same time (decode buffers)
+#define         MEMORY_MAX_LEAKS            32                                      // Max leaked allocations listed on shutdown
+#define         MEMORY_RATE_INTERVAL        1.0                                     // Allocation rates update interval (seconds)
+#define         MEMORY_HEADER_SIZE          ((sizeof(MemoryBlock) + 15) & ~(size_t)15)  // Tracked block header size (keeps 16 bytes alignment)
+
+#define         PBR_MALLOC(tag, size)               AllocMemory(tag, size, __FILE__, __LINE__)
+#define         PBR_CALLOC(tag, count, size)        CallocMemory(tag, count, size, __FILE__, __LINE__)
+#define         PBR_REALLOC(tag, ptr, size)         ReallocMemory(tag, ptr, size, __FILE__, __LINE__)
+#define         PBR_FREE(ptr)                       FreeMemory(ptr)
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef enum {
+    MEMORY_ENVIRONMENT = 0,
+    MEMORY_MODEL,
+    MEMORY_TEXTURES,
+    MEMORY_UI,
+    MEMORY_OTHER,
+    MEMORY_TAGS
+} MemoryTag;
+
+typedef struct MemoryStats {
+    size_t liveBytes;                       // Allocated bytes not released yet
+    size_t peakBytes;                       // Max live bytes
+    int liveCount;                          // Allocations not released yet
+    unsigned int totalCount;                // Allocations since start
+    double totalBytes;                      // Allocated bytes since start
+    double handedBytes;                     // stb bytes handed over to raylib since start
+    float countRate;                        // Allocations per second (last interval)
+    float bytesRate;                        // Allocated bytes per second (last interval)
+    unsigned int lastCount;                 // Allocations at last rates update
+    double lastBytes;                       // Allocated bytes at last rates update
+} MemoryStats;
+
+typedef struct MemoryBlock {
+    struct MemoryBlock *prev;               // Previous tracked block (live blocks list)
+    struct MemoryBlock *next;               // Next tracked block
+    size_t size;                            // Requested size in bytes
+    const char *file;                       // Allocation source file
+    int line;                               // Allocation source line
+    int tag;                                // Allocation subsystem tag
+} MemoryBlock;
+
+typedef struct StbBlock {
+    void *ptr;                              // stb allocated memory (NULL if slot is free)
+    size_t size;                            // Requested size in bytes
+    int tag;                                // Memory scope tag at allocation time
+} StbBlock;
+
+typedef struct MemoryArena {
+    unsigned char *base;                    // Arena memory block (tracked allocation)
+    size_t capacity;                        // Arena memory block size
+    size_t used;                            // Bytes used since last reset
+    size_t peak;                            // Max bytes used (including overflow blocks)
+    size_t overflowBytes;                   // Bytes allocated in overflow blocks since last reset
+    void *overflow;                         // Overflow blocks list (allocations not fitting in capacity)
+    int tag;                                // Arena memory tag
+    unsigned int allocations;               // Allocations served since load
+    unsigned int heapBlocks;                // Heap blocks allocated since load (arena block and overflow blocks)
+} MemoryArena;
+
+typedef struct MemoryPool {
+    unsigned char *base;                    // Pool blocks memory (tracked allocation)
+    size_t blockSize;                       // Block size (multiple of 16 bytes)
+    int capacity;                           // Blocks count
+    int next;                               // Next never used block index
+    void *freeList;                         // Released blocks list
+    int used;                               // Blocks in use
+    int peak;                               // Max blocks in use
+    int tag;                                // Pool memory tag
+    unsigned int allocations;               // Allocations served since load
+    unsigned int fallbacks;                 // Allocations served by heap (too big or pool exhausted)
+} MemoryPool;
+
+typedef struct MemoryTracker {
+    pthread_mutex_t mutex;                  // Protects tracker from worker threads allocations
+    MemoryBlock *blocks;                    // Live tracked blocks list
+    MemoryStats stats[MEMORY_TAGS];         // Per tag statistics
+    int scopes[MEMORY_MAX_SCOPES];          // Memory scopes tags stack (main thread)
+    int scopesCount;                        // Memory scopes stack size
+    StbBlock stb[MEMORY_STB_BLOCKS];        // stb blocks alive (no header)
+    bool stbHooked;                         // stb hooks called at least once (raylib built with hooks)
+    double lastUpdate;                      // Last allocation rates update time
+} MemoryTracker;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static MemoryTracker memory = { .mutex = PTHREAD_MUTEX_INITIALIZER };      // Heap allocations tracker
+static const char *memoryTagNames[MEMORY_TAGS] = { "environment", "model", "textures", "ui", "other" };  // Memory tags names
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+void *AllocMemory(int tag, size_t size, const char *file, int line);                        // Allocate tracked memory (use PBR_MALLOC())
+void *CallocMemory(int tag, size_t count, size_t size, const char *file, int line);         // Allocate zeroed tracked memory (use PBR_CALLOC())
+void *ReallocMemory(int tag, void *ptr, size_t size, const char *file, int line);           // Resize tracked memory (use PBR_REALLOC())
+void FreeMemory(void *ptr);                                                                 // Release tracked memory (use PBR_FREE())
+
+void BeginMemoryScope(int tag);                                                             // Attribute untagged allocations (stb) to a tag
+void EndMemoryScope(void);                                                                  // End current memory scope (hands stb blocks over to raylib)
+void UpdateMemoryStats(void);                                                               // Update allocation rates (call once per frame)
+MemoryStats GetMemoryStats(int tag);                                                        // Get a tag memory statistics
+const char *GetMemoryTagName(int tag);                                                      // Get a tag name
+int ReportMemory(void);                                                                     // Print per tag summary and leaked allocations (returns leaks count)
+
+MemoryArena LoadMemoryArena(int tag, size_t capacity);                                      // Load a linear arena with a single heap block
+void *PushArena(MemoryArena *arena, size_t size);                                           // Allocate memory from arena (16 bytes aligned)
+void *PushArenaZero(MemoryArena *arena, size_t size);                                       // Allocate zeroed memory from arena
+void ResetArena(MemoryArena *arena);                                                        // Release all arena allocations at once
+void UnloadMemoryArena(MemoryArena *arena);                                                 // Unload arena memory
+
+MemoryPool LoadMemoryPool(int tag, size_t blockSize, int capacity);                         // Load a pool of fixed size blocks
+void *AllocPool(MemoryPool *pool, size_t size);                                             // Allocate a block from pool
+void FreePool(MemoryPool *pool, void *ptr);                                                 // Release a pool block (or its heap fallback)
+void ResetPool(MemoryPool *pool);                                                           // Release all pool blocks at once (heap fallbacks must be freed before)
+void UnloadMemoryPool(MemoryPool *pool);                                                    // Unload pool memory
+
+void *StbMallocTracked(size_t size);                                                        // stb_image allocation hook (STBI_MALLOC)
+void *StbReallocTracked(void *ptr, size_t size);                                            // stb_image reallocation hook (STBI_REALLOC)
+void StbFreeTracked(void *ptr);                                                             // stb_image release hook (STBI_FREE)
+
+static int GetMemoryScopeTag(void);                                                         // Get current memory scope tag
+static void TrackAlloc(int tag, size_t size);                                               // Add an allocation to tag statistics (mutex locked)
+static void TrackFree(int tag, size_t size);                                                // Remove an allocation from tag live statistics (mutex locked)
+static StbBlock *FindStbBlock(void *ptr);                                                   // Find stb block slot by pointer (NULL pointer finds a free slot)
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Allocate tracked memory (use PBR_MALLOC())
+void *AllocMemory(int tag, size_t size, const char *file, int line)
+{
+    MemoryBlock *block = (MemoryBlock *)malloc(MEMORY_HEADER_SIZE + size);
+
+    if (block == NULL) return NULL;
+
+    block->prev = NULL;
+    block->size = size;
+    block->file = file;
+    block->line = line;
+    block->tag = (((tag >= 0) && (tag < MEMORY_TAGS)) ? tag : MEMORY_OTHER);
+
+    pthread_mutex_lock(&memory.mutex);
+    block->next = memory.blocks;
+    if (memory.blocks != NULL) memory.blocks->prev = block;
+    memory.blocks = block;
+    TrackAlloc(block->tag, size);
+    pthread_mutex_unlock(&memory.mutex);
+
+    return (unsigned char *)block + MEMORY_HEADER_SIZE;
+}
+
+// Allocate zeroed tracked memory (use PBR_CALLOC())
+void *CallocMemory(int tag, size_t count, size_t size, const char *file, int line)
+{
+    void *ptr = AllocMemory(tag, count*size, file, line);
+
+    if (ptr != NULL) memset(ptr, 0, count*size);
+
+    return ptr;
+}
+
+// Resize tracked memory (use PBR_REALLOC())
+// NOTE: block keeps its original tag, source location is updated to last resize
+void *ReallocMemory(int tag, void *ptr, size_t size, const char *file, int line)
+{
+    if (ptr == NULL) return AllocMemory(tag, size, file, line);
+
+    MemoryBlock *block = (MemoryBlock *)((unsigned char *)ptr - MEMORY_HEADER_SIZE);
+
+    pthread_mutex_lock(&memory.mutex);
+
+    // Unlink block because realloc() can move it
+    if (block->prev != NULL) block->prev->next = block->next;
+    else memory.blocks = block->next;
+    if (block->next != NULL) block->next->prev = block->prev;
+
+    MemoryBlock *resized = (MemoryBlock *)realloc(block, MEMORY_HEADER_SIZE + size);
+    bool failed = (resized == NULL);
+
+    // Keep original block tracked if it could not be resized
+    if (failed) resized = block;
+    else
+    {
+        TrackFree(resized->tag, resized->size);
+        TrackAlloc(resized->tag, size);
+        resized->size = size;
+        resized->file = file;
+        resized->line = line;
+    }
+
+    resized->prev = NULL;
+    resized->next = memory.blocks;
+    if (memory.blocks != NULL) memory.blocks->prev = resized;
+    memory.blocks = resized;
+
+    pthread_mutex_unlock(&memory.mutex);
+
+    return (failed ? NULL : (unsigned char *)resized + MEMORY_HEADER_SIZE);
+}
+
+// Release tracked memory (use PBR_FREE())
+void FreeMemory(void *ptr)
+{
+    if (ptr == NULL) return;
+
+    MemoryBlock *block = (MemoryBlock *)((unsigned char *)ptr - MEMORY_HEADER_SIZE);
+
+    pthread_mutex_lock(&memory.mutex);
+    if (block->prev != NULL) block->prev->next = block->next;
+    else memory.blocks = block->next;
+    if (block->next != NULL) block->next->prev = block->prev;
+    TrackFree(block->tag, block->size);
+    pthread_mutex_unlock(&memory.mutex);
+
+    free(block);
+}
+
+// Attribute untagged allocations (stb) to a tag
+void BeginMemoryScope(int tag)
+{
+    if (memory.scopesCount < MEMORY_MAX_SCOPES) memory.scopes[memory.scopesCount] = tag;
+    memory.scopesCount++;
+}
+
+// End current memory scope (hands stb blocks over to raylib)
+// NOTE: stb blocks still alive are decoded images returned to raylib, which releases them with free()
+void EndMemoryScope(void)
+{
+    if (memory.scopesCount == 0) return;
+
+    int tag = GetMemoryScopeTag();
+    memory.scopesCount--;
+
+    pthread_mutex_lock(&memory.mutex);
+
+    for (int i = 0; i < MEMORY_STB_BLOCKS; i++)
+    {
+        if ((memory.stb[i].ptr != NULL) && (memory.stb[i].tag == tag))
+        {
+            TrackFree(tag, memory.stb[i].size);
+            memory.stats[tag].handedBytes += memory.stb[i].size;
+            memory.stb[i].ptr = NULL;
+        }
+    }
+
+    pthread_mutex_unlock(&memory.mutex);
+}
+
+// Update allocation rates (call once per frame)
+void UpdateMemoryStats(void)
+{
+    double time = GetTime();
+    double elapsed = time - memory.lastUpdate;
+
+    if (elapsed < MEMORY_RATE_INTERVAL) return;
+
+    pthread_mutex_lock(&memory.mutex);
+
+    for (int i = 0; i < MEMORY_TAGS; i++)
+    {
+        MemoryStats *stats = &memory.stats[i];
+        stats->countRate = (float)((stats->totalCount - stats->lastCount)/elapsed);
+        stats->bytesRate = (float)((stats->totalBytes - stats->lastBytes)/elapsed);
+        stats->lastCount = stats->totalCount;
+        stats->lastBytes = stats->totalBytes;
+    }
+
+    pthread_mutex_unlock(&memory.mutex);
+
+    memory.lastUpdate = time;
+}
+
+// Get a tag memory statistics
+MemoryStats GetMemoryStats(int tag)
+{
+    MemoryStats stats = { 0 };
+
+    if ((tag < 0) || (tag >= MEMORY_TAGS)) return stats;
+
+    pthread_mutex_lock(&memory.mutex);
+    stats = memory.stats[tag];
+    pthread_mutex_unlock(&memory.mutex);
+
+    return stats;
+}
+
+// Get a tag name
+const char *GetMemoryTagName(int tag)
+{
+    return (((tag >= 0) && (tag < MEMORY_TAGS)) ? memoryTagNames[tag] : "unknown");
+}
+
+// Print per tag summary and leaked allocations (returns leaks count)
+// NOTE: call it after all resources are unloaded, remaining tracked blocks are leaks
+int ReportMemory(void)
+{
+    int leaks = 0;
+
+    pthread_mutex_lock(&memory.mutex);
+
+    // Report stb bytes handed over to raylib only if raylib was built with stb hooks
+    if (memory.stbHooked) printf("Memory report (tag: live, peak, allocations, allocated, handed to raylib)\n");
+    else printf("Memory report (tag: live, peak, allocations, allocated), stb_image allocations not tracked\n");
+
+    for (int i = 0; i < MEMORY_TAGS; i++)
+    {
+        MemoryStats *stats = &memory.stats[i];
+        printf("    %-12s %10.2f MB %10.2f MB %8u %10.2f MB", memoryTagNames[i], stats->liveBytes/(1024.0*1024.0), stats->peakBytes/(1024.0*1024.0),
+               stats->totalCount, stats->totalBytes/(1024.0*1024.0));
+        if (memory.stbHooked) printf(" %10.2f MB", stats->handedBytes/(1024.0*1024.0));
+        printf("\n");
+    }
+
+    for (MemoryBlock *block = memory.blocks; block != NULL; block = block->next)
+    {
+        if (leaks < MEMORY_MAX_LEAKS) printf("LEAK: %u bytes (%s) allocated at %s:%i\n", (unsigned int)block->size, memoryTagNames[block->tag], block->file, block->line);
+        leaks++;
+    }
+
+    if (leaks > MEMORY_MAX_LEAKS) printf("LEAK: %i more leaked allocations not listed\n", leaks - MEMORY_MAX_LEAKS);
+    printf("%i leaked allocations\n", leaks);
+
+    pthread_mutex_unlock(&memory.mutex);
+
+    return leaks;
+}
+
+// Load a linear arena with a single heap block
+MemoryArena LoadMemoryArena(int tag, size_t capacity)
+{
+    MemoryArena arena = { 0 };
+
+    arena.capacity = (capacity + 15) & ~(size_t)15;
+    arena.base = (unsigned char *)PBR_MALLOC(tag, arena.capacity);
+    arena.tag = tag;
+    arena.heapBlocks = 1;
+
+    if (arena.base == NULL) arena.capacity = 0;
+
+    return arena;
+}
+
+// Allocate memory from arena (16 bytes aligned)
+// NOTE: allocations not fitting in arena get an overflow heap block, released on reset
+void *PushArena(MemoryArena *arena, size_t size)
+{
+    size = (size + 15) & ~(size_t)15;
+    arena->allocations++;
+
+    if (arena->used + size <= arena->capacity)
+    {
+        void *ptr = arena->base + arena->used;
+        arena->used += size;
+        if (arena->used + arena->overflowBytes > arena->peak) arena->peak = arena->used + arena->overflowBytes;
+
+        return ptr;
+    }
+
+    // Overflow blocks start with a link to previous overflow block (16 bytes to keep alignment)
+    unsigned char *block = (unsigned char *)PBR_MALLOC(arena->tag, 16 + size);
+    if (block == NULL) return NULL;
+
+    *(void **)block = arena->overflow;
+    arena->overflow = block;
+    arena->overflowBytes += size;
+    arena->heapBlocks++;
+    if (arena->used + arena->overflowBytes > arena->peak) arena->peak = arena->used + arena->overflowBytes;
+
+    return block + 16;
+}
+
+// Allocate zeroed memory from arena
+void *PushArenaZero(MemoryArena *arena, size_t size)
+{
+    void *ptr = PushArena(arena, size);
+
+    if (ptr != NULL) memset(ptr, 0, size);
+
+    return ptr;
+}
+
+// Release all arena allocations at once
+// NOTE: O(1) unless allocations overflowed arena capacity (one release per overflow block)
+void ResetArena(MemoryArena *arena)
+{
+    while (arena->overflow != NULL)
+    {
+        void *previous = *(void **)arena->overflow;
+        PBR_FREE(arena->overflow);
+        arena->overflow = previous;
+    }
+
+    arena->used = 0;
+    arena->overflowBytes = 0;
+}
+
+// Unload arena memory
+void UnloadMemoryArena(MemoryArena *arena)
+{
+    ResetArena(arena);
+    PBR_FREE(arena->base);
+    arena->base = NULL;
+    arena->capacity = 0;
+}
+
+// Load a pool of fixed size blocks
+// NOTE: blocks are handed out in order first and reused from released blocks list later, so no list is built on load
+MemoryPool LoadMemoryPool(int tag, size_t blockSize, int capacity)
+{
+    MemoryPool pool = { 0 };
+
+    pool.blockSize = (((blockSize < sizeof(void *)) ? sizeof(void *) : blockSize) + 15) & ~(size_t)15;
+    pool.base = (unsigned char *)PBR_MALLOC(tag, pool.blockSize*capacity);
+    pool.capacity = ((pool.base != NULL) ? capacity : 0);
+    pool.tag = tag;
+
+    return pool;
+}
+
+// Allocate a block from pool
+void *AllocPool(MemoryPool *pool, size_t size)
+{
+    void *ptr = NULL;
+
+    pool->allocations++;
+
+    if (size <= pool->blockSize)
+    {
+        if (pool->freeList != NULL)
+        {
+            ptr = pool->freeList;
+            pool->freeList = *(void **)ptr;
+        }
+        else if (pool->next < pool->capacity)
+        {
+            ptr = pool->base + pool->blockSize*pool->next;
+            pool->next++;
+        }
+    }
+
+    if (ptr == NULL)
+    {
+        pool->fallbacks++;
+        return PBR_MALLOC(pool->tag, size);
+    }
+
+    pool->used++;
+    if (pool->used > pool->peak) pool->peak = pool->used;
+
+    return ptr;
+}
+
+// Release a pool block (or its heap fallback)
+void FreePool(MemoryPool *pool, void *ptr)
+{
+    if (ptr == NULL) return;
+
+    unsigned char *block = (unsigned char *)ptr;
+
+    if ((block >= pool->base) && (block < pool->base + pool->blockSize*pool->capacity))
+    {
+        *(void **)ptr = pool->freeList;
+        pool->freeList = ptr;
+        pool->used--;
+    }
+    else PBR_FREE(ptr);
+}
+
+// Release all pool blocks at once (heap fallbacks must be freed before)
+void ResetPool(MemoryPool *pool)
+{
+    pool->next = 0;
+    pool->freeList = NULL;
+    pool->used = 0;
+}
+
+// Unload pool memory
+void UnloadMemoryPool(MemoryPool *pool)
+{
+    PBR_FREE(pool->base);
+    *pool = (MemoryPool){ 0 };
+}
+
+// stb_image allocation hook (STBI_MALLOC)
+void *StbMallocTracked(size_t size)
+{
+    void *ptr = malloc(size);
+
+    if (ptr == NULL) return NULL;
+
+    int tag = GetMemoryScopeTag();
+
+    pthread_mutex_lock(&memory.mutex);
+
+    memory.stbHooked = true;
+
+    // Blocks not fitting in table are counted but not tracked as live memory
+    StbBlock *slot = FindStbBlock(NULL);
+
+    if (slot != NULL)
+    {
+        slot->ptr = ptr;
+        slot->size = size;
+        slot->tag = tag;
+        TrackAlloc(tag, size);
+    }
+    else
+    {
+        memory.stats[tag].totalCount++;
+        memory.stats[tag].totalBytes += size;
+    }
+
+    pthread_mutex_unlock(&memory.mutex);
+
+    return ptr;
+}
+
+// stb_image reallocation hook (STBI_REALLOC)
+void *StbReallocTracked(void *ptr, size_t size)
+{
+    if (ptr == NULL) return StbMallocTracked(size);
+
+    pthread_mutex_lock(&memory.mutex);
+
+    StbBlock *slot = FindStbBlock(ptr);
+    void *resized = realloc(ptr, size);
+
+    if ((slot != NULL) && (resized != NULL))
+    {
+        TrackFree(slot->tag, slot->size);
+        TrackAlloc(slot->tag, size);
+        slot->ptr = resized;
+        slot->size = size;
+    }
+
+    pthread_mutex_unlock(&memory.mutex);
+
+    return resized;
+}
+
+// stb_image release hook (STBI_FREE)
+void StbFreeTracked(void *ptr)
+{
+    if (ptr == NULL) return;
+
+    pthread_mutex_lock(&memory.mutex);
+
+    StbBlock *slot = FindStbBlock(ptr);
+
+    if (slot != NULL)
+    {
+        TrackFree(slot->tag, slot->size);
+        slot->ptr = NULL;
+    }
+
+    pthread_mutex_unlock(&memory.mutex);
+
+    free(ptr);
+}
+
+// Get current memory scope tag
+static int GetMemoryScopeTag(void)
+{
+    if ((memory.scopesCount == 0) || (memory.scopesCount > MEMORY_MAX_SCOPES)) return MEMORY_OTHER;
+
+    int tag = memory.scopes[memory.scopesCount - 1];
+
+    return (((tag >= 0) && (tag < MEMORY_TAGS)) ? tag : MEMORY_OTHER);
+}
+
+// Add an allocation to tag statistics (mutex locked)
+static void TrackAlloc(int tag, size_t size)
+{
+    MemoryStats *stats = &memory.stats[tag];
+
+    stats->liveBytes += size;
+    stats->liveCount++;
+    stats->totalCount++;
+    stats->totalBytes += size;
+    if (stats->liveBytes > stats->peakBytes) stats->peakBytes = stats->liveBytes;
+}
+
+// Remove an allocation from tag live statistics (mutex locked)
+static void TrackFree(int tag, size_t size)
+{
+    MemoryStats *stats = &memory.stats[tag];
+
+    stats->liveBytes -= size;
+    stats->liveCount--;
+}
+
+// Find stb block slot by pointer (NULL pointer finds a free slot)
+static StbBlock *FindStbBlock(void *ptr)
+{
+    for (int i = 0; i < MEMORY_STB_BLOCKS; i++)
+    {
+        if (memory.stb[i].ptr == ptr) return &memory.stb[i];
+    }
+
+    return NULL;
+}
@@ -0,0 +1,147 @@
+/***********************************************************************************
+*
+*   rPBR [mesh] - Mesh tangents generation (shared by cooker and kernels benchmark)
+*
+*   FEATURES:
+*       - Tangents per vertex from texture coordinates derivatives of every triangle sharing it.
+*       - Vertices with same position, normal and texture coordinates welded by a hash table,
+*         so non-indexed OBJ meshes get smooth tangents instead of faceted ones.
+*       - Tangents orthogonalized against vertex normals (Gram-Schmidt) and normalized.
+*
+*   NOTES:
+*       Tangents are 3 floats per vertex (same layout as package tangents stream).
+*       Meshes without texture coordinates or normals keep tangents array unchanged.
+*
+*   DEPENDENCIES:
+*       raylib for Mesh type
+*       pbrmemory.h for tracked allocations (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <string.h>                         // Required for: memset(), memcmp(), memcpy()
+#include <math.h>                           // Required for: sqrtf(), fabsf()
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+void GenerateTangents(Mesh mesh, float *tangents);                                  // Generate tangents of welded vertices (3 floats per vertex)
+
+static unsigned long long HashTangentKey(const float *key, int count);              // Hash vertex attributes values (FNV-1a 64 bits)
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Generate tangents of welded vertices (3 floats per vertex)
+// NOTE: OBJ meshes are not indexed, so vertices with same position, normal and texture coordinates are welded
+// to accumulate tangents of every triangle sharing them (otherwise tangents would be faceted)
+void GenerateTangents(Mesh mesh, float *tangents)
+{
+    if ((mesh.texcoords == NULL) || (mesh.normals == NULL)) return;
+
+    int count = mesh.vertexCount;
+    int capacity = 1;
+    while (capacity < count*2) capacity *= 2;
+
+    int *table = (int *)PBR_MALLOC(MEMORY_MODEL, capacity*sizeof(int));
+    int *remap = (int *)PBR_MALLOC(MEMORY_MODEL, count*sizeof(int));
+    float *welded = (float *)PBR_CALLOC(MEMORY_MODEL, count*3, sizeof(float));
+    memset(table, 0xff, capacity*sizeof(int));
+
+    // Weld vertices by exact attributes values (open addressing hash table)
+    for (int i = 0; i < count; i++)
+    {
+        float key[8] = { mesh.vertices[i*3], mesh.vertices[i*3 + 1], mesh.vertices[i*3 + 2], mesh.normals[i*3], mesh.normals[i*3 + 1], mesh.normals[i*3 + 2], mesh.texcoords[i*2], mesh.texcoords[i*2 + 1] };
+        int slot = (int)(HashTangentKey(key, 8) & (capacity - 1));
+
+        while (table[slot] >= 0)
+        {
+            int other = table[slot];
+            float otherKey[8] = { mesh.vertices[other*3], mesh.vertices[other*3 + 1], mesh.vertices[other*3 + 2], mesh.normals[other*3], mesh.normals[other*3 + 1], mesh.normals[other*3 + 2], mesh.texcoords[other*2], mesh.texcoords[other*2 + 1] };
+            if (memcmp(key, otherKey, sizeof(key)) == 0) break;
+            slot = (slot + 1) & (capacity - 1);
+        }
+
+        if (table[slot] < 0) table[slot] = i;
+        remap[i] = table[slot];
+    }
+
+    // Accumulate triangles tangents in welded vertices
+    int triangles = ((mesh.indices != NULL) ? mesh.triangleCount : count/3);
+
+    for (int t = 0; t < triangles; t++)
+    {
+        int idx[3] = { t*3, t*3 + 1, t*3 + 2 };
+        if (mesh.indices != NULL) for (int k = 0; k < 3; k++) idx[k] = mesh.indices[t*3 + k];
+
+        float *v0 = &mesh.vertices[idx[0]*3], *v1 = &mesh.vertices[idx[1]*3], *v2 = &mesh.vertices[idx[2]*3];
+        float *uv0 = &mesh.texcoords[idx[0]*2], *uv1 = &mesh.texcoords[idx[1]*2], *uv2 = &mesh.texcoords[idx[2]*2];
+
+        float e1[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+        float e2[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+        float du1 = uv1[0] - uv0[0], dv1 = uv1[1] - uv0[1];
+        float du2 = uv2[0] - uv0[0], dv2 = uv2[1] - uv0[1];
+
+        float det = du1*dv2 - du2*dv1;
+        float r = ((fabsf(det) > 1e-12f) ? 1.0f/det : 0.0f);
+
+        for (int k = 0; k < 3; k++)
+        {
+            float *tangent = &welded[remap[idx[k]]*3];
+            for (int c = 0; c < 3; c++) tangent[c] += (e1[c]*dv2 - e2[c]*dv1)*r;
+        }
+    }
+
+    // Orthogonalize welded tangents against normals and copy them to every vertex
+    for (int i = 0; i < count; i++)
+    {
+        float *n = &mesh.normals[i*3];
+        float *tangent = &tangents[i*3];
+        memcpy(tangent, &welded[remap[i]*3], 3*sizeof(float));
+
+        float d = n[0]*tangent[0] + n[1]*tangent[1] + n[2]*tangent[2];
+        for (int c = 0; c < 3; c++) tangent[c] -= n[c]*d;
+
+        float length = sqrtf(tangent[0]*tangent[0] + tangent[1]*tangent[1] + tangent[2]*tangent[2]);
+        if (length > 0.0f) for (int c = 0; c < 3; c++) tangent[c] /= length;
+    }
+
+    PBR_FREE(table);
+    PBR_FREE(remap);
+    PBR_FREE(welded);
+}
+
+// Hash vertex attributes values (FNV-1a 64 bits)
+static unsigned long long HashTangentKey(const float *key, int count)
+{
+    const unsigned char *bytes = (const unsigned char *)key;
+    unsigned long long hash = 14695981039346656037ull;
+
+    for (int i = 0; i < count*(int)sizeof(float); i++) hash = (hash ^ bytes[i])*1099511628211ull;
+
+    return hash;
+}
@@ -0,0 +1,499 @@
+/***********************************************************************************
+*
+*   rPBR [metrics] - Prometheus metrics exporter for fleet monitoring
+*
+*   FEATURES:
+*       - Optional exporter enabled with --metrics <port> (localhost TCP) or --metrics unix:<path>.
+*       - Serves Prometheus text format (GET /metrics) from a background thread.
+*       - Frames counter, frame time and resources load latency histograms, VRAM (NVX/ATI memory info),
+*         heap live bytes per subsystem and OpenGL state calls gauges.
+*       - Render thread only does relaxed atomic increments and stores, it never waits for the exporter.
+*
+*   NOTES:
+*       Test it with a local curl while viewer is running:
+*           rpbr --metrics 9464         ->  curl http://127.0.0.1:9464/metrics
+*           rpbr --metrics unix:/tmp/rpbr.sock  ->  curl --unix-socket /tmp/rpbr.sock http://localhost/metrics
+*       Exporter only binds to 127.0.0.1, put a reverse proxy or node exporter textfile collector in front
+*       of it to scrape it remotely.
+*       Histograms are aggregated with per bucket atomic counters, so a scrape can see a frame counted in
+*       a bucket but not yet in sum (scrapes are not snapshots, Prometheus tolerates it).
+*       Gauges gathered from other modules (VRAM, heap and state calls) are published by render thread
+*       once per METRICS_GAUGES_INTERVAL, so exporter never takes locks owned by render thread.
+*       Exporter is not available on Windows (winsock headers clash with raylib names).
+*
+*   DEPENDENCIES:
+*       pbrcore.h for OpenGL API and state calls counters (must be included before this file)
+*       pbrmemory.h for heap allocations stats (must be included before this file)
+*       POSIX sockets and pthreads for exporter thread
+*       GCC atomic builtins for lock-free aggregation
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdio.h>                          // Required for: snprintf(), vsnprintf()
+#include <stdlib.h>                         // Required for: atoi()
+#include <string.h>                         // Required for: strcmp(), strncmp(), strncpy()
+#include <stdarg.h>                         // Required for: va_list, va_start(), va_end()
+#include <pthread.h>                        // Required for: pthread_create(), pthread_join()
+
+#if !defined(_WIN32)
+    #include <unistd.h>                     // Required for: close(), unlink()
+    #include <sys/socket.h>                 // Required for: socket(), bind(), listen(), accept(), send(), recv()
+    #include <sys/select.h>                 // Required for: select()
+    #include <sys/time.h>                   // Required for: struct timeval
+    #include <sys/un.h>                     // Required for: struct sockaddr_un
+    #include <netinet/in.h>                 // Required for: struct sockaddr_in
+    #include <arpa/inet.h>                  // Required for: htons(), htonl()
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         METRICS_PORT                9464                                    // Default exporter TCP port
+#define         METRICS_MAX_BUCKETS         12                                      // Max histogram buckets (including +Inf)
+#define         METRICS_GAUGES_INTERVAL     1.0                                     // Gauges publishing interval (seconds)
+#define         METRICS_ACCEPT_TIMEOUT      250                                     // Exporter thread quit check interval (milliseconds)
+#define         METRICS_REQUEST_SIZE        1024                                    // Max HTTP request bytes read
+#define         METRICS_RESPONSE_SIZE       16384                                   // Max metrics page size
+
+#define         METRICS_ADD(ptr, value)     __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED)
+#define         METRICS_STORE(ptr, value)   __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+#define         METRICS_LOAD(ptr)           __atomic_load_n(ptr, __ATOMIC_RELAXED)
+
+#define         GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX       0x9048
+#define         GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX     0x9049
+#define         GL_TEXTURE_FREE_MEMORY_ATI                          0x87FC
+
+#if defined(MSG_NOSIGNAL)
+    #define     METRICS_SEND_FLAGS          MSG_NOSIGNAL                            // Don't raise SIGPIPE when scraper closes connection early
+#else
+    #define     METRICS_SEND_FLAGS          0
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef enum {
+    METRICS_LOAD_ENVIRONMENT = 0,
+    METRICS_LOAD_MODEL,
+    METRICS_LOAD_TEXTURE,
+    METRICS_LOAD_POINTCLOUD,
+    METRICS_LOAD_PACKAGE,
+    METRICS_LOAD_KINDS
+} MetricsLoadKind;
+
+typedef enum {
+    METRICS_VRAM_NONE = 0,
+    METRICS_VRAM_NVX,
+    METRICS_VRAM_ATI
+} MetricsVramSource;
+
+typedef struct MetricsHistogram {
+    const double *bounds;                   // Buckets upper bounds in seconds (last bucket is +Inf)
+    int bucketsCount;                       // Buckets count (including +Inf)
+    unsigned long long buckets[METRICS_MAX_BUCKETS];    // Observations per bucket (not cumulative)
+    unsigned long long sumMicros;           // Observations sum in microseconds
+} MetricsHistogram;
+
+typedef struct Metrics {
+    bool enabled;                           // Exporter running
+    bool unixSocket;                        // Listening on a Unix domain socket instead of TCP
+    char socketPath[108];                   // Unix domain socket path
+    int port;                               // TCP port
+    int listener;                           // Listening socket
+    int quit;                               // Exporter thread quit request (atomic)
+    pthread_t thread;
+
+    unsigned long long frames;              // Frames rendered (atomic)
+    MetricsHistogram frameTime;             // Frame times histogram (atomic buckets)
+    MetricsHistogram loads[METRICS_LOAD_KINDS];     // Resources load latencies histograms (atomic buckets)
+
+    int vramSource;                         // VRAM query extension (render thread)
+    bool vramChecked;                       // VRAM query extension checked (render thread)
+    double lastFrame;                       // Last frame observation time (render thread)
+    double lastGauges;                      // Last gauges publishing time (render thread)
+    long long vramTotal;                    // Total VRAM bytes (atomic, -1 if unknown)
+    long long vramAvailable;                // Available VRAM bytes (atomic, -1 if unknown)
+    unsigned long long heapLive[MEMORY_TAGS];       // Heap live bytes per tag (atomic)
+    unsigned long long heapPeak[MEMORY_TAGS];       // Heap peak bytes per tag (atomic)
+    int stateIssued;                        // Last frame OpenGL state calls issued (atomic)
+    int stateElided;                        // Last frame OpenGL state calls elided (atomic)
+} Metrics;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static const double metricsFrameBounds[] = { 0.004, 0.008, 0.0167, 0.0333, 0.05, 0.1, 0.25, 0.0 };         // Frame time buckets (seconds, 0.0 is +Inf)
+static const double metricsLoadBounds[] = { 0.01, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 0.0 };       // Load latency buckets (seconds, 0.0 is +Inf)
+static const char *metricsLoadNames[METRICS_LOAD_KINDS] = { "environment", "model", "texture", "pointcloud", "package" };
+
+static Metrics metrics = { 0 };             // Metrics exporter state and aggregated values
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+void InitMetrics(int argc, char **argv);                                                    // Check --metrics option and start exporter thread
+void ObserveFrameMetrics(void);                                                             // Count a frame and publish gauges periodically (render thread)
+void ObserveLoadMetrics(int kind, double seconds);                                          // Record a resource load latency
+void CloseMetrics(void);                                                                    // Stop exporter thread and close its socket
+
+static void InitMetricsHistogram(MetricsHistogram *histogram, const double *bounds, int count);     // Set histogram buckets bounds
+static void ObserveMetricsHistogram(MetricsHistogram *histogram, double seconds);           // Add an observation to histogram (lock-free)
+static void PublishMetricsGauges(void);                                                     // Publish VRAM, heap and state calls gauges (render thread)
+static int WriteMetricsPage(char *buffer, int size);                                        // Write metrics in Prometheus text format (returns length)
+static void AppendMetrics(char *buffer, int size, int *length, const char *format, ...);    // Append formatted text to metrics page
+static void AppendMetricsHistogram(char *buffer, int size, int *length, const char *name, const char *labels, MetricsHistogram *histogram);  // Append histogram series
+static void *MetricsThread(void *arg);                                                      // Accept scrapes and answer them
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Check --metrics option and start exporter thread
+void InitMetrics(int argc, char **argv)
+{
+    const char *option = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--metrics") == 0) && (i + 1 < argc)) option = argv[i + 1];
+    }
+
+    if (option == NULL) return;
+
+    InitMetricsHistogram(&metrics.frameTime, metricsFrameBounds, sizeof(metricsFrameBounds)/sizeof(double));
+    for (int i = 0; i < METRICS_LOAD_KINDS; i++) InitMetricsHistogram(&metrics.loads[i], metricsLoadBounds, sizeof(metricsLoadBounds)/sizeof(double));
+    metrics.vramTotal = -1;
+    metrics.vramAvailable = -1;
+
+#if defined(_WIN32)
+    TraceLog(LOG_WARNING, "Metrics exporter is not available on Windows");
+#else
+    if (strncmp(option, "unix:", 5) == 0)
+    {
+        struct sockaddr_un address = { 0 };
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, option + 5, sizeof(address.sun_path) - 1);
+        strncpy(metrics.socketPath, address.sun_path, sizeof(metrics.socketPath) - 1);
+        unlink(metrics.socketPath);
+
+        metrics.unixSocket = true;
+        metrics.listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if ((metrics.listener < 0) || (bind(metrics.listener, (struct sockaddr *)&address, sizeof(address)) != 0) || (listen(metrics.listener, 8) != 0))
+        {
+            TraceLog(LOG_WARNING, "[%s] Metrics exporter socket could not be created", metrics.socketPath);
+            if (metrics.listener >= 0) close(metrics.listener);
+            return;
+        }
+    }
+    else
+    {
+        struct sockaddr_in address = { 0 };
+        int reuse = 1;
+
+        metrics.port = (atoi(option) > 0) ? atoi(option) : METRICS_PORT;
+        address.sin_family = AF_INET;
+        address.sin_port = htons((unsigned short)metrics.port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        metrics.listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (metrics.listener >= 0) setsockopt(metrics.listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if ((metrics.listener < 0) || (bind(metrics.listener, (struct sockaddr *)&address, sizeof(address)) != 0) || (listen(metrics.listener, 8) != 0))
+        {
+            TraceLog(LOG_WARNING, "[127.0.0.1:%i] Metrics exporter socket could not be created", metrics.port);
+            if (metrics.listener >= 0) close(metrics.listener);
+            return;
+        }
+    }
+
+    metrics.enabled = true;
+    pthread_create(&metrics.thread, NULL, MetricsThread, NULL);
+
+    if (metrics.unixSocket) TraceLog(LOG_INFO, "[%s] Metrics exporter listening", metrics.socketPath);
+    else TraceLog(LOG_INFO, "[127.0.0.1:%i] Metrics exporter listening", metrics.port);
+#endif
+}
+
+// Count a frame and publish gauges periodically (render thread)
+// NOTE: frame time is measured between calls, so replay fixed timestep doesn't hide real frame times
+void ObserveFrameMetrics(void)
+{
+    if (!metrics.enabled) return;
+
+    double time = GetTime();
+
+    METRICS_ADD(&metrics.frames, 1);
+    if (metrics.lastFrame > 0.0) ObserveMetricsHistogram(&metrics.frameTime, time - metrics.lastFrame);
+    metrics.lastFrame = time;
+
+    if ((time - metrics.lastGauges) >= METRICS_GAUGES_INTERVAL)
+    {
+        PublishMetricsGauges();
+        metrics.lastGauges = time;
+    }
+}
+
+// Record a resource load latency
+void ObserveLoadMetrics(int kind, double seconds)
+{
+    if (!metrics.enabled || (kind < 0) || (kind >= METRICS_LOAD_KINDS)) return;
+
+    ObserveMetricsHistogram(&metrics.loads[kind], seconds);
+}
+
+// Stop exporter thread and close its socket
+void CloseMetrics(void)
+{
+    if (!metrics.enabled) return;
+
+#if !defined(_WIN32)
+    METRICS_STORE(&metrics.quit, 1);
+    pthread_join(metrics.thread, NULL);
+    close(metrics.listener);
+    if (metrics.unixSocket) unlink(metrics.socketPath);
+#endif
+
+    metrics.enabled = false;
+}
+
+// Set histogram buckets bounds
+static void InitMetricsHistogram(MetricsHistogram *histogram, const double *bounds, int count)
+{
+    histogram->bounds = bounds;
+    histogram->bucketsCount = (count < METRICS_MAX_BUCKETS) ? count : METRICS_MAX_BUCKETS;
+}
+
+// Add an observation to histogram (lock-free)
+static void ObserveMetricsHistogram(MetricsHistogram *histogram, double seconds)
+{
+    int bucket = histogram->bucketsCount - 1;
+
+    for (int i = 0; i < histogram->bucketsCount - 1; i++)
+    {
+        if (seconds <= histogram->bounds[i])
+        {
+            bucket = i;
+            break;
+        }
+    }
+
+    METRICS_ADD(&histogram->buckets[bucket], 1);
+    METRICS_ADD(&histogram->sumMicros, (unsigned long long)(((seconds > 0.0) ? seconds : 0.0)*1000000.0));
+}
+
+// Publish VRAM, heap and state calls gauges (render thread)
+// NOTE: VRAM queries need GL_NVX_gpu_memory_info or GL_ATI_meminfo (checked on first call)
+static void PublishMetricsGauges(void)
+{
+    if (!metrics.vramChecked)
+    {
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+        for (int i = 0; i < count; i++)
+        {
+            const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+
+            if (extension == NULL) continue;
+            else if (strcmp(extension, "GL_NVX_gpu_memory_info") == 0) metrics.vramSource = METRICS_VRAM_NVX;
+            else if ((strcmp(extension, "GL_ATI_meminfo") == 0) && (metrics.vramSource == METRICS_VRAM_NONE)) metrics.vramSource = METRICS_VRAM_ATI;
+        }
+
+        metrics.vramChecked = true;
+    }
+
+    if (metrics.vramSource == METRICS_VRAM_NVX)
+    {
+        int total = 0;
+        int available = 0;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+        METRICS_STORE(&metrics.vramTotal, (long long)total*1024);
+        METRICS_STORE(&metrics.vramAvailable, (long long)available*1024);
+    }
+    else if (metrics.vramSource == METRICS_VRAM_ATI)
+    {
+        int info[4] = { 0 };
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, info);
+        METRICS_STORE(&metrics.vramAvailable, (long long)info[0]*1024);
+    }
+
+    for (int i = 0; i < MEMORY_TAGS; i++)
+    {
+        MemoryStats stats = GetMemoryStats(i);
+        METRICS_STORE(&metrics.heapLive[i], (unsigned long long)stats.liveBytes);
+        METRICS_STORE(&metrics.heapPeak[i], (unsigned long long)stats.peakBytes);
+    }
+
+    METRICS_STORE(&metrics.stateIssued, GetStateIssuedGL());
+    METRICS_STORE(&metrics.stateElided, GetStateElidedGL());
+}
+
+// Write metrics in Prometheus text format (returns length)
+static int WriteMetricsPage(char *buffer, int size)
+{
+    int length = 0;
+
+    AppendMetrics(buffer, size, &length, "# HELP rpbr_frames_total Frames rendered.\n# TYPE rpbr_frames_total counter\n");
+    AppendMetrics(buffer, size, &length, "rpbr_frames_total %llu\n", METRICS_LOAD(&metrics.frames));
+
+    AppendMetrics(buffer, size, &length, "# HELP rpbr_frame_time_seconds Frame time.\n# TYPE rpbr_frame_time_seconds histogram\n");
+    AppendMetricsHistogram(buffer, size, &length, "rpbr_frame_time_seconds", "", &metrics.frameTime);
+
+    AppendMetrics(buffer, size, &length, "# HELP rpbr_load_seconds Resources load latency.\n# TYPE rpbr_load_seconds histogram\n");
+    for (int i = 0; i < METRICS_LOAD_KINDS; i++)
+    {
+        char labels[64] = { 0 };
+        snprintf(labels, sizeof(labels), "kind=\"%s\",", metricsLoadNames[i]);
+        AppendMetricsHistogram(buffer, size, &length, "rpbr_load_seconds", labels, &metrics.loads[i]);
+    }
+
+    long long vramTotal = METRICS_LOAD(&metrics.vramTotal);
+    long long vramAvailable = METRICS_LOAD(&metrics.vramAvailable);
+
+    if (vramTotal >= 0)
+    {
+        AppendMetrics(buffer, size, &length, "# HELP rpbr_vram_total_bytes Dedicated video memory.\n# TYPE rpbr_vram_total_bytes gauge\n");
+        AppendMetrics(buffer, size, &length, "rpbr_vram_total_bytes %lld\n", vramTotal);
+    }
+
+    if (vramAvailable >= 0)
+    {
+        AppendMetrics(buffer, size, &length, "# HELP rpbr_vram_available_bytes Available video memory.\n# TYPE rpbr_vram_available_bytes gauge\n");
+        AppendMetrics(buffer, size, &length, "rpbr_vram_available_bytes %lld\n", vramAvailable);
+    }
+
+    AppendMetrics(buffer, size, &length, "# HELP rpbr_heap_live_bytes Tracked heap bytes allocated per subsystem.\n# TYPE rpbr_heap_live_bytes gauge\n");
+    for (int i = 0; i < MEMORY_TAGS; i++) AppendMetrics(buffer, size, &length, "rpbr_heap_live_bytes{tag=\"%s\"} %llu\n", GetMemoryTagName(i), METRICS_LOAD(&metrics.heapLive[i]));
+
+    AppendMetrics(buffer, size, &length, "# HELP rpbr_heap_peak_bytes Tracked heap peak bytes per subsystem.\n# TYPE rpbr_heap_peak_bytes gauge\n");
+    for (int i = 0; i < MEMORY_TAGS; i++) AppendMetrics(buffer, size, &length, "rpbr_heap_peak_bytes{tag=\"%s\"} %llu\n", GetMemoryTagName(i), METRICS_LOAD(&metrics.heapPeak[i]));
+
+    AppendMetrics(buffer, size, &length, "# HELP rpbr_gl_state_calls OpenGL state calls in last frame.\n# TYPE rpbr_gl_state_calls gauge\n");
+    AppendMetrics(buffer, size, &length, "rpbr_gl_state_calls{result=\"issued\"} %i\n", METRICS_LOAD(&metrics.stateIssued));
+    AppendMetrics(buffer, size, &length, "rpbr_gl_state_calls{result=\"elided\"} %i\n", METRICS_LOAD(&metrics.stateElided));
+
+    return length;
+}
+
+// Append formatted text to metrics page
+static void AppendMetrics(char *buffer, int size, int *length, const char *format, ...)
+{
+    if (*length >= size - 1) return;
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + *length, size - *length, format, args);
+    va_end(args);
+
+    if (written > 0) *length = ((*length + written) < size - 1) ? (*length + written) : (size - 1);
+}
+
+// Append histogram series
+// NOTE: buckets are stored per range and written cumulative, count is taken from buckets so +Inf matches it
+static void AppendMetricsHistogram(char *buffer, int size, int *length, const char *name, const char *labels, MetricsHistogram *histogram)
+{
+    unsigned long long cumulative = 0;
+
+    for (int i = 0; i < histogram->bucketsCount; i++)
+    {
+        cumulative += METRICS_LOAD(&histogram->buckets[i]);
+
+        if (i < histogram->bucketsCount - 1) AppendMetrics(buffer, size, length, "%s_bucket{%sle=\"%g\"} %llu\n", name, labels, histogram->bounds[i], cumulative);
+        else AppendMetrics(buffer, size, length, "%s_bucket{%sle=\"+Inf\"} %llu\n", name, labels, cumulative);
+    }
+
+    // Remove trailing comma from labels for sum and count series
+    char plain[64] = { 0 };
+    int labelsLength = (int)strlen(labels);
+    if (labelsLength > 0) snprintf(plain, sizeof(plain), "{%.*s}", labelsLength - 1, labels);
+
+    AppendMetrics(buffer, size, length, "%s_sum%s %.6f\n", name, plain, METRICS_LOAD(&histogram->sumMicros)/1000000.0);
+    AppendMetrics(buffer, size, length, "%s_count%s %llu\n", name, plain, cumulative);
+}
+
+// Accept scrapes and answer them
+// NOTE: select() timeout lets the thread notice quit requests without closing the socket under it
+static void *MetricsThread(void *arg)
+{
+    (void)arg;
+
+#if !defined(_WIN32)
+    static char response[METRICS_RESPONSE_SIZE + 256];
+    static char page[METRICS_RESPONSE_SIZE];
+
+    while (!METRICS_LOAD(&metrics.quit))
+    {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(metrics.listener, &readable);
+        struct timeval timeout = { 0, METRICS_ACCEPT_TIMEOUT*1000 };
+
+        if (select(metrics.listener + 1, &readable, NULL, NULL, &timeout) <= 0) continue;
+
+        int client = accept(metrics.listener, NULL, NULL);
+        if (client < 0) continue;
+
+        struct timeval receiveTimeout = { 1, 0 };
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &receiveTimeout, sizeof(receiveTimeout));
+
+        // Read request until headers end (only request line is used)
+        char request[METRICS_REQUEST_SIZE] = { 0 };
+        int received = 0;
+
+        while (received < METRICS_REQUEST_SIZE - 1)
+        {
+            int count = (int)recv(client, request + received, METRICS_REQUEST_SIZE - 1 - received, 0);
+            if (count <= 0) break;
+            received += count;
+            request[received] = '\0';
+            if (strstr(request, "\r\n\r\n") != NULL) break;
+        }
+
+        int length = 0;
+
+        if ((strncmp(request, "GET /metrics ", 13) == 0) || (strncmp(request, "GET /metrics?", 13) == 0))
+        {
+            int pageLength = WriteMetricsPage(page, sizeof(page));
+            length = snprintf(response, sizeof(response), "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %i\r\nConnection: close\r\n\r\n%s", pageLength, page);
+        }
+        else length = snprintf(response, sizeof(response), "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 21\r\nConnection: close\r\n\r\nTry GET /metrics path");
+
+        for (int sent = 0; sent < length;)
+        {
+            int count = (int)send(client, response + sent, length - sent, METRICS_SEND_FLAGS);
+            if (count <= 0) break;
+            sent += count;
+        }
+
+        close(client);
+    }
+#endif
+
+    return NULL;
+}
@@ -0,0 +1,438 @@
+/***********************************************************************************
+*
+*   rPBR [package] - Cooked asset packages loading (written by rpbrcook)
+*
+*   FEATURES:
+*       - Package opened with a single read-only memory map: fixed header and entries table
+*         pointing to aligned blobs, nothing is parsed or decoded.
+*       - Model vertex streams (positions, texture coordinates, normals and tangents) ready to upload,
+*         no OBJ parsing or tangents generation.
+*       - Textures with complete mipmaps chains (DXT1/DXT5 compressed colors, single channel maps)
+*         uploaded straight from mapped memory.
+*       - Roughness mipmaps already filtered with normal map variance (no specular filter at load).
+*       - Environment cubemap, irradiance, prefilter and BRDF LUT baked by cooker and uploaded as they are
+*         (no HDR decoding or bake passes, only environment shaders are compiled).
+*       - Interface thumbnails stored next to textures (compressed textures can't be read back).
+*
+*   NOTES:
+*       Packages are written by rpbrcook tool (src/rpbrcook.c), drop a .rpk file into viewer to load it.
+*       Package layout: PackageHeader, PackageEntry table and blobs aligned to PACKAGE_ALIGNMENT bytes.
+*       Values are stored in little endian byte order (same as every supported platform).
+*       Package can be closed once its resources are loaded, loaded resources don't reference mapped memory.
+*       Compressed textures require S3TC support (EXT_texture_compression_s3tc, available on desktop GPUs).
+*       Model meshes are not indexed (wireframe drawing uses vertices order), like raylib OBJ meshes.
+*
+*   DEPENDENCIES:
+*       pbrcore.h for OpenGL API, environments, files mapping and tracked allocations (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdlib.h>                         // Required for: malloc()
+#include <string.h>                         // Required for: memcmp(), memcpy()
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         PACKAGE_MAGIC               "RPK1"                                  // Package file identifier
+#define         PACKAGE_VERSION             1                                       // Package layout version (packages with other versions are cooked again)
+#define         PACKAGE_ALIGNMENT           64                                      // Blobs alignment in bytes
+#define         PACKAGE_MAX_ENTRIES         32                                      // Max entries in a package
+
+#if !defined(GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+    #define     GL_COMPRESSED_RGB_S3TC_DXT1_EXT     0x83F0
+    #define     GL_COMPRESSED_RGBA_S3TC_DXT5_EXT    0x83F3
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef enum PackageEntryType {
+    PACKAGE_MESH = 1,                       // Params: vertices count. Blob: positions, texcoords, normals and tangents streams (3, 2, 3 and 3 floats)
+    PACKAGE_TEXTURE,                        // Slot: TypePBR. Params: width, height, mipmaps and raylib format. Blob: mipmaps from biggest level
+    PACKAGE_THUMBNAIL,                      // Slot: TypePBR. Params: width and height. Blob: RGBA8 pixels
+    PACKAGE_ENVIRONMENT                     // Params: cubemap, irradiance, prefilter and BRDF sizes. Blob: cubemap (all mipmaps), irradiance and
+                                            // prefilter (MAX_MIPMAP_LEVELS) faces per level as RGB16F, then BRDF LUT as RG16F
+} PackageEntryType;
+
+typedef struct PackageHeader {
+    char magic[4];                          // Package file identifier (PACKAGE_MAGIC)
+    unsigned int version;                   // Package layout version (PACKAGE_VERSION)
+    unsigned int entriesCount;              // Entries in table following header
+    unsigned int alignment;                 // Blobs alignment in bytes
+    unsigned long long size;                // Package file size (detects truncated files)
+} PackageHeader;
+
+typedef struct PackageEntry {
+    unsigned int type;                      // Entry type (PackageEntryType)
+    unsigned int slot;                      // Texture type (TypePBR) for textures and thumbnails
+    int params[4];                          // Entry type parameters (see PackageEntryType)
+    unsigned long long offset;              // Blob offset from package start (aligned)
+    unsigned long long size;                // Blob size in bytes
+    unsigned long long hash;                // Dependencies hash (sources contents and cook settings, used by rpbrcook)
+} PackageEntry;
+
+typedef struct Package {
+    MappedFile file;                        // Mapped package file (data is NULL if package could not be opened)
+    PackageEntry *entries;                  // Entries table (inside mapped memory)
+    int entriesCount;
+} Package;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+Package OpenPackage(const char *fileName);                                          // Map a package file and validate its header and entries table
+PackageEntry *FindPackageEntry(Package package, int type, int slot);                // Find a package entry (NULL if package has no such entry)
+Model LoadPackageModel(Package package);                                            // Load package model (vertex count is 0 if package has no model)
+Texture2D LoadPackageTexture(Package package, TypePBR type);                        // Load package texture with its mipmaps (id is 0 if package has no such texture)
+Texture2D LoadPackageThumbnail(Package package, TypePBR type, int size);            // Load package texture thumbnail resized to interface size (id is 0 if missing)
+Environment LoadPackageEnvironment(Package package);                                // Load package baked environment (cubemap id is 0 if package has no environment)
+void ClosePackage(Package *package);                                                // Unmap package file
+int GetPackageLevelSize(int width, int height, int format);                         // Get a texture mipmap level size in bytes (DXT1, DXT5, grayscale or RGBA8)
+int GetPackageMipmapsCount(int width, int height);                                  // Get mipmaps count of a complete chain (down to 1x1)
+
+static unsigned int LoadPackageCubemap(unsigned char **data, int size, int levels);  // Upload a RGB16F cubemap from package data (advances data pointer)
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Map a package file and validate its header and entries table
+Package OpenPackage(const char *fileName)
+{
+    Package package = { 0 };
+
+    package.file = MapFile(fileName);
+
+    if (package.file.data == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] Package could not be opened", fileName);
+        ClosePackage(&package);
+        return package;
+    }
+
+    // Validate header and entries table (all blobs must be inside mapped file)
+    PackageHeader *header = (PackageHeader *)package.file.data;
+    bool valid = (package.file.size >= sizeof(PackageHeader)) && (memcmp(header->magic, PACKAGE_MAGIC, 4) == 0) && (header->version == PACKAGE_VERSION) &&
+                 (header->size == package.file.size) && (header->entriesCount <= PACKAGE_MAX_ENTRIES) &&
+                 (sizeof(PackageHeader) + header->entriesCount*sizeof(PackageEntry) <= package.file.size);
+
+    if (valid)
+    {
+        package.entries = (PackageEntry *)(package.file.data + sizeof(PackageHeader));
+        package.entriesCount = header->entriesCount;
+
+        for (int i = 0; (i < package.entriesCount) && valid; i++)
+        {
+            valid = (package.entries[i].offset%PACKAGE_ALIGNMENT == 0) && (package.entries[i].offset <= package.file.size) &&
+                    (package.entries[i].size <= package.file.size - package.entries[i].offset);
+        }
+    }
+
+    if (!valid)
+    {
+        TraceLog(LOG_WARNING, "[%s] Package is not valid or was cooked by a different version", fileName);
+        ClosePackage(&package);
+    }
+
+    return package;
+}
+
+// Find a package entry (NULL if package has no such entry)
+PackageEntry *FindPackageEntry(Package package, int type, int slot)
+{
+    for (int i = 0; i < package.entriesCount; i++)
+    {
+        if ((package.entries[i].type == (unsigned int)type) && (package.entries[i].slot == (unsigned int)slot)) return &package.entries[i];
+    }
+
+    return NULL;
+}
+
+// Load package model (vertex count is 0 if package has no model)
+// NOTE: streams are copied to heap because raylib releases meshes data with free() and software renderer reads them
+Model LoadPackageModel(Package package)
+{
+    Model model = { 0 };
+    PackageEntry *entry = FindPackageEntry(package, PACKAGE_MESH, 0);
+
+    if ((entry == NULL) || (entry->size != (unsigned long long)entry->params[0]*11*sizeof(float))) return model;
+
+    Mesh mesh = { 0 };
+    mesh.vertexCount = entry->params[0];
+    mesh.triangleCount = mesh.vertexCount/3;
+
+    // Split blob in vertex streams
+    float *streams = (float *)(package.file.data + entry->offset);
+    float **targets[4] = { &mesh.vertices, &mesh.texcoords, &mesh.normals, &mesh.tangents };
+    int components[4] = { 3, 2, 3, 3 };
+    int locations[4] = { 0, 1, 2, 4 };                  // raylib default attributes locations (position, texcoord, normal, tangent)
+    int buffers[4] = { 0, 1, 2, 4 };                    // raylib mesh buffers indices
+
+    glGenVertexArrays(1, &mesh.vaoId);
+    glBindVertexArray(mesh.vaoId);
+
+    for (int i = 0; i < 4; i++)
+    {
+        size_t size = mesh.vertexCount*components[i]*sizeof(float);
+        *targets[i] = (float *)malloc(size);
+        memcpy(*targets[i], streams, size);
+
+        glGenBuffers(1, &mesh.vboId[buffers[i]]);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vboId[buffers[i]]);
+        glBufferData(GL_ARRAY_BUFFER, size, streams, GL_STATIC_DRAW);
+        glVertexAttribPointer(locations[i], components[i], GL_FLOAT, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(locations[i]);
+
+        streams += mesh.vertexCount*components[i];
+    }
+
+    // Meshes have no vertex colors, raylib uses white color in that case
+    glVertexAttrib4f(3, 1.0f, 1.0f, 1.0f, 1.0f);
+    glDisableVertexAttribArray(3);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    model.mesh = mesh;
+    model.transform = MatrixIdentity();
+    model.material.shader = GetDefaultShader();
+
+    TraceLog(LOG_INFO, "[VAO ID %i] Package mesh loaded (%i vertices)", mesh.vaoId, mesh.vertexCount);
+
+    return model;
+}
+
+// Load package texture with its mipmaps (id is 0 if package has no such texture)
+// NOTE: single channel textures are swizzled to gray colors, as raylib does with grayscale images
+Texture2D LoadPackageTexture(Package package, TypePBR type)
+{
+    Texture2D texture = { 0 };
+    PackageEntry *entry = FindPackageEntry(package, PACKAGE_TEXTURE, type);
+
+    if (entry == NULL) return texture;
+
+    texture.width = entry->params[0];
+    texture.height = entry->params[1];
+    texture.mipmaps = entry->params[2];
+    texture.format = entry->params[3];
+
+    // Check blob contains every level
+    unsigned long long size = 0;
+    for (int i = 0; i < texture.mipmaps; i++) size += GetPackageLevelSize((texture.width >> i) ? (texture.width >> i) : 1, (texture.height >> i) ? (texture.height >> i) : 1, texture.format);
+    if (size != entry->size) return (Texture2D){ 0 };
+
+    unsigned char *data = package.file.data + entry->offset;
+    int width = texture.width;
+    int height = texture.height;
+
+    glGenTextures(1, &texture.id);
+    BindTextureGL(0, GL_TEXTURE_2D, texture.id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (int i = 0; i < texture.mipmaps; i++)
+    {
+        int levelSize = GetPackageLevelSize(width, height, texture.format);
+
+        switch (texture.format)
+        {
+            case UNCOMPRESSED_GRAYSCALE: glTexImage2D(GL_TEXTURE_2D, i, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, data); break;
+            case UNCOMPRESSED_R8G8B8A8: glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data); break;
+            case COMPRESSED_DXT1_RGB: glCompressedTexImage2D(GL_TEXTURE_2D, i, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, width, height, 0, levelSize, data); break;
+            case COMPRESSED_DXT5_RGBA: glCompressedTexImage2D(GL_TEXTURE_2D, i, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, width, height, 0, levelSize, data); break;
+            default: break;
+        }
+
+        data += levelSize;
+        width = (width > 1) ? width/2 : 1;
+        height = (height > 1) ? height/2 : 1;
+    }
+
+    if (texture.format == UNCOMPRESSED_GRAYSCALE)
+    {
+        GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.mipmaps - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ((texture.mipmaps > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+
+    TraceLog(LOG_INFO, "[TEX ID %i] Package texture loaded (%ix%i, %i mipmaps)", texture.id, texture.width, texture.height, texture.mipmaps);
+
+    return texture;
+}
+
+// Load package texture thumbnail resized to interface size (id is 0 if missing)
+Texture2D LoadPackageThumbnail(Package package, TypePBR type, int size)
+{
+    Texture2D thumbnail = { 0 };
+    PackageEntry *entry = FindPackageEntry(package, PACKAGE_THUMBNAIL, type);
+
+    if ((entry == NULL) || (entry->size != (unsigned long long)entry->params[0]*entry->params[1]*4)) return thumbnail;
+
+    // Resize a copy (mapped memory is read-only)
+    Image image = { package.file.data + entry->offset, entry->params[0], entry->params[1], 1, UNCOMPRESSED_R8G8B8A8 };
+    image = ImageCopy(image);
+    ImageResize(&image, size, size);
+
+    thumbnail = LoadTextureFromImage(image);
+    SetTextureFilter(thumbnail, FILTER_BILINEAR);
+    UnloadImage(image);
+
+    return thumbnail;
+}
+
+// Load package baked environment (cubemap id is 0 if package has no environment)
+Environment LoadPackageEnvironment(Package package)
+{
+    Environment env = { 0 };
+    PackageEntry *entry = FindPackageEntry(package, PACKAGE_ENVIRONMENT, 0);
+
+    if (entry == NULL) return env;
+
+    int cubemapSize = entry->params[0];
+    int irradianceSize = entry->params[1];
+    int prefilterSize = entry->params[2];
+    int brdfSize = entry->params[3];
+
+    // Check blob contains every level of every texture
+    unsigned long long size = (unsigned long long)brdfSize*brdfSize*4;
+    for (int i = 0; i < GetPackageMipmapsCount(cubemapSize, cubemapSize); i++) size += 6*(unsigned long long)((cubemapSize >> i)*(cubemapSize >> i))*6;
+    size += 6*(unsigned long long)irradianceSize*irradianceSize*6;
+    for (int i = 0; i < MAX_MIPMAP_LEVELS; i++) size += 6*(unsigned long long)((prefilterSize >> i)*(prefilterSize >> i))*6;
+
+    if ((prefilterSize >> (MAX_MIPMAP_LEVELS - 1)) < 1) size = 0;
+    if (size != entry->size)
+    {
+        TraceLog(LOG_WARNING, "Package environment size does not match its dimensions");
+        return env;
+    }
+
+    BeginMemoryScope(MEMORY_ENVIRONMENT);
+
+    // Environment shaders are the only work left (same set up than baked environments)
+    SetupEnvironmentShaders(&env);
+
+    unsigned char *data = package.file.data + entry->offset;
+    InvalidateStateGL();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    env.cubemapId = LoadPackageCubemap(&data, cubemapSize, GetPackageMipmapsCount(cubemapSize, cubemapSize));
+    env.irradianceId = LoadPackageCubemap(&data, irradianceSize, 1);
+    env.prefilterId = LoadPackageCubemap(&data, prefilterSize, MAX_MIPMAP_LEVELS);
+
+    glGenTextures(1, &env.brdfId);
+    BindTextureGL(0, GL_TEXTURE_2D, env.brdfId);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, brdfSize, brdfSize, 0, GL_RG, GL_HALF_FLOAT, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    EndMemoryScope();
+
+    TraceLog(LOG_INFO, "Package environment loaded: cubemap %i, irradiance %i, prefilter %i, BRDF %i", cubemapSize, irradianceSize, prefilterSize, brdfSize);
+
+    return env;
+}
+
+// Unmap package file
+void ClosePackage(Package *package)
+{
+    UnmapFile(&package->file);
+    *package = (Package){ 0 };
+}
+
+// Get a texture mipmap level size in bytes (DXT1, DXT5, grayscale or RGBA8)
+int GetPackageLevelSize(int width, int height, int format)
+{
+    int size = 0;
+
+    switch (format)
+    {
+        case UNCOMPRESSED_GRAYSCALE: size = width*height; break;
+        case UNCOMPRESSED_R8G8B8A8: size = width*height*4; break;
+        case COMPRESSED_DXT1_RGB: size = ((width + 3)/4)*((height + 3)/4)*8; break;
+        case COMPRESSED_DXT5_RGBA: size = ((width + 3)/4)*((height + 3)/4)*16; break;
+        default: break;
+    }
+
+    return size;
+}
+
+// Get mipmaps count of a complete chain (down to 1x1)
+int GetPackageMipmapsCount(int width, int height)
+{
+    int count = 1;
+
+    while ((width > 1) || (height > 1))
+    {
+        width = (width > 1) ? width/2 : 1;
+        height = (height > 1) ? height/2 : 1;
+        count++;
+    }
+
+    return count;
+}
+
+// Upload a RGB16F cubemap from package data (advances data pointer)
+// NOTE: faces of each level are stored consecutively, from biggest level
+static unsigned int LoadPackageCubemap(unsigned char **data, int size, int levels)
+{
+    unsigned int id = 0;
+
+    glGenTextures(1, &id);
+    BindTextureGL(0, GL_TEXTURE_CUBE_MAP, id);
+
+    for (int i = 0; i < levels; i++)
+    {
+        int levelSize = ((size >> i) > 1) ? (size >> i) : 1;
+
+        for (int face = 0; face < 6; face++)
+        {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, i, GL_RGB16F, levelSize, levelSize, 0, GL_RGB, GL_HALF_FLOAT, *data);
+            *data += levelSize*levelSize*6;
+        }
+    }
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, ((levels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    BindTextureGL(0, GL_TEXTURE_CUBE_MAP, 0);
+
+    return id;
+}
@@ -0,0 +1,1522 @@
+/***********************************************************************************
+*
+*   rPBR [points] - Point cloud octree building, streaming and drawing functions for raylib
+*
+*   FEATURES:
+*       - Offline octree building from XYZ/PTS text files and PLY files (ASCII or binary).
+*       - Out-of-core building: points are bucketed into chunks on disk and each chunk subtree is built in memory.
+*       - Octree building on a worker thread, point cloud loaded when its octree file is ready.
+*       - Per-node grid subsampling: every node stores a uniform subset, children store the rest.
+*       - Nodes streamed from disk by screen-space error under a global points budget.
+*       - Round splats lit by environment irradiance and prefiltered reflection maps.
+*
+*   NOTES:
+*       Octree files (.rpo) are built once next to the source point cloud and reused later.
+*       Building streams source points through two temporary files next to the octree file (removed when finished),
+*       so memory usage is bounded by POINTCLOUD_CHUNK_MAX points instead of the whole point cloud.
+*       Nodes are read from disk by a worker thread and uploaded to GPU from the main thread.
+*       Remember to call UnloadPointCloud to close octree file and unload GPU buffers
+*
+*   DEPENDENCIES:
+*       pbrcore.h for environment textures, camera matrix and tracked allocations (must be included before this file)
+*       pthreads for background nodes loading
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdio.h>                          // Required for: FILE, fopen(), fread(), fwrite(), fgets()
+#include <stdlib.h>                         // Required for: strtod()
+#include <string.h>                         // Required for: strcmp(), strncmp(), memset(), strlen()
+#include <pthread.h>                        // Required for: pthread_create(), pthread_mutex_lock(), pthread_cond_wait()
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         POINTCLOUD_GRID_SIZE        32                                      // Subsampling grid cells per axis of each octree node
+#define         POINTCLOUD_NODE_MAX         20000                                   // Max points stored in a leaf node
+#define         POINTCLOUD_MAX_LEVEL        20                                      // Max octree depth (avoids infinite splits of duplicated points)
+#define         POINTCLOUD_BUDGET           2000000                                 // Max points drawn per frame
+#define         POINTCLOUD_CACHE            6000000                                 // Max points kept in GPU memory before evicting unused nodes
+#define         POINTCLOUD_MAX_ERROR        1.5f                                    // Max projected points spacing in pixels before refining a node
+#define         POINTCLOUD_MAX_UPLOADS      8                                       // Max nodes uploaded to GPU per frame
+#define         POINTCLOUD_MAX_EVICTIONS    16                                      // Max nodes unloaded from GPU per frame
+#define         POINTCLOUD_SIZE             3.0f                                    // World size of the point cloud biggest dimension
+#define         POINTCLOUD_ROUGHNESS        0.8f                                    // Roughness used to light point cloud splats
+#define         POINTCLOUD_CHUNK_MAX        (1024*1024)                             // Max points of an octree chunk built in memory
+#define         POINTCLOUD_COUNT_LEVEL      6                                       // Octree level of the points counting grid used to split chunks
+#define         POINTCLOUD_BUCKET_POINTS    256                                     // Max points buffered per chunk before writing them to chunks file
+#define         POINTCLOUD_BATCH_POINTS     4096                                    // Points read or written at once from octree build files
+#define         POINTCLOUD_POOL_BLOCKS      (2*POINTCLOUD_MAX_UPLOADS)              // Loaded nodes points buffers kept in loader pool
+#define         POINTCLOUD_POOL_POINTS      (POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE)    // Loader pool block points (inner nodes max points)
+
+#define         PATH_POINTS_VS              "resources/shaders/points.vs"           // Path to point cloud splats vertex shader
+#define         PATH_POINTS_FS              "resources/shaders/points.fs"           // Path to point cloud splats fragment shader
+
+#if defined(_WIN32)
+    #define     POINTCLOUD_FSEEK(file, offset)      _fseeki64(file, offset, SEEK_SET)
+#else
+    #define     POINTCLOUD_FSEEK(file, offset)      fseeko(file, (off_t)(offset), SEEK_SET)
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef enum {
+    NODE_UNLOADED,
+    NODE_QUEUED,
+    NODE_LOADED,
+    NODE_RESIDENT
+} NodeState;
+
+// Point vertex layout (same in octree file and GPU buffers)
+typedef struct PointVertex {
+    float position[3];
+    unsigned char color[4];
+    short normal[2];                        // Octahedron encoded normal
+} PointVertex;
+
+typedef struct PointCloudHeader {
+    char magic[4];                          // Octree file identifier: "RPO1"
+    int nodesCount;
+    unsigned int pointsCount;
+    int hasNormals;
+    float min[3];                           // Points bounding box minimum
+    float max[3];                           // Points bounding box maximum
+} PointCloudHeader;
+
+typedef struct PointNode {
+    float min[3];                           // Node bounding cube minimum corner
+    float size;                             // Node bounding cube size
+    unsigned int offset;                    // Node first point index in points block
+    unsigned int count;                     // Node stored points count
+    int children[8];                        // Child nodes indices (-1 if empty)
+} PointNode;
+
+typedef struct PointNodeState {
+    NodeState state;
+    unsigned int lastUsed;                  // Last frame node was selected
+    int parent;
+    bool refined;                           // Any child node is drawn this frame
+    PointVertex *data;                      // Loaded points waiting for GPU upload
+    unsigned int vaoId;
+    unsigned int vboId;
+} PointNodeState;
+
+typedef struct PointLoader {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    FILE *file;
+    long long pointsOffset;
+    PointNode *nodes;
+    PointNodeState *states;
+    int *requests;                          // Ring buffer of nodes to read from disk
+    int requestsHead;
+    int requestsTail;
+    int *loaded;                            // Ring buffer of nodes ready to upload
+    int loadedHead;
+    int loadedTail;
+    int capacity;
+    MemoryPool pool;                        // Nodes points buffers (used under loader mutex)
+    bool quit;
+} PointLoader;
+
+typedef struct PointCloud {
+    int nodesCount;
+    unsigned int pointsCount;
+    bool hasNormals;
+    PointNode *nodes;
+    PointNodeState *states;
+    PointLoader *loader;
+
+    int *visible;                           // Nodes drawn in current frame
+    int visibleCount;
+    int *heap;                              // Traversal priority queue
+    float *priority;
+    unsigned int frame;
+    unsigned int pointsVisible;
+    unsigned int pointsResident;
+
+    Vector3 offset;                         // Point cloud to world translation (applied before scale)
+    float scale;                            // Point cloud to world uniform scale
+    Matrix transform;
+
+    Shader shader;
+    int mvpLoc;
+    int modelLoc;
+    int viewLoc;
+    int pointScaleLoc;
+    int splatSizeLoc;
+    int useNormalsLoc;
+    int roughnessLoc;
+} PointCloud;
+
+// Octree build chunk (chunks above POINTCLOUD_CHUNK_MAX points are split and subsampled while streaming points)
+typedef struct PointChunk {
+    float min[3];                           // Chunk bounding cube minimum corner
+    float size;                             // Chunk bounding cube size
+    int level;                              // Chunk octree level
+    int children[8];                        // Child chunks indices (-1 if empty)
+    unsigned char *grid;                    // Subsampling grid occupancy bits (NULL if chunk is built in memory)
+    unsigned int count;                     // Chunk bucket points (subsampled points if chunk is split)
+    unsigned int written;                   // Chunk bucket points already written to chunks file
+    long long offset;                       // Chunk bucket first point in chunks file
+    PointVertex *buffer;                    // Chunk bucket points waiting to be written
+    int buffered;
+} PointChunk;
+
+typedef struct PointCloudBuild {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    bool finished;                          // Octree file built or failed (protected by mutex)
+    bool success;                           // Octree file ready to load (protected by mutex)
+    bool cancel;                            // Building canceled by main thread (protected by mutex)
+    bool joined;                            // Building thread already joined
+    char fileName[512];                     // Source point cloud file
+    char octreeName[512];                   // Octree file built next to source point cloud
+} PointCloudBuild;
+
+// Octree build points writer (converts source points into a raw points file)
+typedef struct PointWriter {
+    FILE *file;
+    PointVertex *batch;                     // Points waiting to be written (POINTCLOUD_BATCH_POINTS)
+    int batchCount;
+    PointCloudHeader *header;               // Points count and bounding box updated on every point
+    PointCloudBuild *build;                 // Build checked for cancellation on every batch (can be NULL)
+} PointWriter;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+bool BuildPointCloud(const char *fileName, const char *octreeName);                 // Build an octree file from a XYZ, PTS or PLY point cloud
+PointCloudBuild *StartPointCloudBuild(const char *fileName);                        // Start building point cloud octree file in background (if it is not built yet)
+bool UpdatePointCloudBuild(PointCloudBuild *build, PointCloud *cloud);              // Load point cloud when octree file is ready (returns true and unloads build when finished)
+void StopPointCloudBuild(PointCloudBuild *build);                                   // Cancel octree building and unload build
+PointCloud LoadPointCloud(const char *fileName);                                    // Load a point cloud octree (built if source is not an octree file)
+void UpdatePointCloud(PointCloud *cloud, Camera camera, Vector2 res);               // Select nodes to draw by screen-space error and stream missing ones
+void DrawPointCloud(PointCloud cloud, Environment env, Camera camera, Vector2 res); // Draw selected point cloud nodes as lit splats
+void UnloadPointCloud(PointCloud cloud);                                            // Stop nodes streaming and unload point cloud GPU buffers
+
+static bool BuildPointOctree(const char *fileName, const char *octreeName, PointCloudBuild *build);   // Build an octree file out-of-core (build can be NULL)
+static bool ReadPointsText(const char *fileName, PointWriter *writer, bool *hasNormals);      // Read points from a XYZ or PTS text file
+static bool ReadPointsPLY(const char *fileName, PointWriter *writer, bool *hasNormals);       // Read points from an ASCII or binary little endian PLY file
+static bool WritePoint(PointWriter *writer, PointVertex *point);                    // Add a point to raw points file (returns false if writing failed or was canceled)
+static bool FlushPoints(PointWriter *writer);                                       // Write points waiting in writer batch
+static int BuildPointChunk(float *min, float size, int level, int cx, int cy, int cz);        // Split points counting grid cells into chunks
+static int FindPointChunk(PointVertex *point, float *rootMin, float rootSize);      // Find point chunk bucket, subsampling it into split chunks on the way down
+static bool FlushPointChunk(PointChunk *chunk, FILE *file);                         // Write chunk buffered points to its bucket
+static int BuildChunkNodes(int index, MemoryArena *arena, FILE *chunksFile, FILE *pointsFile, unsigned int *written, PointCloudBuild *build);   // Build octree nodes of a chunk and write its points
+static int BuildPointNode(PointVertex *points, unsigned int begin, unsigned int end, float *min, float size, int level);   // Subsample and split points into an octree node
+static int PushPointNode(PointNode node);                                           // Add a node to octree being built (returns -1 if allocation failed)
+static void GetPointCell(PointVertex *point, float *min, float size, int resolution, int *cell);  // Get point cell coordinates in a grid covering a bounding cube
+static bool IsPointCloudBuildCanceled(PointCloudBuild *build);                      // Check if octree building was canceled (build can be NULL)
+static void EncodePointNormal(PointVertex *point, float x, float y, float z);       // Encode normal with octahedron mapping into point
+static void *PointCloudBuildThread(void *arg);                                      // Build octree file if it does not exist yet
+static void *PointLoaderThread(void *arg);                                          // Read requested nodes points from octree file
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+// NOTE: octree building state is owned by a single building thread (StopPointCloudBuild() joins it before starting another one)
+static PointNode *buildNodes = NULL;                // Octree nodes being built
+static int buildNodesCount = 0;                     // Octree nodes being built count
+static int buildNodesCapacity = 0;                  // Octree nodes being built allocated count
+static unsigned char *buildGrid = NULL;             // Subsampling grid occupancy bits
+static PointChunk *buildChunks = NULL;              // Octree chunks being built
+static int buildChunksCount = 0;                    // Octree chunks being built count
+static int buildChunksCapacity = 0;                 // Octree chunks being built allocated count
+static unsigned int *buildCounts = NULL;            // Points counting grid (2^POINTCLOUD_COUNT_LEVEL cells per axis)
+static bool buildFailed = false;                    // Octree building allocation, reading or writing failed
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Build an octree file from a XYZ, PTS or PLY point cloud
+bool BuildPointCloud(const char *fileName, const char *octreeName)
+{
+    return BuildPointOctree(fileName, octreeName, NULL);
+}
+
+// Start building point cloud octree file in background (if it is not built yet)
+// NOTE: returns NULL if build could not be started
+PointCloudBuild *StartPointCloudBuild(const char *fileName)
+{
+    PointCloudBuild *build = (PointCloudBuild *)PBR_CALLOC(MEMORY_MODEL, 1, sizeof(PointCloudBuild));
+    if (build == NULL) return NULL;
+
+    snprintf(build->fileName, sizeof(build->fileName), "%s", fileName);
+    if (IsFileExtension(fileName, ".rpo")) snprintf(build->octreeName, sizeof(build->octreeName), "%s", fileName);
+    else snprintf(build->octreeName, sizeof(build->octreeName), "%s.rpo", fileName);
+
+    pthread_mutex_init(&build->mutex, NULL);
+
+    if (pthread_create(&build->thread, NULL, PointCloudBuildThread, build) != 0)
+    {
+        TraceLog(LOG_WARNING, "[%s] Point cloud octree building thread could not be started", fileName);
+        pthread_mutex_destroy(&build->mutex);
+        PBR_FREE(build);
+        return NULL;
+    }
+
+    return build;
+}
+
+// Load point cloud when octree file is ready (returns true and unloads build when finished)
+bool UpdatePointCloudBuild(PointCloudBuild *build, PointCloud *cloud)
+{
+    pthread_mutex_lock(&build->mutex);
+    bool finished = build->finished;
+    bool success = build->success;
+    pthread_mutex_unlock(&build->mutex);
+
+    if (!finished) return false;
+
+    pthread_join(build->thread, NULL);
+    build->joined = true;
+
+    // Octree nodes and GPU buffers are loaded from main thread
+    if (success) *cloud = LoadPointCloud(build->octreeName);
+
+    StopPointCloudBuild(build);
+
+    return true;
+}
+
+// Cancel octree building and unload build
+void StopPointCloudBuild(PointCloudBuild *build)
+{
+    pthread_mutex_lock(&build->mutex);
+    build->cancel = true;
+    pthread_mutex_unlock(&build->mutex);
+
+    if (!build->joined) pthread_join(build->thread, NULL);
+
+    pthread_mutex_destroy(&build->mutex);
+    PBR_FREE(build);
+}
+
+// Load a point cloud octree (built if source is not an octree file)
+PointCloud LoadPointCloud(const char *fileName)
+{
+    PointCloud cloud = { 0 };
+    char octreeName[512] = { 0 };
+
+    // Build octree file next to source point cloud if it does not exist yet
+    if (!IsFileExtension(fileName, ".rpo"))
+    {
+        snprintf(octreeName, sizeof(octreeName), "%s.rpo", fileName);
+
+        FILE *existing = fopen(octreeName, "rb");
+        if (existing != NULL) fclose(existing);
+        else if (!BuildPointCloud(fileName, octreeName)) return cloud;
+    }
+    else snprintf(octreeName, sizeof(octreeName), "%s", fileName);
+
+    FILE *file = fopen(octreeName, "rb");
+    if (file == NULL) return cloud;
+
+    PointCloudHeader header = { 0 };
+
+    if ((fread(&header, sizeof(PointCloudHeader), 1, file) != 1) || (strncmp(header.magic, "RPO1", 4) != 0) || (header.nodesCount <= 0))
+    {
+        TraceLog(LOG_WARNING, "[%s] Point cloud octree file not valid", octreeName);
+        fclose(file);
+        return cloud;
+    }
+
+    cloud.nodesCount = header.nodesCount;
+    cloud.pointsCount = header.pointsCount;
+    cloud.hasNormals = header.hasNormals;
+    cloud.nodes = (PointNode *)PBR_MALLOC(MEMORY_MODEL, cloud.nodesCount*sizeof(PointNode));
+    cloud.states = (PointNodeState *)PBR_CALLOC(MEMORY_MODEL, cloud.nodesCount, sizeof(PointNodeState));
+    cloud.visible = (int *)PBR_MALLOC(MEMORY_MODEL, cloud.nodesCount*sizeof(int));
+    cloud.heap = (int *)PBR_MALLOC(MEMORY_MODEL, cloud.nodesCount*sizeof(int));
+    cloud.priority = (float *)PBR_MALLOC(MEMORY_MODEL, cloud.nodesCount*sizeof(float));
+    cloud.loader = (PointLoader *)PBR_CALLOC(MEMORY_MODEL, 1, sizeof(PointLoader));
+
+    bool success = (cloud.nodes != NULL) && (cloud.states != NULL) && (cloud.visible != NULL) && (cloud.heap != NULL) && (cloud.priority != NULL) && (cloud.loader != NULL);
+
+    if (success)
+    {
+        cloud.loader->capacity = cloud.nodesCount + 1;
+        cloud.loader->requests = (int *)PBR_MALLOC(MEMORY_MODEL, cloud.loader->capacity*sizeof(int));
+        cloud.loader->loaded = (int *)PBR_MALLOC(MEMORY_MODEL, cloud.loader->capacity*sizeof(int));
+        success = (cloud.loader->requests != NULL) && (cloud.loader->loaded != NULL) &&
+                  (fread(cloud.nodes, sizeof(PointNode), cloud.nodesCount, file) == (size_t)cloud.nodesCount);
+    }
+
+    // Start nodes loader thread (loader pool falls back to heap allocations if its memory could not be allocated)
+    if (success)
+    {
+        cloud.loader->file = file;
+        cloud.loader->pointsOffset = (long long)sizeof(PointCloudHeader) + (long long)cloud.nodesCount*sizeof(PointNode);
+        cloud.loader->nodes = cloud.nodes;
+        cloud.loader->states = cloud.states;
+        cloud.loader->pool = LoadMemoryPool(MEMORY_MODEL, POINTCLOUD_POOL_POINTS*sizeof(PointVertex), POINTCLOUD_POOL_BLOCKS);
+        pthread_mutex_init(&cloud.loader->mutex, NULL);
+        pthread_cond_init(&cloud.loader->cond, NULL);
+        success = (pthread_create(&cloud.loader->thread, NULL, PointLoaderThread, cloud.loader) == 0);
+
+        if (!success)
+        {
+            pthread_mutex_destroy(&cloud.loader->mutex);
+            pthread_cond_destroy(&cloud.loader->cond);
+            UnloadMemoryPool(&cloud.loader->pool);
+        }
+    }
+
+    if (!success)
+    {
+        TraceLog(LOG_WARNING, "[%s] Point cloud octree nodes could not be loaded", octreeName);
+        fclose(file);
+
+        if (cloud.loader != NULL)
+        {
+            PBR_FREE(cloud.loader->requests);
+            PBR_FREE(cloud.loader->loaded);
+            PBR_FREE(cloud.loader);
+        }
+
+        PBR_FREE(cloud.nodes);
+        PBR_FREE(cloud.states);
+        PBR_FREE(cloud.visible);
+        PBR_FREE(cloud.heap);
+        PBR_FREE(cloud.priority);
+
+        return (PointCloud){ 0 };
+    }
+
+    // Store parent of each node to update parents refinement state
+    for (int i = 0; i < cloud.nodesCount; i++) cloud.states[i].parent = -1;
+    for (int i = 0; i < cloud.nodesCount; i++)
+    {
+        for (int k = 0; k < 8; k++) if (cloud.nodes[i].children[k] != -1) cloud.states[cloud.nodes[i].children[k]].parent = i;
+    }
+
+    // Center point cloud over the grid and scale it to viewer dimensions
+    float extent = fmaxf(header.max[0] - header.min[0], fmaxf(header.max[1] - header.min[1], header.max[2] - header.min[2]));
+    cloud.scale = POINTCLOUD_SIZE/fmaxf(extent, 0.0001f);
+    cloud.offset = (Vector3){ -(header.min[0] + header.max[0])*0.5f, -header.min[1], -(header.min[2] + header.max[2])*0.5f };
+    cloud.transform = MatrixMultiply(MatrixTranslate(cloud.offset.x, cloud.offset.y, cloud.offset.z), MatrixScale(cloud.scale, cloud.scale, cloud.scale));
+
+    // Load point cloud splats shader and get its locations
+    cloud.shader = LoadShader(PATH_POINTS_VS, PATH_POINTS_FS);
+    cloud.mvpLoc = GetShaderLocation(cloud.shader, "mvpMatrix");
+    cloud.modelLoc = GetShaderLocation(cloud.shader, "mMatrix");
+    cloud.viewLoc = GetShaderLocation(cloud.shader, "viewPos");
+    cloud.pointScaleLoc = GetShaderLocation(cloud.shader, "pointScale");
+    cloud.splatSizeLoc = GetShaderLocation(cloud.shader, "splatSize");
+    cloud.useNormalsLoc = GetShaderLocation(cloud.shader, "useNormals");
+    cloud.roughnessLoc = GetShaderLocation(cloud.shader, "roughness");
+
+    // Set up point cloud shader environment texture units
+    SetShaderValuei(cloud.shader, GetShaderLocation(cloud.shader, "irradianceMap"), (int[1]){ 0 }, 1);
+    SetShaderValuei(cloud.shader, GetShaderLocation(cloud.shader, "prefilterMap"), (int[1]){ 1 }, 1);
+    SetShaderValuei(cloud.shader, GetShaderLocation(cloud.shader, "brdfLUT"), (int[1]){ 2 }, 1);
+    SetShaderValuei(cloud.shader, cloud.useNormalsLoc, (int[1]){ cloud.hasNormals }, 1);
+    SetShaderValue(cloud.shader, cloud.roughnessLoc, (float[1]){ POINTCLOUD_ROUGHNESS }, 1);
+
+    TraceLog(LOG_INFO, "[%s] Point cloud loaded (%u points, %i nodes)", octreeName, cloud.pointsCount, cloud.nodesCount);
+
+    return cloud;
+}
+
+// Select nodes to draw by screen-space error and stream missing ones
+void UpdatePointCloud(PointCloud *cloud, Camera camera, Vector2 res)
+{
+    if (cloud->nodesCount == 0) return;
+
+    PointLoader *loader = cloud->loader;
+    cloud->frame++;
+    cloud->visibleCount = 0;
+    cloud->pointsVisible = 0;
+
+    // Extract frustum planes in point cloud space from model-view-projection matrix rows
+    Matrix mvp = MatrixMultiply(cloud->transform, GetCameraMatrixPBR(camera, res.x/res.y));
+    float rows[4][4] = {
+        { mvp.m0, mvp.m4, mvp.m8, mvp.m12 },
+        { mvp.m1, mvp.m5, mvp.m9, mvp.m13 },
+        { mvp.m2, mvp.m6, mvp.m10, mvp.m14 },
+        { mvp.m3, mvp.m7, mvp.m11, mvp.m15 }
+    };
+    float planes[6][4] = { 0 };
+    for (int k = 0; k < 4; k++)
+    {
+        planes[0][k] = rows[3][k] + rows[0][k];
+        planes[1][k] = rows[3][k] - rows[0][k];
+        planes[2][k] = rows[3][k] + rows[1][k];
+        planes[3][k] = rows[3][k] - rows[1][k];
+        planes[4][k] = rows[3][k] + rows[2][k];
+        planes[5][k] = rows[3][k] - rows[2][k];
+    }
+
+    // Calculate camera position in point cloud space and pixels per world unit at unit distance
+    Vector3 viewPos = { camera.position.x/cloud->scale - cloud->offset.x, camera.position.y/cloud->scale - cloud->offset.y, camera.position.z/cloud->scale - cloud->offset.z };
+    float projScale = res.y/(2.0f*tanf(camera.fovy*0.5f*DEG2RAD));
+
+    for (int i = 0; i < cloud->nodesCount; i++) cloud->states[i].refined = false;
+
+    // Traverse octree from root with a max-heap ordered by projected node size
+    int heapCount = 1;
+    cloud->heap[0] = 0;
+    cloud->priority[0] = 1e30f;
+
+    while (heapCount > 0)
+    {
+        // Pop node with highest priority
+        int index = cloud->heap[0];
+        heapCount--;
+        cloud->heap[0] = cloud->heap[heapCount];
+        cloud->priority[0] = cloud->priority[heapCount];
+
+        for (int i = 0; ; )
+        {
+            int largest = i;
+            int left = 2*i + 1;
+            int right = 2*i + 2;
+            if ((left < heapCount) && (cloud->priority[left] > cloud->priority[largest])) largest = left;
+            if ((right < heapCount) && (cloud->priority[right] > cloud->priority[largest])) largest = right;
+            if (largest == i) break;
+
+            int tempIndex = cloud->heap[i];
+            float tempPriority = cloud->priority[i];
+            cloud->heap[i] = cloud->heap[largest];
+            cloud->priority[i] = cloud->priority[largest];
+            cloud->heap[largest] = tempIndex;
+            cloud->priority[largest] = tempPriority;
+            i = largest;
+        }
+
+        PointNode *node = &cloud->nodes[index];
+        PointNodeState *state = &cloud->states[index];
+
+        // Discard nodes outside view frustum
+        bool inside = true;
+        for (int p = 0; (p < 6) && inside; p++)
+        {
+            float x = node->min[0] + ((planes[p][0] > 0.0f) ? node->size : 0.0f);
+            float y = node->min[1] + ((planes[p][1] > 0.0f) ? node->size : 0.0f);
+            float z = node->min[2] + ((planes[p][2] > 0.0f) ? node->size : 0.0f);
+            if ((planes[p][0]*x + planes[p][1]*y + planes[p][2]*z + planes[p][3]) < 0.0f) inside = false;
+        }
+
+        if (!inside) continue;
+        if ((cloud->pointsVisible + node->count) > POINTCLOUD_BUDGET) break;
+
+        state->lastUsed = cloud->frame;
+
+        // Request missing nodes and wait for them before refining
+        if (state->state != NODE_RESIDENT)
+        {
+            if (state->state == NODE_UNLOADED)
+            {
+                pthread_mutex_lock(&loader->mutex);
+                state->state = NODE_QUEUED;
+                loader->requests[loader->requestsTail] = index;
+                loader->requestsTail = (loader->requestsTail + 1)%loader->capacity;
+                pthread_cond_signal(&loader->cond);
+                pthread_mutex_unlock(&loader->mutex);
+            }
+
+            continue;
+        }
+
+        cloud->visible[cloud->visibleCount] = index;
+        cloud->visibleCount++;
+        cloud->pointsVisible += node->count;
+        if (state->parent != -1) cloud->states[state->parent].refined = true;
+
+        // Calculate node projected points spacing to decide if children must be drawn
+        float half = node->size*0.5f;
+        float dx = node->min[0] + half - viewPos.x;
+        float dy = node->min[1] + half - viewPos.y;
+        float dz = node->min[2] + half - viewPos.z;
+        float distance = fmaxf(sqrtf(dx*dx + dy*dy + dz*dz) - half*1.7320508f, 0.0001f);
+        float projSpacing = (node->size/POINTCLOUD_GRID_SIZE)/distance*projScale;
+
+        if (projSpacing > POINTCLOUD_MAX_ERROR)
+        {
+            for (int k = 0; k < 8; k++)
+            {
+                int child = node->children[k];
+                if (child == -1) continue;
+
+                PointNode *childNode = &cloud->nodes[child];
+                float childHalf = childNode->size*0.5f;
+                dx = childNode->min[0] + childHalf - viewPos.x;
+                dy = childNode->min[1] + childHalf - viewPos.y;
+                dz = childNode->min[2] + childHalf - viewPos.z;
+                float childDistance = sqrtf(dx*dx + dy*dy + dz*dz);
+
+                // Push child node with priority based on its projected size
+                int i = heapCount;
+                heapCount++;
+                cloud->heap[i] = child;
+                cloud->priority[i] = (childDistance > childHalf*1.7320508f) ? childNode->size/childDistance : 1e29f;
+
+                while (i > 0)
+                {
+                    int parent = (i - 1)/2;
+                    if (cloud->priority[parent] >= cloud->priority[i]) break;
+
+                    int tempIndex = cloud->heap[i];
+                    float tempPriority = cloud->priority[i];
+                    cloud->heap[i] = cloud->heap[parent];
+                    cloud->priority[i] = cloud->priority[parent];
+                    cloud->heap[parent] = tempIndex;
+                    cloud->priority[parent] = tempPriority;
+                    i = parent;
+                }
+            }
+        }
+    }
+
+    // Upload nodes points read by loader thread
+    for (int uploads = 0; uploads < POINTCLOUD_MAX_UPLOADS; uploads++)
+    {
+        int index = -1;
+
+        pthread_mutex_lock(&loader->mutex);
+        if (loader->loadedHead != loader->loadedTail)
+        {
+            index = loader->loaded[loader->loadedHead];
+            loader->loadedHead = (loader->loadedHead + 1)%loader->capacity;
+        }
+        pthread_mutex_unlock(&loader->mutex);
+
+        if (index == -1) break;
+
+        PointNodeState *state = &cloud->states[index];
+
+        glGenVertexArrays(1, &state->vaoId);
+        glGenBuffers(1, &state->vboId);
+        glBindVertexArray(state->vaoId);
+        glBindBuffer(GL_ARRAY_BUFFER, state->vboId);
+        glBufferData(GL_ARRAY_BUFFER, cloud->nodes[index].count*sizeof(PointVertex), state->data, GL_STATIC_DRAW);
+
+        // Link vertex attributes (position, normal and color locations)
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PointVertex), (GLvoid *)0);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, sizeof(PointVertex), (GLvoid *)(3*sizeof(float) + 4));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PointVertex), (GLvoid *)(3*sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        pthread_mutex_lock(&loader->mutex);
+        FreePool(&loader->pool, state->data);
+        pthread_mutex_unlock(&loader->mutex);
+        state->data = NULL;
+        state->state = NODE_RESIDENT;
+        cloud->pointsResident += cloud->nodes[index].count;
+    }
+
+    // Evict least recently used nodes when GPU cache is full
+    for (int evictions = 0; (evictions < POINTCLOUD_MAX_EVICTIONS) && (cloud->pointsResident > POINTCLOUD_CACHE); evictions++)
+    {
+        int oldest = -1;
+        for (int i = 0; i < cloud->nodesCount; i++)
+        {
+            if ((cloud->states[i].state == NODE_RESIDENT) && (cloud->states[i].lastUsed != cloud->frame) &&
+                ((oldest == -1) || (cloud->states[i].lastUsed < cloud->states[oldest].lastUsed))) oldest = i;
+        }
+
+        if (oldest == -1) break;
+
+        glDeleteBuffers(1, &cloud->states[oldest].vboId);
+        glDeleteVertexArrays(1, &cloud->states[oldest].vaoId);
+        cloud->states[oldest].vboId = 0;
+        cloud->states[oldest].vaoId = 0;
+        cloud->states[oldest].state = NODE_UNLOADED;
+        cloud->pointsResident -= cloud->nodes[oldest].count;
+    }
+}
+
+// Draw selected point cloud nodes as lit splats
+void DrawPointCloud(PointCloud cloud, Environment env, Camera camera, Vector2 res)
+{
+    if (cloud.visibleCount == 0) return;
+
+    InvalidateStateGL();
+    UseProgramGL(cloud.shader.id);
+
+    // Send to shader transformation matrices, camera position and splats projection scale
+    Matrix mvp = MatrixMultiply(cloud.transform, GetCameraMatrixPBR(camera, res.x/res.y));
+    SetShaderValueMatrix(cloud.shader, cloud.mvpLoc, mvp);
+    SetShaderValueMatrix(cloud.shader, cloud.modelLoc, cloud.transform);
+    float cameraPos[3] = { camera.position.x, camera.position.y, camera.position.z };
+    SetShaderValue(cloud.shader, cloud.viewLoc, cameraPos, 3);
+    float pointScale[1] = { cloud.scale*res.y/(2.0f*tanf(camera.fovy*0.5f*DEG2RAD)) };
+    SetShaderValue(cloud.shader, cloud.pointScaleLoc, pointScale, 1);
+
+    // Enable and bind irradiance, prefiltered reflection and BRDF LUT maps
+    BindTextureGL(0, GL_TEXTURE_CUBE_MAP, env.irradianceId);
+    BindTextureGL(1, GL_TEXTURE_CUBE_MAP, env.prefilterId);
+    BindTextureGL(2, GL_TEXTURE_2D, env.brdfId);
+
+    glEnable(GL_PROGRAM_POINT_SIZE);
+
+    for (int i = 0; i < cloud.visibleCount; i++)
+    {
+        int index = cloud.visible[i];
+
+        // Nodes with drawn children fill the gaps between children points with half spacing splats
+        float splatSize[1] = { cloud.nodes[index].size/POINTCLOUD_GRID_SIZE };
+        if (cloud.states[index].refined) splatSize[0] *= 0.5f;
+        glUniform1f(cloud.splatSizeLoc, splatSize[0]);
+
+        glBindVertexArray(cloud.states[index].vaoId);
+        glDrawArrays(GL_POINTS, 0, cloud.nodes[index].count);
+    }
+
+    glBindVertexArray(0);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+
+    // Disable and unbind environment maps
+    BindTextureGL(2, GL_TEXTURE_2D, 0);
+    BindTextureGL(1, GL_TEXTURE_CUBE_MAP, 0);
+    BindTextureGL(0, GL_TEXTURE_CUBE_MAP, 0);
+}
+
+// Stop nodes streaming and unload point cloud GPU buffers
+void UnloadPointCloud(PointCloud cloud)
+{
+    if (cloud.nodesCount == 0) return;
+
+    // Stop loader thread and close octree file
+    pthread_mutex_lock(&cloud.loader->mutex);
+    cloud.loader->quit = true;
+    pthread_cond_signal(&cloud.loader->cond);
+    pthread_mutex_unlock(&cloud.loader->mutex);
+    pthread_join(cloud.loader->thread, NULL);
+    pthread_mutex_destroy(&cloud.loader->mutex);
+    pthread_cond_destroy(&cloud.loader->cond);
+    fclose(cloud.loader->file);
+
+    // Unload nodes GPU buffers and points waiting to be uploaded
+    for (int i = 0; i < cloud.nodesCount; i++)
+    {
+        if (cloud.states[i].state == NODE_RESIDENT)
+        {
+            glDeleteBuffers(1, &cloud.states[i].vboId);
+            glDeleteVertexArrays(1, &cloud.states[i].vaoId);
+        }
+
+        FreePool(&cloud.loader->pool, cloud.states[i].data);
+    }
+
+    UnloadShader(cloud.shader);
+    UnloadMemoryPool(&cloud.loader->pool);
+
+    PBR_FREE(cloud.loader->requests);
+    PBR_FREE(cloud.loader->loaded);
+    PBR_FREE(cloud.loader);
+    PBR_FREE(cloud.nodes);
+    PBR_FREE(cloud.states);
+    PBR_FREE(cloud.visible);
+    PBR_FREE(cloud.heap);
+    PBR_FREE(cloud.priority);
+}
+
+// Build an octree file out-of-core (build can be NULL)
+// NOTE: source points are converted to a raw points file and counted in a coarse grid to split the point cloud into chunks,
+// chunks too big to be built in memory are subsampled while bucketing points into a chunks file and the rest are built one at a time
+static bool BuildPointOctree(const char *fileName, const char *octreeName, PointCloudBuild *build)
+{
+    double startTime = GetTime();
+    char rawName[520] = { 0 };
+    char chunksName[520] = { 0 };
+    snprintf(rawName, sizeof(rawName), "%s.tmp0", octreeName);
+    snprintf(chunksName, sizeof(chunksName), "%s.tmp1", octreeName);
+
+    int resolution = 1 << POINTCLOUD_COUNT_LEVEL;
+    PointCloudHeader header = { { 'R', 'P', 'O', '1' }, 0, 0, 0, { 0 }, { 0 } };
+    MemoryArena arena = { 0 };
+    PointVertex *batch = (PointVertex *)PBR_MALLOC(MEMORY_MODEL, POINTCLOUD_BATCH_POINTS*sizeof(PointVertex));
+    FILE *rawFile = fopen(rawName, "w+b");
+    FILE *chunksFile = fopen(chunksName, "w+b");
+    FILE *file = NULL;
+    bool hasNormals = false;
+    bool success = false;
+
+    buildNodesCount = 0;
+    buildNodesCapacity = 1024;
+    buildNodes = (PointNode *)PBR_MALLOC(MEMORY_MODEL, buildNodesCapacity*sizeof(PointNode));
+    buildChunksCount = 0;
+    buildChunksCapacity = 64;
+    buildChunks = (PointChunk *)PBR_MALLOC(MEMORY_MODEL, buildChunksCapacity*sizeof(PointChunk));
+    buildCounts = (unsigned int *)PBR_CALLOC(MEMORY_MODEL, resolution*resolution*resolution, sizeof(unsigned int));
+    buildGrid = (unsigned char *)PBR_MALLOC(MEMORY_MODEL, POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE/8);
+    buildFailed = (batch == NULL) || (rawFile == NULL) || (chunksFile == NULL) ||
+                  (buildNodes == NULL) || (buildChunks == NULL) || (buildCounts == NULL) || (buildGrid == NULL);
+
+    // Convert source points into raw points file and calculate points bounding box
+    if (!buildFailed)
+    {
+        PointWriter writer = { rawFile, batch, 0, &header, build };
+
+        if (IsFileExtension(fileName, ".ply")) success = ReadPointsPLY(fileName, &writer, &hasNormals);
+        else success = ReadPointsText(fileName, &writer, &hasNormals);
+
+        success = success && FlushPoints(&writer) && (header.pointsCount > 0);
+        header.hasNormals = hasNormals;
+        if (!success && !IsPointCloudBuildCanceled(build)) TraceLog(LOG_WARNING, "[%s] Point cloud could not be read", fileName);
+    }
+
+    float size = fmaxf(header.max[0] - header.min[0], fmaxf(header.max[1] - header.min[1], header.max[2] - header.min[2]));
+    size = fmaxf(size*1.0001f, 0.0001f);
+    float rootMin[3] = { header.min[0], header.min[1], header.min[2] };
+
+    // Stream raw points three times: count them in counting grid, count chunks buckets points and write chunks buckets
+    for (int pass = 0; success && !buildFailed && (pass < 3); pass++)
+    {
+        rewind(rawFile);
+
+        for (unsigned int read = 0; !buildFailed && (read < header.pointsCount); )
+        {
+            unsigned int count = ((header.pointsCount - read) < POINTCLOUD_BATCH_POINTS) ? (header.pointsCount - read) : POINTCLOUD_BATCH_POINTS;
+            buildFailed = (fread(batch, sizeof(PointVertex), count, rawFile) != count) || IsPointCloudBuildCanceled(build);
+
+            for (unsigned int i = 0; !buildFailed && (i < count); i++)
+            {
+                if (pass == 0)
+                {
+                    int cell[3] = { 0 };
+                    GetPointCell(&batch[i], rootMin, size, resolution, cell);
+                    buildCounts[(cell[2]*resolution + cell[1])*resolution + cell[0]]++;
+                }
+                else
+                {
+                    PointChunk *chunk = &buildChunks[FindPointChunk(&batch[i], rootMin, size)];
+
+                    if (pass == 1) chunk->count++;
+                    else
+                    {
+                        chunk->buffer[chunk->buffered] = batch[i];
+                        chunk->buffered++;
+                        if ((chunk->buffered == POINTCLOUD_BUCKET_POINTS) && !FlushPointChunk(chunk, chunksFile)) buildFailed = true;
+                    }
+                }
+            }
+
+            read += count;
+        }
+
+        if (buildFailed) break;
+
+        if (pass == 0)
+        {
+            // Split root chunk until chunks fit in memory
+            BuildPointChunk(rootMin, size, 0, 0, 0, 0);
+        }
+        else if (pass == 1)
+        {
+            // Place chunks buckets one after another in chunks file and allocate their write buffers
+            long long offset = 0;
+            unsigned int maxCount = 0;
+
+            for (int i = 0; !buildFailed && (i < buildChunksCount); i++)
+            {
+                buildChunks[i].offset = offset;
+                offset += buildChunks[i].count;
+                if (buildChunks[i].count > maxCount) maxCount = buildChunks[i].count;
+
+                if (buildChunks[i].grid != NULL) memset(buildChunks[i].grid, 0, POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE/8);
+                if (buildChunks[i].count == 0) continue;
+
+                int bufferSize = (buildChunks[i].count < POINTCLOUD_BUCKET_POINTS) ? (int)buildChunks[i].count : POINTCLOUD_BUCKET_POINTS;
+                buildChunks[i].buffer = (PointVertex *)PBR_MALLOC(MEMORY_MODEL, bufferSize*sizeof(PointVertex));
+                if (buildChunks[i].buffer == NULL) buildFailed = true;
+            }
+
+            // Chunks are built one at a time, so arena only needs to fit biggest chunk bucket
+            if (!buildFailed) arena = LoadMemoryArena(MEMORY_MODEL, maxCount*sizeof(PointVertex));
+            if (arena.base == NULL) buildFailed = true;
+        }
+        else
+        {
+            for (int i = 0; !buildFailed && (i < buildChunksCount); i++) if (!FlushPointChunk(&buildChunks[i], chunksFile)) buildFailed = true;
+        }
+    }
+
+    // Build octree nodes chunk by chunk reusing raw points file for reordered points
+    unsigned int written = 0;
+
+    if (success && !buildFailed)
+    {
+        fclose(rawFile);
+        rawFile = fopen(rawName, "w+b");
+        buildFailed = (rawFile == NULL);
+        if (!buildFailed) BuildChunkNodes(0, &arena, chunksFile, rawFile, &written, build);
+        header.nodesCount = buildNodesCount;
+    }
+
+    // Write octree header, nodes and reordered points
+    if (success && !buildFailed && (written == header.pointsCount))
+    {
+        file = fopen(octreeName, "wb");
+        success = (file != NULL) && (fwrite(&header, sizeof(PointCloudHeader), 1, file) == 1) &&
+                  (fwrite(buildNodes, sizeof(PointNode), buildNodesCount, file) == (size_t)buildNodesCount);
+
+        rewind(rawFile);
+
+        for (unsigned int copied = 0; success && (copied < written); )
+        {
+            unsigned int count = ((written - copied) < POINTCLOUD_BATCH_POINTS) ? (written - copied) : POINTCLOUD_BATCH_POINTS;
+            success = (fread(batch, sizeof(PointVertex), count, rawFile) == count) && (fwrite(batch, sizeof(PointVertex), count, file) == count);
+            copied += count;
+        }
+
+        if ((file != NULL) && (fclose(file) != 0)) success = false;
+
+        // Don't keep partially written octree files (they would be loaded next time)
+        if (!success) remove(octreeName);
+    }
+    else success = false;
+
+    if (success) TraceLog(LOG_INFO, "[%s] Point cloud octree built (%u points, %i nodes, %i chunks) in %.2f ms (%u arena allocations from %u heap blocks, %.2f MB arena peak)", octreeName,
+                          header.pointsCount, buildNodesCount, buildChunksCount, (GetTime() - startTime)*1000.0, arena.allocations, arena.heapBlocks, arena.peak/(1024.0f*1024.0f));
+    else if (IsPointCloudBuildCanceled(build)) TraceLog(LOG_INFO, "[%s] Point cloud octree building canceled", octreeName);
+    else TraceLog(LOG_WARNING, "[%s] Point cloud octree could not be built", octreeName);
+
+    // Remove temporary files and unload building state
+    if (rawFile != NULL) fclose(rawFile);
+    if (chunksFile != NULL) fclose(chunksFile);
+    remove(rawName);
+    remove(chunksName);
+
+    for (int i = 0; (buildChunks != NULL) && (i < buildChunksCount); i++)
+    {
+        PBR_FREE(buildChunks[i].grid);
+        PBR_FREE(buildChunks[i].buffer);
+    }
+
+    PBR_FREE(buildNodes);
+    PBR_FREE(buildChunks);
+    PBR_FREE(buildCounts);
+    PBR_FREE(buildGrid);
+    PBR_FREE(batch);
+    UnloadMemoryArena(&arena);
+    buildNodes = NULL;
+    buildChunks = NULL;
+    buildCounts = NULL;
+    buildGrid = NULL;
+
+    return success;
+}
+
+// Read points from a XYZ or PTS text file
+// NOTE: supported columns layouts are XYZ, XYZ-I, XYZ-RGB, XYZ-I-RGB, XYZ-RGB-N and XYZ-I-RGB-N
+static bool ReadPointsText(const char *fileName, PointWriter *writer, bool *hasNormals)
+{
+    FILE *file = fopen(fileName, "rt");
+    if (file == NULL) return false;
+
+    char line[512] = { 0 };
+    bool success = true;
+    *hasNormals = false;
+
+    while (success && (fgets(line, sizeof(line), file) != NULL))
+    {
+        float values[10] = { 0 };
+        int columns = 0;
+        char *cursor = line;
+
+        while (columns < 10)
+        {
+            char *end = NULL;
+            float value = strtof(cursor, &end);
+            if (end == cursor) break;
+            values[columns] = value;
+            columns++;
+            cursor = end;
+        }
+
+        // Skip headers and PTS points count line
+        if (columns < 3) continue;
+
+        PointVertex vertex = { { values[0], values[1], values[2] }, { 255, 255, 255, 255 }, { 0, 0 } };
+        PointVertex *point = &vertex;
+
+        int rgb = -1;
+        int normal = -1;
+        if (columns == 4) point->color[0] = point->color[1] = point->color[2] = (unsigned char)fminf(fmaxf(values[3], 0.0f), 255.0f);
+        else if ((columns == 6) || (columns == 9)) rgb = 3;
+        else if ((columns == 7) || (columns == 10)) rgb = 4;
+        if (columns >= 9) normal = rgb + 3;
+
+        if (rgb != -1) for (int k = 0; k < 3; k++) point->color[k] = (unsigned char)fminf(fmaxf(values[rgb + k], 0.0f), 255.0f);
+        if (normal != -1)
+        {
+            EncodePointNormal(point, values[normal], values[normal + 1], values[normal + 2]);
+            *hasNormals = true;
+        }
+
+        success = WritePoint(writer, point);
+    }
+
+    fclose(file);
+
+    return success;
+}
+
+// Read points from an ASCII or binary little endian PLY file
+// NOTE: vertex element must be the first element of the file
+static bool ReadPointsPLY(const char *fileName, PointWriter *writer, bool *hasNormals)
+{
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return false;
+
+    const char *names[9] = { "x", "y", "z", "nx", "ny", "nz", "red", "green", "blue" };
+    int offsets[9] = { -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+    int types[9] = { 0 };
+    int columns[9] = { -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+    int stride = 0;
+    int properties = 0;
+    unsigned int vertices = 0;
+    bool binary = false;
+    bool inVertex = false;
+    char line[256] = { 0 };
+
+    // Parse header vertex element properties layout
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char type[64] = { 0 };
+        char name[64] = { 0 };
+
+        if (strncmp(line, "end_header", 10) == 0) break;
+        else if (strncmp(line, "format", 6) == 0)
+        {
+            if (strstr(line, "binary_little_endian") != NULL) binary = true;
+            else if (strstr(line, "ascii") == NULL)
+            {
+                TraceLog(LOG_WARNING, "[%s] PLY big endian format not supported", fileName);
+                fclose(file);
+                return false;
+            }
+        }
+        else if (strncmp(line, "element", 7) == 0)
+        {
+            unsigned int elements = 0;
+            inVertex = (sscanf(line, "element %63s %u", name, &elements) == 2) && (strcmp(name, "vertex") == 0);
+            if (inVertex) vertices = elements;
+        }
+        else if (inVertex && (sscanf(line, "property %63s %63s", type, name) == 2))
+        {
+            int size = 4;
+            if ((strcmp(type, "char") == 0) || (strcmp(type, "uchar") == 0) || (strcmp(type, "int8") == 0) || (strcmp(type, "uint8") == 0)) size = 1;
+            else if ((strcmp(type, "short") == 0) || (strcmp(type, "ushort") == 0) || (strcmp(type, "int16") == 0) || (strcmp(type, "uint16") == 0)) size = 2;
+            else if ((strcmp(type, "double") == 0) || (strcmp(type, "float64") == 0)) size = 8;
+
+            for (int k = 0; k < 9; k++)
+            {
+                if ((strcmp(name, names[k]) == 0) || ((k >= 6) && (strncmp(name, "diffuse_", 8) == 0) && (strcmp(name + 8, names[k]) == 0)))
+                {
+                    offsets[k] = stride;
+                    columns[k] = properties;
+                    types[k] = ((strcmp(type, "float") == 0) || (strcmp(type, "float32") == 0)) ? 'f' : ((size == 8) ? 'd' : ((size == 1) ? 'b' : 'i'));
+                }
+            }
+
+            stride += size;
+            properties++;
+        }
+    }
+
+    if ((vertices == 0) || (offsets[0] == -1) || (offsets[1] == -1) || (offsets[2] == -1))
+    {
+        fclose(file);
+        return false;
+    }
+
+    *hasNormals = (offsets[3] != -1) && (offsets[4] != -1) && (offsets[5] != -1);
+
+    unsigned char *record = (unsigned char *)PBR_MALLOC(MEMORY_MODEL, stride);
+
+    if (record == NULL)
+    {
+        fclose(file);
+        return false;
+    }
+
+    bool success = true;
+
+
+    for (unsigned int i = 0; success && (i < vertices); i++)
+    {
+        float values[9] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 255.0f, 255.0f, 255.0f };
+
+        if (binary)
+        {
+            if (fread(record, stride, 1, file) != 1) break;
+
+            for (int k = 0; k < 9; k++)
+            {
+                if (offsets[k] == -1) continue;
+
+                unsigned char *data = record + offsets[k];
+                if (types[k] == 'f') { float value; memcpy(&value, data, 4); values[k] = value; }
+                else if (types[k] == 'd') { double value; memcpy(&value, data, 8); values[k] = (float)value; }
+                else if (types[k] == 'b') values[k] = (float)data[0];
+                else { int value; memcpy(&value, data, 4); values[k] = (float)value; }
+            }
+        }
+        else
+        {
+            if (fgets(line, sizeof(line), file) == NULL) break;
+
+            char *cursor = line;
+            for (int c = 0; c < properties; c++)
+            {
+                char *end = NULL;
+                float value = strtof(cursor, &end);
+                if (end == cursor) break;
+                for (int k = 0; k < 9; k++) if (columns[k] == c) values[k] = value;
+                cursor = end;
+            }
+        }
+
+        PointVertex point = { { values[0], values[1], values[2] }, { 0, 0, 0, 255 }, { 0, 0 } };
+        point.color[0] = (unsigned char)fminf(fmaxf(values[6], 0.0f), 255.0f);
+        point.color[1] = (unsigned char)fminf(fmaxf(values[7], 0.0f), 255.0f);
+        point.color[2] = (unsigned char)fminf(fmaxf(values[8], 0.0f), 255.0f);
+        if (*hasNormals) EncodePointNormal(&point, values[3], values[4], values[5]);
+
+        success = WritePoint(writer, &point);
+    }
+
+    PBR_FREE(record);
+    fclose(file);
+
+    return success;
+}
+
+// Add a point to raw points file (returns false if writing failed or was canceled)
+static bool WritePoint(PointWriter *writer, PointVertex *point)
+{
+    PointCloudHeader *header = writer->header;
+
+    if (header->pointsCount == 0) for (int k = 0; k < 3; k++) header->min[k] = header->max[k] = point->position[k];
+
+    for (int k = 0; k < 3; k++)
+    {
+        if (point->position[k] < header->min[k]) header->min[k] = point->position[k];
+        else if (point->position[k] > header->max[k]) header->max[k] = point->position[k];
+    }
+
+    header->pointsCount++;
+    writer->batch[writer->batchCount] = *point;
+    writer->batchCount++;
+
+    if (writer->batchCount == POINTCLOUD_BATCH_POINTS) return FlushPoints(writer);
+
+    return true;
+}
+
+// Write points waiting in writer batch
+static bool FlushPoints(PointWriter *writer)
+{
+    bool success = (fwrite(writer->batch, sizeof(PointVertex), writer->batchCount, writer->file) == (size_t)writer->batchCount);
+    writer->batchCount = 0;
+
+    return success && !IsPointCloudBuildCanceled(writer->build);
+}
+
+// Split points counting grid cells into chunks
+// NOTE: chunks are split until they fit in POINTCLOUD_CHUNK_MAX points or reach counting grid level (denser cells are built in memory anyway)
+static int BuildPointChunk(float *min, float size, int level, int cx, int cy, int cz)
+{
+    int resolution = 1 << POINTCLOUD_COUNT_LEVEL;
+    int cells = 1 << (POINTCLOUD_COUNT_LEVEL - level);
+    unsigned long long count = 0;
+
+    for (int z = cz; z < cz + cells; z++)
+    {
+        for (int y = cy; y < cy + cells; y++)
+        {
+            for (int x = cx; x < cx + cells; x++) count += buildCounts[(z*resolution + y)*resolution + x];
+        }
+    }
+
+    if (count == 0) return -1;
+
+    if (buildChunksCount == buildChunksCapacity)
+    {
+        PointChunk *chunks = (PointChunk *)PBR_REALLOC(MEMORY_MODEL, buildChunks, 2*buildChunksCapacity*sizeof(PointChunk));
+
+        if (chunks == NULL)
+        {
+            buildFailed = true;
+            return -1;
+        }
+
+        buildChunks = chunks;
+        buildChunksCapacity *= 2;
+    }
+
+    int index = buildChunksCount;
+    buildChunksCount++;
+
+    PointChunk chunk = { { min[0], min[1], min[2] }, size, level, { -1, -1, -1, -1, -1, -1, -1, -1 }, NULL, 0, 0, 0, NULL, 0 };
+
+    if ((count > POINTCLOUD_CHUNK_MAX) && (level < POINTCLOUD_COUNT_LEVEL))
+    {
+        chunk.grid = (unsigned char *)PBR_CALLOC(MEMORY_MODEL, POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE/8, 1);
+        if (chunk.grid == NULL) buildFailed = true;
+    }
+
+    buildChunks[index] = chunk;
+    if ((chunk.grid == NULL) || buildFailed) return index;
+
+    // Split chunk in octants (chunks array can be reallocated, so don't keep pointers to it)
+    float half = size*0.5f;
+    int halfCells = cells/2;
+
+    for (int k = 0; (k < 8) && !buildFailed; k++)
+    {
+        float childMin[3] = { min[0] + ((k & 1) ? half : 0.0f), min[1] + ((k & 2) ? half : 0.0f), min[2] + ((k & 4) ? half : 0.0f) };
+        int child = BuildPointChunk(childMin, half, level + 1, cx + ((k & 1) ? halfCells : 0), cy + ((k & 2) ? halfCells : 0), cz + ((k & 4) ? halfCells : 0));
+        buildChunks[index].children[k] = child;
+    }
+
+    return index;
+}
+
+// Find point chunk bucket, subsampling it into split chunks on the way down
+// NOTE: octants are taken from counting grid cell so points always reach a chunk they were counted in
+static int FindPointChunk(PointVertex *point, float *rootMin, float rootSize)
+{
+    int cell[3] = { 0 };
+    GetPointCell(point, rootMin, rootSize, 1 << POINTCLOUD_COUNT_LEVEL, cell);
+
+    int index = 0;
+
+    while (buildChunks[index].grid != NULL)
+    {
+        PointChunk *chunk = &buildChunks[index];
+
+        // Keep first point of each subsampling grid cell in split chunk
+        int gridCell[3] = { 0 };
+        GetPointCell(point, chunk->min, chunk->size, POINTCLOUD_GRID_SIZE, gridCell);
+        int bit = (gridCell[2]*POINTCLOUD_GRID_SIZE + gridCell[1])*POINTCLOUD_GRID_SIZE + gridCell[0];
+
+        if (!(chunk->grid[bit >> 3] & (1 << (bit & 7))))
+        {
+            chunk->grid[bit >> 3] |= (1 << (bit & 7));
+            break;
+        }
+
+        int shift = POINTCLOUD_COUNT_LEVEL - chunk->level - 1;
+        index = chunk->children[((cell[0] >> shift) & 1) | (((cell[1] >> shift) & 1) << 1) | (((cell[2] >> shift) & 1) << 2)];
+    }
+
+    return index;
+}
+
+// Write chunk buffered points to its bucket
+static bool FlushPointChunk(PointChunk *chunk, FILE *file)
+{
+    if (chunk->buffered == 0) return true;
+
+    bool success = (POINTCLOUD_FSEEK(file, (chunk->offset + chunk->written)*(long long)sizeof(PointVertex)) == 0) &&
+                   (fwrite(chunk->buffer, sizeof(PointVertex), chunk->buffered, file) == (size_t)chunk->buffered);
+
+    chunk->written += chunk->buffered;
+    chunk->buffered = 0;
+
+    return success;
+}
+
+// Build octree nodes of a chunk and write its points
+// NOTE: split chunks nodes store their subsampled bucket, other chunks are loaded and built in memory one at a time
+static int BuildChunkNodes(int index, MemoryArena *arena, FILE *chunksFile, FILE *pointsFile, unsigned int *written, PointCloudBuild *build)
+{
+    PointChunk *chunk = &buildChunks[index];
+    if (chunk->count == 0) return -1;
+
+    if (IsPointCloudBuildCanceled(build))
+    {
+        buildFailed = true;
+        return -1;
+    }
+
+    // Read chunk bucket points
+    PointVertex *points = (PointVertex *)PushArena(arena, chunk->count*sizeof(PointVertex));
+
+    if ((points == NULL) || (POINTCLOUD_FSEEK(chunksFile, chunk->offset*(long long)sizeof(PointVertex)) != 0) ||
+        (fread(points, sizeof(PointVertex), chunk->count, chunksFile) != chunk->count))
+    {
+        buildFailed = true;
+        ResetArena(arena);
+        return -1;
+    }
+
+    int node = -1;
+
+    if (chunk->grid == NULL)
+    {
+        // Build chunk subtree and move its nodes points offsets after previous chunks points
+        int first = buildNodesCount;
+        node = BuildPointNode(points, 0, chunk->count, chunk->min, chunk->size, chunk->level);
+        for (int i = first; i < buildNodesCount; i++) buildNodes[i].offset += *written;
+    }
+    else node = PushPointNode((PointNode){ { chunk->min[0], chunk->min[1], chunk->min[2] }, chunk->size, *written, chunk->count, { -1, -1, -1, -1, -1, -1, -1, -1 } });
+
+    if (!buildFailed && (fwrite(points, sizeof(PointVertex), chunk->count, pointsFile) != chunk->count)) buildFailed = true;
+
+    *written += chunk->count;
+    ResetArena(arena);
+
+    if (buildFailed) return -1;
+
+    // Build split chunk children after its own points (nodes array can be reallocated, so don't keep pointers to it)
+    for (int k = 0; (k < 8) && (buildChunks[index].grid != NULL); k++)
+    {
+        if (buildChunks[index].children[k] == -1) continue;
+
+        int child = BuildChunkNodes(buildChunks[index].children[k], arena, chunksFile, pointsFile, written, build);
+        if (buildFailed) return -1;
+        buildNodes[node].children[k] = child;
+    }
+
+    return node;
+}
+
+// Subsample and split points into an octree node
+static int BuildPointNode(PointVertex *points, unsigned int begin, unsigned int end, float *min, float size, int level)
+{
+    PointNode node = { { min[0], min[1], min[2] }, size, begin, end - begin, { -1, -1, -1, -1, -1, -1, -1, -1 } };
+    int index = PushPointNode(node);
+
+    if ((index == -1) || ((end - begin) <= POINTCLOUD_NODE_MAX) || (level >= POINTCLOUD_MAX_LEVEL)) return index;
+
+    // Keep first point of each subsampling grid cell in this node moving them to range start
+    memset(buildGrid, 0, POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE*POINTCLOUD_GRID_SIZE/8);
+    unsigned int selected = begin;
+
+    for (unsigned int i = begin; i < end; i++)
+    {
+        int coords[3] = { 0 };
+        GetPointCell(&points[i], min, size, POINTCLOUD_GRID_SIZE, coords);
+        int cell = (coords[2]*POINTCLOUD_GRID_SIZE + coords[1])*POINTCLOUD_GRID_SIZE + coords[0];
+
+        if (!(buildGrid[cell >> 3] & (1 << (cell & 7))))
+        {
+            buildGrid[cell >> 3] |= (1 << (cell & 7));
+            PointVertex temp = points[i];
+            points[i] = points[selected];
+            points[selected] = temp;
+            selected++;
+        }
+    }
+
+    node.count = selected - begin;
+
+    // Partition remaining points in place by octant (american flag sort)
+    float half = size*0.5f;
+    unsigned int counts[8] = { 0 };
+    unsigned int starts[8] = { 0 };
+    unsigned int next[8] = { 0 };
+
+    #define POINT_OCTANT(p) ((((p).position[0] >= min[0] + half) ? 1 : 0) | (((p).position[1] >= min[1] + half) ? 2 : 0) | (((p).position[2] >= min[2] + half) ? 4 : 0))
+
+    for (unsigned int i = selected; i < end; i++) counts[POINT_OCTANT(points[i])]++;
+
+    starts[0] = selected;
+    for (int k = 1; k < 8; k++) starts[k] = starts[k - 1] + counts[k - 1];
+    for (int k = 0; k < 8; k++) next[k] = starts[k];
+
+    for (int k = 0; k < 8; k++)
+    {
+        while (next[k] < starts[k] + counts[k])
+        {
+            int octant = POINT_OCTANT(points[next[k]]);
+
+            if (octant == k) next[k]++;
+            else
+            {
+                PointVertex temp = points[next[k]];
+                points[next[k]] = points[next[octant]];
+                points[next[octant]] = temp;
+                next[octant]++;
+            }
+        }
+    }
+
+    #undef POINT_OCTANT
+
+    buildNodes[index] = node;
+
+    // Build child nodes (nodes array can be reallocated, so don't keep pointers to it)
+    for (int k = 0; (k < 8) && !buildFailed; k++)
+    {
+        if (counts[k] == 0) continue;
+
+        float childMin[3] = { min[0] + ((k & 1) ? half : 0.0f), min[1] + ((k & 2) ? half : 0.0f), min[2] + ((k & 4) ? half : 0.0f) };
+        int child = BuildPointNode(points, starts[k], starts[k] + counts[k], childMin, half, level + 1);
+        buildNodes[index].children[k] = child;
+    }
+
+    return index;
+}
+
+// Add a node to octree being built (returns -1 if allocation failed)
+static int PushPointNode(PointNode node)
+{
+    if (buildNodesCount == buildNodesCapacity)
+    {
+        PointNode *nodes = (PointNode *)PBR_REALLOC(MEMORY_MODEL, buildNodes, 2*buildNodesCapacity*sizeof(PointNode));
+
+        if (nodes == NULL)
+        {
+            buildFailed = true;
+            return -1;
+        }
+
+        buildNodes = nodes;
+        buildNodesCapacity *= 2;
+    }
+
+    buildNodes[buildNodesCount] = node;
+    buildNodesCount++;
+
+    return buildNodesCount - 1;
+}
+
+// Get point cell coordinates in a grid covering a bounding cube
+static void GetPointCell(PointVertex *point, float *min, float size, int resolution, int *cell)
+{
+    float cellScale = resolution/size;
+
+    for (int k = 0; k < 3; k++)
+    {
+        int c = (int)((point->position[k] - min[k])*cellScale);
+        cell[k] = (c < 0) ? 0 : ((c >= resolution) ? resolution - 1 : c);
+    }
+}
+
+// Check if octree building was canceled (build can be NULL)
+static bool IsPointCloudBuildCanceled(PointCloudBuild *build)
+{
+    if (build == NULL) return false;
+
+    pthread_mutex_lock(&build->mutex);
+    bool cancel = build->cancel;
+    pthread_mutex_unlock(&build->mutex);
+
+    return cancel;
+}
+
+// Encode normal with octahedron mapping into point
+static void EncodePointNormal(PointVertex *point, float x, float y, float z)
+{
+    float length = fabsf(x) + fabsf(y) + fabsf(z);
+    if (length <= 0.0f) return;
+
+    x /= length;
+    y /= length;
+
+    if (z < 0.0f)
+    {
+        float ox = (1.0f - fabsf(y))*((x >= 0.0f) ? 1.0f : -1.0f);
+        float oy = (1.0f - fabsf(x))*((y >= 0.0f) ? 1.0f : -1.0f);
+        x = ox;
+        y = oy;
+    }
+
+    point->normal[0] = (short)(x*32767.0f);
+    point->normal[1] = (short)(y*32767.0f);
+}
+
+// Build octree file if it does not exist yet
+static void *PointCloudBuildThread(void *arg)
+{
+    PointCloudBuild *build = (PointCloudBuild *)arg;
+
+    FILE *existing = fopen(build->octreeName, "rb");
+    bool success = (existing != NULL);
+    if (existing != NULL) fclose(existing);
+    else if (strcmp(build->fileName, build->octreeName) != 0) success = BuildPointOctree(build->fileName, build->octreeName, build);
+
+    pthread_mutex_lock(&build->mutex);
+    build->success = success;
+    build->finished = true;
+    pthread_mutex_unlock(&build->mutex);
+
+    return NULL;
+}
+
+// Read requested nodes points from octree file
+static void *PointLoaderThread(void *arg)
+{
+    PointLoader *loader = (PointLoader *)arg;
+
+    pthread_mutex_lock(&loader->mutex);
+
+    while (!loader->quit)
+    {
+        if (loader->requestsHead == loader->requestsTail)
+        {
+            pthread_cond_wait(&loader->cond, &loader->mutex);
+            continue;
+        }
+
+        int index = loader->requests[loader->requestsHead];
+        loader->requestsHead = (loader->requestsHead + 1)%loader->capacity;
+        PointNode *node = &loader->nodes[index];
+        PointVertex *data = (PointVertex *)AllocPool(&loader->pool, node->count*sizeof(PointVertex));
+        pthread_mutex_unlock(&loader->mutex);
+
+        // Read node points without holding the lock (node is requested again if its points could not be allocated or read)
+        size_t read = 0;
+
+        if ((data != NULL) && (POINTCLOUD_FSEEK(loader->file, loader->pointsOffset + (long long)node->offset*sizeof(PointVertex)) == 0))
+        {
+            read = fread(data, sizeof(PointVertex), node->count, loader->file);
+        }
+
+        pthread_mutex_lock(&loader->mutex);
+
+        if ((data != NULL) && (read == node->count))
+        {
+            loader->states[index].data = data;
+            loader->states[index].state = NODE_LOADED;
+            loader->loaded[loader->loadedTail] = index;
+            loader->loadedTail = (loader->loadedTail + 1)%loader->capacity;
+        }
+        else
+        {
+            FreePool(&loader->pool, data);
+            loader->states[index].state = NODE_UNLOADED;
+        }
+    }
+
+    pthread_mutex_unlock(&loader->mutex);
+
+    return NULL;
+}
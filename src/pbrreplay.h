@@ -0,0 +1,622 @@
+/***********************************************************************************
+*
+*   rPBR [replay] - Input recording and deterministic replay for raylib
+*
+*   FEATURES:
+*       - Input consumed by main loop captured once per frame (mouse, buttons, wheel, keys, dropped files,
+*         camera updates and frame delta), so every query in a frame returns the same values.
+*       - Frames recorded into a compact binary log (.rpr), only changed values are written per frame.
+*       - Replay mode feeds the log back with a fixed timestep and no frame rate limit, windowed or headless
+*         (hidden window), and stops when the log ends.
+*       - Frame times trace (CSV) and summary (average, median, 95th percentile, max) to compare builds.
+*
+*   NOTES:
+*       Include this file after every other header which calls raylib input functions and before raygui,
+*       raylib input functions are redirected to replay snapshot functions by macros at the end of this file.
+*       Camera is recorded after UpdateCamera() instead of camera keys, camera module reads raylib input directly.
+*       Replays must be played with the same window size and assets than recorded (dropped files use same paths).
+*       Headless replay still requires an OpenGL context (a virtual display can be used on servers).
+*
+*       Command line options:
+*           --record <file.rpr>     Record input into a log file
+*           --replay <file.rpr>     Replay a log file with a fixed timestep
+*           --headless              Hide window during replay
+*           --trace <file.csv>      Write replay frame times trace
+*
+*   DEPENDENCIES:
+*       raylib for input functions
+*       GLFW for window hiding (headless replay)
+*       pbrmemory.h for tracked allocations (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdio.h>                          // Required for: FILE, fopen(), fread(), fwrite(), fprintf()
+#include <stdlib.h>                         // Required for: qsort()
+#include <string.h>                         // Required for: strcmp(), strncmp(), memset()
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         REPLAY_TIMESTEP             (1.0f/60.0f)                            // Replay fixed frame delta (same as target frame rate)
+#define         REPLAY_MAX_DROPS            8                                       // Max dropped files recorded per frame
+#define         REPLAY_MAX_PATH             512                                     // Max recorded dropped file path length
+#define         REPLAY_MOUSE_BUTTONS        3                                       // Mouse buttons recorded (left, right and middle)
+#define         REPLAY_WATCHED_KEYS         16                                      // Keys recorded as pressed and down bits
+
+// Frame record changed values flags
+#define         REPLAY_CHANGED_MOUSE        1
+#define         REPLAY_CHANGED_WHEEL        2
+#define         REPLAY_CHANGED_BUTTONS      4
+#define         REPLAY_CHANGED_KEYS         8
+#define         REPLAY_CHANGED_KEY          16
+#define         REPLAY_CHANGED_DROPS        32
+#define         REPLAY_CHANGED_CAMERA       64
+
+#if !defined(_glfw3_h_) && !defined(PBR_GLFW_WINDOW)
+    #define PBR_GLFW_WINDOW
+    typedef struct GLFWwindow GLFWwindow;
+    GLFWwindow *glfwGetCurrentContext(void);
+    void glfwHideWindow(GLFWwindow *window);
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef enum {
+    REPLAY_NONE = 0,                        // Input read from raylib, nothing recorded
+    REPLAY_RECORD,                          // Input read from raylib and recorded
+    REPLAY_PLAY                             // Input read from log file
+} ReplayMode;
+
+typedef struct ReplayHeader {
+    char magic[4];                          // Replay file identifier: "RPR1"
+    int screenWidth;                        // Window width when recording started
+    int screenHeight;                       // Window height when recording started
+    int framesCount;                        // Recorded frames (written when recording ends)
+} ReplayHeader;
+
+typedef struct ReplayFrame {
+    float frameTime;                        // Recorded frame delta time
+    Vector2 mouse;                          // Mouse position
+    int wheel;                              // Mouse wheel movement
+    unsigned short buttons;                 // Mouse buttons down, pressed and released bits (3 bits groups)
+    unsigned int keysPressed;               // Watched keys pressed bits
+    unsigned int keysDown;                  // Watched keys down bits
+    int key;                                // Last key pressed (-1 if none)
+    int dropsCount;                         // Dropped files count
+    char *drops[REPLAY_MAX_DROPS];          // Dropped files paths
+    bool cameraUpdated;                     // Camera updated during frame
+    Camera camera;                          // Camera values after update
+} ReplayFrame;
+
+typedef struct Replay {
+    ReplayMode mode;                        // Current replay mode
+    bool headless;                          // Hide window during replay
+    FILE *file;                             // Log file
+    const char *traceName;                  // Frame times trace file name (can be NULL)
+    ReplayHeader header;                    // Log file header
+
+    ReplayFrame frame;                      // Current frame input snapshot
+    ReplayFrame last;                       // Previous frame snapshot (record changed values comparison)
+    char **rawDrops;                        // raylib dropped files (record and none modes)
+    int framesCount;                        // Processed frames
+
+    double lastTime;                        // Last frame start time
+    float *times;                           // Measured frame times in milliseconds
+    int timesCount;
+    int timesCapacity;
+} Replay;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static Replay replay = { 0 };               // Current input replay state
+
+static const int replayKeys[REPLAY_WATCHED_KEYS] = {           // Watched keys (bit index is array index)
+    KEY_R, KEY_SPACE, KEY_H, KEY_F1, KEY_F2, KEY_F3, KEY_F4, KEY_F5, KEY_F6, KEY_F7, KEY_F8, KEY_F9, KEY_F10, KEY_F11, KEY_LEFT, KEY_RIGHT
+};
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+void InitReplay(int argc, char **argv);                                                         // Parse replay command line options and open log file (before window creation)
+void BeginReplay(void);                                                                         // Check replay window size and hide window if headless (after window creation)
+void EndReplay(void);                                                                           // Close log file and write frame times trace and summary
+bool IsReplayPlaying(void);                                                                     // Check if input is read from a log file
+
+bool ReplayShouldClose(void);                                                                   // Advance to next frame input and check if main loop must end
+float ReplayFrameTime(void);                                                                    // Get frame delta time (fixed during replay)
+Vector2 ReplayMousePosition(void);                                                              // Get mouse position
+int ReplayMouseWheelMove(void);                                                                 // Get mouse wheel movement
+bool ReplayMouseButtonDown(int button);                                                         // Check if mouse button is down
+bool ReplayMouseButtonPressed(int button);                                                      // Check if mouse button has been pressed this frame
+bool ReplayMouseButtonReleased(int button);                                                     // Check if mouse button has been released this frame
+bool ReplayKeyPressed(int key);                                                                 // Check if key has been pressed this frame
+bool ReplayKeyDown(int key);                                                                    // Check if key is down
+int ReplayGetKeyPressed(void);                                                                  // Get last key pressed
+bool ReplayFileDropped(void);                                                                   // Check if files have been dropped this frame
+char **ReplayDroppedFiles(int *count);                                                          // Get dropped files paths
+void ReplayClearDroppedFiles(void);                                                             // Clear dropped files
+void ReplayUpdateCamera(Camera *camera);                                                        // Update camera from input (replaced by recorded camera during replay)
+
+static void CaptureReplayFrame(void);                                                           // Capture current frame input from raylib
+static void WriteReplayFrame(void);                                                             // Write current frame changed values to log file
+static bool ReadReplayFrame(void);                                                              // Read next frame changed values from log file
+static void ClearReplayDrops(ReplayFrame *frame);                                               // Free frame dropped files paths
+static int CompareReplayTimes(const void *a, const void *b);                                    // Compare frame times for sorting
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Parse replay command line options and open log file (before window creation)
+void InitReplay(int argc, char **argv)
+{
+    const char *fileName = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--record") == 0) && (i + 1 < argc)) { replay.mode = REPLAY_RECORD; fileName = argv[++i]; }
+        else if ((strcmp(argv[i], "--replay") == 0) && (i + 1 < argc)) { replay.mode = REPLAY_PLAY; fileName = argv[++i]; }
+        else if ((strcmp(argv[i], "--trace") == 0) && (i + 1 < argc)) replay.traceName = argv[++i];
+        else if (strcmp(argv[i], "--headless") == 0) replay.headless = true;
+    }
+
+    replay.frame.key = -1;
+    replay.last.key = -1;
+
+    if (replay.mode == REPLAY_NONE) return;
+
+    replay.file = fopen(fileName, ((replay.mode == REPLAY_RECORD) ? "wb" : "rb"));
+
+    if (replay.file == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] Replay file could not be opened", fileName);
+        replay.mode = REPLAY_NONE;
+        return;
+    }
+
+    if (replay.mode == REPLAY_PLAY)
+    {
+        if ((fread(&replay.header, sizeof(ReplayHeader), 1, replay.file) != 1) || (strncmp(replay.header.magic, "RPR1", 4) != 0))
+        {
+            TraceLog(LOG_WARNING, "[%s] Replay file is not valid", fileName);
+            fclose(replay.file);
+            replay.file = NULL;
+            replay.mode = REPLAY_NONE;
+            return;
+        }
+
+        TraceLog(LOG_INFO, "[%s] Replaying %i frames (%ix%i)", fileName, replay.header.framesCount, replay.header.screenWidth, replay.header.screenHeight);
+    }
+    else TraceLog(LOG_INFO, "[%s] Recording input", fileName);
+}
+
+// Check replay window size and hide window if headless (after window creation)
+void BeginReplay(void)
+{
+    if (replay.mode == REPLAY_RECORD)
+    {
+        // Header is written again with frames count when recording ends
+        replay.header = (ReplayHeader){ { 'R', 'P', 'R', '1' }, GetScreenWidth(), GetScreenHeight(), 0 };
+        fwrite(&replay.header, sizeof(ReplayHeader), 1, replay.file);
+    }
+    else if (replay.mode == REPLAY_PLAY)
+    {
+        if ((replay.header.screenWidth != GetScreenWidth()) || (replay.header.screenHeight != GetScreenHeight()))
+        {
+            TraceLog(LOG_WARNING, "Replay recorded at %ix%i but window is %ix%i, interface input can differ", replay.header.screenWidth, replay.header.screenHeight, GetScreenWidth(), GetScreenHeight());
+        }
+
+        if (replay.headless) glfwHideWindow(glfwGetCurrentContext());
+    }
+
+    replay.lastTime = GetTime();
+}
+
+// Close log file and write frame times trace and summary
+void EndReplay(void)
+{
+    ClearReplayDrops(&replay.frame);
+    ClearReplayDrops(&replay.last);
+
+    if (replay.mode == REPLAY_RECORD)
+    {
+        // Update header frames count with finished frames
+        // NOTE: last captured frame is discarded, main loop ended before running it
+        replay.header.framesCount = replay.timesCount;
+        fseek(replay.file, 0, SEEK_SET);
+        fwrite(&replay.header, sizeof(ReplayHeader), 1, replay.file);
+        TraceLog(LOG_INFO, "Replay recorded (%i frames)", replay.header.framesCount);
+    }
+
+    if (replay.file != NULL) fclose(replay.file);
+
+    // First frame includes loading, so it is excluded from trace and summary
+    if ((replay.mode == REPLAY_PLAY) && (replay.timesCount > 1))
+    {
+        int count = replay.timesCount - 1;
+        float *times = replay.times + 1;
+
+        if (replay.traceName != NULL)
+        {
+            FILE *trace = fopen(replay.traceName, "w");
+
+            if (trace != NULL)
+            {
+                fprintf(trace, "frame,time_ms\n");
+                for (int i = 0; i < count; i++) fprintf(trace, "%i,%.3f\n", i + 1, times[i]);
+                fclose(trace);
+            }
+            else TraceLog(LOG_WARNING, "[%s] Replay trace file could not be written", replay.traceName);
+        }
+
+        double total = 0.0;
+        for (int i = 0; i < count; i++) total += times[i];
+        qsort(times, count, sizeof(float), CompareReplayTimes);
+
+        TraceLog(LOG_INFO, "Replay frame times: %i frames, %.3f ms average, %.3f ms median, %.3f ms 95th percentile, %.3f ms max",
+                 count, total/count, times[count/2], times[(int)(count*0.95f)], times[count - 1]);
+    }
+
+    PBR_FREE(replay.times);
+    replay = (Replay){ 0 };
+}
+
+// Check if input is read from a log file
+bool IsReplayPlaying(void)
+{
+    return (replay.mode == REPLAY_PLAY);
+}
+
+// Advance to next frame input and check if main loop must end
+// NOTE: called once per frame by main loop condition, previous frame is finished here
+bool ReplayShouldClose(void)
+{
+    double time = GetTime();
+
+    if (replay.framesCount > 0)
+    {
+        if (replay.timesCount == replay.timesCapacity)
+        {
+            replay.timesCapacity = ((replay.timesCapacity > 0) ? replay.timesCapacity*2 : 1024);
+            replay.times = (float *)PBR_REALLOC(MEMORY_UI, replay.times, replay.timesCapacity*sizeof(float));
+        }
+
+        replay.times[replay.timesCount++] = (float)((time - replay.lastTime)*1000.0);
+        if (replay.mode == REPLAY_RECORD) WriteReplayFrame();
+    }
+
+    replay.lastTime = time;
+
+    if (replay.mode == REPLAY_PLAY)
+    {
+        if (!ReadReplayFrame()) return true;
+    }
+    else CaptureReplayFrame();
+
+    replay.framesCount++;
+
+    return WindowShouldClose();
+}
+
+// Get frame delta time (fixed during replay)
+float ReplayFrameTime(void)
+{
+    return ((replay.mode == REPLAY_PLAY) ? REPLAY_TIMESTEP : replay.frame.frameTime);
+}
+
+// Get mouse position
+Vector2 ReplayMousePosition(void)
+{
+    return replay.frame.mouse;
+}
+
+// Get mouse wheel movement
+int ReplayMouseWheelMove(void)
+{
+    return replay.frame.wheel;
+}
+
+// Check if mouse button is down
+bool ReplayMouseButtonDown(int button)
+{
+    return ((button < REPLAY_MOUSE_BUTTONS) && (replay.frame.buttons & (1 << button)));
+}
+
+// Check if mouse button has been pressed this frame
+bool ReplayMouseButtonPressed(int button)
+{
+    return ((button < REPLAY_MOUSE_BUTTONS) && (replay.frame.buttons & (1 << (REPLAY_MOUSE_BUTTONS + button))));
+}
+
+// Check if mouse button has been released this frame
+bool ReplayMouseButtonReleased(int button)
+{
+    return ((button < REPLAY_MOUSE_BUTTONS) && (replay.frame.buttons & (1 << (REPLAY_MOUSE_BUTTONS*2 + button))));
+}
+
+// Check if key has been pressed this frame
+// NOTE: keys not watched are read from raylib (always false during replay)
+bool ReplayKeyPressed(int key)
+{
+    for (int i = 0; i < REPLAY_WATCHED_KEYS; i++)
+    {
+        if (replayKeys[i] == key) return (replay.frame.keysPressed & (1u << i));
+    }
+
+    return ((replay.mode != REPLAY_PLAY) && IsKeyPressed(key));
+}
+
+// Check if key is down
+bool ReplayKeyDown(int key)
+{
+    for (int i = 0; i < REPLAY_WATCHED_KEYS; i++)
+    {
+        if (replayKeys[i] == key) return (replay.frame.keysDown & (1u << i));
+    }
+
+    return ((replay.mode != REPLAY_PLAY) && IsKeyDown(key));
+}
+
+// Get last key pressed
+int ReplayGetKeyPressed(void)
+{
+    return replay.frame.key;
+}
+
+// Check if files have been dropped this frame
+bool ReplayFileDropped(void)
+{
+    return ((replay.mode == REPLAY_PLAY) ? (replay.frame.dropsCount > 0) : (replay.rawDrops != NULL));
+}
+
+// Get dropped files paths
+char **ReplayDroppedFiles(int *count)
+{
+    *count = replay.frame.dropsCount;
+
+    return ((replay.mode == REPLAY_PLAY) ? replay.frame.drops : replay.rawDrops);
+}
+
+// Clear dropped files
+// NOTE: recorded paths copies are kept until frame is written
+void ReplayClearDroppedFiles(void)
+{
+    if (replay.mode == REPLAY_PLAY) ClearReplayDrops(&replay.frame);
+    else ClearDroppedFiles();
+
+    replay.rawDrops = NULL;
+}
+
+// Update camera from input (replaced by recorded camera during replay)
+void ReplayUpdateCamera(Camera *camera)
+{
+    if (replay.mode == REPLAY_PLAY)
+    {
+        if (replay.frame.cameraUpdated) *camera = replay.frame.camera;
+    }
+    else
+    {
+        UpdateCamera(camera);
+        replay.frame.cameraUpdated = true;
+        replay.frame.camera = *camera;
+    }
+}
+
+// Capture current frame input from raylib
+static void CaptureReplayFrame(void)
+{
+    ReplayFrame *frame = &replay.frame;
+
+    ClearReplayDrops(frame);
+
+    frame->frameTime = GetFrameTime();
+    frame->mouse = GetMousePosition();
+    frame->wheel = GetMouseWheelMove();
+    frame->key = GetKeyPressed();
+    frame->buttons = 0;
+    frame->keysPressed = 0;
+    frame->keysDown = 0;
+    frame->cameraUpdated = false;
+
+    for (int i = 0; i < REPLAY_MOUSE_BUTTONS; i++)
+    {
+        if (IsMouseButtonDown(i)) frame->buttons |= (1 << i);
+        if (IsMouseButtonPressed(i)) frame->buttons |= (1 << (REPLAY_MOUSE_BUTTONS + i));
+        if (IsMouseButtonReleased(i)) frame->buttons |= (1 << (REPLAY_MOUSE_BUTTONS*2 + i));
+    }
+
+    for (int i = 0; i < REPLAY_WATCHED_KEYS; i++)
+    {
+        if (IsKeyPressed(replayKeys[i])) frame->keysPressed |= (1u << i);
+        if (IsKeyDown(replayKeys[i])) frame->keysDown |= (1u << i);
+    }
+
+    frame->dropsCount = 0;
+    replay.rawDrops = NULL;
+
+    if (IsFileDropped())
+    {
+        replay.rawDrops = GetDroppedFiles(&frame->dropsCount);
+
+        // Keep a copy of dropped paths to write them with frame
+        if (replay.mode == REPLAY_RECORD)
+        {
+            for (int i = 0; (i < frame->dropsCount) && (i < REPLAY_MAX_DROPS); i++)
+            {
+                frame->drops[i] = (char *)PBR_MALLOC(MEMORY_UI, REPLAY_MAX_PATH);
+                snprintf(frame->drops[i], REPLAY_MAX_PATH, "%s", replay.rawDrops[i]);
+            }
+        }
+    }
+}
+
+// Write current frame changed values to log file
+// NOTE: frame delta is always written, changed flags byte tells which values follow
+static void WriteReplayFrame(void)
+{
+    ReplayFrame *frame = &replay.frame;
+    ReplayFrame *last = &replay.last;
+    unsigned char changed = 0;
+
+    if ((frame->mouse.x != last->mouse.x) || (frame->mouse.y != last->mouse.y)) changed |= REPLAY_CHANGED_MOUSE;
+    if (frame->wheel != last->wheel) changed |= REPLAY_CHANGED_WHEEL;
+    if (frame->buttons != last->buttons) changed |= REPLAY_CHANGED_BUTTONS;
+    if ((frame->keysPressed != last->keysPressed) || (frame->keysDown != last->keysDown)) changed |= REPLAY_CHANGED_KEYS;
+    if (frame->key != last->key) changed |= REPLAY_CHANGED_KEY;
+    if (frame->dropsCount > 0) changed |= REPLAY_CHANGED_DROPS;
+    if (frame->cameraUpdated) changed |= REPLAY_CHANGED_CAMERA;
+
+    fwrite(&changed, 1, 1, replay.file);
+    fwrite(&frame->frameTime, sizeof(float), 1, replay.file);
+
+    if (changed & REPLAY_CHANGED_MOUSE) fwrite(&frame->mouse, sizeof(Vector2), 1, replay.file);
+    if (changed & REPLAY_CHANGED_WHEEL) fwrite(&frame->wheel, sizeof(int), 1, replay.file);
+    if (changed & REPLAY_CHANGED_BUTTONS) fwrite(&frame->buttons, sizeof(unsigned short), 1, replay.file);
+    if (changed & REPLAY_CHANGED_KEYS)
+    {
+        fwrite(&frame->keysPressed, sizeof(unsigned int), 1, replay.file);
+        fwrite(&frame->keysDown, sizeof(unsigned int), 1, replay.file);
+    }
+    if (changed & REPLAY_CHANGED_KEY) fwrite(&frame->key, sizeof(int), 1, replay.file);
+    if (changed & REPLAY_CHANGED_DROPS)
+    {
+        unsigned char count = (unsigned char)((frame->dropsCount < REPLAY_MAX_DROPS) ? frame->dropsCount : REPLAY_MAX_DROPS);
+        fwrite(&count, 1, 1, replay.file);
+
+        for (int i = 0; i < count; i++)
+        {
+            unsigned short length = (unsigned short)strlen(frame->drops[i]);
+            fwrite(&length, sizeof(unsigned short), 1, replay.file);
+            fwrite(frame->drops[i], 1, length, replay.file);
+        }
+    }
+    if (changed & REPLAY_CHANGED_CAMERA) fwrite(&frame->camera, sizeof(Camera), 1, replay.file);
+
+    // Dropped files are not compared between frames, so they are freed once written
+    ClearReplayDrops(frame);
+    *last = *frame;
+}
+
+// Read next frame changed values from log file (false at end of file or truncated frame)
+// NOTE: values not changed keep previous frame values
+static bool ReadReplayFrame(void)
+{
+    ReplayFrame *frame = &replay.frame;
+    unsigned char changed = 0;
+
+    ClearReplayDrops(frame);
+    frame->cameraUpdated = false;
+
+    if ((fread(&changed, 1, 1, replay.file) != 1) || (fread(&frame->frameTime, sizeof(float), 1, replay.file) != 1)) return false;
+
+    bool success = true;
+
+    if (changed & REPLAY_CHANGED_MOUSE) success &= (fread(&frame->mouse, sizeof(Vector2), 1, replay.file) == 1);
+    if (changed & REPLAY_CHANGED_WHEEL) success &= (fread(&frame->wheel, sizeof(int), 1, replay.file) == 1);
+    if (changed & REPLAY_CHANGED_BUTTONS) success &= (fread(&frame->buttons, sizeof(unsigned short), 1, replay.file) == 1);
+    if (changed & REPLAY_CHANGED_KEYS)
+    {
+        success &= (fread(&frame->keysPressed, sizeof(unsigned int), 1, replay.file) == 1);
+        success &= (fread(&frame->keysDown, sizeof(unsigned int), 1, replay.file) == 1);
+    }
+    if (changed & REPLAY_CHANGED_KEY) success &= (fread(&frame->key, sizeof(int), 1, replay.file) == 1);
+    if (changed & REPLAY_CHANGED_DROPS)
+    {
+        unsigned char count = 0;
+        success &= (fread(&count, 1, 1, replay.file) == 1);
+
+        for (int i = 0; success && (i < count) && (i < REPLAY_MAX_DROPS); i++)
+        {
+            unsigned short length = 0;
+            if (fread(&length, sizeof(unsigned short), 1, replay.file) != 1)
+            {
+                success = false;
+                break;
+            }
+
+            frame->drops[i] = (char *)PBR_MALLOC(MEMORY_UI, length + 1);
+            frame->dropsCount++;
+
+            success &= (fread(frame->drops[i], 1, length, replay.file) == length);
+            frame->drops[i][length] = '\0';
+        }
+    }
+    if (changed & REPLAY_CHANGED_CAMERA)
+    {
+        success &= (fread(&frame->camera, sizeof(Camera), 1, replay.file) == 1);
+        frame->cameraUpdated = true;
+    }
+
+    // Truncated frame ends replay (its values are incomplete)
+    if (!success) TraceLog(LOG_WARNING, "Replay log file ends with a truncated frame");
+
+    return success;
+}
+
+// Free frame dropped files paths
+static void ClearReplayDrops(ReplayFrame *frame)
+{
+    for (int i = 0; i < REPLAY_MAX_DROPS; i++)
+    {
+        PBR_FREE(frame->drops[i]);
+        frame->drops[i] = NULL;
+    }
+
+    frame->dropsCount = 0;
+}
+
+// Compare frame times for sorting
+static int CompareReplayTimes(const void *a, const void *b)
+{
+    float timeA = *(const float *)a;
+    float timeB = *(const float *)b;
+
+    return ((timeA > timeB) - (timeA < timeB));
+}
+
+//----------------------------------------------------------------------------------
+// raylib input redirection (main loop and raygui read input through replay snapshot)
+//----------------------------------------------------------------------------------
+#define WindowShouldClose() ReplayShouldClose()
+#define GetFrameTime() ReplayFrameTime()
+#define GetMousePosition() ReplayMousePosition()
+#define GetMouseX() ((int)ReplayMousePosition().x)
+#define GetMouseY() ((int)ReplayMousePosition().y)
+#define GetMouseWheelMove() ReplayMouseWheelMove()
+#define IsMouseButtonDown(button) ReplayMouseButtonDown(button)
+#define IsMouseButtonUp(button) (!ReplayMouseButtonDown(button))
+#define IsMouseButtonPressed(button) ReplayMouseButtonPressed(button)
+#define IsMouseButtonReleased(button) ReplayMouseButtonReleased(button)
+#define IsKeyPressed(key) ReplayKeyPressed(key)
+#define IsKeyDown(key) ReplayKeyDown(key)
+#define GetKeyPressed() ReplayGetKeyPressed()
+#define IsFileDropped() ReplayFileDropped()
+#define GetDroppedFiles(count) ReplayDroppedFiles(count)
+#define ClearDroppedFiles() ReplayClearDroppedFiles()
+#define UpdateCamera(camera) ReplayUpdateCamera(camera)
@@ -0,0 +1,961 @@
+/***********************************************************************************
+*
+*   rPBR [server] - Render server mode answering render requests over a Unix domain socket
+*
+*   FEATURES:
+*       - Enabled with --serve <socket path>, viewer window keeps rendering requests until it is closed.
+*       - Text requests (model, texture set, HDR, camera, size and render mode) answered with PNG bytes.
+*       - Environments (with their compiled shader programs), models and textures cached between requests
+*         (least recently used slots are replaced, files modified on disk are reloaded).
+*       - Pending requests of all clients are batched and sorted by environment, size and model, so
+*         compatible requests share environment setup, render targets and loaded assets.
+*       - Warm (all assets cached) and cold requests counted separately, requests per second reported.
+*       - Image regions rendered with off-center projections and raw RGBA8 responses, so a coordinator
+*         (rpbrfarm) can split a frame in tiles across several server processes and stitch them.
+*
+*   NOTES:
+*       A request is a list of "key value" lines terminated by an empty line:
+*           id <text>                           Identifier echoed in response (default is client request index)
+*           model <path>                        OBJ model (required)
+*           hdr <path>                          Equirectangular HDR environment (required)
+*           textures <prefix>                   Texture maps loaded from <prefix>_albedo.png, <prefix>_normals.png...
+*           camera <px py pz tx ty tz [fovy]>   Camera position, target and field of view
+*           size <width>x<height>               Output image dimensions
+*           region <x y width height>           Render only a region of output image (pixels, used for tiles)
+*           mode <name or index>                Render mode (default, albedo, normals...)
+*           vignette <0|1>                      Apply vignette effect (disabled for tiles, applied once stitched)
+*           format <png|raw>                    Response image format (raw is RGBA8 pixels from top to bottom)
+*       Response is a header line followed by image bytes ("OK <id> <bytes> <milliseconds> <warm|cold>")
+*       or an error line ("ERROR <id> <message>"). Responses of a batch can arrive in a different order
+*       than requests, use ids to match them. Example:
+*           printf 'model resources/models/cerberus.obj\nhdr resources/textures/hdr/pinetree.hdr\n\n' | nc -U /tmp/rpbr.sock
+*       PNG images are encoded with a small fixed Huffman deflate (faster than smallest).
+*       Render server is not available on Windows (no Unix domain sockets in raylib toolchain).
+*
+*   DEPENDENCIES:
+*       pbrcore.h for environments, materials and models (must be included before this file)
+*       pbrmemory.h for tracked allocations (must be included before this file)
+*       POSIX sockets for Unix domain socket
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdio.h>                          // Required for: snprintf(), sscanf()
+#include <stdlib.h>                         // Required for: qsort(), atoi()
+#include <string.h>                         // Required for: strcmp(), strncmp(), memmove(), memchr()
+#include <sys/stat.h>                       // Required for: stat()
+
+#if !defined(_WIN32)
+    #include <unistd.h>                     // Required for: close(), unlink()
+    #include <sys/socket.h>                 // Required for: socket(), bind(), listen(), accept(), send(), recv()
+    #include <sys/select.h>                 // Required for: select()
+    #include <sys/time.h>                   // Required for: struct timeval
+    #include <sys/un.h>                     // Required for: struct sockaddr_un
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         SERVER_MAX_CLIENTS          16                                      // Max connected clients
+#define         SERVER_MAX_BATCH            32                                      // Max requests rendered per batch
+#define         SERVER_MAX_PATH             512                                     // Max request paths length
+#define         SERVER_MAX_ID               64                                      // Max request identifier length
+#define         SERVER_MAX_SIZE             4096                                    // Max output image width or height
+#define         SERVER_REQUEST_SIZE         8192                                    // Max pending request bytes per client
+#define         SERVER_CACHE_ENVIRONMENTS   4                                       // Cached environments (each one owns its shader programs)
+#define         SERVER_CACHE_MODELS         16                                      // Cached models
+#define         SERVER_CACHE_TEXTURES       64                                      // Cached textures
+#define         SERVER_CUBEMAP_SIZE         1024                                    // Environments cubemap size (same than viewer)
+#define         SERVER_IRRADIANCE_SIZE      32                                      // Environments irradiance map size
+#define         SERVER_PREFILTERED_SIZE     256                                     // Environments prefiltered map size
+#define         SERVER_BRDF_SIZE            512                                     // Environments BRDF LUT size
+#define         SERVER_DEFAULT_WIDTH        640                                     // Default output image width
+#define         SERVER_DEFAULT_HEIGHT       360                                     // Default output image height
+#define         SERVER_DEFAULT_FOVY         60.0f                                   // Default camera field of view
+#define         SERVER_POLL_TIMEOUT         50                                      // Wait for requests when idle (milliseconds, window stays responsive)
+#define         SERVER_REPORT_INTERVAL      10.0                                    // Requests per second report interval (seconds)
+#define         PNG_HASH_BITS               15                                      // Deflate matches hash table bits
+#define         PNG_WINDOW_SIZE             32768                                   // Deflate matches window size
+#define         PNG_MAX_CHAIN               32                                      // Deflate matches candidates checked per position
+#define         PNG_NICE_LENGTH             64                                      // Deflate match length which stops candidates search
+
+#if defined(MSG_NOSIGNAL)
+    #define     SERVER_SEND_FLAGS           MSG_NOSIGNAL                            // Don't raise SIGPIPE when client disconnects
+#else
+    #define     SERVER_SEND_FLAGS           0
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct RenderRequest {
+    int client;                             // Client slot index
+    int socket;                             // Client socket (response is dropped if client slot was reused)
+    char id[SERVER_MAX_ID];                 // Request identifier echoed in response
+    char model[SERVER_MAX_PATH];            // Model file path
+    char textures[SERVER_MAX_PATH];         // Texture maps files prefix (empty for no textures)
+    char hdr[SERVER_MAX_PATH];              // HDR environment file path
+    char mode[32];                          // Render mode name or index
+    Camera camera;                          // Render camera
+    int width;                              // Output image width
+    int height;                             // Output image height
+    Rectangle region;                       // Rendered region of output image in pixels (whole image by default)
+    bool vignette;                          // Apply vignette effect
+    bool raw;                               // Send raw RGBA8 pixels instead of PNG bytes
+    char error[128];                        // Request parse error (empty if valid)
+} RenderRequest;
+
+typedef struct ServerClient {
+    int socket;                             // Client socket (-1 if slot is free)
+    int requests;                           // Parsed requests count (default identifiers)
+    int length;                             // Pending bytes in buffer
+    char buffer[SERVER_REQUEST_SIZE];       // Pending request bytes
+} ServerClient;
+
+typedef struct ServerCacheKey {
+    bool used;                              // Slot holds a resource
+    char path[SERVER_MAX_PATH];             // Resource file path
+    long long modTime;                      // File modification time when loaded
+    unsigned int lastUse;                   // Last use counter (least recently used slot is replaced)
+} ServerCacheKey;
+
+typedef struct ServerEnvironment {
+    Environment env;                        // Environment cubemaps and shader programs
+    MaterialPBR material;                   // Material set up for environment shader (no textures)
+    int modeLoc;                            // Render mode shader location
+    int skyProjectionLoc;                   // Skybox projection shader location (regions use off-center projections)
+} ServerEnvironment;
+
+typedef struct RenderServer {
+    bool enabled;                           // Render server requested
+    char path[108];                         // Unix domain socket path
+    int listener;                           // Listening socket
+    ServerClient clients[SERVER_MAX_CLIENTS];
+
+    unsigned int useCounter;                // Cache slots use counter
+    ServerCacheKey environmentKeys[SERVER_CACHE_ENVIRONMENTS];
+    ServerEnvironment environments[SERVER_CACHE_ENVIRONMENTS];
+    ServerCacheKey modelKeys[SERVER_CACHE_MODELS];
+    Model models[SERVER_CACHE_MODELS];
+    ServerCacheKey textureKeys[SERVER_CACHE_TEXTURES];
+    Texture2D textures[SERVER_CACHE_TEXTURES];
+
+    int warmCount;                          // Answered requests with all assets cached
+    int coldCount;                          // Answered requests which loaded assets
+    double warmTime;                        // Warm requests render and encode time (seconds)
+    double coldTime;                        // Cold requests load, render and encode time (seconds)
+    int batches;                            // Rendered batches count
+    double lastReport;                      // Last requests per second report time
+} RenderServer;
+
+typedef struct PngStream {
+    unsigned char *data;                    // Output buffer
+    int size;                               // Output bytes written
+    unsigned int bits;                      // Pending bits (LSB first)
+    int bitsCount;                          // Pending bits count
+} PngStream;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static const int pngLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const int pngLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const int pngDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const int pngDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static unsigned int pngCrcTable[256] = { 0 };
+static unsigned int pngCodes[288] = { 0 };                               // Fixed Huffman literal/length codes (bits reversed)
+static int pngCodeLengths[288] = { 0 };                                  // Fixed Huffman literal/length codes lengths
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+RenderServer *InitRenderServer(int argc, char **argv);                                         // Check --serve option and listen on its Unix domain socket (NULL if not requested)
+int PollRenderRequests(RenderServer *server, RenderRequest *requests, int max, int timeout);    // Read clients requests, wait up to timeout milliseconds if none is pending (returns batch sorted by compatibility)
+ServerEnvironment *GetServerEnvironment(RenderServer *server, const char *path, bool *cold);   // Get cached environment or load it (NULL if file is missing)
+Model *GetServerModel(RenderServer *server, const char *path, bool *cold);                     // Get cached model or load it (NULL if file is missing)
+Texture2D GetServerTexture(RenderServer *server, const char *path, bool *cold);                // Get cached texture or load it (id 0 if file is missing)
+void SendRenderImage(RenderServer *server, RenderRequest *request, Image image, bool cold, double startTime);    // Encode image (RGBA8) as PNG (unless raw format was requested), send it and count request time
+void SendRenderError(RenderServer *server, RenderRequest *request, const char *message);       // Send request error line
+void ReportRenderServer(RenderServer *server, bool force);                                     // Log warm and cold requests per second (every report interval)
+void CloseRenderServer(RenderServer *server);                                                  // Unload cached resources, disconnect clients and remove socket file
+unsigned char *EncodeImagePNG(Image image, int *size);                                         // Encode an UNCOMPRESSED_R8G8B8A8 image as PNG file bytes (free with PBR_FREE())
+
+static bool ParseRenderRequest(ServerClient *client, int index, RenderRequest *request);        // Parse a complete request from client buffer (false if none is complete)
+static int CompareRenderRequests(const void *a, const void *b);                                 // Sort requests by environment, rendered size, model and textures
+static int FindServerCacheSlot(RenderServer *server, ServerCacheKey *keys, int count, const char *path, bool *found);   // Find path slot or least recently used slot
+static void SendServerBytes(RenderServer *server, RenderRequest *request, const void *data, int size);   // Send bytes to request client (disconnects it on failure)
+static void CloseServerClient(RenderServer *server, int index);                                 // Close a client connection
+static void WritePngBits(PngStream *stream, unsigned int value, int count);                     // Write bits to deflate stream (LSB first)
+static void WritePngCode(PngStream *stream, int symbol);                                        // Write a fixed Huffman literal/length symbol
+static void WritePngMatch(PngStream *stream, int length, int distance);                         // Write a fixed Huffman length and distance pair
+static int GetPngPaeth(int a, int b, int c);                                                    // Get PNG paeth predictor
+static void WritePngChunkEnd(unsigned char *png, int start, int *size);                         // Write chunk length and CRC of chunk started at start
+static unsigned int GetPngCrc(const unsigned char *data, int size);                             // Get PNG chunk CRC32
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Check --serve option and listen on its Unix domain socket (NULL if not requested)
+RenderServer *InitRenderServer(int argc, char **argv)
+{
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--serve") == 0) && (i + 1 < argc)) path = argv[i + 1];
+    }
+
+    if (path == NULL) return NULL;
+
+#if defined(_WIN32)
+    TraceLog(LOG_WARNING, "Render server is not available on Windows");
+    return NULL;
+#else
+    RenderServer *server = (RenderServer *)PBR_CALLOC(MEMORY_OTHER, 1, sizeof(RenderServer));
+    struct sockaddr_un address = { 0 };
+
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    strncpy(server->path, address.sun_path, sizeof(server->path) - 1);
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) server->clients[i].socket = -1;
+
+    // Remove socket file left by a previous server which did not close
+    unlink(server->path);
+    server->listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if ((server->listener < 0) || (bind(server->listener, (struct sockaddr *)&address, sizeof(address)) != 0) || (listen(server->listener, SERVER_MAX_CLIENTS) != 0))
+    {
+        TraceLog(LOG_WARNING, "[%s] Render server socket could not be created", server->path);
+        if (server->listener >= 0) close(server->listener);
+        PBR_FREE(server);
+        return NULL;
+    }
+
+    server->enabled = true;
+    server->lastReport = GetTime();
+    TraceLog(LOG_INFO, "[%s] Render server listening", server->path);
+
+    return server;
+#endif
+}
+
+// Read clients requests, wait up to timeout milliseconds if none is pending (returns batch sorted by compatibility)
+// NOTE: requests already buffered are returned without waiting, remaining ones stay buffered for next batch
+int PollRenderRequests(RenderServer *server, RenderRequest *requests, int max, int timeout)
+{
+    int count = 0;
+
+#if !defined(_WIN32)
+    // Parse requests left in buffers by previous full batch
+    for (int i = 0; (i < SERVER_MAX_CLIENTS) && (count < max); i++)
+    {
+        while ((server->clients[i].socket >= 0) && (count < max) && ParseRenderRequest(&server->clients[i], i, &requests[count])) count++;
+    }
+
+    if (count < max)
+    {
+        fd_set readable;
+        int maxSocket = server->listener;
+        struct timeval wait = { 0, ((count > 0) ? 0 : timeout*1000) };
+
+        FD_ZERO(&readable);
+        FD_SET(server->listener, &readable);
+
+        for (int i = 0; i < SERVER_MAX_CLIENTS; i++)
+        {
+            if (server->clients[i].socket < 0) continue;
+            FD_SET(server->clients[i].socket, &readable);
+            if (server->clients[i].socket > maxSocket) maxSocket = server->clients[i].socket;
+        }
+
+        if (select(maxSocket + 1, &readable, NULL, NULL, &wait) > 0)
+        {
+            // Accept new client in a free slot (refused if all slots are used)
+            if (FD_ISSET(server->listener, &readable))
+            {
+                int socket = accept(server->listener, NULL, NULL);
+                int slot = -1;
+
+                for (int i = 0; (i < SERVER_MAX_CLIENTS) && (slot < 0); i++) if (server->clients[i].socket < 0) slot = i;
+
+                if ((socket >= 0) && (slot >= 0))
+                {
+                    server->clients[slot].socket = socket;
+                    server->clients[slot].requests = 0;
+                    server->clients[slot].length = 0;
+                }
+                else if (socket >= 0) close(socket);
+            }
+
+            for (int i = 0; i < SERVER_MAX_CLIENTS; i++)
+            {
+                ServerClient *client = &server->clients[i];
+
+                if ((client->socket < 0) || !FD_ISSET(client->socket, &readable)) continue;
+
+                int received = (int)recv(client->socket, client->buffer + client->length, SERVER_REQUEST_SIZE - client->length, 0);
+
+                if (received <= 0) CloseServerClient(server, i);
+                else
+                {
+                    client->length += received;
+
+                    while ((count < max) && ParseRenderRequest(client, i, &requests[count])) count++;
+
+                    // Pending bytes filled buffer without a complete request
+                    if ((client->length == SERVER_REQUEST_SIZE) && (count < max))
+                    {
+                        RenderRequest request = { .client = i, .socket = client->socket };
+                        SendRenderError(server, &request, "request is too long");
+                        CloseServerClient(server, i);
+                    }
+                }
+            }
+        }
+    }
+
+    // Sort batch so compatible requests are rendered together
+    qsort(requests, count, sizeof(RenderRequest), CompareRenderRequests);
+    if (count > 0) server->batches++;
+#endif
+
+    return count;
+}
+
+// Get cached environment or load it (NULL if file is missing)
+// NOTE: cold is set when environment is loaded, caller must set its lights and effects uniforms
+ServerEnvironment *GetServerEnvironment(RenderServer *server, const char *path, bool *cold)
+{
+    bool found = false;
+    int slot = FindServerCacheSlot(server, server->environmentKeys, SERVER_CACHE_ENVIRONMENTS, path, &found);
+
+    if (slot < 0) return NULL;
+
+    if (!found)
+    {
+        if (server->environmentKeys[slot].used) UnloadEnvironment(server->environments[slot].env);
+
+        ServerEnvironment *entry = &server->environments[slot];
+        entry->env = LoadEnvironment(path, SERVER_CUBEMAP_SIZE, SERVER_IRRADIANCE_SIZE, SERVER_PREFILTERED_SIZE, SERVER_BRDF_SIZE);
+        entry->material = SetupMaterialPBR(entry->env, (Color){ 255, 255, 255, 255 }, 255, 255);
+        entry->modeLoc = GetShaderLocation(entry->env.pbrShader, "renderMode");
+        entry->skyProjectionLoc = GetShaderLocation(entry->env.skyShader, "projection");
+        server->environmentKeys[slot].used = true;
+        *cold = true;
+    }
+
+    return &server->environments[slot];
+}
+
+// Get cached model or load it (NULL if file is missing)
+Model *GetServerModel(RenderServer *server, const char *path, bool *cold)
+{
+    bool found = false;
+    int slot = FindServerCacheSlot(server, server->modelKeys, SERVER_CACHE_MODELS, path, &found);
+
+    if (slot < 0) return NULL;
+
+    if (!found)
+    {
+        // Materials shaders belong to cached environments
+        if (server->modelKeys[slot].used)
+        {
+            server->models[slot].material = (Material){ 0 };
+            UnloadModel(server->models[slot]);
+        }
+
+        BeginMemoryScope(MEMORY_MODEL);
+        server->models[slot] = LoadModel(path);
+        EndMemoryScope();
+        server->modelKeys[slot].used = true;
+        *cold = true;
+    }
+
+    return &server->models[slot];
+}
+
+// Get cached texture or load it (id 0 if file is missing)
+Texture2D GetServerTexture(RenderServer *server, const char *path, bool *cold)
+{
+    bool found = false;
+    int slot = FindServerCacheSlot(server, server->textureKeys, SERVER_CACHE_TEXTURES, path, &found);
+
+    if (slot < 0) return (Texture2D){ 0 };
+
+    if (!found)
+    {
+        if (server->textureKeys[slot].used && (server->textures[slot].id != 0))
+        {
+            ForgetTextureGL(server->textures[slot].id);
+            UnloadTexture(server->textures[slot]);
+        }
+
+        BeginMemoryScope(MEMORY_TEXTURES);
+        server->textures[slot] = LoadTexture(path);
+        EndMemoryScope();
+        SetTextureFilter(server->textures[slot], FILTER_BILINEAR);
+        server->textureKeys[slot].used = true;
+        *cold = true;
+    }
+
+    return server->textures[slot];
+}
+
+// Encode image (RGBA8) as PNG (unless raw format was requested), send it and count request time
+void SendRenderImage(RenderServer *server, RenderRequest *request, Image image, bool cold, double startTime)
+{
+    int size = image.width*image.height*4;
+    unsigned char *png = request->raw ? NULL : EncodeImagePNG(image, &size);
+    double time = GetTime() - startTime;
+    char header[160] = { 0 };
+
+    int length = snprintf(header, sizeof(header), "OK %s %i %.2f %s\n", request->id, size, time*1000.0, (cold ? "cold" : "warm"));
+    SendServerBytes(server, request, header, length);
+    SendServerBytes(server, request, (request->raw ? image.data : png), size);
+    if (png != NULL) PBR_FREE(png);
+
+    if (cold)
+    {
+        server->coldCount++;
+        server->coldTime += time;
+    }
+    else
+    {
+        server->warmCount++;
+        server->warmTime += time;
+    }
+}
+
+// Send request error line
+void SendRenderError(RenderServer *server, RenderRequest *request, const char *message)
+{
+    char line[256] = { 0 };
+    int length = snprintf(line, sizeof(line), "ERROR %s %s\n", ((request->id[0] != '\0') ? request->id : "-"), message);
+
+    SendServerBytes(server, request, line, length);
+}
+
+// Log warm and cold requests per second (every report interval)
+// NOTE: rates are requests count divided by their own time (load, render, read back and encode)
+void ReportRenderServer(RenderServer *server, bool force)
+{
+    double time = GetTime();
+
+    if (!force && ((time - server->lastReport) < SERVER_REPORT_INTERVAL)) return;
+    if ((server->warmCount + server->coldCount) == 0) return;
+
+    TraceLog(LOG_INFO, "Render server: %i warm requests (%.1f req/s), %i cold requests (%.1f req/s), %.1f requests per batch",
+             server->warmCount, ((server->warmTime > 0.0) ? server->warmCount/server->warmTime : 0.0),
+             server->coldCount, ((server->coldTime > 0.0) ? server->coldCount/server->coldTime : 0.0),
+             (float)(server->warmCount + server->coldCount)/((server->batches > 0) ? server->batches : 1));
+
+    server->lastReport = time;
+}
+
+// Unload cached resources, disconnect clients and remove socket file
+void CloseRenderServer(RenderServer *server)
+{
+    if (server == NULL) return;
+
+    ReportRenderServer(server, true);
+
+    for (int i = 0; i < SERVER_CACHE_ENVIRONMENTS; i++) if (server->environmentKeys[i].used) UnloadEnvironment(server->environments[i].env);
+
+    for (int i = 0; i < SERVER_CACHE_MODELS; i++)
+    {
+        if (!server->modelKeys[i].used) continue;
+        server->models[i].material = (Material){ 0 };
+        UnloadModel(server->models[i]);
+    }
+
+    for (int i = 0; i < SERVER_CACHE_TEXTURES; i++)
+    {
+        if (!server->textureKeys[i].used || (server->textures[i].id == 0)) continue;
+        ForgetTextureGL(server->textures[i].id);
+        UnloadTexture(server->textures[i]);
+    }
+
+#if !defined(_WIN32)
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) CloseServerClient(server, i);
+    close(server->listener);
+    unlink(server->path);
+#endif
+
+    PBR_FREE(server);
+}
+
+// Encode an UNCOMPRESSED_R8G8B8A8 image as PNG file bytes (free with PBR_FREE())
+// NOTE: rows use the filter with smallest absolute sum, deflate uses fixed Huffman codes and greedy hash chain matches
+unsigned char *EncodeImagePNG(Image image, int *size)
+{
+    const unsigned char *pixels = (const unsigned char *)image.data;
+    int stride = image.width*4;
+    int rawSize = (stride + 1)*image.height;
+    unsigned char *raw = (unsigned char *)PBR_MALLOC(MEMORY_OTHER, rawSize);
+    int *head = (int *)PBR_MALLOC(MEMORY_OTHER, (1 << PNG_HASH_BITS)*sizeof(int));
+    int *prev = (int *)PBR_MALLOC(MEMORY_OTHER, PNG_WINDOW_SIZE*sizeof(int));
+    unsigned char *png = (unsigned char *)PBR_MALLOC(MEMORY_OTHER, rawSize + rawSize/8 + 1024);
+    int pngSize = 0;
+
+    // Filter rows with the candidate (none, sub, up and paeth) which has smallest absolute sum
+    unsigned char *zeros = (unsigned char *)PBR_CALLOC(MEMORY_OTHER, 1, stride);
+
+    for (int y = 0; y < image.height; y++)
+    {
+        const unsigned char *row = pixels + y*stride;
+        const unsigned char *above = (y > 0) ? (row - stride) : zeros;
+        unsigned char *out = raw + y*(stride + 1) + 1;
+        int sums[4] = { 0 };
+
+        for (int x = 0; x < stride; x++)
+        {
+            int a = (x >= 4) ? row[x - 4] : 0;
+            int c = (x >= 4) ? above[x - 4] : 0;
+            sums[0] += abs((signed char)row[x]);
+            sums[1] += abs((signed char)(row[x] - a));
+            sums[2] += abs((signed char)(row[x] - above[x]));
+            sums[3] += abs((signed char)(row[x] - GetPngPaeth(a, above[x], c)));
+        }
+
+        int filter = 0;
+        for (int i = 1; i < 4; i++) if (sums[i] < sums[filter]) filter = i;
+
+        for (int x = 0; x < stride; x++)
+        {
+            int a = (x >= 4) ? row[x - 4] : 0;
+            int c = (x >= 4) ? above[x - 4] : 0;
+
+            if (filter == 0) out[x] = row[x];
+            else if (filter == 1) out[x] = (unsigned char)(row[x] - a);
+            else if (filter == 2) out[x] = (unsigned char)(row[x] - above[x]);
+            else out[x] = (unsigned char)(row[x] - GetPngPaeth(a, above[x], c));
+        }
+
+        out[-1] = (unsigned char)((filter == 3) ? 4 : filter);
+    }
+
+    PBR_FREE(zeros);
+
+    // PNG signature and header chunk
+    const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    memcpy(png, signature, 8);
+    pngSize = 8;
+
+    int start = pngSize;
+    pngSize += 4;
+    memcpy(png + pngSize, "IHDR", 4);
+    pngSize += 4;
+    unsigned char header[13] = { image.width >> 24, image.width >> 16, image.width >> 8, image.width, image.height >> 24, image.height >> 16, image.height >> 8, image.height, 8, 6, 0, 0, 0 };
+    memcpy(png + pngSize, header, 13);
+    pngSize += 13;
+    WritePngChunkEnd(png, start, &pngSize);
+
+    // Image data chunk (zlib stream with fixed Huffman deflate block)
+    start = pngSize;
+    memcpy(png + start + 4, "IDAT", 4);
+
+    PngStream stream = { png, start + 8, 0, 0 };
+    stream.data[stream.size++] = 0x78;
+    stream.data[stream.size++] = 0x01;
+    WritePngBits(&stream, 1, 1);
+    WritePngBits(&stream, 1, 2);
+
+    for (int i = 0; i < (1 << PNG_HASH_BITS); i++) head[i] = -1;
+
+    for (int i = 0; i < rawSize;)
+    {
+        int bestLength = 0;
+        int bestDistance = 0;
+
+        if (i + 2 < rawSize)
+        {
+            int hash = ((raw[i] << 10) ^ (raw[i + 1] << 5) ^ raw[i + 2]) & ((1 << PNG_HASH_BITS) - 1);
+            int maxLength = ((rawSize - i) < 258) ? (rawSize - i) : 258;
+            int candidate = head[hash];
+
+            for (int chain = 0; (chain < PNG_MAX_CHAIN) && (candidate >= 0) && (bestLength < maxLength) && ((i - candidate) <= PNG_WINDOW_SIZE); chain++)
+            {
+                // Skip candidates which can't improve best match
+                if (raw[candidate + bestLength] == raw[i + bestLength])
+                {
+                    int length = 0;
+                    while ((length < maxLength) && (raw[candidate + length] == raw[i + length])) length++;
+
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = i - candidate;
+                        if (length >= PNG_NICE_LENGTH) break;
+                    }
+                }
+
+                // Window slots are reused, stop when chain points forward
+                int next = prev[candidate % PNG_WINDOW_SIZE];
+                if (next >= candidate) break;
+                candidate = next;
+            }
+        }
+
+        int advance = (bestLength >= 3) ? bestLength : 1;
+
+        if (bestLength >= 3) WritePngMatch(&stream, bestLength, bestDistance);
+        else WritePngCode(&stream, raw[i]);
+
+        // Insert advanced positions in hash chains (last two positions can't be hashed)
+        for (int last = i + advance; i < last; i++)
+        {
+            if (i + 2 >= rawSize) continue;
+
+            int hash = ((raw[i] << 10) ^ (raw[i + 1] << 5) ^ raw[i + 2]) & ((1 << PNG_HASH_BITS) - 1);
+            prev[i % PNG_WINDOW_SIZE] = head[hash];
+            head[hash] = i;
+        }
+    }
+
+    WritePngCode(&stream, 256);
+    if (stream.bitsCount > 0) WritePngBits(&stream, 0, 8 - stream.bitsCount);
+
+    // Adler-32 checksum of uncompressed data
+    // NOTE: sums can't overflow in 5552 bytes blocks, modulo is applied once per block
+    unsigned int s1 = 1, s2 = 0;
+    for (int i = 0; i < rawSize;)
+    {
+        for (int last = ((rawSize - i) < 5552) ? rawSize : (i + 5552); i < last; i++)
+        {
+            s1 += raw[i];
+            s2 += s1;
+        }
+
+        s1 %= 65521;
+        s2 %= 65521;
+    }
+
+    unsigned int adler = (s2 << 16) | s1;
+    stream.data[stream.size++] = (unsigned char)(adler >> 24);
+    stream.data[stream.size++] = (unsigned char)(adler >> 16);
+    stream.data[stream.size++] = (unsigned char)(adler >> 8);
+    stream.data[stream.size++] = (unsigned char)adler;
+
+    pngSize = stream.size;
+    WritePngChunkEnd(png, start, &pngSize);
+
+    // Image end chunk
+    start = pngSize;
+    memcpy(png + start + 4, "IEND", 4);
+    pngSize += 8;
+    WritePngChunkEnd(png, start, &pngSize);
+
+    PBR_FREE(raw);
+    PBR_FREE(head);
+    PBR_FREE(prev);
+
+    *size = pngSize;
+
+    return png;
+}
+
+// Parse a complete request from client buffer (false if none is complete)
+static bool ParseRenderRequest(ServerClient *client, int index, RenderRequest *request)
+{
+    // Find request end (empty line)
+    int end = -1;
+
+    for (int i = 0; (i < client->length) && (end < 0); i++)
+    {
+        if (client->buffer[i] != '\n') continue;
+        if ((i + 1 < client->length) && (client->buffer[i + 1] == '\n')) end = i + 2;
+        else if ((i + 2 < client->length) && (client->buffer[i + 1] == '\r') && (client->buffer[i + 2] == '\n')) end = i + 3;
+    }
+
+    if (end < 0) return false;
+
+    *request = (RenderRequest){ 0 };
+    request->client = index;
+    request->socket = client->socket;
+    request->width = SERVER_DEFAULT_WIDTH;
+    request->height = SERVER_DEFAULT_HEIGHT;
+    request->camera.position = (Vector3){ 3.5f, 3.0f, 3.5f };
+    request->camera.target = (Vector3){ 0.0f, 0.5f, 0.0f };
+    request->camera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
+    request->camera.fovy = SERVER_DEFAULT_FOVY;
+    request->vignette = true;
+    snprintf(request->id, sizeof(request->id), "%i", client->requests++);
+    strcpy(request->mode, "default");
+
+    // Parse "key value" lines (values can contain spaces)
+    for (int i = 0; i < end;)
+    {
+        char line[SERVER_MAX_PATH + 32] = { 0 };
+        int length = 0;
+
+        while ((i < end) && (client->buffer[i] != '\n'))
+        {
+            if ((client->buffer[i] != '\r') && (length < (int)sizeof(line) - 1)) line[length++] = client->buffer[i];
+            i++;
+        }
+
+        i++;
+        if (length == 0) continue;
+
+        char *value = strchr(line, ' ');
+        if (value != NULL) *value++ = '\0';
+        else value = line + length;
+
+        if (strcmp(line, "id") == 0) snprintf(request->id, sizeof(request->id), "%s", value);
+        else if (strcmp(line, "model") == 0) snprintf(request->model, sizeof(request->model), "%s", value);
+        else if (strcmp(line, "textures") == 0) snprintf(request->textures, sizeof(request->textures), "%s", value);
+        else if (strcmp(line, "hdr") == 0) snprintf(request->hdr, sizeof(request->hdr), "%s", value);
+        else if (strcmp(line, "mode") == 0) snprintf(request->mode, sizeof(request->mode), "%s", value);
+        else if (strcmp(line, "size") == 0)
+        {
+            if (sscanf(value, "%dx%d", &request->width, &request->height) != 2) snprintf(request->error, sizeof(request->error), "invalid size '%.64s'", value);
+        }
+        else if (strcmp(line, "vignette") == 0) request->vignette = (atoi(value) != 0);
+        else if (strcmp(line, "format") == 0)
+        {
+            if (strcmp(value, "raw") == 0) request->raw = true;
+            else if (strcmp(value, "png") != 0) snprintf(request->error, sizeof(request->error), "unknown format '%.64s'", value);
+        }
+        else if (strcmp(line, "region") == 0)
+        {
+            Rectangle *region = &request->region;
+            if (sscanf(value, "%d %d %d %d", &region->x, &region->y, &region->width, &region->height) != 4) snprintf(request->error, sizeof(request->error), "invalid region '%.64s'", value);
+        }
+        else if (strcmp(line, "camera") == 0)
+        {
+            Camera *camera = &request->camera;
+            if (sscanf(value, "%f %f %f %f %f %f %f", &camera->position.x, &camera->position.y, &camera->position.z,
+                       &camera->target.x, &camera->target.y, &camera->target.z, &camera->fovy) < 6) snprintf(request->error, sizeof(request->error), "invalid camera '%.64s'", value);
+        }
+        else snprintf(request->error, sizeof(request->error), "unknown key '%.64s'", line);
+    }
+
+    if ((request->error[0] == '\0') && ((request->model[0] == '\0') || (request->hdr[0] == '\0'))) snprintf(request->error, sizeof(request->error), "model and hdr are required");
+    else if ((request->error[0] == '\0') && ((request->width < 1) || (request->height < 1) || (request->width > SERVER_MAX_SIZE) || (request->height > SERVER_MAX_SIZE))) snprintf(request->error, sizeof(request->error), "size must be 1-%i pixels", SERVER_MAX_SIZE);
+
+    // Whole image is rendered when no region is requested
+    Rectangle *region = &request->region;
+
+    if (region->width == 0) *region = (Rectangle){ 0, 0, request->width, request->height };
+    else if ((request->error[0] == '\0') && ((region->x < 0) || (region->y < 0) || (region->width < 1) || (region->height < 1) ||
+             (region->x + region->width > request->width) || (region->y + region->height > request->height))) snprintf(request->error, sizeof(request->error), "region is outside image");
+
+    // Remove parsed request from client buffer
+    memmove(client->buffer, client->buffer + end, client->length - end);
+    client->length -= end;
+
+    return true;
+}
+
+// Sort requests by environment, rendered size, model and textures
+static int CompareRenderRequests(const void *a, const void *b)
+{
+    const RenderRequest *first = (const RenderRequest *)a;
+    const RenderRequest *second = (const RenderRequest *)b;
+    int result = strcmp(first->hdr, second->hdr);
+
+    if (result == 0) result = first->region.width - second->region.width;
+    if (result == 0) result = first->region.height - second->region.height;
+    if (result == 0) result = strcmp(first->model, second->model);
+    if (result == 0) result = strcmp(first->textures, second->textures);
+
+    return result;
+}
+
+// Find path slot or least recently used slot
+// NOTE: cached slot is not found if its file was modified since it was loaded, returns -1 if file is missing
+static int FindServerCacheSlot(RenderServer *server, ServerCacheKey *keys, int count, const char *path, bool *found)
+{
+    struct stat info = { 0 };
+    int slot = 0;
+
+    if (stat(path, &info) != 0) return -1;
+
+    *found = false;
+    server->useCounter++;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (keys[i].used && (strcmp(keys[i].path, path) == 0))
+        {
+            slot = i;
+            *found = (keys[i].modTime == (long long)info.st_mtime);
+            break;
+        }
+
+        if (!keys[i].used || (keys[slot].used && (keys[i].lastUse < keys[slot].lastUse))) slot = i;
+    }
+
+    snprintf(keys[slot].path, sizeof(keys[slot].path), "%s", path);
+    keys[slot].modTime = (long long)info.st_mtime;
+    keys[slot].lastUse = server->useCounter;
+
+    return slot;
+}
+
+// Send bytes to request client (disconnects it on failure)
+static void SendServerBytes(RenderServer *server, RenderRequest *request, const void *data, int size)
+{
+#if !defined(_WIN32)
+    ServerClient *client = &server->clients[request->client];
+
+    // Client disconnected or slot reused by another client
+    if (client->socket != request->socket) return;
+
+    for (int sent = 0; sent < size;)
+    {
+        int count = (int)send(client->socket, (const char *)data + sent, size - sent, SERVER_SEND_FLAGS);
+
+        if (count <= 0)
+        {
+            CloseServerClient(server, request->client);
+            break;
+        }
+
+        sent += count;
+    }
+#endif
+}
+
+// Close a client connection
+static void CloseServerClient(RenderServer *server, int index)
+{
+#if !defined(_WIN32)
+    if (server->clients[index].socket >= 0) close(server->clients[index].socket);
+#endif
+    server->clients[index].socket = -1;
+    server->clients[index].length = 0;
+}
+
+// Write bits to deflate stream (LSB first)
+static void WritePngBits(PngStream *stream, unsigned int value, int count)
+{
+    stream->bits |= value << stream->bitsCount;
+    stream->bitsCount += count;
+
+    while (stream->bitsCount >= 8)
+    {
+        stream->data[stream->size++] = (unsigned char)(stream->bits & 0xff);
+        stream->bits >>= 8;
+        stream->bitsCount -= 8;
+    }
+}
+
+// Write a fixed Huffman literal/length symbol
+// NOTE: Huffman codes are stored MSB first, so they are reversed once in a table
+static void WritePngCode(PngStream *stream, int symbol)
+{
+    if (pngCodeLengths[0] == 0)
+    {
+        for (int i = 0; i < 288; i++)
+        {
+            unsigned int code = 0;
+            int length = 0;
+
+            if (i < 144) { code = 0x30 + i; length = 8; }
+            else if (i < 256) { code = 0x190 + (i - 144); length = 9; }
+            else if (i < 280) { code = i - 256; length = 7; }
+            else { code = 0xc0 + (i - 280); length = 8; }
+
+            unsigned int reversed = 0;
+            for (int k = 0; k < length; k++) reversed |= ((code >> k) & 1) << (length - 1 - k);
+
+            pngCodes[i] = reversed;
+            pngCodeLengths[i] = length;
+        }
+    }
+
+    WritePngBits(stream, pngCodes[symbol], pngCodeLengths[symbol]);
+}
+
+// Get PNG paeth predictor
+static int GetPngPaeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+
+    return ((pa <= pb) && (pa <= pc)) ? a : ((pb <= pc) ? b : c);
+}
+
+// Write a fixed Huffman length and distance pair
+static void WritePngMatch(PngStream *stream, int length, int distance)
+{
+    int index = 28;
+    while (pngLengthBase[index] > length) index--;
+
+    WritePngCode(stream, 257 + index);
+    WritePngBits(stream, length - pngLengthBase[index], pngLengthExtra[index]);
+
+    index = 29;
+    while (pngDistanceBase[index] > distance) index--;
+
+    // Distance codes are 5 bits long
+    unsigned int reversed = 0;
+    for (int i = 0; i < 5; i++) reversed |= ((index >> i) & 1) << (4 - i);
+
+    WritePngBits(stream, reversed, 5);
+    WritePngBits(stream, distance - pngDistanceBase[index], pngDistanceExtra[index]);
+}
+
+// Write chunk length and CRC of chunk started at start
+static void WritePngChunkEnd(unsigned char *png, int start, int *size)
+{
+    int length = *size - start - 8;
+    unsigned int crc = GetPngCrc(png + start + 4, length + 4);
+
+    png[start] = (unsigned char)(length >> 24);
+    png[start + 1] = (unsigned char)(length >> 16);
+    png[start + 2] = (unsigned char)(length >> 8);
+    png[start + 3] = (unsigned char)length;
+
+    png[*size] = (unsigned char)(crc >> 24);
+    png[*size + 1] = (unsigned char)(crc >> 16);
+    png[*size + 2] = (unsigned char)(crc >> 8);
+    png[*size + 3] = (unsigned char)crc;
+    *size += 4;
+}
+
+// Get PNG chunk CRC32
+static unsigned int GetPngCrc(const unsigned char *data, int size)
+{
+    if (pngCrcTable[1] == 0)
+    {
+        for (unsigned int i = 0; i < 256; i++)
+        {
+            unsigned int value = i;
+            for (int k = 0; k < 8; k++) value = (value & 1) ? (0xedb88320u ^ (value >> 1)) : (value >> 1);
+            pngCrcTable[i] = value;
+        }
+    }
+
+    unsigned int crc = 0xffffffffu;
+    for (int i = 0; i < size; i++) crc = pngCrcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+    return crc ^ 0xffffffffu;
+}
@@ -0,0 +1,1254 @@
+/***********************************************************************************
+*
+*   rPBR [soft] - Software rasterizer fallback for physically based rendering without GPU
+*
+*   FEATURES:
+*       - Same shading model than pbr.vs/pbr.fs: Cook-Torrance directional and point lights plus
+*         split-sum image based lighting (irradiance, prefilter and BRDF LUT) baked on CPU.
+*       - Perspective correct attributes interpolation and near plane clipping.
+*       - Triangles binned into screen tiles, tiles rasterized and shaded by worker threads.
+*       - Coverage, depth and barycentrics evaluated with SIMD for 2x2 pixel quads (two quads with AVX2).
+*       - Visibility buffer per tile, so each pixel is shaded once whatever the overdraw.
+*       - No OpenGL context required (thumbnails and turntables on headless machines).
+*       - Command line options parsing for viewer software rendering mode (--soft <directory>).
+*
+*   NOTES:
+*       Meshes must keep their CPU data (vertices, normals and texcoords, tangents are optional).
+*       Environment HDR image must be an equirectangular UNCOMPRESSED_R32G32B32 image (LoadImage() of .hdr).
+*       Material maps are CPU images in UNCOMPRESSED_R8G8B8A8 format (use ImageFormat() if needed).
+*       Area lights, parallax mapping, half resolution lighting and render modes are not supported.
+*       Two quads coverage requires AVX2 and FMA (-mavx2 -mfma or -march=native), SSE2 quads are used otherwise.
+*
+*   DEPENDENCIES:
+*       raylib for data types and images (no rlgl calls)
+*       pbrmemory.h for tracked allocations (must be included before this file)
+*       pthreads for tiles worker threads
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdlib.h>                         // Required for: malloc(), atoi()
+#include <string.h>                         // Required for: memcpy(), strcmp()
+#include <stdio.h>                          // Required for: sscanf()
+#include <time.h>                           // Required for: clock_gettime()
+#include <math.h>                           // Required for: sqrtf(), powf(), atan2f(), asinf(), tanf(), floorf()
+#include <pthread.h>                        // Required for: pthread_create(), pthread_join(), pthread_mutex_lock()
+
+#include "external/raylib/src/raymath.h"    // Required for vectors math functions
+
+#if defined(__AVX2__) && defined(__FMA__)
+    #include <immintrin.h>                  // Required for: AVX2 coverage of two pixel quads
+    #define     SOFT_BLOCK_WIDTH            4
+#elif defined(__SSE2__)
+    #include <emmintrin.h>                  // Required for: SSE2 coverage of a pixel quad
+    #define     SOFT_BLOCK_WIDTH            2
+#else
+    #define     SOFT_BLOCK_WIDTH            2
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         SOFT_BLOCK_HEIGHT           2                                       // Pixels rows per rasterized block (quads)
+#define         SOFT_LANES                  (SOFT_BLOCK_WIDTH*SOFT_BLOCK_HEIGHT)    // Pixels per rasterized block
+#define         SOFT_TILE_SIZE              64                                      // Screen tile dimensions in pixels
+#define         SOFT_MAX_THREADS            16                                      // Max tiles worker threads
+#define         SOFT_MAX_LIGHTS             4                                       // Max lights (same as PBR shader)
+#define         SOFT_ATTRIBUTES             11                                      // Interpolated attributes (position, normal, texcoord and tangent)
+#define         SOFT_NEAR_PLANE             0.01f                                   // Camera near plane (same as 3D mode)
+#define         SOFT_FAR_PLANE              1000.0f                                 // Camera far plane (same as 3D mode)
+#define         SOFT_GAMMA_SIZE             4096                                    // Tonemapped values gamma correction table entries
+
+#define         SOFT_PREFILTER_LEVELS       5                                       // Prefilter mipmap levels (same as MAX_MIPMAP_LEVELS)
+#define         SOFT_PREFILTER_SAMPLES      64                                      // GGX samples per prefiltered texel
+#define         SOFT_SOURCE_LEVELS          8                                       // Radiance source mipmap levels used by prefilter
+#define         SOFT_SH_SIZE                32                                      // Radiance level size projected into spherical harmonics
+#define         SOFT_BRDF_SIZE              32                                      // BRDF LUT dimensions
+#define         SOFT_BRDF_SAMPLES           256                                     // GGX samples per BRDF LUT texel
+
+#define         SOFT_DEFAULT_WIDTH          1920                                    // Default --soft frames width
+#define         SOFT_DEFAULT_HEIGHT         1080                                    // Default --soft frames height
+#define         SOFT_DEFAULT_FRAMES         36                                      // Default --soft turntable frames count
+#define         SOFT_DEFAULT_THREADS        4                                       // Default --soft tiles worker threads
+
+#ifndef PI
+    #define PI 3.14159265358979323846f
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct SoftCubemap {
+    int size;                               // First level faces dimensions
+    int levels;                             // Mipmap levels count
+    float *data[SOFT_SOURCE_LEVELS];        // Levels RGB texels (6 faces each, in cubemap faces order)
+} SoftCubemap;
+
+typedef struct SoftEnvironment {
+    SoftCubemap radiance;                   // Environment radiance with box filtered mipmaps (skybox and prefilter source)
+    SoftCubemap prefilter;                  // GGX prefiltered radiance (roughness based on level)
+    float irradiance[9][3];                 // Irradiance spherical harmonics (3 bands, convolved with cosine lobe)
+    float brdf[SOFT_BRDF_SIZE*SOFT_BRDF_SIZE*2];    // Split-sum BRDF scale and bias (NdotV in X, roughness in Y)
+} SoftEnvironment;
+
+typedef struct SoftProperty {
+    Color color;                            // Property color (used when no image)
+    Color *pixels;                          // Property image pixels (not owned)
+    int width;
+    int height;
+} SoftProperty;
+
+typedef struct SoftMaterial {
+    SoftProperty albedo;
+    SoftProperty normals;
+    SoftProperty metalness;
+    SoftProperty roughness;
+    SoftProperty ao;
+    SoftProperty emission;
+} SoftMaterial;
+
+typedef struct SoftLight {
+    bool enabled;
+    int type;                               // Light type (0: directional, 1: point, area lights are skipped)
+    Vector3 position;
+    Vector3 target;
+    Color color;                            // Light color (alpha is intensity, same as PBR shader)
+} SoftLight;
+
+typedef struct SoftVertex {
+    float clip[4];                          // Clip space position
+    float attributes[SOFT_ATTRIBUTES];      // World position, normal, texcoord and tangent
+} SoftVertex;
+
+typedef struct SoftTriangle {
+    float edges[3][3];                      // Barycentric coordinates plane equations (x, y and constant terms)
+    float depth[3];                         // Vertices normalized device depth
+    float invW[3];                          // Vertices clip space inverse W
+    float attributes[3][SOFT_ATTRIBUTES];   // Vertices attributes
+    int minX, minY, maxX, maxY;             // Screen bounds (inclusive)
+    const SoftMaterial *material;           // Triangle material
+} SoftTriangle;
+
+typedef struct SoftBin {
+    int *triangles;                         // Triangles indices overlapping tile
+    int count;
+    int capacity;
+} SoftBin;
+
+typedef struct SoftRenderer {
+    int width;                              // Target width
+    int height;                             // Target height
+    Color *pixels;                          // Target pixels (RGBA8)
+    unsigned char gamma[SOFT_GAMMA_SIZE];   // Gamma correction table for tonemapped values in [0, 1) range
+
+    int threadsCount;                       // Tiles worker threads
+    int tilesX;                             // Horizontal tiles
+    int tilesY;                             // Vertical tiles
+    SoftBin *bins;                          // Triangles bins per tile
+
+    SoftTriangle *triangles;                // Frame triangles setup data
+    int trianglesCount;
+    int trianglesCapacity;
+
+    Vector3 viewPos;                        // Camera position
+    Vector3 forward, right, up;             // Camera basis
+    float tanHalfFovy;                      // Camera vertical field of view half tangent
+    float aspect;                           // Target aspect ratio
+
+    const SoftEnvironment *env;             // Frame environment
+    SoftLight lights[SOFT_MAX_LIGHTS];      // Frame lights
+    int lightsCount;
+
+    pthread_mutex_t mutex;                  // Next tile index lock
+    int nextTile;                           // Next tile to rasterize
+
+    double frameStart;                      // Current frame begin time in seconds
+    float frameTime;                        // Last frame time in milliseconds (begin to end of rasterization)
+} SoftRenderer;
+
+typedef struct SoftOptions {
+    bool enabled;                           // Software rendering requested (no window or OpenGL context)
+    const char *directory;                  // Rendered frames output directory
+    int width;                              // Frames width
+    int height;                             // Frames height
+    int frames;                             // Turntable frames count
+    int threads;                            // Tiles worker threads
+} SoftOptions;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+SoftOptions InitSoftOptions(int argc, char **argv);                                         // Parse --soft <directory>, --soft-size <width>x<height>, --soft-frames <count> and --soft-threads <count> options
+SoftEnvironment *LoadSoftEnvironment(Image hdr, int cubemapSize, int prefilterSize);         // Bake environment radiance, irradiance, prefilter and BRDF LUT on CPU
+void UnloadSoftEnvironment(SoftEnvironment *env);                                           // Unload CPU environment
+
+SoftProperty LoadSoftProperty(Image image);                                                 // Get a material property from an RGBA8 image (pixels not copied)
+SoftMaterial SetupSoftMaterial(Color albedo, int metalness, int roughness);                 // Set up a material with constant values (same defaults as PBR materials)
+
+SoftRenderer *LoadSoftRenderer(int width, int height, int threads);                         // Load software renderer target and tiles bins
+void BeginSoftFrame(SoftRenderer *renderer, Camera camera, const SoftEnvironment *env, const SoftLight *lights, int count);    // Begin a frame with camera, environment and lights
+void DrawSoftMesh(SoftRenderer *renderer, Mesh mesh, Matrix transform, const SoftMaterial *material);                           // Transform, clip and bin mesh triangles
+void EndSoftFrame(SoftRenderer *renderer);                                                  // Rasterize and shade all tiles using worker threads
+Image GetSoftImage(SoftRenderer *renderer);                                                 // Get a copy of rendered frame (RGBA8)
+void UnloadSoftRenderer(SoftRenderer *renderer);                                            // Unload software renderer
+
+static void *SoftTilesThread(void *arg);                                                    // Rasterize and shade tiles until none is left
+static void RasterizeSoftTile(SoftRenderer *renderer, int tile);                            // Rasterize tile triangles into a visibility buffer and shade it
+static int CoverSoftBlock(const SoftTriangle *tri, float x, float y, float *b1, float *b2, float *depth);   // Evaluate block pixels coverage, barycentrics and depth
+static void SetupSoftTriangle(SoftRenderer *renderer, const SoftVertex *v0, const SoftVertex *v1, const SoftVertex *v2, const SoftMaterial *material);  // Project triangle, set up its equations and bin it
+static void ShadeSoftPixel(const SoftRenderer *renderer, const SoftTriangle *tri, float b1, float b2, float *color);   // Shade a pixel like pbr.fs
+static void ShadeSoftSky(const SoftRenderer *renderer, int x, int y, float *color);         // Shade a background pixel like skybox.fs
+
+static void SampleSoftCubemap(const SoftCubemap *cube, const float *dir, float lod, float *color);  // Trilinear cubemap sample
+static void SampleSoftProperty(const SoftProperty *property, float u, float v, float *value);       // Bilinear material property sample (repeat)
+static void GetSoftCubeDirection(int face, float s, float t, float *dir);                  // Get direction from cubemap face coordinates in [-1, 1] range
+static void GetSoftBasisSH(const float *n, float *basis);                                   // Get spherical harmonics basis values (3 bands)
+static void GetSoftSampleGGX(unsigned int i, unsigned int count, float roughness, float *h);        // Get GGX importance sample half vector in tangent space
+static double GetSoftTime(void);                                                            // Get monotonic time in seconds
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Parse --soft <directory>, --soft-size <width>x<height>, --soft-frames <count> and --soft-threads <count> options
+SoftOptions InitSoftOptions(int argc, char **argv)
+{
+    SoftOptions options = { false, NULL, SOFT_DEFAULT_WIDTH, SOFT_DEFAULT_HEIGHT, SOFT_DEFAULT_FRAMES, SOFT_DEFAULT_THREADS };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--soft") == 0) && (i + 1 < argc)) { options.enabled = true; options.directory = argv[++i]; }
+        else if ((strcmp(argv[i], "--soft-size") == 0) && (i + 1 < argc)) sscanf(argv[++i], "%ix%i", &options.width, &options.height);
+        else if ((strcmp(argv[i], "--soft-frames") == 0) && (i + 1 < argc)) options.frames = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--soft-threads") == 0) && (i + 1 < argc)) options.threads = atoi(argv[++i]);
+    }
+
+    if (options.width < 1) options.width = SOFT_DEFAULT_WIDTH;
+    if (options.height < 1) options.height = SOFT_DEFAULT_HEIGHT;
+    if (options.frames < 1) options.frames = 1;
+    if (options.threads < 1) options.threads = 1;
+    if (options.threads > SOFT_MAX_THREADS) options.threads = SOFT_MAX_THREADS;
+
+    return options;
+}
+
+// Bake environment radiance, irradiance, prefilter and BRDF LUT on CPU
+// NOTE: same conventions than cubemap.fs, irradiance SH projection than bake.cs, prefilter than prefilter.fs and LUT than brdf.fs
+SoftEnvironment *LoadSoftEnvironment(Image hdr, int cubemapSize, int prefilterSize)
+{
+    SoftEnvironment *env = (SoftEnvironment *)PBR_CALLOC(MEMORY_ENVIRONMENT, 1, sizeof(SoftEnvironment));
+    const float *source = (const float *)hdr.data;
+
+    // Convert equirectangular map to cubemap faces (bilinear sampling)
+    env->radiance.size = cubemapSize;
+    env->radiance.data[0] = (float *)PBR_MALLOC(MEMORY_ENVIRONMENT, 6*cubemapSize*cubemapSize*3*sizeof(float));
+
+    for (int face = 0; face < 6; face++)
+    {
+        for (int y = 0; y < cubemapSize; y++)
+        {
+            for (int x = 0; x < cubemapSize; x++)
+            {
+                float dir[3];
+                GetSoftCubeDirection(face, (x + 0.5f)/cubemapSize*2.0f - 1.0f, (y + 0.5f)/cubemapSize*2.0f - 1.0f, dir);
+
+                // NOTE: image rows are stored from top to bottom, so up direction is first row
+                float u = atan2f(dir[2], dir[0])*0.1591f + 0.5f;
+                float v = 0.5f - asinf(dir[1])*0.3183f;
+                float fx = u*hdr.width - 0.5f;
+                float fy = v*hdr.height - 0.5f;
+                int x0 = (int)floorf(fx), y0 = (int)floorf(fy);
+                float tx = fx - x0, ty = fy - y0;
+                float *texel = &env->radiance.data[0][((face*cubemapSize + y)*cubemapSize + x)*3];
+
+                for (int c = 0; c < 3; c++) texel[c] = 0.0f;
+
+                for (int k = 0; k < 4; k++)
+                {
+                    int sx = (x0 + (k & 1) + hdr.width)%hdr.width;
+                    int sy = y0 + (k >> 1);
+                    if (sy < 0) sy = 0;
+                    else if (sy >= hdr.height) sy = hdr.height - 1;
+
+                    float weight = ((k & 1) ? tx : (1.0f - tx))*((k >> 1) ? ty : (1.0f - ty));
+                    for (int c = 0; c < 3; c++) texel[c] += source[(sy*hdr.width + sx)*3 + c]*weight;
+                }
+            }
+        }
+    }
+
+    // Generate radiance box filtered mipmaps
+    env->radiance.levels = 1;
+
+    for (int i = 1, size = cubemapSize/2; (i < SOFT_SOURCE_LEVELS) && (size > 0); i++, size /= 2)
+    {
+        float *previous = env->radiance.data[i - 1];
+        float *level = (float *)PBR_MALLOC(MEMORY_ENVIRONMENT, 6*size*size*3*sizeof(float));
+
+        for (int face = 0; face < 6; face++)
+        {
+            for (int y = 0; y < size; y++)
+            {
+                for (int x = 0; x < size; x++)
+                {
+                    for (int c = 0; c < 3; c++)
+                    {
+                        int row = face*size*2 + y*2;
+                        level[((face*size + y)*size + x)*3 + c] = 0.25f*(previous[((row*size*2) + x*2)*3 + c] + previous[((row*size*2) + x*2 + 1)*3 + c] +
+                                                                          previous[(((row + 1)*size*2) + x*2)*3 + c] + previous[(((row + 1)*size*2) + x*2 + 1)*3 + c]);
+                    }
+                }
+            }
+        }
+
+        env->radiance.data[i] = level;
+        env->radiance.levels++;
+    }
+
+    // Prefilter radiance with GGX lobes of increasing roughness (first level is a copy)
+    env->prefilter.size = prefilterSize;
+    env->prefilter.levels = SOFT_PREFILTER_LEVELS;
+    float saTexel = 4.0f*PI/(6.0f*cubemapSize*cubemapSize);
+
+    for (int i = 0; i < SOFT_PREFILTER_LEVELS; i++)
+    {
+        int size = prefilterSize >> i;
+        if (size < 1) size = 1;
+
+        float roughness = (float)i/(float)(SOFT_PREFILTER_LEVELS - 1);
+        float *level = (float *)PBR_MALLOC(MEMORY_ENVIRONMENT, 6*size*size*3*sizeof(float));
+        float samples[SOFT_PREFILTER_SAMPLES][4];
+
+        // Lobe samples only depend on roughness (view direction equals normal)
+        for (unsigned int k = 0; k < SOFT_PREFILTER_SAMPLES; k++)
+        {
+            float h[3];
+            GetSoftSampleGGX(k, SOFT_PREFILTER_SAMPLES, roughness, h);
+
+            float a2 = roughness*roughness*roughness*roughness;
+            float denom = h[2]*h[2]*(a2 - 1.0f) + 1.0f;
+            float pdf = a2/(PI*denom*denom)*0.25f + 0.0001f;
+            float saSample = 1.0f/(SOFT_PREFILTER_SAMPLES*pdf + 0.0001f);
+
+            samples[k][0] = 2.0f*h[2]*h[0];
+            samples[k][1] = 2.0f*h[2]*h[1];
+            samples[k][2] = 2.0f*h[2]*h[2] - 1.0f;
+            samples[k][3] = 0.5f*log2f(saSample/saTexel);
+        }
+
+        for (int face = 0; face < 6; face++)
+        {
+            for (int y = 0; y < size; y++)
+            {
+                for (int x = 0; x < size; x++)
+                {
+                    float n[3], color[3] = { 0 }, total = 0.0f;
+                    float *texel = &level[((face*size + y)*size + x)*3];
+                    GetSoftCubeDirection(face, (x + 0.5f)/size*2.0f - 1.0f, (y + 0.5f)/size*2.0f - 1.0f, n);
+
+                    if (i == 0)
+                    {
+                        SampleSoftCubemap(&env->radiance, n, 0.0f, texel);
+                        continue;
+                    }
+
+                    // Build tangent frame like bake.cs (up vector switched near poles)
+                    float tangent[3] = { -n[1], n[0], 0.0f };
+                    if (fabsf(n[2]) >= 0.999f) { tangent[0] = 0.0f; tangent[1] = -n[2]; tangent[2] = n[1]; }
+
+                    float length = sqrtf(tangent[0]*tangent[0] + tangent[1]*tangent[1] + tangent[2]*tangent[2]);
+                    for (int c = 0; c < 3; c++) tangent[c] /= length;
+                    float bitangent[3] = { n[1]*tangent[2] - n[2]*tangent[1], n[2]*tangent[0] - n[0]*tangent[2], n[0]*tangent[1] - n[1]*tangent[0] };
+
+                    for (int k = 0; k < SOFT_PREFILTER_SAMPLES; k++)
+                    {
+                        if (samples[k][2] <= 0.0f) continue;
+
+                        float l[3], value[3];
+                        for (int c = 0; c < 3; c++) l[c] = tangent[c]*samples[k][0] + bitangent[c]*samples[k][1] + n[c]*samples[k][2];
+
+                        SampleSoftCubemap(&env->radiance, l, samples[k][3], value);
+                        for (int c = 0; c < 3; c++) color[c] += value[c]*samples[k][2];
+                        total += samples[k][2];
+                    }
+
+                    for (int c = 0; c < 3; c++) texel[c] = color[c]/total;
+                }
+            }
+        }
+
+        env->prefilter.data[i] = level;
+    }
+
+    // Project low resolution radiance into spherical harmonics weighted by texel solid angle
+    const float bands[9] = { 1.0f, 2.0f/3.0f, 2.0f/3.0f, 2.0f/3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+    float shLod = log2f((float)cubemapSize/SOFT_SH_SIZE);
+    float totalWeight = 0.0f;
+    if (shLod < 0.0f) shLod = 0.0f;
+
+    for (int face = 0; face < 6; face++)
+    {
+        for (int y = 0; y < SOFT_SH_SIZE; y++)
+        {
+            for (int x = 0; x < SOFT_SH_SIZE; x++)
+            {
+                float s = (x + 0.5f)/SOFT_SH_SIZE*2.0f - 1.0f;
+                float t = (y + 0.5f)/SOFT_SH_SIZE*2.0f - 1.0f;
+                float weight = 1.0f/powf(1.0f + s*s + t*t, 1.5f);
+                float n[3], radiance[3], basis[9];
+
+                GetSoftCubeDirection(face, s, t, n);
+                SampleSoftCubemap(&env->radiance, n, shLod, radiance);
+                GetSoftBasisSH(n, basis);
+
+                for (int k = 0; k < 9; k++)
+                {
+                    for (int c = 0; c < 3; c++) env->irradiance[k][c] += radiance[c]*basis[k]*weight;
+                }
+
+                totalWeight += weight;
+            }
+        }
+    }
+
+    for (int k = 0; k < 9; k++)
+    {
+        for (int c = 0; c < 3; c++) env->irradiance[k][c] *= 4.0f*PI/totalWeight*bands[k];
+    }
+
+    // Integrate split-sum BRDF scale and bias
+    for (int y = 0; y < SOFT_BRDF_SIZE; y++)
+    {
+        float roughness = (y + 0.5f)/SOFT_BRDF_SIZE;
+        float k = roughness*roughness/2.0f;
+
+        for (int x = 0; x < SOFT_BRDF_SIZE; x++)
+        {
+            float NdotV = (x + 0.5f)/SOFT_BRDF_SIZE;
+            float v[3] = { sqrtf(1.0f - NdotV*NdotV), 0.0f, NdotV };
+            float scale = 0.0f, bias = 0.0f;
+
+            for (unsigned int i = 0; i < SOFT_BRDF_SAMPLES; i++)
+            {
+                float h[3];
+                GetSoftSampleGGX(i, SOFT_BRDF_SAMPLES, roughness, h);
+
+                float VdotH = v[0]*h[0] + v[1]*h[1] + v[2]*h[2];
+                float NdotL = 2.0f*VdotH*h[2] - v[2];
+
+                if (NdotL > 0.0f)
+                {
+                    float NdotH = (h[2] > 0.0f) ? h[2] : 0.0f;
+                    if (VdotH < 0.0f) VdotH = 0.0f;
+
+                    float G = (NdotV/(NdotV*(1.0f - k) + k))*(NdotL/(NdotL*(1.0f - k) + k));
+                    float visibility = G*VdotH/(NdotH*NdotV + 0.0001f);
+                    float fresnel = powf(1.0f - VdotH, 5.0f);
+
+                    scale += (1.0f - fresnel)*visibility;
+                    bias += fresnel*visibility;
+                }
+            }
+
+            env->brdf[(y*SOFT_BRDF_SIZE + x)*2] = scale/SOFT_BRDF_SAMPLES;
+            env->brdf[(y*SOFT_BRDF_SIZE + x)*2 + 1] = bias/SOFT_BRDF_SAMPLES;
+        }
+    }
+
+    TraceLog(LOG_INFO, "Software environment baked (cubemap %i, prefilter %i, %i radiance levels)", cubemapSize, prefilterSize, env->radiance.levels);
+
+    return env;
+}
+
+// Unload CPU environment
+void UnloadSoftEnvironment(SoftEnvironment *env)
+{
+    for (int i = 0; i < env->radiance.levels; i++) PBR_FREE(env->radiance.data[i]);
+    for (int i = 0; i < env->prefilter.levels; i++) PBR_FREE(env->prefilter.data[i]);
+    PBR_FREE(env);
+}
+
+// Get a material property from an RGBA8 image (pixels not copied)
+SoftProperty LoadSoftProperty(Image image)
+{
+    SoftProperty property = { 0 };
+
+    if (image.format != UNCOMPRESSED_R8G8B8A8) TraceLog(LOG_WARNING, "Software material images must be RGBA8, property ignored");
+    else
+    {
+        property.pixels = (Color *)image.data;
+        property.width = image.width;
+        property.height = image.height;
+    }
+
+    property.color = WHITE;
+
+    return property;
+}
+
+// Set up a material with constant values (same defaults as PBR materials)
+SoftMaterial SetupSoftMaterial(Color albedo, int metalness, int roughness)
+{
+    SoftMaterial mat = { 0 };
+
+    mat.albedo.color = albedo;
+    mat.normals.color = (Color){ 128, 128, 255, 255 };
+    mat.metalness.color = (Color){ metalness, 0, 0, 0 };
+    mat.roughness.color = (Color){ roughness, 0, 0, 0 };
+    mat.ao.color = (Color){ 255, 255, 255, 255 };
+    mat.emission.color = (Color){ 0, 0, 0, 0 };
+
+    return mat;
+}
+
+// Load software renderer target and tiles bins
+SoftRenderer *LoadSoftRenderer(int width, int height, int threads)
+{
+    SoftRenderer *renderer = (SoftRenderer *)PBR_CALLOC(MEMORY_OTHER, 1, sizeof(SoftRenderer));
+
+    renderer->width = width;
+    renderer->height = height;
+    renderer->pixels = (Color *)PBR_CALLOC(MEMORY_OTHER, width*height, sizeof(Color));
+    renderer->threadsCount = ((threads < 1) ? 1 : ((threads > SOFT_MAX_THREADS) ? SOFT_MAX_THREADS : threads));
+    renderer->tilesX = (width + SOFT_TILE_SIZE - 1)/SOFT_TILE_SIZE;
+    renderer->tilesY = (height + SOFT_TILE_SIZE - 1)/SOFT_TILE_SIZE;
+    renderer->bins = (SoftBin *)PBR_CALLOC(MEMORY_OTHER, renderer->tilesX*renderer->tilesY, sizeof(SoftBin));
+    pthread_mutex_init(&renderer->mutex, NULL);
+
+    for (int i = 0; i < SOFT_GAMMA_SIZE; i++) renderer->gamma[i] = (unsigned char)(powf((i + 0.5f)/SOFT_GAMMA_SIZE, 1.0f/2.2f)*255.0f + 0.5f);
+
+    return renderer;
+}
+
+// Begin a frame with camera, environment and lights
+// NOTE: projection is the same as 3D mode (vertical field of view in degrees, near 0.01 and far 1000)
+void BeginSoftFrame(SoftRenderer *renderer, Camera camera, const SoftEnvironment *env, const SoftLight *lights, int count)
+{
+    renderer->trianglesCount = 0;
+    for (int i = 0; i < renderer->tilesX*renderer->tilesY; i++) renderer->bins[i].count = 0;
+
+    renderer->env = env;
+    renderer->lightsCount = ((count > SOFT_MAX_LIGHTS) ? SOFT_MAX_LIGHTS : count);
+    for (int i = 0; i < renderer->lightsCount; i++) renderer->lights[i] = lights[i];
+
+    // Calculate camera basis (right handed, looking down -Z in view space)
+    Vector3 forward = VectorSubtract(camera.target, camera.position);
+    VectorNormalize(&forward);
+    Vector3 right = VectorCrossProduct(forward, camera.up);
+    VectorNormalize(&right);
+
+    renderer->viewPos = camera.position;
+    renderer->forward = forward;
+    renderer->right = right;
+    renderer->up = VectorCrossProduct(right, forward);
+    renderer->tanHalfFovy = tanf(camera.fovy*0.5f*PI/180.0f);
+    renderer->aspect = (float)renderer->width/(float)renderer->height;
+    renderer->frameStart = GetSoftTime();
+}
+
+// Transform, clip and bin mesh triangles
+void DrawSoftMesh(SoftRenderer *renderer, Mesh mesh, Matrix transform, const SoftMaterial *material)
+{
+    if ((mesh.vertices == NULL) || (mesh.normals == NULL))
+    {
+        TraceLog(LOG_WARNING, "Software rendering requires mesh CPU vertices and normals");
+        return;
+    }
+
+    // Calculate normal matrix (inverse transpose of model matrix upper 3x3)
+    float m[9] = { transform.m0, transform.m4, transform.m8, transform.m1, transform.m5, transform.m9, transform.m2, transform.m6, transform.m10 };
+    float cof[9] = {
+        m[4]*m[8] - m[5]*m[7], m[5]*m[6] - m[3]*m[8], m[3]*m[7] - m[4]*m[6],
+        m[2]*m[7] - m[1]*m[8], m[0]*m[8] - m[2]*m[6], m[1]*m[6] - m[0]*m[7],
+        m[1]*m[5] - m[2]*m[4], m[2]*m[3] - m[0]*m[5], m[0]*m[4] - m[1]*m[3]
+    };
+    float det = m[0]*cof[0] + m[1]*cof[1] + m[2]*cof[2];
+    float f = 1.0f/renderer->tanHalfFovy;
+    float projA = (SOFT_FAR_PLANE + SOFT_NEAR_PLANE)/(SOFT_NEAR_PLANE - SOFT_FAR_PLANE);
+    float projB = 2.0f*SOFT_FAR_PLANE*SOFT_NEAR_PLANE/(SOFT_NEAR_PLANE - SOFT_FAR_PLANE);
+    int count = ((mesh.indices != NULL) ? mesh.triangleCount*3 : mesh.vertexCount);
+
+    for (int i = 0; i + 2 < count; i += 3)
+    {
+        SoftVertex vertices[3];
+
+        // Execute vertex stage like pbr.vs
+        for (int k = 0; k < 3; k++)
+        {
+            int index = ((mesh.indices != NULL) ? mesh.indices[i + k] : (i + k));
+            const float *p = &mesh.vertices[index*3];
+            const float *n = &mesh.normals[index*3];
+            float *attributes = vertices[k].attributes;
+
+            attributes[0] = transform.m0*p[0] + transform.m4*p[1] + transform.m8*p[2] + transform.m12;
+            attributes[1] = transform.m1*p[0] + transform.m5*p[1] + transform.m9*p[2] + transform.m13;
+            attributes[2] = transform.m2*p[0] + transform.m6*p[1] + transform.m10*p[2] + transform.m14;
+
+            for (int c = 0; c < 3; c++) attributes[3 + c] = ((det < 0.0f) ? -1.0f : 1.0f)*(cof[c*3]*n[0] + cof[c*3 + 1]*n[1] + cof[c*3 + 2]*n[2]);
+
+            attributes[6] = ((mesh.texcoords != NULL) ? mesh.texcoords[index*2] : 0.0f);
+            attributes[7] = ((mesh.texcoords != NULL) ? mesh.texcoords[index*2 + 1] : 0.0f);
+
+            if (mesh.tangents != NULL)
+            {
+                const float *t = &mesh.tangents[index*3];
+                for (int c = 0; c < 3; c++) attributes[8 + c] = m[c*3]*t[0] + m[c*3 + 1]*t[1] + m[c*3 + 2]*t[2];
+            }
+            else attributes[8] = attributes[9] = attributes[10] = 0.0f;
+
+            // Transform world position to clip space
+            Vector3 d = { attributes[0] - renderer->viewPos.x, attributes[1] - renderer->viewPos.y, attributes[2] - renderer->viewPos.z };
+            float viewZ = -VectorDotProduct(d, renderer->forward);
+
+            vertices[k].clip[0] = VectorDotProduct(d, renderer->right)*f/renderer->aspect;
+            vertices[k].clip[1] = VectorDotProduct(d, renderer->up)*f;
+            vertices[k].clip[2] = viewZ*projA + projB;
+            vertices[k].clip[3] = -viewZ;
+        }
+
+        // Reject triangles fully outside one of the side planes
+        bool outside = false;
+
+        for (int plane = 0; (plane < 4) && !outside; plane++)
+        {
+            int axis = plane/2;
+            float sign = ((plane%2 == 0) ? 1.0f : -1.0f);
+            outside = true;
+
+            for (int k = 0; (k < 3) && outside; k++) outside = (sign*vertices[k].clip[axis] > vertices[k].clip[3]);
+        }
+
+        if (outside) continue;
+
+        // Clip against near plane (z + w >= 0), result is a convex polygon of up to 4 vertices
+        SoftVertex polygon[4];
+        int polygonCount = 0;
+
+        for (int k = 0; k < 3; k++)
+        {
+            const SoftVertex *a = &vertices[k];
+            const SoftVertex *b = &vertices[(k + 1)%3];
+            float da = a->clip[2] + a->clip[3];
+            float db = b->clip[2] + b->clip[3];
+
+            if (da >= 0.0f) polygon[polygonCount++] = *a;
+
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                float t = da/(da - db);
+                SoftVertex *v = &polygon[polygonCount++];
+
+                for (int c = 0; c < 4; c++) v->clip[c] = a->clip[c] + (b->clip[c] - a->clip[c])*t;
+                for (int c = 0; c < SOFT_ATTRIBUTES; c++) v->attributes[c] = a->attributes[c] + (b->attributes[c] - a->attributes[c])*t;
+            }
+        }
+
+        for (int k = 1; k + 1 < polygonCount; k++) SetupSoftTriangle(renderer, &polygon[0], &polygon[k], &polygon[k + 1], material);
+    }
+}
+
+// Rasterize and shade all tiles using worker threads
+void EndSoftFrame(SoftRenderer *renderer)
+{
+    pthread_t threads[SOFT_MAX_THREADS];
+
+    renderer->nextTile = 0;
+
+    for (int i = 1; i < renderer->threadsCount; i++) pthread_create(&threads[i], NULL, SoftTilesThread, renderer);
+    SoftTilesThread(renderer);
+    for (int i = 1; i < renderer->threadsCount; i++) pthread_join(threads[i], NULL);
+
+    renderer->frameTime = (float)((GetSoftTime() - renderer->frameStart)*1000.0);
+}
+
+// Get a copy of rendered frame (RGBA8)
+// NOTE: image data is not tracked, it is released by raylib UnloadImage() with free()
+Image GetSoftImage(SoftRenderer *renderer)
+{
+    Image image = { 0 };
+
+    image.width = renderer->width;
+    image.height = renderer->height;
+    image.mipmaps = 1;
+    image.format = UNCOMPRESSED_R8G8B8A8;
+    image.data = malloc(renderer->width*renderer->height*sizeof(Color));
+    memcpy(image.data, renderer->pixels, renderer->width*renderer->height*sizeof(Color));
+
+    return image;
+}
+
+// Unload software renderer
+void UnloadSoftRenderer(SoftRenderer *renderer)
+{
+    for (int i = 0; i < renderer->tilesX*renderer->tilesY; i++) PBR_FREE(renderer->bins[i].triangles);
+
+    pthread_mutex_destroy(&renderer->mutex);
+    PBR_FREE(renderer->bins);
+    PBR_FREE(renderer->triangles);
+    PBR_FREE(renderer->pixels);
+    PBR_FREE(renderer);
+}
+
+// Rasterize and shade tiles until none is left
+static void *SoftTilesThread(void *arg)
+{
+    SoftRenderer *renderer = (SoftRenderer *)arg;
+
+    while (true)
+    {
+        pthread_mutex_lock(&renderer->mutex);
+        int tile = renderer->nextTile++;
+        pthread_mutex_unlock(&renderer->mutex);
+
+        if (tile >= renderer->tilesX*renderer->tilesY) break;
+
+        RasterizeSoftTile(renderer, tile);
+    }
+
+    return NULL;
+}
+
+// Rasterize tile triangles into a visibility buffer and shade it
+// NOTE: tile buffers are stored in blocks order, so each block lanes are contiguous
+static void RasterizeSoftTile(SoftRenderer *renderer, int tile)
+{
+    float depths[SOFT_TILE_SIZE*SOFT_TILE_SIZE];
+    float barycentrics[SOFT_TILE_SIZE*SOFT_TILE_SIZE][2];
+    int visible[SOFT_TILE_SIZE*SOFT_TILE_SIZE];
+
+    int tileX = (tile%renderer->tilesX)*SOFT_TILE_SIZE;
+    int tileY = (tile/renderer->tilesX)*SOFT_TILE_SIZE;
+    int blocksPerRow = SOFT_TILE_SIZE/SOFT_BLOCK_WIDTH;
+    const SoftBin *bin = &renderer->bins[tile];
+
+    for (int i = 0; i < SOFT_TILE_SIZE*SOFT_TILE_SIZE; i++)
+    {
+        depths[i] = 1.0f;
+        visible[i] = -1;
+    }
+
+    // Rasterize binned triangles (depth test only, no shading)
+    for (int i = 0; i < bin->count; i++)
+    {
+        const SoftTriangle *tri = &renderer->triangles[bin->triangles[i]];
+
+        int minX = ((tri->minX > tileX) ? tri->minX : tileX) - tileX;
+        int minY = ((tri->minY > tileY) ? tri->minY : tileY) - tileY;
+        int maxX = ((tri->maxX < tileX + SOFT_TILE_SIZE - 1) ? tri->maxX : tileX + SOFT_TILE_SIZE - 1) - tileX;
+        int maxY = ((tri->maxY < tileY + SOFT_TILE_SIZE - 1) ? tri->maxY : tileY + SOFT_TILE_SIZE - 1) - tileY;
+
+        minX -= minX%SOFT_BLOCK_WIDTH;
+        minY -= minY%SOFT_BLOCK_HEIGHT;
+
+        for (int y = minY; y <= maxY; y += SOFT_BLOCK_HEIGHT)
+        {
+            for (int x = minX; x <= maxX; x += SOFT_BLOCK_WIDTH)
+            {
+                float b1[SOFT_LANES], b2[SOFT_LANES], z[SOFT_LANES];
+                int mask = CoverSoftBlock(tri, (float)(tileX + x), (float)(tileY + y), b1, b2, z);
+
+                if (mask == 0) continue;
+
+                int base = ((y/SOFT_BLOCK_HEIGHT)*blocksPerRow + x/SOFT_BLOCK_WIDTH)*SOFT_LANES;
+
+                for (int lane = 0; lane < SOFT_LANES; lane++)
+                {
+                    if ((mask & (1 << lane)) && (z[lane] < depths[base + lane]))
+                    {
+                        depths[base + lane] = z[lane];
+                        barycentrics[base + lane][0] = b1[lane];
+                        barycentrics[base + lane][1] = b2[lane];
+                        visible[base + lane] = bin->triangles[i];
+                    }
+                }
+            }
+        }
+    }
+
+#if defined(__AVX2__) && defined(__FMA__)
+    // Clear AVX registers upper halves, shading calls libm functions compiled with SSE (transition penalties)
+    _mm256_zeroupper();
+#endif
+
+    // Shade visible pixels once (background shaded as skybox)
+    for (int i = 0; i < SOFT_TILE_SIZE*SOFT_TILE_SIZE; i++)
+    {
+        int block = i/SOFT_LANES;
+        int lane = i%SOFT_LANES;
+        int x = tileX + (block%blocksPerRow)*SOFT_BLOCK_WIDTH + lane%SOFT_BLOCK_WIDTH;
+        int y = tileY + (block/blocksPerRow)*SOFT_BLOCK_HEIGHT + lane/SOFT_BLOCK_WIDTH;
+
+        if ((x >= renderer->width) || (y >= renderer->height)) continue;
+
+        float color[3];
+
+        if (visible[i] >= 0) ShadeSoftPixel(renderer, &renderer->triangles[visible[i]], barycentrics[i][0], barycentrics[i][1], color);
+        else ShadeSoftSky(renderer, x, y, color);
+
+        // Apply HDR tonemapping and gamma correction (table lookup)
+        unsigned char rgb[3];
+
+        for (int c = 0; c < 3; c++)
+        {
+            float mapped = fmaxf(color[c], 0.0f);
+            int index = (int)fminf(mapped/(mapped + 1.0f)*SOFT_GAMMA_SIZE, (float)(SOFT_GAMMA_SIZE - 1));
+            rgb[c] = renderer->gamma[index];
+        }
+
+        renderer->pixels[y*renderer->width + x] = (Color){ rgb[0], rgb[1], rgb[2], 255 };
+    }
+}
+
+// Evaluate block pixels coverage, barycentrics and depth
+// NOTE: returns covered lanes mask, lanes are ordered by rows inside block
+static int CoverSoftBlock(const SoftTriangle *tri, float x, float y, float *b1, float *b2, float *depth)
+{
+    int mask = 0;
+
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 px = _mm256_add_ps(_mm256_set1_ps(x + 0.5f), _mm256_setr_ps(0, 1, 2, 3, 0, 1, 2, 3));
+    __m256 py = _mm256_add_ps(_mm256_set1_ps(y + 0.5f), _mm256_setr_ps(0, 0, 0, 0, 1, 1, 1, 1));
+    __m256 w[3];
+
+    for (int i = 0; i < 3; i++) w[i] = _mm256_fmadd_ps(_mm256_set1_ps(tri->edges[i][0]), px, _mm256_fmadd_ps(_mm256_set1_ps(tri->edges[i][1]), py, _mm256_set1_ps(tri->edges[i][2])));
+
+    __m256 zero = _mm256_setzero_ps();
+    __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(w[0], zero, _CMP_GE_OQ), _mm256_cmp_ps(w[1], zero, _CMP_GE_OQ)), _mm256_cmp_ps(w[2], zero, _CMP_GE_OQ));
+    mask = _mm256_movemask_ps(inside);
+
+    if (mask != 0)
+    {
+        __m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w[0], _mm256_set1_ps(tri->depth[0])), _mm256_mul_ps(w[1], _mm256_set1_ps(tri->depth[1]))), _mm256_mul_ps(w[2], _mm256_set1_ps(tri->depth[2])));
+        _mm256_storeu_ps(b1, w[1]);
+        _mm256_storeu_ps(b2, w[2]);
+        _mm256_storeu_ps(depth, z);
+    }
+#elif defined(__SSE2__)
+    __m128 px = _mm_add_ps(_mm_set1_ps(x + 0.5f), _mm_setr_ps(0, 1, 0, 1));
+    __m128 py = _mm_add_ps(_mm_set1_ps(y + 0.5f), _mm_setr_ps(0, 0, 1, 1));
+    __m128 w[3];
+
+    for (int i = 0; i < 3; i++) w[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri->edges[i][0]), px), _mm_mul_ps(_mm_set1_ps(tri->edges[i][1]), py)), _mm_set1_ps(tri->edges[i][2]));
+
+    __m128 zero = _mm_setzero_ps();
+    __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w[0], zero), _mm_cmpge_ps(w[1], zero)), _mm_cmpge_ps(w[2], zero));
+    mask = _mm_movemask_ps(inside);
+
+    if (mask != 0)
+    {
+        __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w[0], _mm_set1_ps(tri->depth[0])), _mm_mul_ps(w[1], _mm_set1_ps(tri->depth[1]))), _mm_mul_ps(w[2], _mm_set1_ps(tri->depth[2])));
+        _mm_storeu_ps(b1, w[1]);
+        _mm_storeu_ps(b2, w[2]);
+        _mm_storeu_ps(depth, z);
+    }
+#else
+    for (int lane = 0; lane < SOFT_LANES; lane++)
+    {
+        float px = x + (lane%SOFT_BLOCK_WIDTH) + 0.5f;
+        float py = y + (lane/SOFT_BLOCK_WIDTH) + 0.5f;
+        float w[3];
+
+        for (int i = 0; i < 3; i++) w[i] = tri->edges[i][0]*px + tri->edges[i][1]*py + tri->edges[i][2];
+
+        if ((w[0] >= 0.0f) && (w[1] >= 0.0f) && (w[2] >= 0.0f)) mask |= (1 << lane);
+
+        b1[lane] = w[1];
+        b2[lane] = w[2];
+        depth[lane] = w[0]*tri->depth[0] + w[1]*tri->depth[1] + w[2]*tri->depth[2];
+    }
+#endif
+
+    return mask;
+}
+
+// Project triangle, set up its equations and bin it
+static void SetupSoftTriangle(SoftRenderer *renderer, const SoftVertex *v0, const SoftVertex *v1, const SoftVertex *v2, const SoftMaterial *material)
+{
+    const SoftVertex *v[3] = { v0, v1, v2 };
+    float sx[3], sy[3];
+    SoftTriangle tri = { 0 };
+
+    // Project to screen pixels (first row on top)
+    for (int i = 0; i < 3; i++)
+    {
+        tri.invW[i] = 1.0f/v[i]->clip[3];
+        sx[i] = (v[i]->clip[0]*tri.invW[i]*0.5f + 0.5f)*renderer->width;
+        sy[i] = (0.5f - v[i]->clip[1]*tri.invW[i]*0.5f)*renderer->height;
+        tri.depth[i] = v[i]->clip[2]*tri.invW[i]*0.5f + 0.5f;
+        memcpy(tri.attributes[i], v[i]->attributes, SOFT_ATTRIBUTES*sizeof(float));
+    }
+
+    // Skip degenerated triangles, both windings are drawn (no face culling, same as PBR rendering)
+    float area = (sx[1] - sx[0])*(sy[2] - sy[0]) - (sx[2] - sx[0])*(sy[1] - sy[0]);
+    if (fabsf(area) < 1e-8f) return;
+
+    // Set up edge equations normalized by area (they are barycentric coordinates)
+    for (int i = 0; i < 3; i++)
+    {
+        int a = (i + 1)%3;
+        int b = (i + 2)%3;
+
+        tri.edges[i][0] = (sy[a] - sy[b])/area;
+        tri.edges[i][1] = (sx[b] - sx[a])/area;
+        tri.edges[i][2] = (sx[a]*sy[b] - sx[b]*sy[a])/area;
+    }
+
+    // Calculate screen bounds and skip triangles outside screen
+    float minX = fminf(sx[0], fminf(sx[1], sx[2])), maxX = fmaxf(sx[0], fmaxf(sx[1], sx[2]));
+    float minY = fminf(sy[0], fminf(sy[1], sy[2])), maxY = fmaxf(sy[0], fmaxf(sy[1], sy[2]));
+
+    tri.minX = (int)fmaxf(floorf(minX), 0.0f);
+    tri.minY = (int)fmaxf(floorf(minY), 0.0f);
+    tri.maxX = (int)fminf(floorf(maxX), (float)(renderer->width - 1));
+    tri.maxY = (int)fminf(floorf(maxY), (float)(renderer->height - 1));
+    tri.material = material;
+
+    if ((tri.minX > tri.maxX) || (tri.minY > tri.maxY)) return;
+
+    if (renderer->trianglesCount == renderer->trianglesCapacity)
+    {
+        renderer->trianglesCapacity = ((renderer->trianglesCapacity > 0) ? renderer->trianglesCapacity*2 : 1024);
+        renderer->triangles = (SoftTriangle *)PBR_REALLOC(MEMORY_OTHER, renderer->triangles, renderer->trianglesCapacity*sizeof(SoftTriangle));
+    }
+
+    int index = renderer->trianglesCount++;
+    renderer->triangles[index] = tri;
+
+    // Bin triangle into overlapped tiles (triangles order is kept inside each bin)
+    for (int y = tri.minY/SOFT_TILE_SIZE; y <= tri.maxY/SOFT_TILE_SIZE; y++)
+    {
+        for (int x = tri.minX/SOFT_TILE_SIZE; x <= tri.maxX/SOFT_TILE_SIZE; x++)
+        {
+            SoftBin *bin = &renderer->bins[y*renderer->tilesX + x];
+
+            if (bin->count == bin->capacity)
+            {
+                bin->capacity = ((bin->capacity > 0) ? bin->capacity*2 : 256);
+                bin->triangles = (int *)PBR_REALLOC(MEMORY_OTHER, bin->triangles, bin->capacity*sizeof(int));
+            }
+
+            bin->triangles[bin->count++] = index;
+        }
+    }
+}
+
+// Shade a pixel like pbr.fs
+static void ShadeSoftPixel(const SoftRenderer *renderer, const SoftTriangle *tri, float b1, float b2, float *color)
+{
+    const SoftMaterial *mat = tri->material;
+    const SoftEnvironment *env = renderer->env;
+    float attributes[SOFT_ATTRIBUTES];
+
+    // Interpolate attributes with perspective correction
+    float w0 = (1.0f - b1 - b2)*tri->invW[0];
+    float w1 = b1*tri->invW[1];
+    float w2 = b2*tri->invW[2];
+    float invSum = 1.0f/(w0 + w1 + w2);
+    w0 *= invSum;
+    w1 *= invSum;
+    w2 *= invSum;
+
+    for (int i = 0; i < SOFT_ATTRIBUTES; i++) attributes[i] = tri->attributes[0][i]*w0 + tri->attributes[1][i]*w1 + tri->attributes[2][i]*w2;
+
+    Vector3 fragPos = { attributes[0], attributes[1], attributes[2] };
+    Vector3 normal = { attributes[3], attributes[4], attributes[5] };
+    Vector3 view = VectorSubtract(renderer->viewPos, fragPos);
+    VectorNormalize(&normal);
+    VectorNormalize(&view);
+
+    // Fetch material values from images or color attributes
+    float albedo[3], metal[3], rough[3], occlusion[3], emiss[3];
+    SampleSoftProperty(&mat->albedo, attributes[6], attributes[7], albedo);
+    SampleSoftProperty(&mat->metalness, attributes[6], attributes[7], metal);
+    SampleSoftProperty(&mat->roughness, attributes[6], attributes[7], rough);
+    SampleSoftProperty(&mat->ao, attributes[6], attributes[7], occlusion);
+    SampleSoftProperty(&mat->emission, attributes[6], attributes[7], emiss);
+    for (int c = 0; c < 3; c++) albedo[c] = powf(albedo[c], 2.2f);
+
+    // Apply normal map in tangent space (tangent frame built like pbr.vs)
+    if ((mat->normals.pixels != NULL) && ((attributes[8] != 0.0f) || (attributes[9] != 0.0f) || (attributes[10] != 0.0f)))
+    {
+        float sample[3];
+        SampleSoftProperty(&mat->normals, attributes[6], attributes[7], sample);
+
+        Vector3 tangent = { attributes[8], attributes[9], attributes[10] };
+        Vector3 projected = normal;
+        VectorScale(&projected, VectorDotProduct(tangent, normal));
+        tangent = VectorSubtract(tangent, projected);
+        VectorNormalize(&tangent);
+        Vector3 binormal = VectorCrossProduct(normal, tangent);
+        Vector3 mapped = { sample[0]*2.0f - 1.0f, sample[1]*2.0f - 1.0f, sample[2]*2.0f - 1.0f };
+
+        normal = (Vector3){ tangent.x*mapped.x + binormal.x*mapped.y + normal.x*mapped.z,
+                            tangent.y*mapped.x + binormal.y*mapped.y + normal.y*mapped.z,
+                            tangent.z*mapped.x + binormal.z*mapped.y + normal.z*mapped.z };
+        VectorNormalize(&normal);
+    }
+
+    float NdotV = fmaxf(VectorDotProduct(normal, view), 0.0f);
+    float roughness = rough[0];
+    float metalness = metal[0];
+    float F0[3];
+    for (int c = 0; c < 3; c++) F0[c] = 0.04f + (albedo[c] - 0.04f)*metalness;
+
+    // Calculate lighting for directional and point lights (Cook-Torrance BRDF)
+    float Lo[3] = { 0 };
+
+    for (int i = 0; i < renderer->lightsCount; i++)
+    {
+        const SoftLight *light = &renderer->lights[i];
+        if (!light->enabled || (light->type > 1)) continue;
+
+        float radiance[3] = { light->color.r/255.0f, light->color.g/255.0f, light->color.b/255.0f };
+        Vector3 L = { 0 };
+
+        if (light->type == 0)
+        {
+            L = VectorSubtract(light->position, light->target);
+            VectorNormalize(&L);
+        }
+        else
+        {
+            L = VectorSubtract(light->position, fragPos);
+            float distance = VectorLength(L);
+            VectorNormalize(&L);
+            for (int c = 0; c < 3; c++) radiance[c] /= (distance*distance);
+        }
+
+        Vector3 H = VectorAdd(view, L);
+        VectorNormalize(&H);
+
+        float NdotL = fmaxf(VectorDotProduct(normal, L), 0.0f);
+        float NdotH = fmaxf(VectorDotProduct(normal, H), 0.0f);
+        float HdotV = fmaxf(VectorDotProduct(H, view), 0.0f);
+        float a2 = roughness*roughness*roughness*roughness;
+        float denom = NdotH*NdotH*(a2 - 1.0f) + 1.0f;
+        float NDF = a2/(PI*denom*denom);
+        float k = (roughness + 1.0f)*(roughness + 1.0f)/8.0f;
+        float G = (NdotV/(NdotV*(1.0f - k) + k))*(NdotL/(NdotL*(1.0f - k) + k));
+        float fresnel = powf(1.0f - HdotV, 5.0f);
+
+        for (int c = 0; c < 3; c++)
+        {
+            float F = F0[c] + (1.0f - F0[c])*fresnel;
+            float brdf = NDF*G*F/(4.0f*NdotV*NdotL + 0.001f);
+            float kD = (1.0f - F)*(1.0f - metalness);
+
+            Lo[c] += (kD*albedo[c]/PI + brdf)*radiance[c]*NdotL*light->color.a/255.0f;
+        }
+    }
+
+    // Calculate ambient lighting using split-sum IBL
+    float n[3] = { normal.x, normal.y, normal.z };
+    float basis[9], irradiance[3] = { 0 }, prefiltered[3];
+    Vector3 refl = { 2.0f*NdotV*normal.x - view.x, 2.0f*NdotV*normal.y - view.y, 2.0f*NdotV*normal.z - view.z };
+    float r[3] = { refl.x, refl.y, refl.z };
+
+    GetSoftBasisSH(n, basis);
+    for (int k = 0; k < 9; k++)
+    {
+        for (int c = 0; c < 3; c++) irradiance[c] += env->irradiance[k][c]*basis[k];
+    }
+
+    SampleSoftCubemap(&env->prefilter, r, roughness*(SOFT_PREFILTER_LEVELS - 1), prefiltered);
+
+    int bx = (int)(NdotV*SOFT_BRDF_SIZE);
+    int by = (int)(roughness*SOFT_BRDF_SIZE);
+    if (bx > SOFT_BRDF_SIZE - 1) bx = SOFT_BRDF_SIZE - 1;
+    if (by > SOFT_BRDF_SIZE - 1) by = SOFT_BRDF_SIZE - 1;
+    const float *brdf = &env->brdf[(by*SOFT_BRDF_SIZE + bx)*2];
+    float fresnel = powf(1.0f - NdotV, 5.0f);
+
+    for (int c = 0; c < 3; c++)
+    {
+        float F = F0[c] + (fmaxf(1.0f - roughness, F0[c]) - F0[c])*fresnel;
+        float kD = (1.0f - F)*(1.0f - metalness);
+        float reflection = prefiltered[c]*(F*brdf[0] + brdf[1]);
+        float ambient = (kD*albedo[c]*fmaxf(irradiance[c], 0.0f) + reflection)*occlusion[c];
+
+        color[c] = ambient + Lo[c] + emiss[c];
+    }
+}
+
+// Shade a background pixel like skybox.fs
+static void ShadeSoftSky(const SoftRenderer *renderer, int x, int y, float *color)
+{
+    float ndcX = ((x + 0.5f)/renderer->width)*2.0f - 1.0f;
+    float ndcY = 1.0f - ((y + 0.5f)/renderer->height)*2.0f;
+    float dir[3];
+
+    dir[0] = renderer->forward.x + (renderer->right.x*ndcX*renderer->aspect + renderer->up.x*ndcY)*renderer->tanHalfFovy;
+    dir[1] = renderer->forward.y + (renderer->right.y*ndcX*renderer->aspect + renderer->up.y*ndcY)*renderer->tanHalfFovy;
+    dir[2] = renderer->forward.z + (renderer->right.z*ndcX*renderer->aspect + renderer->up.z*ndcY)*renderer->tanHalfFovy;
+
+    if (renderer->env != NULL) SampleSoftCubemap(&renderer->env->radiance, dir, 0.0f, color);
+    else color[0] = color[1] = color[2] = 0.0f;
+}
+
+// Trilinear cubemap sample
+// NOTE: faces are sampled independently (edges are clamped, not seamless)
+static void SampleSoftCubemap(const SoftCubemap *cube, const float *dir, float lod, float *color)
+{
+    float ax = fabsf(dir[0]), ay = fabsf(dir[1]), az = fabsf(dir[2]);
+    float s = 0.0f, t = 0.0f, major = 1.0f;
+    int face = 0;
+
+    // Select face and coordinates like OpenGL specification (inverse of cube direction)
+    if ((ax >= ay) && (ax >= az)) { major = ax; face = ((dir[0] > 0.0f) ? 0 : 1); s = ((dir[0] > 0.0f) ? -dir[2] : dir[2]); t = -dir[1]; }
+    else if (ay >= az) { major = ay; face = ((dir[1] > 0.0f) ? 2 : 3); s = dir[0]; t = ((dir[1] > 0.0f) ? dir[2] : -dir[2]); }
+    else { major = az; face = ((dir[2] > 0.0f) ? 4 : 5); s = ((dir[2] > 0.0f) ? dir[0] : -dir[0]); t = -dir[1]; }
+
+    s = (s/major)*0.5f + 0.5f;
+    t = (t/major)*0.5f + 0.5f;
+
+    if (lod < 0.0f) lod = 0.0f;
+    if (lod > (float)(cube->levels - 1)) lod = (float)(cube->levels - 1);
+
+    int level0 = (int)lod;
+    int level1 = ((level0 + 1 < cube->levels) ? (level0 + 1) : level0);
+    float blend = lod - level0;
+
+    color[0] = color[1] = color[2] = 0.0f;
+
+    for (int l = 0; l < 2; l++)
+    {
+        int level = ((l == 0) ? level0 : level1);
+        float levelWeight = ((l == 0) ? (1.0f - blend) : blend);
+        if (levelWeight <= 0.0f) continue;
+
+        int size = cube->size >> level;
+        if (size < 1) size = 1;
+
+        float fx = s*size - 0.5f, fy = t*size - 0.5f;
+        int x0 = (int)floorf(fx), y0 = (int)floorf(fy);
+        float tx = fx - x0, ty = fy - y0;
+        const float *data = cube->data[level] + face*size*size*3;
+
+        for (int k = 0; k < 4; k++)
+        {
+            int x = x0 + (k & 1), y = y0 + (k >> 1);
+            x = ((x < 0) ? 0 : ((x >= size) ? size - 1 : x));
+            y = ((y < 0) ? 0 : ((y >= size) ? size - 1 : y));
+
+            float weight = levelWeight*((k & 1) ? tx : (1.0f - tx))*((k >> 1) ? ty : (1.0f - ty));
+            for (int c = 0; c < 3; c++) color[c] += data[(y*size + x)*3 + c]*weight;
+        }
+    }
+}
+
+// Bilinear material property sample (repeat)
+static void SampleSoftProperty(const SoftProperty *property, float u, float v, float *value)
+{
+    if (property->pixels == NULL)
+    {
+        value[0] = property->color.r/255.0f;
+        value[1] = property->color.g/255.0f;
+        value[2] = property->color.b/255.0f;
+        return;
+    }
+
+    float fx = (u - floorf(u))*property->width - 0.5f;
+    float fy = (v - floorf(v))*property->height - 0.5f;
+    int x0 = (int)floorf(fx), y0 = (int)floorf(fy);
+    float tx = fx - x0, ty = fy - y0;
+
+    value[0] = value[1] = value[2] = 0.0f;
+
+    for (int k = 0; k < 4; k++)
+    {
+        int x = (x0 + (k & 1) + property->width)%property->width;
+        int y = (y0 + (k >> 1) + property->height)%property->height;
+        Color texel = property->pixels[y*property->width + x];
+        float weight = ((k & 1) ? tx : (1.0f - tx))*((k >> 1) ? ty : (1.0f - ty))/255.0f;
+
+        value[0] += texel.r*weight;
+        value[1] += texel.g*weight;
+        value[2] += texel.b*weight;
+    }
+}
+
+// Get direction from cubemap face coordinates in [-1, 1] range
+static void GetSoftCubeDirection(int face, float s, float t, float *dir)
+{
+    switch (face)
+    {
+        case 0: dir[0] = 1.0f; dir[1] = -t; dir[2] = -s; break;
+        case 1: dir[0] = -1.0f; dir[1] = -t; dir[2] = s; break;
+        case 2: dir[0] = s; dir[1] = 1.0f; dir[2] = t; break;
+        case 3: dir[0] = s; dir[1] = -1.0f; dir[2] = -t; break;
+        case 4: dir[0] = s; dir[1] = -t; dir[2] = 1.0f; break;
+        default: dir[0] = -s; dir[1] = -t; dir[2] = -1.0f; break;
+    }
+
+    float length = sqrtf(dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]);
+    for (int i = 0; i < 3; i++) dir[i] /= length;
+}
+
+// Get spherical harmonics basis values (3 bands)
+static void GetSoftBasisSH(const float *n, float *basis)
+{
+    basis[0] = 0.282095f;
+    basis[1] = 0.488603f*n[1];
+    basis[2] = 0.488603f*n[2];
+    basis[3] = 0.488603f*n[0];
+    basis[4] = 1.092548f*n[0]*n[1];
+    basis[5] = 1.092548f*n[1]*n[2];
+    basis[6] = 0.315392f*(3.0f*n[2]*n[2] - 1.0f);
+    basis[7] = 1.092548f*n[0]*n[2];
+    basis[8] = 0.546274f*(n[0]*n[0] - n[1]*n[1]);
+}
+
+// Get GGX importance sample half vector in tangent space
+static void GetSoftSampleGGX(unsigned int i, unsigned int count, float roughness, float *h)
+{
+    unsigned int bits = i;
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+
+    float x = (float)i/(float)count;
+    float y = (float)bits*2.3283064365386963e-10f;
+    float a = roughness*roughness;
+    float phi = 2.0f*PI*x;
+    float cosTheta = sqrtf((1.0f - y)/(1.0f + (a*a - 1.0f)*y));
+    float sinTheta = sqrtf(1.0f - cosTheta*cosTheta);
+
+    h[0] = cosf(phi)*sinTheta;
+    h[1] = sinf(phi)*sinTheta;
+    h[2] = cosTheta;
+}
+
+// Get monotonic time in seconds
+// NOTE: raylib GetTime() requires a window, software rendering runs without it
+static double GetSoftTime(void)
+{
+    struct timespec time = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec*1e-9;
+}
@@ -0,0 +1,283 @@
+/***********************************************************************************
+*
+*   rPBR [ssao] - Half resolution screen space ambient occlusion for raylib
+*
+*   FEATURES:
+*       - Horizon based ambient occlusion (HBAO style) calculated at half resolution.
+*       - Positions and normals reconstructed from a half resolution depth pre-pass.
+*       - Temporal denoising: sampling directions rotate each frame and previous frame result
+*         is reprojected and accumulated (rejected on disocclusions using view distance).
+*       - Bilateral upsampling in PBR shader, applied to ambient lighting only.
+*       - GPU cost measured with timer queries read when available (one or more frames later).
+*
+*   NOTES:
+*       Ambient occlusion is only used for materials without ambient occlusion map.
+*       Depth pre-pass is drawn by user between BeginSSAOMode and EndSSAOMode (a cheap shader is recommended).
+*
+*   DEPENDENCIES:
+*       pbrcore.h for OpenGL API and screen quad drawing (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         PATH_SSAO_FS                "resources/shaders/ssao.fs"             // Path to ambient occlusion calculation fragment shader
+
+#define         SSAO_TEXTURE_UNIT           15                                      // Ambient occlusion texture unit used by PBR shader
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct SSAOTarget {
+    unsigned int depthFboId;                // Half resolution depth pre-pass framebuffer id
+    unsigned int depthId;                   // Half resolution depth texture id
+    unsigned int ids[2];                    // Occlusion framebuffers ids (current frame is written while previous frame is read)
+    unsigned int textureIds[2];             // Occlusion and view distance textures ids
+    int current;                            // Current occlusion texture index (upsampled by PBR shader)
+    int width;
+    int height;
+
+    int frame;                              // Current frame index (rotates sampling directions)
+    bool validHistory;                      // Previous frame occlusion available to be accumulated
+    Matrix prevViewProj;                    // Previous frame camera view-projection matrix
+    Vector3 prevViewPos;                    // Previous frame camera position
+
+    unsigned int queryId;                   // GPU time elapsed query id
+    bool queryPending;                      // Query result not available yet
+    float gpuTime;                          // Last measured GPU time in milliseconds
+
+    Shader shader;
+    int resolutionLoc;
+    int projScaleLoc;
+    int frameLoc;
+    int validHistoryLoc;
+    int invViewProjLoc;
+    int prevViewProjLoc;
+    int viewPosLoc;
+    int prevViewPosLoc;
+} SSAOTarget;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+SSAOTarget LoadSSAOTarget(int width, int height);                                               // Load half resolution depth and occlusion render targets and shader
+void BeginSSAOMode(SSAOTarget *target);                                                         // Begin drawing depth pre-pass to half resolution target
+void EndSSAOMode(SSAOTarget *target, Camera camera);                                            // End depth pre-pass and calculate temporally accumulated ambient occlusion
+void EnableSSAO(SSAOTarget target, Environment env);                                            // Bind current ambient occlusion to be upsampled by PBR shader
+void DisableSSAO(Environment env);                                                              // Unbind ambient occlusion from PBR shader
+void UnloadSSAOTarget(SSAOTarget target);                                                       // Unload ambient occlusion render targets and shader from GPU
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Load half resolution depth and occlusion render targets and shader
+SSAOTarget LoadSSAOTarget(int width, int height)
+{
+    SSAOTarget target = { 0 };
+    target.width = width;
+    target.height = height;
+
+    InvalidateStateGL();
+
+    // Create depth texture and its depth only framebuffer
+    glGenTextures(1, &target.depthId);
+    BindTextureGL(0, GL_TEXTURE_2D, target.depthId);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &target.depthFboId);
+    BindFramebufferGL(GL_FRAMEBUFFER, target.depthFboId);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, target.depthId, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) TraceLog(LOG_WARNING, "[FBO ID %i] Ambient occlusion depth framebuffer object could not be created", target.depthFboId);
+    else TraceLog(LOG_INFO, "[FBO ID %i] Ambient occlusion depth framebuffer object created successfully", target.depthFboId);
+
+    // Create occlusion textures (occlusion in R channel and view distance in G channel for bilateral filtering)
+    for (int i = 0; i < 2; i++)
+    {
+        glGenTextures(1, &target.textureIds[i]);
+        BindTextureGL(0, GL_TEXTURE_2D, target.textureIds[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, width, height, 0, GL_RG, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glGenFramebuffers(1, &target.ids[i]);
+        BindFramebufferGL(GL_FRAMEBUFFER, target.ids[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.textureIds[i], 0);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) TraceLog(LOG_WARNING, "[FBO ID %i] Ambient occlusion framebuffer object could not be created", target.ids[i]);
+    }
+
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+
+    // Load ambient occlusion shader (drawn with a screen quad)
+    target.shader = LoadShader(PATH_BRDF_VS, PATH_SSAO_FS);
+    target.resolutionLoc = GetShaderLocation(target.shader, "resolution");
+    target.projScaleLoc = GetShaderLocation(target.shader, "projScale");
+    target.frameLoc = GetShaderLocation(target.shader, "frame");
+    target.validHistoryLoc = GetShaderLocation(target.shader, "validHistory");
+    target.invViewProjLoc = GetShaderLocation(target.shader, "invViewProj");
+    target.prevViewProjLoc = GetShaderLocation(target.shader, "prevViewProj");
+    target.viewPosLoc = GetShaderLocation(target.shader, "viewPos");
+    target.prevViewPosLoc = GetShaderLocation(target.shader, "prevViewPos");
+
+    // Set up ambient occlusion shader samplers units
+    SetShaderValuei(target.shader, GetShaderLocation(target.shader, "depthTexture"), (int[1]){ 0 }, 1);
+    SetShaderValuei(target.shader, GetShaderLocation(target.shader, "historyTexture"), (int[1]){ 1 }, 1);
+    SetShaderValue(target.shader, target.resolutionLoc, (float[2]){ (float)width, (float)height }, 2);
+
+    glGenQueries(1, &target.queryId);
+
+    return target;
+}
+
+// Begin drawing depth pre-pass to half resolution target
+void BeginSSAOMode(SSAOTarget *target)
+{
+    // Get previous measured GPU time if available (never waits for the result)
+    if (target->queryPending)
+    {
+        int available = 0;
+        glGetQueryObjectiv(target->queryId, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available)
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(target->queryId, GL_QUERY_RESULT, &elapsed);
+            target->gpuTime = (float)elapsed/1000000.0f;
+            target->queryPending = false;
+        }
+    }
+
+    if (!target->queryPending) glBeginQuery(GL_TIME_ELAPSED, target->queryId);
+
+    InvalidateStateGL();
+    BindFramebufferGL(GL_FRAMEBUFFER, target->depthFboId);
+    ViewportGL(0, 0, target->width, target->height);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+}
+
+// End depth pre-pass and calculate temporally accumulated ambient occlusion
+void EndSSAOMode(SSAOTarget *target, Camera camera)
+{
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    // Calculate current frame inverse view-projection to reconstruct positions from depth
+    Matrix viewProj = GetCameraMatrixPBR(camera, (float)GetScreenWidth()/(float)GetScreenHeight());
+    Matrix invViewProj = viewProj;
+    MatrixInvert(&invViewProj);
+
+    // Calculate pixels per world unit at unit distance to get sampling radius in pixels
+    float projScale = 0.5f*target->height/tanf(camera.fovy*0.5f*DEG2RAD);
+
+    SetShaderValue(target->shader, target->projScaleLoc, (float[1]){ projScale }, 1);
+    SetShaderValuei(target->shader, target->frameLoc, (int[1]){ target->frame }, 1);
+    SetShaderValuei(target->shader, target->validHistoryLoc, (int[1]){ target->validHistory }, 1);
+    SetShaderValueMatrix(target->shader, target->invViewProjLoc, invViewProj);
+    SetShaderValueMatrix(target->shader, target->prevViewProjLoc, target->prevViewProj);
+    SetShaderValue(target->shader, target->viewPosLoc, (float[3]){ camera.position.x, camera.position.y, camera.position.z }, 3);
+    SetShaderValue(target->shader, target->prevViewPosLoc, (float[3]){ target->prevViewPos.x, target->prevViewPos.y, target->prevViewPos.z }, 3);
+    InvalidateStateGL();
+
+    // Draw ambient occlusion into next texture reading current one as history
+    int next = 1 - target->current;
+    BindFramebufferGL(GL_FRAMEBUFFER, target->ids[next]);
+
+    BindTextureGL(0, GL_TEXTURE_2D, target->depthId);
+    BindTextureGL(1, GL_TEXTURE_2D, target->textureIds[target->current]);
+
+    UseProgramGL(target->shader.id);
+    RenderQuad();
+
+    BindTextureGL(1, GL_TEXTURE_2D, 0);
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+
+    BindFramebufferGL(GL_FRAMEBUFFER, 0);
+    ViewportGL(0, 0, GetScreenWidth(), GetScreenHeight());
+
+    if (!target->queryPending)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        target->queryPending = true;
+    }
+
+    // Keep current frame values as history for next frame
+    target->current = next;
+    target->frame++;
+    target->validHistory = true;
+    target->prevViewProj = viewProj;
+    target->prevViewPos = camera.position;
+}
+
+// Bind current ambient occlusion to be upsampled by PBR shader
+void EnableSSAO(SSAOTarget target, Environment env)
+{
+    SetShaderValueiPBR(env, env.pbrSSAOLoc, (int[1]){ 1 }, 1);
+    InvalidateStateGL();
+
+    BindTextureGL(SSAO_TEXTURE_UNIT, GL_TEXTURE_2D, target.textureIds[target.current]);
+    ActiveTextureGL(0);
+}
+
+// Unbind ambient occlusion from PBR shader
+void DisableSSAO(Environment env)
+{
+    SetShaderValueiPBR(env, env.pbrSSAOLoc, (int[1]){ 0 }, 1);
+    InvalidateStateGL();
+
+    BindTextureGL(SSAO_TEXTURE_UNIT, GL_TEXTURE_2D, 0);
+    ActiveTextureGL(0);
+}
+
+// Unload ambient occlusion render targets and shader from GPU
+void UnloadSSAOTarget(SSAOTarget target)
+{
+    ForgetFramebufferGL(target.depthFboId);
+    ForgetTextureGL(target.depthId);
+
+    for (int i = 0; i < 2; i++)
+    {
+        ForgetFramebufferGL(target.ids[i]);
+        ForgetTextureGL(target.textureIds[i]);
+    }
+
+    glDeleteFramebuffers(1, &target.depthFboId);
+    glDeleteFramebuffers(2, target.ids);
+    glDeleteTextures(1, &target.depthId);
+    glDeleteTextures(2, target.textureIds);
+    glDeleteQueries(1, &target.queryId);
+
+    UnloadShader(target.shader);
+}
@@ -0,0 +1,336 @@
+/***********************************************************************************
+*
+*   rPBR [state] - OpenGL state tracker to skip redundant state changes
+*
+*   FEATURES:
+*       - Shadows bound program, active texture unit, textures per unit and target, framebuffers,
+*         viewport and depth state (test, write mask and function).
+*       - State calls that would not change anything are skipped (elided).
+*       - Issued and elided calls counted per frame.
+*
+*   NOTES:
+*       raylib changes OpenGL state internally (draw calls, shader values, render textures, 3D mode),
+*       so state it can touch must be invalidated with InvalidateStateGL() after calling raylib functions.
+*       raylib binds 2D textures in texture unit 0 (shapes, text and render textures drawing), but meshes drawing
+*       (DrawModel(), DrawModelEx(), DrawModelWires()) unbinds every material map unit (0 to MAX_MATERIAL_MAPS - 1)
+*       after drawing, so InvalidateMeshStateGL() must be called after raylib mesh draws.
+*       Other units remain tracked as long as active texture unit is restored to 0 before returning control to raylib.
+*       Deleted textures and framebuffers must be forgotten because their ids can be reused by OpenGL.
+*
+*   DEPENDENCIES:
+*       GLAD for OpenGL API (must be included before this file)
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         STATE_MAX_TEXTURE_UNITS     16                                      // Texture units tracked (all units used by PBR shader)
+#define         STATE_MAX_TEXTURE_TARGETS   3                                       // Texture targets tracked per unit (2D, cube map and 2D array)
+#define         STATE_MESH_TEXTURE_UNITS    12                                      // Texture units unbound by raylib mesh draws (MAX_MATERIAL_MAPS)
+#define         STATE_UNKNOWN               -1                                      // Shadowed value not known (changed outside of tracker)
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct StateGL {
+    bool ready;                             // Shadowed values initialized (all unknown)
+    int program;                            // Bound shader program id
+    int activeUnit;                         // Active texture unit index
+    int textures[STATE_MAX_TEXTURE_UNITS][STATE_MAX_TEXTURE_TARGETS];   // Bound texture id per unit and target
+    int readFramebuffer;                    // Bound read framebuffer id
+    int drawFramebuffer;                    // Bound draw framebuffer id
+    int viewport[4];                        // Viewport position and dimensions
+    int depthTest;                          // Depth test enabled state
+    int depthMask;                          // Depth buffer write state
+    int depthFunc;                          // Depth comparison function
+
+    int issued;                             // Current frame calls sent to OpenGL
+    int elided;                             // Current frame calls skipped (no state change)
+    int lastIssued;                         // Previous frame calls sent to OpenGL
+    int lastElided;                         // Previous frame calls skipped
+} StateGL;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static StateGL stateGL = { 0 };             // Current OpenGL context shadowed state
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+void UseProgramGL(unsigned int id);                                                             // Bind shader program if not bound
+void ActiveTextureGL(int unit);                                                                 // Set active texture unit (index, not GL_TEXTUREi) if not active
+void BindTextureGL(int unit, unsigned int target, unsigned int id);                             // Bind texture to unit and target if not bound (changes active unit)
+void BindFramebufferGL(unsigned int target, unsigned int id);                                   // Bind framebuffer to target (GL_FRAMEBUFFER sets read and draw) if not bound
+void ViewportGL(int x, int y, int width, int height);                                           // Set viewport if different
+void DepthTestGL(bool enabled);                                                                 // Enable or disable depth test if different
+void DepthMaskGL(bool enabled);                                                                 // Enable or disable depth buffer writes if different
+void DepthFuncGL(unsigned int func);                                                            // Set depth comparison function if different
+void InvalidateStateGL(void);                                                                   // Forget state raylib can change (program, unit 0, framebuffers, viewport and depth)
+void InvalidateMeshStateGL(void);                                                               // Forget state raylib mesh draws can change (also material map units)
+void ResetStateGL(void);                                                                        // Forget all shadowed state
+void ForgetProgramGL(void);                                                                     // Forget program binding (call after raylib shader values)
+void ForgetTextureGL(unsigned int id);                                                          // Forget texture bindings (call when texture is deleted)
+void ForgetFramebufferGL(unsigned int id);                                                      // Forget framebuffer bindings (call when framebuffer is deleted)
+void EndFrameStateGL(void);                                                                     // Store current frame issued and elided calls and reset counters
+int GetStateIssuedGL(void);                                                                     // Get previous frame state calls sent to OpenGL
+int GetStateElidedGL(void);                                                                     // Get previous frame state calls skipped
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Bind shader program if not bound
+void UseProgramGL(unsigned int id)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    if (stateGL.program != (int)id)
+    {
+        glUseProgram(id);
+        stateGL.program = (int)id;
+        stateGL.issued++;
+    }
+    else stateGL.elided++;
+}
+
+// Set active texture unit (index, not GL_TEXTUREi) if not active
+void ActiveTextureGL(int unit)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    if (stateGL.activeUnit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        stateGL.activeUnit = unit;
+        stateGL.issued++;
+    }
+    else stateGL.elided++;
+}
+
+// Bind texture to unit and target if not bound (changes active unit)
+// NOTE: untracked targets and units are always bound
+void BindTextureGL(int unit, unsigned int target, unsigned int id)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    int index = -1;
+
+    switch (target)
+    {
+        case GL_TEXTURE_2D: index = 0; break;
+        case GL_TEXTURE_CUBE_MAP: index = 1; break;
+        case GL_TEXTURE_2D_ARRAY: index = 2; break;
+        default: break;
+    }
+
+    if ((index != -1) && (unit < STATE_MAX_TEXTURE_UNITS) && (stateGL.textures[unit][index] == (int)id))
+    {
+        stateGL.elided++;
+        return;
+    }
+
+    ActiveTextureGL(unit);
+    glBindTexture(target, id);
+    stateGL.issued++;
+
+    if ((index != -1) && (unit < STATE_MAX_TEXTURE_UNITS)) stateGL.textures[unit][index] = (int)id;
+}
+
+// Bind framebuffer to target (GL_FRAMEBUFFER sets read and draw) if not bound
+void BindFramebufferGL(unsigned int target, unsigned int id)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    bool read = ((target == GL_FRAMEBUFFER) || (target == GL_READ_FRAMEBUFFER));
+    bool draw = ((target == GL_FRAMEBUFFER) || (target == GL_DRAW_FRAMEBUFFER));
+
+    if ((!read || (stateGL.readFramebuffer == (int)id)) && (!draw || (stateGL.drawFramebuffer == (int)id)))
+    {
+        stateGL.elided++;
+        return;
+    }
+
+    glBindFramebuffer(target, id);
+    stateGL.issued++;
+
+    if (read) stateGL.readFramebuffer = (int)id;
+    if (draw) stateGL.drawFramebuffer = (int)id;
+}
+
+// Set viewport if different
+void ViewportGL(int x, int y, int width, int height)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    if ((stateGL.viewport[0] != x) || (stateGL.viewport[1] != y) || (stateGL.viewport[2] != width) || (stateGL.viewport[3] != height))
+    {
+        glViewport(x, y, width, height);
+        stateGL.viewport[0] = x;
+        stateGL.viewport[1] = y;
+        stateGL.viewport[2] = width;
+        stateGL.viewport[3] = height;
+        stateGL.issued++;
+    }
+    else stateGL.elided++;
+}
+
+// Enable or disable depth test if different
+void DepthTestGL(bool enabled)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    if (stateGL.depthTest != (int)enabled)
+    {
+        if (enabled) glEnable(GL_DEPTH_TEST);
+        else glDisable(GL_DEPTH_TEST);
+        stateGL.depthTest = (int)enabled;
+        stateGL.issued++;
+    }
+    else stateGL.elided++;
+}
+
+// Enable or disable depth buffer writes if different
+void DepthMaskGL(bool enabled)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    if (stateGL.depthMask != (int)enabled)
+    {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+        stateGL.depthMask = (int)enabled;
+        stateGL.issued++;
+    }
+    else stateGL.elided++;
+}
+
+// Set depth comparison function if different
+void DepthFuncGL(unsigned int func)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    if (stateGL.depthFunc != (int)func)
+    {
+        glDepthFunc(func);
+        stateGL.depthFunc = (int)func;
+        stateGL.issued++;
+    }
+    else stateGL.elided++;
+}
+
+// Forget state raylib can change (program, unit 0, framebuffers, viewport and depth)
+// NOTE: active unit is forgotten too but callers must leave it at unit 0 before returning to raylib
+void InvalidateStateGL(void)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    stateGL.program = STATE_UNKNOWN;
+    stateGL.activeUnit = STATE_UNKNOWN;
+    stateGL.textures[0][0] = STATE_UNKNOWN;
+    stateGL.readFramebuffer = STATE_UNKNOWN;
+    stateGL.drawFramebuffer = STATE_UNKNOWN;
+    for (int i = 0; i < 4; i++) stateGL.viewport[i] = STATE_UNKNOWN;
+    stateGL.depthTest = STATE_UNKNOWN;
+    stateGL.depthMask = STATE_UNKNOWN;
+    stateGL.depthFunc = STATE_UNKNOWN;
+}
+
+// Forget state raylib mesh draws can change (also material map units)
+// NOTE: rlDrawMesh() unbinds 2D textures (albedo, normals... maps) and cube maps (irradiance, prefilter, cubemap maps) of every material map unit
+void InvalidateMeshStateGL(void)
+{
+    InvalidateStateGL();
+
+    for (int i = 0; i < STATE_MESH_TEXTURE_UNITS; i++)
+    {
+        for (int k = 0; k < STATE_MAX_TEXTURE_TARGETS; k++) stateGL.textures[i][k] = STATE_UNKNOWN;
+    }
+}
+
+// Forget all shadowed state
+void ResetStateGL(void)
+{
+    stateGL.ready = true;
+
+    for (int i = 0; i < STATE_MAX_TEXTURE_UNITS; i++)
+    {
+        for (int k = 0; k < STATE_MAX_TEXTURE_TARGETS; k++) stateGL.textures[i][k] = STATE_UNKNOWN;
+    }
+
+    InvalidateStateGL();
+}
+
+// Forget program binding (call after raylib shader values)
+// NOTE: SetShaderValue() and SetShaderValuei() only switch program, other shadowed state is still valid
+void ForgetProgramGL(void)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    stateGL.program = STATE_UNKNOWN;
+}
+
+// Forget texture bindings (call when texture is deleted)
+void ForgetTextureGL(unsigned int id)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    for (int i = 0; i < STATE_MAX_TEXTURE_UNITS; i++)
+    {
+        for (int k = 0; k < STATE_MAX_TEXTURE_TARGETS; k++)
+        {
+            if (stateGL.textures[i][k] == (int)id) stateGL.textures[i][k] = STATE_UNKNOWN;
+        }
+    }
+}
+
+// Forget framebuffer bindings (call when framebuffer is deleted)
+void ForgetFramebufferGL(unsigned int id)
+{
+    if (!stateGL.ready) ResetStateGL();
+
+    if (stateGL.readFramebuffer == (int)id) stateGL.readFramebuffer = STATE_UNKNOWN;
+    if (stateGL.drawFramebuffer == (int)id) stateGL.drawFramebuffer = STATE_UNKNOWN;
+}
+
+// Store current frame issued and elided calls and reset counters
+void EndFrameStateGL(void)
+{
+    stateGL.lastIssued = stateGL.issued;
+    stateGL.lastElided = stateGL.elided;
+    stateGL.issued = 0;
+    stateGL.elided = 0;
+}
+
+// Get previous frame state calls sent to OpenGL
+int GetStateIssuedGL(void)
+{
+    return stateGL.lastIssued;
+}
+
+// Get previous frame state calls skipped
+int GetStateElidedGL(void)
+{
+    return stateGL.lastElided;
+}
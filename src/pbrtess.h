@@ -0,0 +1,430 @@
+/***********************************************************************************
+*
+*   rPBR [tess] - Adaptive tessellation and height map displacement for raylib
+*
+*   FEATURES:
+*       - Model geometry displaced by PBR height map as an alternative to parallax mapping.
+*       - Tessellation levels per edge from screen-space edge size and height map variance.
+*       - Height map variance precomputed per triangle on CPU (flat areas are not subdivided).
+*       - Generated triangles kept under a budget using previous frames primitives count.
+*       - Same PBR fragment shader and material values used by regular model drawing.
+*
+*   NOTES:
+*       Tessellation requires an OpenGL 4.0 context, it is disabled on older GPUs.
+*       Call ResetTessellation when model or height map texture change to compute variance again.
+*       Vertices with same position share variance, so edges levels match on non-indexed meshes.
+*
+*   DEPENDENCIES:
+*       pbrcore.h for OpenGL API, PBR materials and tracked allocations (must be included before this file)
+*       GLFW for OpenGL 4.0 functions loading
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+***********************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include <stdlib.h>                         // Required for: free(), qsort()
+#include <string.h>                         // Required for: memcmp()
+#include <math.h>                           // Required for: sqrtf(), floorf()
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         TESS_MAX_LEVEL              32.0f                                   // Max tessellation level per edge (clamped to GPU limit)
+#define         TESS_MAX_TRIANGLES          2000000                                 // Max generated triangles per frame
+#define         TESS_VARIANCE_SAMPLES       8                                       // Height map samples per axis to compute triangle variance
+#define         TESS_VARIANCE_LOCATION      6                                       // Height map variance vertex attribute location
+
+#define         PATH_TESS_VS                "resources/shaders/displace.vs"         // Path to tessellation vertex shader
+#define         PATH_TESS_TCS               "resources/shaders/displace.tcs"        // Path to tessellation control shader (edge levels)
+#define         PATH_TESS_TES               "resources/shaders/displace.tes"        // Path to tessellation evaluation shader (height displacement)
+
+// OpenGL 4.0 tessellation values (not available in GLAD 3.3 Core profile)
+#ifndef GL_PATCHES
+    #define     GL_PATCHES                  0x000E
+#endif
+#ifndef GL_PATCH_VERTICES
+    #define     GL_PATCH_VERTICES           0x8E72
+#endif
+#ifndef GL_MAX_TESS_GEN_LEVEL
+    #define     GL_MAX_TESS_GEN_LEVEL       0x8E7E
+#endif
+#ifndef GL_TESS_EVALUATION_SHADER
+    #define     GL_TESS_EVALUATION_SHADER   0x8E87
+#endif
+#ifndef GL_TESS_CONTROL_SHADER
+    #define     GL_TESS_CONTROL_SHADER      0x8E88
+#endif
+
+#if !defined(_glfw3_h_) && !defined(PBR_GLFW_PROC_ADDRESS)
+    #define PBR_GLFW_PROC_ADDRESS
+    typedef void (*GLFWglproc)(void);
+    GLFWglproc glfwGetProcAddress(const char *procname);
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef void (APIENTRYP PFNPATCHPARAMETERIPROC)(GLenum pname, GLint value);
+
+typedef struct Tessellation {
+    bool supported;                         // OpenGL 4.0 tessellation available
+    PFNPATCHPARAMETERIPROC patchParameteri;
+
+    Shader shader;                          // PBR shader with tessellation stages
+    int mvpLoc;
+    int resolutionLoc;
+    int maxLevelLoc;
+    int budgetScaleLoc;
+    int heightMapLoc;
+    int heightScaleLoc;
+    int useParallaxLoc;
+    float maxLevel;
+
+    unsigned int varianceId;                // Height map variance vertex buffer id (0 if it must be computed)
+    unsigned int queryId;                   // Generated primitives query id
+    bool queryPending;
+    float budgetScale;                      // Tessellation levels scale to keep triangles under budget
+    unsigned int trianglesCount;            // Last generated triangles count
+} Tessellation;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+Tessellation LoadTessellation(void);                                                // Load tessellation shader if OpenGL 4.0 is available
+void ResetTessellation(Tessellation *tess);                                         // Discard height map variance (computed again in next drawing)
+void DrawModelTessellatedPBR(Tessellation *tess, Model model, MaterialPBR mat, Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale, Camera camera, Vector2 res);  // Draw a model displaced by height map using tessellation
+void UnloadTessellation(Tessellation tess);                                         // Unload tessellation shader and buffers
+
+static unsigned int LoadTessProgram(void);                                          // Compile and link PBR shader with tessellation stages
+static char *LoadTessShaderText(const char *fileName);                              // Load shader text file (must be freed)
+static void ComputeTessVariance(Tessellation *tess, Mesh mesh, Texture2D height);   // Compute height map variance per vertex and upload it to mesh
+static int CompareTessVertex(const void *a, const void *b);                         // Compare two mesh vertices positions (used to weld them)
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static float *tessVertices = NULL;                  // Mesh vertices being welded
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Load tessellation shader if OpenGL 4.0 is available
+Tessellation LoadTessellation(void)
+{
+    Tessellation tess = { 0 };
+    tess.budgetScale = 1.0f;
+
+    int major = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    tess.patchParameteri = (PFNPATCHPARAMETERIPROC)glfwGetProcAddress("glPatchParameteri");
+
+    if ((major < 4) || (tess.patchParameteri == NULL))
+    {
+        TraceLog(LOG_WARNING, "Tessellation requires OpenGL 4.0, height map displacement disabled");
+        return tess;
+    }
+
+    tess.shader.id = LoadTessProgram();
+    if (tess.shader.id == 0) return tess;
+
+    tess.supported = true;
+    tess.mvpLoc = glGetUniformLocation(tess.shader.id, "mvpMatrix");
+    tess.resolutionLoc = glGetUniformLocation(tess.shader.id, "resolution");
+    tess.maxLevelLoc = glGetUniformLocation(tess.shader.id, "maxLevel");
+    tess.budgetScaleLoc = glGetUniformLocation(tess.shader.id, "budgetScale");
+    tess.heightMapLoc = glGetUniformLocation(tess.shader.id, "heightMap");
+    tess.heightScaleLoc = glGetUniformLocation(tess.shader.id, "heightScale");
+    tess.useParallaxLoc = glGetUniformLocation(tess.shader.id, "height.useSampler");
+
+    // Clamp max tessellation level to GPU limit
+    int maxLevel = 0;
+    glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &maxLevel);
+    tess.maxLevel = ((maxLevel > 0) && (maxLevel < TESS_MAX_LEVEL)) ? (float)maxLevel : TESS_MAX_LEVEL;
+
+    glGenQueries(1, &tess.queryId);
+
+    TraceLog(LOG_INFO, "[SHDR ID %i] Tessellation shader loaded successfully (max level: %i)", tess.shader.id, (int)tess.maxLevel);
+
+    return tess;
+}
+
+// Discard height map variance (computed again in next drawing)
+void ResetTessellation(Tessellation *tess)
+{
+    if (tess->varianceId != 0) glDeleteBuffers(1, &tess->varianceId);
+    tess->varianceId = 0;
+    tess->budgetScale = 1.0f;
+}
+
+// Draw a model displaced by height map using tessellation
+// NOTE: material must have a height map, otherwise model should be drawn with DrawModelPBR
+void DrawModelTessellatedPBR(Tessellation *tess, Model model, MaterialPBR mat, Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale, Camera camera, Vector2 res)
+{
+    if (tess->varianceId == 0) ComputeTessVariance(tess, model.mesh, mat.height.bitmap);
+
+    // Calculate model matrix
+    Matrix matScale = MatrixScale(scale.x, scale.y, scale.z);
+    Matrix matRotation = MatrixRotate(rotationAxis, rotationAngle*DEG2RAD);
+    Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
+    Matrix transform = MatrixMultiply(MatrixMultiply(matScale, matRotation), matTranslation);
+
+    // Mirror PBR shader values into tessellation shader (matched again when environment is reloaded)
+    if (!IsSharedProgramPBR(mat.env, tess->shader.id)) SetSharedProgramPBR(mat.env, tess->shader.id);
+
+    // Switch to tessellation shader and send material values
+    BindSharedMaterialPBR(mat, transform);
+
+    Matrix mvp = MatrixMultiply(transform, GetCameraMatrixPBR(camera, (float)GetScreenWidth()/(float)GetScreenHeight()));
+    glUniformMatrix4fv(tess->mvpLoc, 1, false, MatrixToFloat(mvp));
+    glUniform2f(tess->resolutionLoc, res.x, res.y);
+    glUniform1f(tess->maxLevelLoc, tess->maxLevel);
+    glUniform1f(tess->budgetScaleLoc, tess->budgetScale);
+    glUniform1i(tess->heightMapLoc, 9);
+    glUniform1f(tess->heightScaleLoc, (float)mat.height.color.r/(float)255);
+
+    // Parallax mapping is replaced by real geometry
+    glUniform1i(tess->useParallaxLoc, 0);
+
+    // Draw mesh triangles as patches and count generated triangles (if previous count was already read)
+    if (!tess->queryPending) glBeginQuery(GL_PRIMITIVES_GENERATED, tess->queryId);
+
+    tess->patchParameteri(GL_PATCH_VERTICES, 3);
+    glBindVertexArray(model.mesh.vaoId);
+    if (model.mesh.indices != NULL) glDrawElements(GL_PATCHES, model.mesh.triangleCount*3, GL_UNSIGNED_SHORT, 0);
+    else glDrawArrays(GL_PATCHES, 0, model.mesh.vertexCount);
+    glBindVertexArray(0);
+
+    if (!tess->queryPending)
+    {
+        glEndQuery(GL_PRIMITIVES_GENERATED);
+        tess->queryPending = true;
+    }
+
+    UseProgramGL(0);
+    UnbindMaterialPBR();
+
+    // Read generated triangles count without stalling and scale levels to keep triangles under budget
+    // NOTE: triangles count grows with the square of tessellation levels
+    int available = 0;
+    glGetQueryObjectiv(tess->queryId, GL_QUERY_RESULT_AVAILABLE, &available);
+
+    if (available)
+    {
+        glGetQueryObjectuiv(tess->queryId, GL_QUERY_RESULT, &tess->trianglesCount);
+        tess->queryPending = false;
+
+        if (tess->trianglesCount > TESS_MAX_TRIANGLES) tess->budgetScale *= sqrtf((float)TESS_MAX_TRIANGLES/(float)tess->trianglesCount);
+        else if (tess->budgetScale < 1.0f) tess->budgetScale = fminf(tess->budgetScale*1.05f, 1.0f);
+    }
+}
+
+// Unload tessellation shader and buffers
+void UnloadTessellation(Tessellation tess)
+{
+    if (!tess.supported) return;
+
+    UnsetSharedProgramPBR(tess.shader.id);
+    UnloadShader(tess.shader);
+    if (tess.varianceId != 0) glDeleteBuffers(1, &tess.varianceId);
+    glDeleteQueries(1, &tess.queryId);
+}
+
+// Compile and link PBR shader with tessellation stages
+static unsigned int LoadTessProgram(void)
+{
+    const char *fileNames[4] = { PATH_TESS_VS, PATH_TESS_TCS, PATH_TESS_TES, PATH_PBR_FS };
+    const GLenum types[4] = { GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_FRAGMENT_SHADER };
+    unsigned int shaders[4] = { 0 };
+    unsigned int program = glCreateProgram();
+    int success = 0;
+    char log[1024] = { 0 };
+
+    for (int i = 0; i < 4; i++)
+    {
+        char *text = LoadTessShaderText(fileNames[i]);
+
+        if (text == NULL)
+        {
+            TraceLog(LOG_WARNING, "[%s] Tessellation shader file could not be opened", fileNames[i]);
+            glDeleteProgram(program);
+            return 0;
+        }
+
+        shaders[i] = glCreateShader(types[i]);
+        glShaderSource(shaders[i], 1, (const char **)&text, NULL);
+        glCompileShader(shaders[i]);
+        PBR_FREE(text);
+
+        glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &success);
+
+        if (!success)
+        {
+            glGetShaderInfoLog(shaders[i], sizeof(log), NULL, log);
+            TraceLog(LOG_WARNING, "[%s] Tessellation shader failed to compile: %s", fileNames[i], log);
+        }
+
+        glAttachShader(program, shaders[i]);
+    }
+
+    // Use same attributes locations than raylib meshes
+    glBindAttribLocation(program, 0, "vertexPosition");
+    glBindAttribLocation(program, 1, "vertexTexCoord");
+    glBindAttribLocation(program, 2, "vertexNormal");
+    glBindAttribLocation(program, 4, "vertexTangent");
+    glBindAttribLocation(program, TESS_VARIANCE_LOCATION, "vertexVariance");
+
+    glLinkProgram(program);
+
+    for (int i = 0; i < 4; i++)
+    {
+        glDetachShader(program, shaders[i]);
+        glDeleteShader(shaders[i]);
+    }
+
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    if (!success)
+    {
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        TraceLog(LOG_WARNING, "[SHDR ID %i] Tessellation shader failed to link: %s", program, log);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+// Load shader text file (must be freed)
+static char *LoadTessShaderText(const char *fileName)
+{
+    unsigned int size = 0;
+
+    // Text is loaded from resources archive if available
+    return (char *)LoadResourceData(fileName, MEMORY_MODEL, &size);
+}
+
+// Compute height map variance per vertex and upload it to mesh
+// NOTE: variances and welding order arrays are allocated from a single job arena
+static void ComputeTessVariance(Tessellation *tess, Mesh mesh, Texture2D height)
+{
+    double startTime = GetTime();
+    int verticesCount = mesh.vertexCount;
+    int trianglesCount = (mesh.indices != NULL) ? mesh.triangleCount : mesh.vertexCount/3;
+    MemoryArena arena = LoadMemoryArena(MEMORY_MODEL, verticesCount*(sizeof(float) + sizeof(int)) + 32);
+    float *variances = (float *)PushArenaZero(&arena, verticesCount*sizeof(float));
+
+    Image image = GetTextureData(height);
+    Color *pixels = GetImageData(image);
+
+    for (int t = 0; (t < trianglesCount) && (mesh.texcoords != NULL); t++)
+    {
+        int ids[3] = { t*3, t*3 + 1, t*3 + 2 };
+        if (mesh.indices != NULL) for (int k = 0; k < 3; k++) ids[k] = mesh.indices[t*3 + k];
+
+        // Calculate triangle texture coordinates bounds
+        float minU = mesh.texcoords[ids[0]*2], maxU = minU;
+        float minV = mesh.texcoords[ids[0]*2 + 1], maxV = minV;
+
+        for (int k = 1; k < 3; k++)
+        {
+            minU = fminf(minU, mesh.texcoords[ids[k]*2]);
+            maxU = fmaxf(maxU, mesh.texcoords[ids[k]*2]);
+            minV = fminf(minV, mesh.texcoords[ids[k]*2 + 1]);
+            maxV = fmaxf(maxV, mesh.texcoords[ids[k]*2 + 1]);
+        }
+
+        // Sample height map inside bounds (wrapped) and calculate depth variance
+        float sum = 0.0f;
+        float sumSquared = 0.0f;
+
+        for (int y = 0; y < TESS_VARIANCE_SAMPLES; y++)
+        {
+            for (int x = 0; x < TESS_VARIANCE_SAMPLES; x++)
+            {
+                float u = minU + (maxU - minU)*((float)x + 0.5f)/TESS_VARIANCE_SAMPLES;
+                float v = minV + (maxV - minV)*((float)y + 0.5f)/TESS_VARIANCE_SAMPLES;
+                int px = (int)((u - floorf(u))*image.width)%image.width;
+                int py = (int)((v - floorf(v))*image.height)%image.height;
+
+                float depth = (float)pixels[py*image.width + px].r/255.0f;
+                sum += depth;
+                sumSquared += depth*depth;
+            }
+        }
+
+        float samples = (float)(TESS_VARIANCE_SAMPLES*TESS_VARIANCE_SAMPLES);
+        float mean = sum/samples;
+        float variance = fmaxf(sumSquared/samples - mean*mean, 0.0f);
+
+        for (int k = 0; k < 3; k++) variances[ids[k]] = fmaxf(variances[ids[k]], variance);
+    }
+
+    free(pixels);
+    UnloadImage(image);
+
+    // Weld vertices with same position so shared edges get the same tessellation levels
+    int *order = (int *)PushArena(&arena, verticesCount*sizeof(int));
+    for (int i = 0; i < verticesCount; i++) order[i] = i;
+
+    tessVertices = mesh.vertices;
+    qsort(order, verticesCount, sizeof(int), CompareTessVertex);
+    tessVertices = NULL;
+
+    for (int i = 0; i < verticesCount;)
+    {
+        int end = i + 1;
+        float variance = variances[order[i]];
+
+        while ((end < verticesCount) && (memcmp(&mesh.vertices[order[i]*3], &mesh.vertices[order[end]*3], 3*sizeof(float)) == 0))
+        {
+            variance = fmaxf(variance, variances[order[end]]);
+            end++;
+        }
+
+        for (int k = i; k < end; k++) variances[order[k]] = variance;
+        i = end;
+    }
+
+    // Upload variance as a new vertex attribute of mesh vertex array
+    glBindVertexArray(mesh.vaoId);
+    glGenBuffers(1, &tess->varianceId);
+    glBindBuffer(GL_ARRAY_BUFFER, tess->varianceId);
+    glBufferData(GL_ARRAY_BUFFER, verticesCount*sizeof(float), variances, GL_STATIC_DRAW);
+    glVertexAttribPointer(TESS_VARIANCE_LOCATION, 1, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(TESS_VARIANCE_LOCATION);
+    glBindVertexArray(0);
+
+    TraceLog(LOG_INFO, "[VAO ID %i] Height map variance computed for %i triangles in %.2f ms (%u arena allocations from %u heap blocks)", mesh.vaoId, trianglesCount,
+             (GetTime() - startTime)*1000.0, arena.allocations, arena.heapBlocks);
+
+    UnloadMemoryArena(&arena);
+}
+
+// Compare two mesh vertices positions (used to weld them)
+static int CompareTessVertex(const void *a, const void *b)
+{
+    return memcmp(&tessVertices[*(const int *)a*3], &tessVertices[*(const int *)b*3], 3*sizeof(float));
+}
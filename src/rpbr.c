@@ -4,9 +4,34 @@
 *
 *   FEATURES:
 *       - Load OBJ models and texture images in real-time by drag and drop.
+*       - Load huge point clouds (XYZ, PTS and PLY) by drag and drop, streamed from an octree built on first load.
+*       - Load cooked packages (RPK, written by rpbrcook) by drag and drop: model, mipmapped compressed textures and
+*         baked environment mapped from a single file, without decoding or baking.
 *       - Use right mouse button to rotate lighting.
 *       - Use middle mouse button to rotate and pan camera.
 *       - Use interface to adjust material, textures, render and effects settings (space bar - display/hide interface).
+*       - Multisampled rendering (MSAA 2X, 4X and 8X) as a cheaper alternative to render scale supersampling.
+*       - Checkerboard rendering (half pixels shaded per frame) reconstructed with previous frame for high resolutions.
+*       - Adaptive tessellation with height map displacement as an alternative to parallax mapping (OpenGL 4.0).
+*       - Rectangular and disk area lights (linearly transformed cosines) selectable from light settings interface.
+*       - Automatic exposure adapted on GPU from scene average luminance (no CPU readback).
+*       - Half resolution screen space ambient occlusion for models without ambient occlusion map.
+*       - Redundant OpenGL state changes skipped, issued and skipped calls per frame displayed in stats overlay (S key).
+*       - Environment irradiance and prefilter maps baked with a compute shader on OpenGL 4.3, bake GPU times displayed in stats overlay.
+*       - Record input with --record <file.rpr> and replay it with --replay <file.rpr> (fixed timestep, optionally
+*         --headless and --trace <file.csv>) to reproduce performance issues and compare frame times between builds.
+*       - Render bundled models, HDRs and render modes offscreen with --golden <directory> and compare them against
+*         golden images and GPU/CPU time budgets (HTML report, failed scenes count as exit code).
+*       - Heap allocations tracked per subsystem (environment, model, textures, interface): live, peak and
+*         allocation rate displayed in stats overlay, summary and leaked allocations reported on exit.
+*       - Render thumbnails and previews on demand with --serve <socket path>: requests (model, textures, HDR, camera,
+*         size and render mode) answered with PNG bytes, assets and shaders cached between requests.
+*       - Export frame times, load latencies, VRAM and heap usage in Prometheus format with --metrics <port> or
+*         --metrics unix:<path> (localhost only, scrape it with curl http://127.0.0.1:9464/metrics).
+*       - Load shaders, textures, models, interface style and icon from a memory mapped resources archive (resources.rpa,
+*         written by rpbrarchive) or --archive <file>, missing resources loaded from loose files (--no-archive to disable).
+*       - Render default scene turntable on CPU with --soft <directory> (optionally --soft-size <width>x<height>,
+*         --soft-frames <count> and --soft-threads <count>): no window or OpenGL context required, frames saved as PNG.
 *       - Press F1-F11 to switch between different render modes.
 *       - Press F12 or use Screenshot button to capture a screenshot and save it as PNG file.
 *
@@ -14,7 +39,13 @@
 *
 *   gcc -o $(NAME_PART).exe $(FILE_NAME) -s icon\rpbr_icon -I$(CURRENT_DIRECTORY)\external\raylib\src -L$(CURRENT_DIRECTORY)\external\raylib\release\win32
 *   -L$(CURRENT_DIRECTORY)\external\raylib\src\external\glfw3\lib\win32 -L$(CURRENT_DIRECTORY)\external\raylib\src\external\openal_soft\lib\win32\ -lraylib
-*   -lglfw3 -lopengl32 -lgdi32 -lopenal32 -lwinmm -std=c99 -Wl,--subsystem,windows -Wl,-allow-multiple-definition
+*   -lglfw3 -lopengl32 -lgdi32 -lopenal32 -lwinmm -lpthread -std=c99 -Wl,--subsystem,windows -Wl,-allow-multiple-definition
+*
+*   To track stb_image allocations per subsystem, build raylib adding to its CFLAGS (src/Makefile):
+*
+*   -DSTBI_MALLOC=StbMallocTracked -DSTBI_REALLOC=StbReallocTracked -DSTBI_FREE=StbFreeTracked
+*
+*   Otherwise stb_image allocations are not tracked and the exit memory report doesn't attribute them.
 *
 *   LICENSE: zlib/libpng
 *
@@ -43,8 +74,25 @@
 //----------------------------------------------------------------------------------
 // Includes
 //----------------------------------------------------------------------------------
+#if !defined(_WIN32)
+    #define _POSIX_C_SOURCE 200809L             // Required for: fseeko()
+#endif
+
 #include "external/raylib/src/raylib.h"         // Required for raylib framework
+#include "external/raylib/src/rlgl.h"           // Required for: rlglDraw(), rlFrustum(), rlMultMatrixf()
 #include "pbrcore.h"                            // Required for lighting, environment and drawing functions
+#include "pbrpoints.h"                          // Required for point cloud streaming and drawing functions
+#include "pbrfilter.h"                          // Required for roughness specular antialiasing filtering functions
+#include "pbrpackage.h"                         // Required for cooked packages loading functions
+#include "pbrchecker.h"                         // Required for checkerboard rendering and reconstruction functions
+#include "pbrtess.h"                            // Required for tessellation and height map displacement functions
+#include "pbrexposure.h"                        // Required for GPU automatic exposure functions
+#include "pbrssao.h"                            // Required for screen space ambient occlusion functions
+#include "pbrgolden.h"                          // Required for golden images regression checks
+#include "pbrmetrics.h"                         // Required for Prometheus metrics exporter
+#include "pbrserver.h"                          // Required for render server requests and assets cache
+#include "pbrsoft.h"                            // Required for software rendering without OpenGL context
+#include "pbrreplay.h"                          // Required for input recording and replay (redirects raylib input functions)
 
 #define RAYGUI_IMPLEMENTATION
 #include "external/raygui.h"                    // Required for user interface functions
@@ -76,11 +124,13 @@
 
 #define         MAX_TEXTURES                7                   // Max number of supported textures in a PBR material
 #define         MAX_RENDER_SCALES           5                   // Max number of available render scales (RenderScale type)
+#define         MAX_MULTISAMPLES            4                   // Max number of available multisampling modes (Multisample type)
 #define         MAX_RENDER_MODES            11                  // Max number of render modes to switch (RenderMode type)
 #define         MAX_CAMERA_TYPES            2                   // Max number of camera modes to switch (CameraType type)
+#define         MAX_LIGHT_TYPES             4                   // Max number of light types to switch (LightType type)
 #define         MAX_SUPPORTED_EXTENSIONS    5                   // Max number of supported image file extensions (JPG, PNG, BMP, TGA and PSD)
 #define         MAX_SCROLL                  850                 // Max mouse wheel for interface scrolling
-#define         MAX_TEXTS                   16                  // Max number of text length in array
+#define         MAX_TEXTS                   17                  // Max number of text length in array
 
 #define         SCROLL_SPEED                50                  // Interface scrolling speed
 #define         CAMERA_FOV                  60.0f               // Camera global field of view
@@ -91,11 +141,23 @@
 #define         LIGHT_HEIGHT                1.0f                // Light height from center of world
 #define         LIGHT_RADIUS                0.05f               // Light gizmo drawing radius
 #define         LIGHT_OFFSET                0.03f               // Light gizmo drawing radius when mouse is over
+#define         LIGHT_MIN_SIZE              0.1f                // Area light min width and height
+#define         LIGHT_MAX_SIZE              4.0f                // Area light max width and height
+#define         LIGHT_DISK_SEGMENTS         32                  // Area disk light gizmo drawing segments
 
 #define         CUBEMAP_SIZE                1024                // Cubemap texture size
 #define         IRRADIANCE_SIZE             32                  // Irradiance map from cubemap texture size
 #define         PREFILTERED_SIZE            256                 // Prefiltered HDR environment map texture size
 #define         BRDF_SIZE                   512                 // BRDF LUT texture map size
+#define         SOFT_CUBEMAP_SIZE           256                 // Software rendering environment cubemap size (baked on CPU)
+#define         SOFT_PREFILTERED_SIZE       128                 // Software rendering prefiltered environment map size
+
+#define         GOLDEN_WIDTH                640                 // Golden images width (same aspect ratio than default window)
+#define         GOLDEN_HEIGHT               360                 // Golden images height
+#define         GOLDEN_MODELS               6                   // Bundled models rendered by golden images check
+#define         GOLDEN_HDRS                 3                   // Bundled HDR environments rendered by golden images check
+#define         GOLDEN_WARMUP_FRAMES        2                   // Golden scene frames drawn before measuring times
+#define         GOLDEN_FRAMES               5                   // Golden scene measured frames (median times are checked)
 
 #define         UI_MENU_WIDTH               225
 #define         UI_MENU_BORDER              5
@@ -108,7 +170,8 @@
 #define         UI_BUTTON_WIDTH             120
 #define         UI_BUTTON_HEIGHT            35
 #define         UI_LIGHT_WIDTH              200
-#define         UI_LIGHT_HEIGHT             140
+#define         UI_LIGHT_HEIGHT             240
+#define         UI_REDRAW_FRAMES            2                   // Interface redraws after an input (controls can change state while drawing)
 #define         UI_COLOR_BACKGROUND         (Color){ 5, 26, 36, 255 }
 #define         UI_COLOR_SECONDARY          (Color){ 245, 245, 245, 255 }
 #define         UI_COLOR_PRIMARY            (Color){ 234, 83, 77, 255 }
@@ -121,12 +184,18 @@
 #define         UI_TEXT_RENDER_TITLE        "Render Settings"
 #define         UI_TEXT_RENDER_SCALE        "Render Scale"
 #define         UI_TEXT_RENDER_MODE         "Render Mode"
+#define         UI_TEXT_RENDER_MSAA         "Multisampling (MSAA)"
 #define         UI_TEXT_RENDER_EFFECTS      "Screen Effects"
 #define         UI_TEXT_EFFECTS_TITLE       "Screen Effects"
 #define         UI_TEXT_EFFECTS_FXAA        "   Antialiasing"
 #define         UI_TEXT_EFFECTS_BLOOM       "   Bloom"
 #define         UI_TEXT_EFFECTS_VIGNETTE    "   Vignette"
 #define         UI_TEXT_EFFECTS_WIRE        "   Wireframe"
+#define         UI_TEXT_HALF_LIGHTING       "   Half-res Lighting"
+#define         UI_TEXT_CHECKERBOARD        "   Checkerboard"
+#define         UI_TEXT_TESSELLATION        "   Tessellation"
+#define         UI_TEXT_AUTO_EXPOSURE       "   Auto Exposure"
+#define         UI_TEXT_SSAO                "   Screen Space AO"
 #define         UI_TEXT_DRAW_LOGO           "   Show Logo"
 #define         UI_TEXT_DRAW_LIGHTS         "   Show Lights"
 #define         UI_TEXT_DRAW_GRID           "   Show Grid"
@@ -142,7 +211,8 @@
 #define         UI_TEXT_CONTROLS_01         "- RMB for lighting rotation."
 #define         UI_TEXT_CONTROLS_02         "- MMB (+ ALT) for camera panning (and rotation)."
 #define         UI_TEXT_CONTROLS_03         "- From F1 to F11 to display each shading mode."
-#define         UI_TEXT_CONTROLS_04         "- Drag and drop models (OBJ) and textures in real time."
+#define         UI_TEXT_CONTROLS_04         "- Drag and drop models (OBJ), point clouds (XYZ, PTS, PLY) and textures in real time."
+#define         UI_TEXT_CONTROLS_05         "- S to display/hide rendering and memory stats."
 #define         UI_TEXT_CREDITS_WEB         "Visit www.victorfisac.com for more information about the tool."
 #define         UI_TEXT_DELETE              "CLICK TO DELETE TEXTURE"
 #define         UI_TEXT_DISPLAY             "Use SPACE BAR to display/hide interface"
@@ -150,12 +220,22 @@
 #define         UI_TEXT_LIGHT_R             "R"
 #define         UI_TEXT_LIGHT_G             "G"
 #define         UI_TEXT_LIGHT_B             "B"
+#define         UI_TEXT_LIGHT_W             "W"
+#define         UI_TEXT_LIGHT_H             "H"
+#define         UI_TEXT_POINTS_STATS        "%u/%u points drawn (%i nodes)"
+#define         UI_TEXT_EXPOSURE_STATS      "Auto exposure: %.3f ms GPU"
+#define         UI_TEXT_SSAO_STATS          "Ambient occlusion (%ix%i): %.3f ms GPU"
+#define         UI_TEXT_STATE_STATS         "GL state calls: %i issued, %i elided"
+#define         UI_TEXT_BAKE_STATS          "Environment bake (%s): %.2f ms cubemap, %.2f ms IBL, %.2f ms BRDF"
+#define         UI_TEXT_MEMORY_STATS        "Memory %s: %.2f MB live, %.2f MB peak, %.0f allocs/s"
+#define         UI_TEXT_SERVER_STATS        "Render server (%s): %i warm, %i cold requests"
 
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
 //----------------------------------------------------------------------------------
 typedef enum { DEFAULT, ALBEDO, NORMALS, METALNESS, ROUGHNESS, AMBIENT_OCCLUSION, EMISSION, LIGHTING, FRESNEL, IRRADIANCE, REFLECTIVITY } RenderMode;
 typedef enum { RENDER_SCALE_0_5X, RENDER_SCALE_1X, RENDER_SCALE_2X, RENDER_SCALE_4X, RENDER_SCALE_8X } RenderScale;
+typedef enum { MULTISAMPLE_NONE, MULTISAMPLE_2X, MULTISAMPLE_4X, MULTISAMPLE_8X } Multisample;
 typedef enum { CAMERA_TYPE_FREE, CAMERA_TYPE_ORBITAL } CameraType;
 typedef enum {
     LENGTH_TEXTURES_TITLE,
@@ -163,6 +243,7 @@ typedef enum {
     LENGTH_RENDER_TITLE,
     LENGTH_RENDER_SCALE,
     LENGTH_RENDER_MODE,
+    LENGTH_RENDER_MSAA,
     LENGTH_RENDER_EFFECTS,
     LENGTH_EFFECTS_TITLE,
     LENGTH_CONTROLS,
@@ -205,6 +286,12 @@ const char *renderScalesTitles[MAX_RENDER_SCALES] = {                   // Inter
     "4.0X",
     "8.0X"
 };
+const char *multisamplesTitles[MAX_MULTISAMPLES] = {                    // Interface multisampling settings titles
+    "None",
+    "2X",
+    "4X",
+    "8X"
+};
 const char *renderModesTitles[MAX_RENDER_MODES] = {                     // Interface render modes settings titles
     "PBR (default)",
     "Albedo",
@@ -218,10 +305,51 @@ const char *renderModesTitles[MAX_RENDER_MODES] = {                     // Inter
     "Irradiance (GI)",
     "Reflectivity"
 };
+const char *goldenModels[GOLDEN_MODELS] = {                             // Golden images check models (textures folder has same name)
+    "cerberus",
+    "gold",
+    "podracer",
+    "robot",
+    "silversurfer",
+    "trooper"
+};
+const char *goldenHdrs[GOLDEN_HDRS] = {                                 // Golden images check HDR environments
+    "apartament",
+    "pinetree",
+    "road"
+};
+const char *goldenModes[MAX_RENDER_MODES] = {                           // Golden images check render modes names (scene names suffixes)
+    "default",
+    "albedo",
+    "normals",
+    "metalness",
+    "roughness",
+    "ao",
+    "emission",
+    "lighting",
+    "fresnel",
+    "irradiance",
+    "reflectivity"
+};
+const char *goldenMaps[MAX_TEXTURES] = {                                // Golden images check texture files suffixes (PBR properties order)
+    "albedo",
+    "normals",
+    "metalness",
+    "roughness",
+    "ao",
+    "emission",
+    "height"
+};
 const char *cameraTypesTitles[MAX_CAMERA_TYPES] = {                     // Interface camera type titles
     "Free Camera",
     "Orbital Camera",
 };
+const char *lightTypesTitles[MAX_LIGHT_TYPES] = {                       // Interface light type titles
+    "Directional",
+    "Point",
+    "Rect Area",
+    "Disk Area"
+};
 const float renderScales[MAX_RENDER_SCALES] = {                         // Availables render scales
     0.5f,
     1.0f,
@@ -229,65 +357,115 @@ const float renderScales[MAX_RENDER_SCALES] = {                         // Avail
     4.0f,
     8.0f
 };
+const int multisamples[MAX_MULTISAMPLES] = {                            // Availables multisampling samples count
+    0,
+    2,
+    4,
+    8
+};
 
 // Interface settings values
 RenderMode renderMode = DEFAULT;
 RenderScale renderScale = RENDER_SCALE_2X;
+Multisample multisample = MULTISAMPLE_NONE;
 CameraType cameraType = CAMERA_TYPE_FREE;
 CameraType lastCameraType = CAMERA_TYPE_FREE;
 Texture2D textures[7] = { 0 };
+Texture2D thumbnails[7] = { 0 };
 int selectedLight = -1;
 int screenShotCount = 0;
+bool takeScreenshot = false;
 bool resetScene = false;
 bool drawGrid = false;
 bool drawWire = false;
+bool halfLighting = false;
+bool checkerboard = false;
+bool tessellation = false;
+Tessellation tess = { 0 };
+bool autoExposure = false;
+bool ssao = false;
 bool drawLights = true;
 bool drawSkybox = true;
 bool drawLogo = true;
 bool drawUI = true;
 bool drawHelp = false;
+bool drawStats = false;
 bool enabledFxaa = true;
 bool enabledBloom = true;
 bool enabledVignette = true;
 
 // Scene resources values
 Model model = { 0 };
+PointCloud cloud = { 0 };
+PointCloudBuild *cloudBuild = NULL;
+double cloudLoadStart = 0.0;
 Environment environment = { 0 };
 MaterialPBR matPBR = { 0 };
 Camera camera = { 0 };
+SpecularFilter *specularFilter = NULL;
 
 //----------------------------------------------------------------------------------
 // Function Declarations
 //----------------------------------------------------------------------------------
 void InitInterface(void);                                                                       // Initialize interface texts lengths
+void LoadInterfaceStyle(const char *fileName);                                                  // Load GUI style from resources archive or loose file
 void DrawLight(Light light, bool over);                                                         // Draw a light gizmo based on light attributes
 void DrawInterface(Vector2 size, int scrolling);                                                // Draw interface based on current window dimensions
 void DrawLightInterface(Light *light);                                                          // Draw specific light settings interface
-void DrawTextureMap(int id, Texture2D texture, Vector2 position);                               // Draw interface PBR texture or alternative text
+void DrawTextureMap(int id, Texture2D thumbnail, Vector2 position);                             // Draw interface PBR texture thumbnail or alternative text
+Texture2D LoadTextureThumbnail(Texture2D texture);                                              // Load a downscaled copy of a texture to display in interface
+void ResetSpecularFilter(void);                                                                 // Restart roughness specular antialiasing filtering with current normal map
+int RenderGoldenScenes(GoldenSuite *suite, Shader fxShader, Light *lights, int count);          // Render bundled scenes offscreen and check them against golden images
+void RenderServerRequests(RenderServer *server, Shader fxShader, Light *lights, int count);      // Answer render server requests until window is closed
+int RenderSoftTurntable(SoftOptions options);                                                   // Render default scene turntable on CPU and save frames as PNG files (no window required)
+void Begin3dModeRegion(Camera camera, Vector2 size, Rectangle region, Shader skyShader, int skyProjectionLoc);  // Begin 3D mode for a region of an image (off-center projection, skybox included)
 
 //----------------------------------------------------------------------------------
 // Main program
 //----------------------------------------------------------------------------------
-int main()
+int main(int argc, char **argv)
 {
     // Initialization
     //------------------------------------------------------------------------------
+    // Check input recording, replay, golden images, metrics, render server, resources archive and software rendering command line options
+    InitReplay(argc, argv);
+    GoldenSuite golden = InitGoldenSuite(argc, argv);
+    InitMetrics(argc, argv);
+    RenderServer *server = InitRenderServer(argc, argv);
+    InitResourceArchive(argc, argv);
+    SoftOptions soft = InitSoftOptions(argc, argv);
+
+    // Render default scene on CPU instead of running viewer if requested (no window or OpenGL context)
+    if (soft.enabled)
+    {
+        int softExitCode = RenderSoftTurntable(soft);
+        CloseMetrics();
+        CloseResourceArchive();
+        ReportMemory();
+        return softExitCode;
+    }
+
     // Enable V-Sync and window resizable state
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "rPBR - Physically based rendering 3D model viewer");
+    BeginMemoryScope(MEMORY_UI);
     InitInterface();
+    BeginReplay();
 
     // Change default window icon
     Image icon = LoadImage(PATH_ICON);
     Texture2D iconTex = LoadTextureFromImage(icon);
     SetWindowIcon(icon);
     SetWindowMinSize(WINDOW_MIN_WIDTH, WINDOW_MIN_HEIGHT);
+    EndMemoryScope();
 
     // Define render settings states
     drawUI = true;
     bool canMoveCamera = true;
     bool overUI = false;
+    int uiRedraws = UI_REDRAW_FRAMES;
     int scrolling = 0;
+    Vector2 lastMousePos = { 0.0f, 0.0f };
 
     // Initialize lighting rotation
     int mousePosX = 0;
@@ -302,11 +480,19 @@ int main()
     SetCameraMode(camera, (((cameraType == CAMERA_TYPE_FREE) ? CAMERA_FREE : CAMERA_ORBITAL)));
 
     // Define environment attributes
+    double loadStart = GetTime();
     environment = LoadEnvironment(PATH_TEXTURES_HDR, CUBEMAP_SIZE, IRRADIANCE_SIZE, PREFILTERED_SIZE, BRDF_SIZE);
+    ObserveLoadMetrics(METRICS_LOAD_ENVIRONMENT, GetTime() - loadStart);
 
     // Load external resources
+    loadStart = GetTime();
+    BeginMemoryScope(MEMORY_MODEL);
     model = LoadModel(PATH_MODEL);
+    EndMemoryScope();
+    ObserveLoadMetrics(METRICS_LOAD_MODEL, GetTime() - loadStart);
+
     matPBR = SetupMaterialPBR(environment, (Color){ 255, 255, 255, 255 }, 255, 255);
+    BeginMemoryScope(MEMORY_TEXTURES);
 #if defined(PATH_TEXTURES_ALBEDO)
     SetMaterialTexturePBR(&matPBR, PBR_ALBEDO, LoadTexture(PATH_TEXTURES_ALBEDO));
     SetTextureFilter(matPBR.albedo.bitmap, FILTER_BILINEAR);
@@ -342,6 +528,15 @@ int main()
     SetTextureFilter(matPBR.height.bitmap, FILTER_BILINEAR);
     textures[PBR_HEIGHT] = matPBR.height.bitmap;
 #endif
+    for (int i = 0; i < MAX_TEXTURES; i++) if (textures[i].id != 0) thumbnails[i] = LoadTextureThumbnail(textures[i]);
+    ResetSpecularFilter();
+    EndMemoryScope();
+
+    // Load height map displacement tessellation shader (disabled if OpenGL 4.0 is not available)
+    tess = LoadTessellation();
+
+    // Load automatic exposure luminance reduction and adaptation
+    AutoExposure exposure = LoadAutoExposure();
     Shader fxShader = LoadShader(PATH_SHADERS_POSTFX_VS, PATH_SHADERS_POSTFX_FS);
 
     // Set up materials and lighting
@@ -351,6 +546,7 @@ int main()
 
     // Get shaders required locations
     int shaderModeLoc = GetShaderLocation(environment.pbrShader, "renderMode");
+    int shaderWireLoc = GetShaderLocation(environment.pbrShader, "drawWire");
     int fxResolutionLoc = GetShaderLocation(fxShader, "resolution");
     int enabledFxaaLoc = GetShaderLocation(fxShader, "enabledFxaa");
     int enabledBloomLoc = GetShaderLocation(fxShader, "enabledBloom");
@@ -368,20 +564,46 @@ int main()
     // Create a render texture for antialiasing post-processing effect and initialize Bloom shader
     RenderTexture2D fxTarget = LoadRenderTexture(GetScreenWidth()*renderScales[renderScale], GetScreenHeight()*renderScales[renderScale]);
 
+    // Define multisampled render target (created when multisampling is enabled and resolved into post-processing render texture)
+    RenderTextureMSAA msaaTarget = { 0 };
+
+    // Define half resolution image based lighting render target (created when half resolution lighting is enabled)
+    LightingTarget lightingTarget = { 0 };
+
+    // Define half resolution ambient occlusion target (created when screen space ambient occlusion is enabled)
+    SSAOTarget ssaoTarget = { 0 };
+
+    // Define checkerboard render target (created when checkerboard rendering is enabled and reconstructed into post-processing render texture)
+    CheckerTarget checkerTarget = { 0 };
+
+    // Create a render texture to cache interface drawing between input changes
+    RenderTexture2D uiTarget = LoadRenderTexture(GetScreenWidth(), GetScreenHeight());
+
     // Send resolution values to post-processing shader
     float resolution[2] = { (float)GetScreenWidth()*renderScales[renderScale], (float)GetScreenHeight()*renderScales[renderScale] };
     SetShaderValue(fxShader, fxResolutionLoc, resolution, 2);
     SetShaderValue(environment.skyShader, environment.skyResolutionLoc, resolution, 2);
 
-    // Set our game to run at 60 frames-per-second
-    SetTargetFPS(60);
+    // Set our game to run at 60 frames-per-second (no limit during replay to measure frame times)
+    SetTargetFPS(IsReplayPlaying() ? 0 : 60);
+
+    // Report startup time (time since window creation, resources loading included)
+    TraceLog(LOG_INFO, "Viewer initialized in %.2f ms (resources loaded from %s)", GetTime()*1000.0, (IsResourceArchiveOpened() ? "archive" : "loose files"));
+
+    // Render golden images regression scenes or answer render requests instead of running viewer if requested
+    int exitCode = 0;
+    if (golden.enabled) exitCode = RenderGoldenScenes(&golden, fxShader, lights, totalLights);
+    else if (server != NULL) RenderServerRequests(server, fxShader, lights, totalLights);
     //------------------------------------------------------------------------------
 
     // Main game loop
-    while (!WindowShouldClose())
+    while (!golden.enabled && (server == NULL) && !WindowShouldClose())
     {
         // Update
         //--------------------------------------------------------------------------
+        // Update heap allocation rates per subsystem
+        UpdateMemoryStats();
+
         // Update mouse collision states
         overUI = CheckCollisionPointRec(GetMousePosition(), (Rectangle){ GetScreenWidth() - UI_MENU_WIDTH, 0, UI_MENU_WIDTH, GetScreenHeight() });
 
@@ -435,7 +657,9 @@ int main()
             if (IsFileExtension(droppedFiles[0], ".hdr"))
             {
                 UnloadEnvironment(environment);
+                double loadStart = GetTime();
                 environment = LoadEnvironment(droppedFiles[0], CUBEMAP_SIZE, IRRADIANCE_SIZE, PREFILTERED_SIZE, BRDF_SIZE);
+                ObserveLoadMetrics(METRICS_LOAD_ENVIRONMENT, GetTime() - loadStart);
                 resolution[0] = (float)GetScreenWidth()*renderScales[renderScale];
                 resolution[1] = (float)GetScreenHeight()*renderScales[renderScale];
                 SetShaderValue(environment.skyShader, environment.skyResolutionLoc, resolution, 2);
@@ -458,8 +682,108 @@ int main()
             else if (IsFileExtension(droppedFiles[0], ".obj"))
             {
                 UnloadModel(model);
+                double loadStart = GetTime();
+                BeginMemoryScope(MEMORY_MODEL);
                 model = LoadModel(droppedFiles[0]);
+                EndMemoryScope();
+                ObserveLoadMetrics(METRICS_LOAD_MODEL, GetTime() - loadStart);
                 model.material = material;
+                ResetTessellation(&tess);
+
+                // Switch back to model drawing
+                if (cloudBuild != NULL) StopPointCloudBuild(cloudBuild);
+                cloudBuild = NULL;
+                UnloadPointCloud(cloud);
+                cloud = (PointCloud){ 0 };
+            }
+            else if (IsFileExtension(droppedFiles[0], ".xyz") || IsFileExtension(droppedFiles[0], ".pts") ||
+                     IsFileExtension(droppedFiles[0], ".ply") || IsFileExtension(droppedFiles[0], ".rpo"))
+            {
+                // Build point cloud octree in background (model is drawn until point cloud is loaded)
+                if (cloudBuild != NULL) StopPointCloudBuild(cloudBuild);
+                UnloadPointCloud(cloud);
+                cloud = (PointCloud){ 0 };
+                cloudLoadStart = GetTime();
+                cloudBuild = StartPointCloudBuild(droppedFiles[0]);
+            }
+            else if (IsFileExtension(droppedFiles[0], ".rpk"))
+            {
+                // Replace scene resources stored in cooked package (other resources are kept)
+                double loadStart = GetTime();
+                Package package = OpenPackage(droppedFiles[0]);
+
+                if (package.file.data != NULL)
+                {
+                    if (FindPackageEntry(package, PACKAGE_ENVIRONMENT, 0) != NULL)
+                    {
+                        UnloadEnvironment(environment);
+                        environment = LoadPackageEnvironment(package);
+                        resolution[0] = (float)GetScreenWidth()*renderScales[renderScale];
+                        resolution[1] = (float)GetScreenHeight()*renderScales[renderScale];
+                        SetShaderValue(environment.skyShader, environment.skyResolutionLoc, resolution, 2);
+                        matPBR = SetupMaterialPBR(environment, (Color){ 255, 255, 255, 255 }, 255, 255);
+                    }
+
+                    // Package textures already have their mipmaps and filtering set up
+                    BeginMemoryScope(MEMORY_TEXTURES);
+
+                    for (int i = 0; i < MAX_TEXTURES; i++)
+                    {
+                        Texture2D newTex = LoadPackageTexture(package, i);
+
+                        if (newTex.id != 0)
+                        {
+                            if (textures[i].id != 0)
+                            {
+                                ForgetTextureGL(textures[i].id);
+                                UnloadTexture(textures[i]);
+                            }
+
+                            if (thumbnails[i].id != 0) UnloadTexture(thumbnails[i]);
+                            textures[i] = newTex;
+                            thumbnails[i] = LoadPackageThumbnail(package, i, UI_TEXTURES_SIZE);
+                        }
+
+                        // Apply previously imported textures too (material is set up again with a new environment)
+                        if (textures[i].id != 0) SetMaterialTexturePBR(&matPBR, i, textures[i]);
+                    }
+
+                    EndMemoryScope();
+
+                    // Cooked roughness mipmaps are already filtered with its normal map
+                    if (FindPackageEntry(package, PACKAGE_TEXTURE, PBR_ROUGHNESS) != NULL)
+                    {
+                        if (specularFilter != NULL) StopSpecularFilter(specularFilter);
+                        specularFilter = NULL;
+                    }
+                    else if (FindPackageEntry(package, PACKAGE_TEXTURE, PBR_NORMALS) != NULL) ResetSpecularFilter();
+
+                    BeginMemoryScope(MEMORY_MODEL);
+                    Model newModel = LoadPackageModel(package);
+                    EndMemoryScope();
+
+                    if (newModel.mesh.vertexCount > 0)
+                    {
+                        UnloadModel(model);
+                        model = newModel;
+
+                        // Switch back to model drawing
+                        if (cloudBuild != NULL) StopPointCloudBuild(cloudBuild);
+                        cloudBuild = NULL;
+                        UnloadPointCloud(cloud);
+                        cloud = (PointCloud){ 0 };
+                    }
+
+                    if ((newModel.mesh.vertexCount > 0) || (FindPackageEntry(package, PACKAGE_TEXTURE, PBR_HEIGHT) != NULL)) ResetTessellation(&tess);
+
+                    // Set up materials and lighting
+                    material = (Material){ 0 };
+                    material.shader = matPBR.env.pbrShader;
+                    model.material = material;
+
+                    ClosePackage(&package);
+                    ObserveLoadMetrics(METRICS_LOAD_PACKAGE, GetTime() - loadStart);
+                }
             }
             else
             {
@@ -487,10 +811,18 @@ int main()
                         // Check if file is droppen in texture rectangle
                         if (CheckCollisionPointRec(GetMousePosition(), rect))
                         {
+                            double loadStart = GetTime();
+                            BeginMemoryScope(MEMORY_TEXTURES);
                             Texture2D newTex = LoadTexture(droppedFiles[0]);
+                            ObserveLoadMetrics(METRICS_LOAD_TEXTURE, GetTime() - loadStart);
                             if (textures[i].id != 0) UnsetMaterialTexturePBR(&matPBR, i);
+                            if (thumbnails[i].id != 0) UnloadTexture(thumbnails[i]);
                             SetMaterialTexturePBR(&matPBR, i, newTex);
                             textures[i] = newTex;
+                            thumbnails[i] = LoadTextureThumbnail(newTex);
+                            if ((i == PBR_ROUGHNESS) || (i == PBR_NORMALS)) ResetSpecularFilter();
+                            EndMemoryScope();
+                            if (i == PBR_HEIGHT) ResetTessellation(&tess);
                             break;
                         }
                     }
@@ -498,6 +830,7 @@ int main()
             }
 
             ClearDroppedFiles();
+            uiRedraws = UI_REDRAW_FRAMES;
         }
 
         // Check for display UI switch states
@@ -510,6 +843,9 @@ int main()
             if (selectedLight != -1) selectedLight = -1;
         }
 
+        // Check for display stats shortcut input
+        if (IsKeyPressed(KEY_S)) drawStats = !drawStats;
+
         // Check for display help UI shortcut input
         if (IsKeyPressed(KEY_H))
         {
@@ -582,7 +918,11 @@ int main()
             if (CheckCollisionPointRec(GetMousePosition(), rect) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
             {
                 UnsetMaterialTexturePBR(&matPBR, i);
+                UnloadTexture(thumbnails[i]);
                 textures[i] = (Texture2D){ 0 };
+                thumbnails[i] = (Texture2D){ 0 };
+                if ((i == PBR_ROUGHNESS) || (i == PBR_NORMALS)) ResetSpecularFilter();
+                if (i == PBR_HEIGHT) ResetTessellation(&tess);
                 break;
             }
         }
@@ -625,6 +965,85 @@ int main()
         Vector2 screenRes = { (float)GetScreenWidth()*renderScales[renderScale], (float)GetScreenHeight()*renderScales[renderScale] };
         UpdateEnvironmentValues(environment, camera, screenRes);
 
+        // Upload roughness mipmaps filtered with normal map variance when ready
+        if ((specularFilter != NULL) && UpdateSpecularFilter(specularFilter)) specularFilter = NULL;
+
+        // Load point cloud when its octree file is built
+        if ((cloudBuild != NULL) && UpdatePointCloudBuild(cloudBuild, &cloud))
+        {
+            ObserveLoadMetrics(METRICS_LOAD_POINTCLOUD, GetTime() - cloudLoadStart);
+            cloudBuild = NULL;
+        }
+
+        // Select point cloud nodes to draw and stream missing ones
+        if (cloud.nodesCount > 0) UpdatePointCloud(&cloud, camera, screenRes);
+
+        // Recreate scene render targets if window size, render scale or multisampling changed
+        if ((fxTarget.texture.width != (int)screenRes.x) || (fxTarget.texture.height != (int)screenRes.y) ||
+            (msaaTarget.samples != multisamples[multisample]) || (msaaTarget.width != fxTarget.texture.width) || (msaaTarget.height != fxTarget.texture.height))
+        {
+            if ((fxTarget.texture.width != (int)screenRes.x) || (fxTarget.texture.height != (int)screenRes.y))
+            {
+                UnloadRenderTexture(fxTarget);
+                fxTarget = LoadRenderTexture(screenRes.x, screenRes.y);
+            }
+
+            if (msaaTarget.id != 0) UnloadRenderTextureMSAA(msaaTarget);
+            msaaTarget = (RenderTextureMSAA){ 0 };
+
+            if (multisamples[multisample] > 0)
+            {
+                msaaTarget = LoadRenderTextureMSAA(fxTarget.texture.width, fxTarget.texture.height, multisamples[multisample]);
+
+                // Keep requested samples count to avoid recreating render target each frame if it was clamped
+                msaaTarget.samples = multisamples[multisample];
+            }
+            else
+            {
+                msaaTarget.width = fxTarget.texture.width;
+                msaaTarget.height = fxTarget.texture.height;
+            }
+        }
+
+        // Recreate half resolution lighting target if enabled and scene render target size changed
+        int halfWidth = (fxTarget.texture.width + 1)/2;
+        int halfHeight = (fxTarget.texture.height + 1)/2;
+
+        if (halfLighting && ((lightingTarget.width != halfWidth) || (lightingTarget.height != halfHeight)))
+        {
+            if (lightingTarget.id != 0) UnloadLightingTarget(lightingTarget);
+            lightingTarget = LoadLightingTarget(halfWidth, halfHeight);
+        }
+        else if (!halfLighting && (lightingTarget.id != 0))
+        {
+            UnloadLightingTarget(lightingTarget);
+            lightingTarget = (LightingTarget){ 0 };
+        }
+
+        // Recreate half resolution ambient occlusion target if enabled and scene render target size changed (history is lost)
+        if (ssao && ((ssaoTarget.width != halfWidth) || (ssaoTarget.height != halfHeight)))
+        {
+            if (ssaoTarget.depthFboId != 0) UnloadSSAOTarget(ssaoTarget);
+            ssaoTarget = LoadSSAOTarget(halfWidth, halfHeight);
+        }
+        else if (!ssao && (ssaoTarget.depthFboId != 0))
+        {
+            UnloadSSAOTarget(ssaoTarget);
+            ssaoTarget = (SSAOTarget){ 0 };
+        }
+
+        // Recreate checkerboard target if enabled and scene render target size changed (previous frame history is lost)
+        if (checkerboard && ((checkerTarget.width != fxTarget.texture.width) || (checkerTarget.height != fxTarget.texture.height)))
+        {
+            if (checkerTarget.id != 0) UnloadCheckerTarget(checkerTarget);
+            checkerTarget = LoadCheckerTarget(fxTarget.texture.width, fxTarget.texture.height);
+        }
+        else if (!checkerboard && (checkerTarget.id != 0))
+        {
+            UnloadCheckerTarget(checkerTarget);
+            checkerTarget = (CheckerTarget){ 0 };
+        }
+
         // Send resolution values to post-processing shader
         resolution[0] = screenRes.x;
         resolution[1] = screenRes.y;
@@ -632,13 +1051,29 @@ int main()
 
         // Send current mode to PBR shader and enabled screen effects states to post-processing shader
         int shaderMode[1] = { renderMode };
-        SetShaderValuei(environment.pbrShader, shaderModeLoc, shaderMode, 1);
+        SetShaderValueiPBR(environment, shaderModeLoc, shaderMode, 1);
+        shaderMode[0] = (drawWire && (model.mesh.indices == NULL));
+        SetShaderValueiPBR(environment, shaderWireLoc, shaderMode, 1);
         shaderMode[0] = enabledFxaa;
         SetShaderValuei(fxShader, enabledFxaaLoc, shaderMode, 1);
         shaderMode[0] = enabledBloom;
         SetShaderValuei(fxShader, enabledBloomLoc, shaderMode, 1);
         shaderMode[0] = enabledVignette;
         SetShaderValuei(fxShader, enabledVignetteLoc, shaderMode, 1);
+
+        // Check if interface needs to be drawn again (any input can change interface controls states)
+        Vector2 mousePos = GetMousePosition();
+        if ((mousePos.x != lastMousePos.x) || (mousePos.y != lastMousePos.y) || (GetMouseWheelMove() != 0) || (GetKeyPressed() != -1)) uiRedraws = UI_REDRAW_FRAMES;
+        else if (IsMouseButtonDown(MOUSE_LEFT_BUTTON) || IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) uiRedraws = UI_REDRAW_FRAMES;
+        lastMousePos = mousePos;
+
+        // Recreate interface render texture if window has been resized
+        if ((uiTarget.texture.width != GetScreenWidth()) || (uiTarget.texture.height != GetScreenHeight()))
+        {
+            UnloadRenderTexture(uiTarget);
+            uiTarget = LoadRenderTexture(GetScreenWidth(), GetScreenHeight());
+            uiRedraws = UI_REDRAW_FRAMES;
+        }
         //--------------------------------------------------------------------------
 
         // Draw
@@ -647,17 +1082,79 @@ int main()
 
             ClearBackground(DARKGRAY);
 
-            // Render to texture for antialiasing post-processing
-            BeginTextureMode(fxTarget);
+            // Apply exposure adapted in previous frames or fixed exposure
+            if (autoExposure) EnableAutoExposure(exposure, environment);
+            else DisableAutoExposure(environment);
+
+            // Draw half resolution depth pre-pass and calculate ambient occlusion if material has no ambient occlusion map
+            bool occlusionPass = ssao && !matPBR.ao.useBitmap && (cloud.nodesCount == 0);
+
+            if (occlusionPass)
+            {
+                // Draw depth with default shader (color writes are disabled)
+                Model depthModel = model;
+                depthModel.material.shader = GetDefaultShader();
+
+                BeginSSAOMode(&ssaoTarget);
+
+                    Begin3dMode(camera);
+
+                        DrawModel(depthModel, (Vector3){ 0.0f, 0.0f, 0.0f }, MODEL_SCALE, WHITE);
+                        InvalidateMeshStateGL();
+
+                    End3dMode();
+
+                EndSSAOMode(&ssaoTarget, camera);
+
+                EnableSSAO(ssaoTarget, environment);
+            }
+            else DisableSSAO(environment);
+
+            // Draw low frequency image based lighting at half resolution to be upsampled in scene drawing
+            bool lightingPass = halfLighting && (cloud.nodesCount == 0);
+
+            if (lightingPass)
+            {
+                BeginLightingMode(environment, lightingTarget);
+
+                    Begin3dMode(camera);
+
+                        DrawModelPBR(model, matPBR, (Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 1.0f, 0.0f }, 0.0f, (Vector3){ MODEL_SCALE, MODEL_SCALE, MODEL_SCALE });
+
+                    End3dMode();
+
+                EndLightingMode(environment, lightingTarget);
+            }
+
+            // Render to texture for antialiasing post-processing (checkerboard or multisampled framebuffer if enabled)
+            RenderTexture2D sceneTarget = fxTarget;
+            if (checkerTarget.id != 0) sceneTarget.id = checkerTarget.id;
+            else if (msaaTarget.id != 0) sceneTarget.id = msaaTarget.id;
+
+            BeginTextureMode(sceneTarget);
+
+                if (checkerTarget.id != 0) BeginCheckerMode(checkerTarget);
 
                 Begin3dMode(camera);
 
                     // Draw ground grid
                     if (drawGrid) DrawGrid(10, 1.0f);
 
-                    // Draw loaded model using physically based rendering
-                    DrawModelPBR(model, matPBR, (Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 1.0f, 0.0f }, 0.0f, (Vector3){ MODEL_SCALE, MODEL_SCALE, MODEL_SCALE });
-                    if (drawWire) DrawModelWires(model, (Vector3){ 0.0f, 0.0f, 0.0f }, MODEL_SCALE, DARKGRAY);
+                    // Draw loaded point cloud or model using physically based rendering
+                    if (cloud.nodesCount > 0) DrawPointCloud(cloud, environment, camera, screenRes);
+                    else
+                    {
+                        // Displace model geometry with height map instead of parallax mapping if tessellation is enabled
+                        if (tessellation && tess.supported && matPBR.height.useBitmap) DrawModelTessellatedPBR(&tess, model, matPBR, (Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 1.0f, 0.0f }, 0.0f, (Vector3){ MODEL_SCALE, MODEL_SCALE, MODEL_SCALE }, camera, screenRes);
+                        else DrawModelPBR(model, matPBR, (Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 1.0f, 0.0f }, 0.0f, (Vector3){ MODEL_SCALE, MODEL_SCALE, MODEL_SCALE });
+
+                        // Indexed meshes can't compute barycentric coordinates in PBR shader, so draw wireframe separately
+                        if (drawWire && (model.mesh.indices != NULL))
+                        {
+                            DrawModelWires(model, (Vector3){ 0.0f, 0.0f, 0.0f }, MODEL_SCALE, DARKGRAY);
+                            InvalidateMeshStateGL();
+                        }
+                    }
 
                     // Draw light gizmos
                     if (drawLights) for (unsigned int i = 0; (i < totalLights); i++)
@@ -671,8 +1168,20 @@ int main()
 
                 End3dMode();
 
+                if (checkerTarget.id != 0) EndCheckerMode();
+
             EndTextureMode();
 
+            // Return to full rate lighting for next frames
+            if (lightingPass) DisableLightingTarget(environment);
+
+            // Reconstruct checkerboard scene or resolve multisampled scene into post-processing render texture
+            if (checkerTarget.id != 0) ReconstructCheckerTarget(&checkerTarget, fxTarget, camera);
+            else if (msaaTarget.id != 0) ResolveRenderTextureMSAA(msaaTarget, fxTarget);
+
+            // Measure scene luminance and adapt exposure on GPU for next frame
+            if (autoExposure) UpdateAutoExposure(&exposure, fxTarget, GetFrameTime());
+
             BeginShaderMode(fxShader);
 
                 DrawTexturePro(fxTarget.texture, (Rectangle){ 0, 0, fxTarget.texture.width, -fxTarget.texture.height }, 
@@ -688,59 +1197,144 @@ int main()
                 DrawTexture(iconTex, padding, GetScreenHeight() - UI_MENU_PADDING*1.25f - iconTex.height, WHITE);
             }
 
-            // Draw help window if help menu is enabled
-            if (drawHelp)
+            // Take requested screenshot before drawing interface (interface is drawn to its own render texture)
+            if (takeScreenshot)
             {
-                // Draw help background
-                DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), Fade(UI_COLOR_BACKGROUND, 0.8f));
-
-                // Draw rPBR logo and title
-                int padding = UI_MENU_PADDING*3 + iconTex.height + UI_MENU_PADDING;
-                DrawTexture(iconTex, GetScreenWidth()/2 - iconTex.width/2, UI_MENU_PADDING*3, WHITE);
-                DrawText(UI_TEXT_TITLE, GetScreenWidth()/2 - textsLength[LENGTH_TITLE]/2, padding, UI_TEXT_SIZE_H3, WHITE);
-
-                // Draw controls title
-                padding += UI_MENU_PADDING*3.5f;
-                DrawText(UI_TEXT_CONTROLS, GetScreenWidth()/2 - textsLength[LENGTH_CONTROLS]/2, padding, UI_TEXT_SIZE_H1, UI_COLOR_PRIMARY);
-                DrawRectangle(GetScreenWidth()/2 - textsLength[LENGTH_CONTROLS], padding + UI_TEXT_SIZE_H1 + UI_MENU_PADDING/2, textsLength[LENGTH_CONTROLS]*2, 2, UI_COLOR_PRIMARY);
-
-                // Draw camera controls labels
-                padding += UI_TEXT_SIZE_H1 + UI_MENU_PADDING*2.5f;
-                DrawText(UI_TEXT_CONTROLS_01, GetScreenWidth()*0.35f, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
-                padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING;
-                DrawText(UI_TEXT_CONTROLS_02, GetScreenWidth()*0.35f, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
-                padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING;
-                DrawText(UI_TEXT_CONTROLS_03, GetScreenWidth()*0.35f, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
-                padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING;
-                DrawText(UI_TEXT_CONTROLS_04, GetScreenWidth()*0.35f, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
-
-                // Draw credits title
-                padding += UI_MENU_PADDING*4;
-                DrawText(UI_TEXT_CREDITS, GetScreenWidth()/2 - textsLength[LENGTH_CREDITS]/2, padding, UI_TEXT_SIZE_H1, UI_COLOR_PRIMARY);
-                DrawRectangle(GetScreenWidth()/2 - textsLength[LENGTH_CREDITS], padding + UI_TEXT_SIZE_H1 + UI_MENU_PADDING/2, textsLength[LENGTH_CREDITS]*2, 2, UI_COLOR_PRIMARY);
-
-                // Draw credits labels
-                padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING*2.5f;
-                DrawText(UI_TEXT_CREDITS_VICTOR, GetScreenWidth()/2 - textsLength[LENGTH_CREDITS_VICTOR]/2, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
-                padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING;
-                DrawText(UI_TEXT_CREDITS_RAMON, GetScreenWidth()/2 - textsLength[LENGTH_CREDITS_RAMON]/2, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
-                padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING*3;
-                DrawText(UI_TEXT_CREDITS_WEB, GetScreenWidth()/2 - textsLength[LENGTH_CREDITS_WEB]/2, padding, UI_TEXT_SIZE_H2, UI_COLOR_PRIMARY);
-
-                // Draw close help menu button and check input
-                if (GuiButton((Rectangle){ GetScreenWidth()/2 - UI_BUTTON_WIDTH/2, GetScreenHeight() - UI_BUTTON_HEIGHT - UI_MENU_PADDING*5, 
-                    UI_BUTTON_WIDTH, UI_BUTTON_HEIGHT }, UI_TEXT_BUTTON_CLOSE_HELP)) drawHelp = false;
+                rlglDraw();
+                TakeScreenshot(FormatText("rpbr_screenshot_%i.png", screenShotCount));
+                screenShotCount++;
+                takeScreenshot = false;
             }
-            else if (drawUI)
+
+            // Draw point cloud streaming, GPU costs, state calls, bake times and memory stats if enabled (after screenshot, so they are not captured)
+            if (drawStats && !drawHelp)
             {
-                // Draw light settings interface if any light is selected
-                if (selectedLight != -1) DrawLightInterface(&lights[selectedLight]);
+                int statsPadding = UI_MENU_PADDING;
+
+                if (cloud.nodesCount > 0)
+                {
+                    DrawText(FormatText(UI_TEXT_POINTS_STATS, cloud.pointsVisible, cloud.pointsCount, cloud.visibleCount), UI_MENU_PADDING, statsPadding, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
+                    statsPadding += UI_TEXT_SIZE_H3*1.5f;
+                }
+
+                if (autoExposure)
+                {
+                    DrawText(FormatText(UI_TEXT_EXPOSURE_STATS, exposure.gpuTime), UI_MENU_PADDING, statsPadding, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
+                    statsPadding += UI_TEXT_SIZE_H3*1.5f;
+                }
+
+                if (occlusionPass)
+                {
+                    DrawText(FormatText(UI_TEXT_SSAO_STATS, ssaoTarget.width, ssaoTarget.height, ssaoTarget.gpuTime), UI_MENU_PADDING, statsPadding, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
+                    statsPadding += UI_TEXT_SIZE_H3*1.5f;
+                }
+
+                DrawText(FormatText(UI_TEXT_STATE_STATS, GetStateIssuedGL(), GetStateElidedGL()), UI_MENU_PADDING, statsPadding, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
+                statsPadding += UI_TEXT_SIZE_H3*1.5f;
 
-                // Draw global interface to manage textures, material properties and render settings
-                DrawInterface((Vector2){ GetScreenWidth(), GetScreenHeight() }, scrolling);
+                DrawText(FormatText(UI_TEXT_BAKE_STATS, (environment.computeBake ? "compute" : "raster"), environment.cubemapTime, environment.bakeTime, environment.brdfTime), 
+                         UI_MENU_PADDING, statsPadding, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
+
+                // Draw heap allocations of subsystems which allocated memory
+                for (int i = 0; i < MEMORY_TAGS; i++)
+                {
+                    MemoryStats stats = GetMemoryStats(i);
+                    if (stats.totalCount == 0) continue;
+
+                    statsPadding += UI_TEXT_SIZE_H3*1.5f;
+                    DrawText(FormatText(UI_TEXT_MEMORY_STATS, GetMemoryTagName(i), stats.liveBytes/(1024.0f*1024.0f), stats.peakBytes/(1024.0f*1024.0f), stats.countRate), 
+                             UI_MENU_PADDING, statsPadding, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
+                }
+            }
+
+            // Draw light settings interface if any light is selected (not cached because it follows light screen position)
+            if (!drawHelp && drawUI && (selectedLight != -1)) DrawLightInterface(&lights[selectedLight]);
+
+            // Render help window or global interface to its render texture just if any input or state changed
+            if (uiRedraws > 0)
+            {
+                BeginTextureMode(uiTarget);
+
+                    ClearBackground(BLANK);
+
+                    // Accumulate premultiplied colors and coverage alpha to composite interface properly
+                    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+                    // Draw help window if help menu is enabled
+                    if (drawHelp)
+                    {
+                        // Draw help background
+                        DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), Fade(UI_COLOR_BACKGROUND, 0.8f));
+
+                        // Draw rPBR logo and title
+                        int padding = UI_MENU_PADDING*3 + iconTex.height + UI_MENU_PADDING;
+                        DrawTexture(iconTex, GetScreenWidth()/2 - iconTex.width/2, UI_MENU_PADDING*3, WHITE);
+                        DrawText(UI_TEXT_TITLE, GetScreenWidth()/2 - textsLength[LENGTH_TITLE]/2, padding, UI_TEXT_SIZE_H3, WHITE);
+
+                        // Draw controls title
+                        padding += UI_MENU_PADDING*3.5f;
+                        DrawText(UI_TEXT_CONTROLS, GetScreenWidth()/2 - textsLength[LENGTH_CONTROLS]/2, padding, UI_TEXT_SIZE_H1, UI_COLOR_PRIMARY);
+                        DrawRectangle(GetScreenWidth()/2 - textsLength[LENGTH_CONTROLS], padding + UI_TEXT_SIZE_H1 + UI_MENU_PADDING/2, textsLength[LENGTH_CONTROLS]*2, 2, UI_COLOR_PRIMARY);
+
+                        // Draw camera controls labels
+                        padding += UI_TEXT_SIZE_H1 + UI_MENU_PADDING*2.5f;
+                        DrawText(UI_TEXT_CONTROLS_01, GetScreenWidth()*0.35f, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
+                        padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING;
+                        DrawText(UI_TEXT_CONTROLS_02, GetScreenWidth()*0.35f, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
+                        padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING;
+                        DrawText(UI_TEXT_CONTROLS_03, GetScreenWidth()*0.35f, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
+                        padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING;
+                        DrawText(UI_TEXT_CONTROLS_04, GetScreenWidth()*0.35f, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
+                        padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING;
+                        DrawText(UI_TEXT_CONTROLS_05, GetScreenWidth()*0.35f, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
+
+                        // Draw credits title
+                        padding += UI_MENU_PADDING*4;
+                        DrawText(UI_TEXT_CREDITS, GetScreenWidth()/2 - textsLength[LENGTH_CREDITS]/2, padding, UI_TEXT_SIZE_H1, UI_COLOR_PRIMARY);
+                        DrawRectangle(GetScreenWidth()/2 - textsLength[LENGTH_CREDITS], padding + UI_TEXT_SIZE_H1 + UI_MENU_PADDING/2, textsLength[LENGTH_CREDITS]*2, 2, UI_COLOR_PRIMARY);
+
+                        // Draw credits labels
+                        padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING*2.5f;
+                        DrawText(UI_TEXT_CREDITS_VICTOR, GetScreenWidth()/2 - textsLength[LENGTH_CREDITS_VICTOR]/2, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
+                        padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING;
+                        DrawText(UI_TEXT_CREDITS_RAMON, GetScreenWidth()/2 - textsLength[LENGTH_CREDITS_RAMON]/2, padding, UI_TEXT_SIZE_H2, UI_COLOR_SECONDARY);
+                        padding += UI_TEXT_SIZE_H2 + UI_MENU_PADDING*3;
+                        DrawText(UI_TEXT_CREDITS_WEB, GetScreenWidth()/2 - textsLength[LENGTH_CREDITS_WEB]/2, padding, UI_TEXT_SIZE_H2, UI_COLOR_PRIMARY);
+
+                        // Draw close help menu button and check input
+                        if (GuiButton((Rectangle){ GetScreenWidth()/2 - UI_BUTTON_WIDTH/2, GetScreenHeight() - UI_BUTTON_HEIGHT - UI_MENU_PADDING*5, 
+                            UI_BUTTON_WIDTH, UI_BUTTON_HEIGHT }, UI_TEXT_BUTTON_CLOSE_HELP)) drawHelp = false;
+                    }
+                    else if (drawUI)
+                    {
+                        // Draw global interface to manage textures, material properties and render settings
+                        DrawInterface((Vector2){ GetScreenWidth(), GetScreenHeight() }, scrolling);
+                    }
+
+                EndTextureMode();
+
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                uiRedraws--;
+            }
+
+            // Composite cached interface with a single premultiplied alpha draw
+            if (drawHelp || drawUI)
+            {
+                rlglDraw();
+                glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+                DrawTexturePro(uiTarget.texture, (Rectangle){ 0, 0, uiTarget.texture.width, -uiTarget.texture.height },
+                               (Rectangle){ 0, 0, GetScreenWidth(), GetScreenHeight() }, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+                rlglDraw();
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             }
 
         EndDrawing();
+
+        // Keep current frame state calls counters to be displayed next frame
+        EndFrameStateGL();
+
+        // Count frame time and publish gauges to metrics exporter
+        ObserveFrameMetrics();
         //--------------------------------------------------------------------------
     }
 
@@ -752,6 +1346,19 @@ int main()
     // Unload loaded model mesh and binded textures
     UnloadModel(model);
 
+    // Unload tessellation shader and height map variance buffer
+    UnloadTessellation(tess);
+
+    // Unload automatic exposure textures and shaders
+    UnloadAutoExposure(exposure);
+
+    // Stop roughness filtering if it is still running
+    if (specularFilter != NULL) StopSpecularFilter(specularFilter);
+
+    // Stop point cloud octree building and streaming and unload its buffers
+    if (cloudBuild != NULL) StopPointCloudBuild(cloudBuild);
+    UnloadPointCloud(cloud);
+
     // Unload materialPBR assigned textures
     UnloadMaterialPBR(matPBR);
 
@@ -762,13 +1369,31 @@ int main()
     UnloadImage(icon);
     UnloadTexture(iconTex);
     UnloadRenderTexture(fxTarget);
+    UnloadRenderTexture(uiTarget);
+    if (msaaTarget.id != 0) UnloadRenderTextureMSAA(msaaTarget);
+    if (lightingTarget.id != 0) UnloadLightingTarget(lightingTarget);
+    if (checkerTarget.id != 0) UnloadCheckerTarget(checkerTarget);
+    if (ssaoTarget.depthFboId != 0) UnloadSSAOTarget(ssaoTarget);
+    for (int i = 0; i < MAX_TEXTURES; i++) if (thumbnails[i].id != 0) UnloadTexture(thumbnails[i]);
     UnloadShader(fxShader);
 
+    // Finish input recording or write replay frame times
+    EndReplay();
+
+    // Stop metrics exporter
+    CloseMetrics();
+
+    // Unmap resources archive
+    CloseResourceArchive();
+
     // Close window and OpenGL context
     CloseWindow();
+
+    // Report heap allocations per subsystem and leaked allocations
+    ReportMemory();
     //------------------------------------------------------------------------------
 
-    return 0;
+    return exitCode;
 }
 
 //----------------------------------------------------------------------------------
@@ -778,7 +1403,7 @@ int main()
 void InitInterface(void)
 {
     // Load GUI style
-    LoadGuiStyle(PATH_GUI_STYLE);
+    LoadInterfaceStyle(PATH_GUI_STYLE);
 
     // Calculate interface right menu titles lengths
     textsLength[LENGTH_TEXTURES_TITLE] = MeasureText(UI_TEXT_TEXTURES_TITLE, UI_TEXT_SIZE_H2);
@@ -795,6 +1420,7 @@ void InitInterface(void)
     textsLength[LENGTH_RENDER_TITLE] = MeasureText(UI_TEXT_RENDER_TITLE, UI_TEXT_SIZE_H2);
     textsLength[LENGTH_RENDER_SCALE] = MeasureText(UI_TEXT_RENDER_SCALE, UI_TEXT_SIZE_H3);
     textsLength[LENGTH_RENDER_MODE] = MeasureText(UI_TEXT_RENDER_MODE, UI_TEXT_SIZE_H3);
+    textsLength[LENGTH_RENDER_MSAA] = MeasureText(UI_TEXT_RENDER_MSAA, UI_TEXT_SIZE_H3);
     textsLength[LENGTH_RENDER_EFFECTS] = MeasureText(UI_TEXT_RENDER_EFFECTS, UI_TEXT_SIZE_H3);
     textsLength[LENGTH_EFFECTS_TITLE] = MeasureText(UI_TEXT_EFFECTS_TITLE, UI_TEXT_SIZE_H2);
     textsLength[LENGTH_CONTROLS] = MeasureText(UI_TEXT_CONTROLS, UI_TEXT_SIZE_H1);
@@ -808,6 +1434,36 @@ void InitInterface(void)
     textsLength[LENGTH_DISPLAY] = MeasureText(UI_TEXT_DISPLAY, UI_TEXT_SIZE_H3);
 }
 
+// Load GUI style from resources archive or loose file
+// NOTE: same text format than raygui LoadGuiStyle() (property name and value per line)
+void LoadInterfaceStyle(const char *fileName)
+{
+    unsigned int size = 0;
+    char *text = (char *)LoadResourceData(fileName, MEMORY_UI, &size);
+    if (text == NULL) return;
+
+    char *line = text;
+
+    while (*line != '\0')
+    {
+        char id[64] = { 0 };
+        char value[32] = { 0 };
+
+        if (sscanf(line, "%63s %31s", id, value) == 2)
+        {
+            for (int i = 0; i < NUM_PROPERTIES; i++)
+            {
+                if (strcmp(id, guiPropertyName[i]) == 0) SetStyleProperty(i, (int)strtoul(value, NULL, 0));
+            }
+        }
+
+        char *next = strchr(line, '\n');
+        line = ((next != NULL) ? next + 1 : line + strlen(line));
+    }
+
+    UnloadResourceData((unsigned char *)text);
+}
+
 // Draw a light gizmo based on light attributes
 void DrawLight(Light light, bool over)
 {
@@ -821,7 +1477,44 @@ void DrawLight(Light light, bool over)
             DrawCircle3D(light.target, LIGHT_RADIUS, (Vector3){ 0.0f, 1.0f, 0.0f }, 90.0f, (light.enabled ? light.color : GRAY));
             DrawCircle3D(light.target, LIGHT_RADIUS, (Vector3){ 0.0f, 0.0f, 1.0f }, 90.0f, (light.enabled ? light.color : GRAY));
         } break;
-        case LIGHT_POINT: DrawSphere(light.position, (over ? (LIGHT_RADIUS + LIGHT_OFFSET) : LIGHT_RADIUS), (light.enabled ? light.color : GRAY));
+        case LIGHT_POINT: DrawSphere(light.position, (over ? (LIGHT_RADIUS + LIGHT_OFFSET) : LIGHT_RADIUS), (light.enabled ? light.color : GRAY)); break;
+        case LIGHT_RECT:
+        case LIGHT_DISK:
+        {
+            DrawSphere(light.position, (over ? (LIGHT_RADIUS + LIGHT_OFFSET) : LIGHT_RADIUS), (light.enabled ? light.color : GRAY));
+
+            // Calculate area light frame facing its target (same as PBR shader)
+            Vector3 forward = VectorSubtract(light.target, light.position);
+            VectorNormalize(&forward);
+            Vector3 right = VectorCrossProduct(forward, ((fabsf(forward.y) < 0.99f) ? (Vector3){ 0.0f, 1.0f, 0.0f } : (Vector3){ 1.0f, 0.0f, 0.0f }));
+            VectorNormalize(&right);
+            Vector3 up = VectorCrossProduct(right, forward);
+            VectorScale(&right, light.size.x*0.5f);
+            VectorScale(&up, light.size.y*0.5f);
+
+            // Draw area light outline (rectangle corners are placed at 45 degrees of an inscribed ellipse)
+            int segments = ((light.type == LIGHT_RECT) ? 4 : LIGHT_DISK_SEGMENTS);
+            float scale = ((light.type == LIGHT_RECT) ? sqrtf(2.0f) : 1.0f);
+            float offset = ((light.type == LIGHT_RECT) ? 45.0f : 0.0f);
+
+            for (int i = 0; i < segments; i++)
+            {
+                float startAngle = (offset + 360.0f*i/segments)*DEG2RAD;
+                float endAngle = (offset + 360.0f*(i + 1)/segments)*DEG2RAD;
+                Vector3 start = { light.position.x + (right.x*cosf(startAngle) + up.x*sinf(startAngle))*scale,
+                                  light.position.y + (right.y*cosf(startAngle) + up.y*sinf(startAngle))*scale,
+                                  light.position.z + (right.z*cosf(startAngle) + up.z*sinf(startAngle))*scale };
+                Vector3 end = { light.position.x + (right.x*cosf(endAngle) + up.x*sinf(endAngle))*scale,
+                                light.position.y + (right.y*cosf(endAngle) + up.y*sinf(endAngle))*scale,
+                                light.position.z + (right.z*cosf(endAngle) + up.z*sinf(endAngle))*scale };
+
+                DrawLine3D(start, end, (light.enabled ? light.color : DARKGRAY));
+            }
+
+            // Draw emission direction
+            VectorScale(&forward, LIGHT_RADIUS*4.0f);
+            DrawLine3D(light.position, VectorAdd(light.position, forward), (light.enabled ? light.color : DARKGRAY));
+        } break;
         default: break;
     }
 }
@@ -846,7 +1539,7 @@ void DrawInterface(Vector2 size, int scrolling)
     for (int i = 0; i < MAX_TEXTURES; i++)
     {
         Vector2 pos = { size.x - UI_MENU_WIDTH + UI_MENU_WIDTH/2, padding + UI_MENU_WIDTH*0.375f - UI_TEXT_SIZE_H3/2 + i*UI_TEXTURES_PADDING };
-        DrawTextureMap(i, textures[i], pos);
+        DrawTextureMap(i, thumbnails[i], pos);
     }
 
     // Reset padding to start with left menu drawing
@@ -905,6 +1598,12 @@ void DrawInterface(Vector2 size, int scrolling)
     padding += UI_MENU_PADDING*2.25f;
     renderScale = GuiComboBox((Rectangle){ UI_MENU_WIDTH/2 - UI_MENU_WIDTH*0.3f - UI_MENU_WIDTH*0.6f/8, padding, UI_MENU_WIDTH*0.6f, UI_SLIDER_HEIGHT*1.5f }, MAX_RENDER_SCALES, (char **)renderScalesTitles, renderScale);
 
+    // Draw multisampling combo box
+    padding += UI_MENU_PADDING*2.0f;
+    DrawText(UI_TEXT_RENDER_MSAA, UI_MENU_WIDTH/2 - textsLength[LENGTH_RENDER_MSAA]/2, padding + UI_MENU_PADDING, UI_TEXT_SIZE_H3, UI_COLOR_PRIMARY);
+    padding += UI_MENU_PADDING*2.25f;
+    multisample = GuiComboBox((Rectangle){ UI_MENU_WIDTH/2 - UI_MENU_WIDTH*0.3f - UI_MENU_WIDTH*0.6f/8, padding, UI_MENU_WIDTH*0.6f, UI_SLIDER_HEIGHT*1.5f }, MAX_MULTISAMPLES, (char **)multisamplesTitles, multisample);
+
     // Draw render mode combo box
     padding += UI_MENU_PADDING*2.0f;
     DrawText(UI_TEXT_RENDER_MODE, UI_MENU_WIDTH/2 - textsLength[LENGTH_RENDER_MODE]/2, padding + UI_MENU_PADDING, UI_TEXT_SIZE_H3, UI_COLOR_PRIMARY);
@@ -932,6 +1631,26 @@ void DrawInterface(Vector2 size, int scrolling)
     padding += UI_MENU_PADDING*2.0f;
     drawWire = GuiCheckBox((Rectangle){ UI_MENU_PADDING*1.85f, padding, UI_CHECKBOX_SIZE, UI_CHECKBOX_SIZE }, UI_TEXT_EFFECTS_WIRE, drawWire);
 
+    // Draw half resolution lighting enabled state checkbox
+    padding += UI_MENU_PADDING*2.0f;
+    halfLighting = GuiCheckBox((Rectangle){ UI_MENU_PADDING*1.85f, padding, UI_CHECKBOX_SIZE, UI_CHECKBOX_SIZE }, UI_TEXT_HALF_LIGHTING, halfLighting);
+
+    // Draw checkerboard rendering enabled state checkbox
+    padding += UI_MENU_PADDING*2.0f;
+    checkerboard = GuiCheckBox((Rectangle){ UI_MENU_PADDING*1.85f, padding, UI_CHECKBOX_SIZE, UI_CHECKBOX_SIZE }, UI_TEXT_CHECKERBOARD, checkerboard);
+
+    // Draw height map tessellation enabled state checkbox (just if supported by GPU)
+    padding += UI_MENU_PADDING*2.0f;
+    tessellation = GuiCheckBox((Rectangle){ UI_MENU_PADDING*1.85f, padding, UI_CHECKBOX_SIZE, UI_CHECKBOX_SIZE }, UI_TEXT_TESSELLATION, tessellation) && tess.supported;
+
+    // Draw automatic exposure enabled state checkbox
+    padding += UI_MENU_PADDING*2.0f;
+    autoExposure = GuiCheckBox((Rectangle){ UI_MENU_PADDING*1.85f, padding, UI_CHECKBOX_SIZE, UI_CHECKBOX_SIZE }, UI_TEXT_AUTO_EXPOSURE, autoExposure);
+
+    // Draw screen space ambient occlusion enabled state checkbox
+    padding += UI_MENU_PADDING*2.0f;
+    ssao = GuiCheckBox((Rectangle){ UI_MENU_PADDING*1.85f, padding, UI_CHECKBOX_SIZE, UI_CHECKBOX_SIZE }, UI_TEXT_SSAO, ssao);
+
     // Draw draw logo enabled state checkbox
     padding += UI_MENU_PADDING*2.0f;
     drawLogo = GuiCheckBox((Rectangle){ UI_MENU_PADDING*1.85f, padding, UI_CHECKBOX_SIZE, UI_CHECKBOX_SIZE }, UI_TEXT_DRAW_LOGO, drawLogo);
@@ -955,8 +1674,7 @@ void DrawInterface(Vector2 size, int scrolling)
     padding = UI_MENU_WIDTH + UI_MENU_PADDING + UI_BUTTON_WIDTH + UI_MENU_PADDING;
     if (GuiButton((Rectangle){ padding, GetScreenHeight() - UI_MENU_PADDING - UI_BUTTON_HEIGHT, UI_BUTTON_WIDTH, UI_BUTTON_HEIGHT }, UI_TEXT_BUTTON_SS))
     {
-        TakeScreenshot(FormatText("rpbr_screenshot_%i.png", screenShotCount));
-        screenShotCount++;
+        takeScreenshot = true;
     }
 
     // Draw viewport interface camera type combo box
@@ -994,6 +1712,10 @@ void DrawLightInterface(Light *light)
     light->enabled = GuiCheckBox((Rectangle){ padding.x, padding.y, UI_CHECKBOX_SIZE, UI_CHECKBOX_SIZE }, UI_TEXT_LIGHT_ENABLED, light->enabled);
     padding.y += UI_MENU_PADDING*2;
 
+    // Draw light type combo box
+    light->type = GuiComboBox((Rectangle){ padding.x, padding.y, UI_LIGHT_WIDTH*0.6f, UI_SLIDER_HEIGHT*1.5f }, MAX_LIGHT_TYPES, (char **)lightTypesTitles, light->type);
+    padding.y += UI_MENU_PADDING*2.5f;
+
     // Draw light color R channel slider
     light->color.r = (int)GuiSlider((Rectangle){ padding.x + UI_MENU_PADDING*1.5f, padding.y, UI_LIGHT_WIDTH*0.75f, UI_SLIDER_HEIGHT }, light->color.r, 0, 255);
     DrawText(UI_TEXT_LIGHT_R, padding.x, padding.y + UI_TEXT_SIZE_H3/2, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
@@ -1009,21 +1731,31 @@ void DrawLightInterface(Light *light)
     DrawText(UI_TEXT_LIGHT_B, padding.x, padding.y + UI_TEXT_SIZE_H3/2, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
     padding.y += UI_MENU_PADDING*2;
 
+    // Draw area light width slider
+    light->size.x = GuiSlider((Rectangle){ padding.x + UI_MENU_PADDING*1.5f, padding.y, UI_LIGHT_WIDTH*0.75f, UI_SLIDER_HEIGHT }, light->size.x, LIGHT_MIN_SIZE, LIGHT_MAX_SIZE);
+    DrawText(UI_TEXT_LIGHT_W, padding.x, padding.y + UI_TEXT_SIZE_H3/2, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
+    padding.y += UI_MENU_PADDING*2;
+
+    // Draw area light height slider
+    light->size.y = GuiSlider((Rectangle){ padding.x + UI_MENU_PADDING*1.5f, padding.y, UI_LIGHT_WIDTH*0.75f, UI_SLIDER_HEIGHT }, light->size.y, LIGHT_MIN_SIZE, LIGHT_MAX_SIZE);
+    DrawText(UI_TEXT_LIGHT_H, padding.x, padding.y + UI_TEXT_SIZE_H3/2, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
+    padding.y += UI_MENU_PADDING*2;
+
     // Send lights values to environment PBR shader
     UpdateLightValues(environment, *light);
 }
 
-// Draw interface PBR texture or alternative text
-void DrawTextureMap(int id, Texture2D texture, Vector2 position)
+// Draw interface PBR texture thumbnail or alternative text
+void DrawTextureMap(int id, Texture2D thumbnail, Vector2 position)
 {
     Rectangle rect = { position.x - UI_TEXTURES_SIZE/2, position.y - UI_TEXTURES_SIZE/2, UI_TEXTURES_SIZE, UI_TEXTURES_SIZE };
     DrawRectangle(rect.x - UI_MENU_BORDER, rect.y - UI_MENU_BORDER, rect.width + UI_MENU_BORDER*2, rect.height + UI_MENU_BORDER*2, UI_COLOR_PRIMARY);
     DrawText(textureTitles[id], position.x - titlesLength[id]/2, position.y - UI_TEXT_SIZE_H3/2 - rect.height*0.6f, UI_TEXT_SIZE_H3, UI_COLOR_PRIMARY);
 
-    // Draw PBR texture or display help message
-    if (texture.id != 0)
+    // Draw PBR texture thumbnail or display help message
+    if (thumbnail.id != 0)
     {
-        DrawTexturePro(texture, (Rectangle){ 0, 0, texture.width, texture.height }, rect, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+        DrawTexturePro(thumbnail, (Rectangle){ 0, 0, thumbnail.width, thumbnail.height }, rect, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
 
         // Draw semi-transparent rectangle if mouse is over the texture rectangle
         if (CheckCollisionPointRec(GetMousePosition(), rect))
@@ -1038,3 +1770,474 @@ void DrawTextureMap(int id, Texture2D texture, Vector2 position)
         DrawText(UI_TEXT_DRAG_HERE, position.x - textsLength[LENGTH_DRAG]/2, position.y, UI_TEXT_SIZE_H3, UI_COLOR_PRIMARY);
     }
 }
+
+// Load a downscaled copy of a texture to display in interface
+Texture2D LoadTextureThumbnail(Texture2D texture)
+{
+    Image image = GetTextureData(texture);
+    ImageResize(&image, UI_TEXTURES_SIZE, UI_TEXTURES_SIZE);
+
+    Texture2D thumbnail = LoadTextureFromImage(image);
+    SetTextureFilter(thumbnail, FILTER_BILINEAR);
+    UnloadImage(image);
+
+    return thumbnail;
+}
+
+// Restart roughness specular antialiasing filtering with current normal map
+void ResetSpecularFilter(void)
+{
+    if (specularFilter != NULL) StopSpecularFilter(specularFilter);
+    specularFilter = NULL;
+
+    if (textures[PBR_ROUGHNESS].id != 0) specularFilter = StartSpecularFilter(textures[PBR_ROUGHNESS], textures[PBR_NORMALS]);
+}
+
+// Render bundled scenes offscreen and check them against golden images
+// NOTE: scenes use default camera, lights and post-processing effects, returns failed scenes count
+int RenderGoldenScenes(GoldenSuite *suite, Shader fxShader, Light *lights, int count)
+{
+    RenderTexture2D sceneTarget = LoadRenderTexture(GOLDEN_WIDTH, GOLDEN_HEIGHT);
+    RenderTexture2D outputTarget = LoadRenderTexture(GOLDEN_WIDTH, GOLDEN_HEIGHT);
+    Vector2 res = { (float)GOLDEN_WIDTH, (float)GOLDEN_HEIGHT };
+    float resolution[2] = { res.x, res.y };
+    int enabled[1] = { 1 };
+    unsigned int queryId = 0;
+
+    Camera goldenCamera = { 0 };
+    goldenCamera.position = (Vector3){ 3.5f, 3.0f, 3.5f };
+    goldenCamera.target = (Vector3){ 0.0f, 0.5f, 0.0f };
+    goldenCamera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
+    goldenCamera.fovy = CAMERA_FOV;
+
+    // Enable all post-processing effects at golden images resolution
+    SetShaderValue(fxShader, GetShaderLocation(fxShader, "resolution"), resolution, 2);
+    SetShaderValuei(fxShader, GetShaderLocation(fxShader, "enabledFxaa"), enabled, 1);
+    SetShaderValuei(fxShader, GetShaderLocation(fxShader, "enabledBloom"), enabled, 1);
+    SetShaderValuei(fxShader, GetShaderLocation(fxShader, "enabledVignette"), enabled, 1);
+
+    glGenQueries(1, &queryId);
+
+    for (int h = 0; h < GOLDEN_HDRS; h++)
+    {
+        Environment env = LoadEnvironment(FormatText("resources/textures/hdr/%s.hdr", goldenHdrs[h]), CUBEMAP_SIZE, IRRADIANCE_SIZE, PREFILTERED_SIZE, BRDF_SIZE);
+        int modeLoc = GetShaderLocation(env.pbrShader, "renderMode");
+
+        SetShaderValue(env.skyShader, env.skyResolutionLoc, resolution, 2);
+        UpdateEnvironmentValues(env, goldenCamera, res);
+        DisableAutoExposure(env);
+        DisableSSAO(env);
+        for (int i = 0; i < count; i++) UpdateLightValues(env, lights[i]);
+
+        for (int m = 0; m < GOLDEN_MODELS; m++)
+        {
+            Model sceneModel = LoadModel(FormatText("resources/models/%s.obj", goldenModels[m]));
+            MaterialPBR sceneMat = SetupMaterialPBR(env, (Color){ 255, 255, 255, 255 }, 255, 255);
+            sceneModel.material = (Material){ 0 };
+            sceneModel.material.shader = env.pbrShader;
+
+            // Apply model texture maps available in its textures folder
+            for (int i = 0; i < MAX_TEXTURES; i++)
+            {
+                const char *path = FormatText("resources/textures/%s/%s_%s.png", goldenModels[m], goldenModels[m], goldenMaps[i]);
+                FILE *file = fopen(path, "rb");
+
+                if (file != NULL)
+                {
+                    fclose(file);
+                    Texture2D texture = LoadTexture(path);
+                    SetTextureFilter(texture, FILTER_BILINEAR);
+                    SetMaterialTexturePBR(&sceneMat, i, texture);
+                }
+            }
+
+            for (int mode = 0; mode < MAX_RENDER_MODES; mode++)
+            {
+                float gpuTimes[GOLDEN_FRAMES] = { 0 };
+                float cpuTimes[GOLDEN_FRAMES] = { 0 };
+                int shaderMode[1] = { mode };
+                SetShaderValueiPBR(env, modeLoc, shaderMode, 1);
+
+                for (int f = 0; f < GOLDEN_WARMUP_FRAMES + GOLDEN_FRAMES; f++)
+                {
+                    double startTime = GetTime();
+                    glBeginQuery(GL_TIME_ELAPSED, queryId);
+
+                    BeginTextureMode(sceneTarget);
+
+                        ClearBackground(DARKGRAY);
+
+                        Begin3dMode(goldenCamera);
+
+                            DrawModelPBR(sceneModel, sceneMat, (Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 1.0f, 0.0f }, 0.0f, (Vector3){ MODEL_SCALE, MODEL_SCALE, MODEL_SCALE });
+                            DrawSkybox(env, goldenCamera);
+
+                        End3dMode();
+
+                    EndTextureMode();
+
+                    BeginTextureMode(outputTarget);
+
+                        BeginShaderMode(fxShader);
+
+                            DrawTexturePro(sceneTarget.texture, (Rectangle){ 0, 0, sceneTarget.texture.width, -sceneTarget.texture.height },
+                                           (Rectangle){ 0, 0, GOLDEN_WIDTH, GOLDEN_HEIGHT }, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+
+                        EndShaderMode();
+
+                    EndTextureMode();
+
+                    glEndQuery(GL_TIME_ELAPSED);
+                    float cpuTime = (float)((GetTime() - startTime)*1000.0);
+
+                    // Wait for GPU time (scenes are measured one by one, no frames overlap)
+                    GLuint64 elapsed = 0;
+                    glGetQueryObjectui64v(queryId, GL_QUERY_RESULT, &elapsed);
+
+                    if (f >= GOLDEN_WARMUP_FRAMES)
+                    {
+                        gpuTimes[f - GOLDEN_WARMUP_FRAMES] = (float)elapsed/1000000.0f;
+                        cpuTimes[f - GOLDEN_WARMUP_FRAMES] = cpuTime;
+                    }
+                }
+
+                // Sort measured frames times to get medians
+                for (int i = 1; i < GOLDEN_FRAMES; i++)
+                {
+                    for (int j = i; (j > 0) && (gpuTimes[j - 1] > gpuTimes[j]); j--) { float t = gpuTimes[j]; gpuTimes[j] = gpuTimes[j - 1]; gpuTimes[j - 1] = t; }
+                    for (int j = i; (j > 0) && (cpuTimes[j - 1] > cpuTimes[j]); j--) { float t = cpuTimes[j]; cpuTimes[j] = cpuTimes[j - 1]; cpuTimes[j - 1] = t; }
+                }
+
+                // Read back output (render textures are stored bottom to top)
+                Image image = GetTextureData(outputTarget.texture);
+                ImageFlipVertical(&image);
+                ImageFormat(&image, UNCOMPRESSED_R8G8B8A8);
+
+                CheckGoldenScene(suite, FormatText("%s_%s_%s", goldenModels[m], goldenHdrs[h], goldenModes[mode]), image, gpuTimes[GOLDEN_FRAMES/2], cpuTimes[GOLDEN_FRAMES/2]);
+                UnloadImage(image);
+            }
+
+            UnloadMaterialPBR(sceneMat);
+            sceneModel.material = (Material){ 0 };
+            UnloadModel(sceneModel);
+        }
+
+        UnloadEnvironment(env);
+    }
+
+    glDeleteQueries(1, &queryId);
+    UnloadRenderTexture(sceneTarget);
+    UnloadRenderTexture(outputTarget);
+
+    return EndGoldenSuite(suite);
+}
+
+// Answer render server requests until window is closed
+// NOTE: requests use viewer lights and post-processing effects, batches are sorted so targets are only recreated when size changes
+void RenderServerRequests(RenderServer *server, Shader fxShader, Light *lights, int count)
+{
+    static RenderRequest requests[SERVER_MAX_BATCH];
+    RenderTexture2D sceneTarget = { 0 };
+    RenderTexture2D outputTarget = { 0 };
+    int fxResolutionLoc = GetShaderLocation(fxShader, "resolution");
+    int fxVignetteLoc = GetShaderLocation(fxShader, "enabledVignette");
+    int enabled[1] = { 1 };
+
+    // Enable all post-processing effects (same output than golden images, vignette can be disabled by tiles)
+    SetShaderValuei(fxShader, GetShaderLocation(fxShader, "enabledFxaa"), enabled, 1);
+    SetShaderValuei(fxShader, GetShaderLocation(fxShader, "enabledBloom"), enabled, 1);
+
+    // Requests are waited in PollRenderRequests(), no frame rate limit
+    SetTargetFPS(0);
+
+    while (!WindowShouldClose())
+    {
+        int batchCount = PollRenderRequests(server, requests, SERVER_MAX_BATCH, SERVER_POLL_TIMEOUT);
+
+        for (int r = 0; r < batchCount; r++)
+        {
+            RenderRequest *request = &requests[r];
+            double startTime = GetTime();
+            bool cold = false;
+            bool coldEnvironment = false;
+            int mode = -1;
+
+            if (request->error[0] != '\0')
+            {
+                SendRenderError(server, request, request->error);
+                continue;
+            }
+
+            // Get render mode from its name or index
+            for (int i = 0; i < MAX_RENDER_MODES; i++) if (strcmp(request->mode, goldenModes[i]) == 0) mode = i;
+            if ((mode < 0) && (request->mode[0] >= '0') && (request->mode[0] <= '9') && (atoi(request->mode) < MAX_RENDER_MODES)) mode = atoi(request->mode);
+
+            if (mode < 0)
+            {
+                SendRenderError(server, request, "unknown render mode");
+                continue;
+            }
+
+            ServerEnvironment *scene = GetServerEnvironment(server, request->hdr, &coldEnvironment);
+
+            if (scene == NULL)
+            {
+                SendRenderError(server, request, "hdr file not found");
+                continue;
+            }
+
+            // Set up lights and disable screen space effects in new environment shaders
+            if (coldEnvironment)
+            {
+                DisableAutoExposure(scene->env);
+                DisableSSAO(scene->env);
+                for (int i = 0; i < count; i++) UpdateLightValues(scene->env, lights[i]);
+                cold = true;
+            }
+
+            Model *sceneModel = GetServerModel(server, request->model, &cold);
+
+            if (sceneModel == NULL)
+            {
+                SendRenderError(server, request, "model file not found");
+                continue;
+            }
+
+            sceneModel->material = (Material){ 0 };
+            sceneModel->material.shader = scene->env.pbrShader;
+
+            // Apply texture maps available with request textures prefix
+            MaterialPBR sceneMat = scene->material;
+
+            if (request->textures[0] != '\0')
+            {
+                for (int i = 0; i < MAX_TEXTURES; i++)
+                {
+                    Texture2D texture = GetServerTexture(server, FormatText("%s_%s.png", request->textures, goldenMaps[i]), &cold);
+                    if (texture.id != 0) SetMaterialTexturePBR(&sceneMat, i, texture);
+                }
+            }
+
+            // Recreate render targets when rendered region size changes
+            Rectangle region = request->region;
+            Vector2 res = { (float)region.width, (float)region.height };
+            float resolution[2] = { res.x, res.y };
+
+            if ((sceneTarget.texture.width != region.width) || (sceneTarget.texture.height != region.height))
+            {
+                if (sceneTarget.id != 0)
+                {
+                    UnloadRenderTexture(sceneTarget);
+                    UnloadRenderTexture(outputTarget);
+                }
+
+                sceneTarget = LoadRenderTexture(region.width, region.height);
+                outputTarget = LoadRenderTexture(region.width, region.height);
+                SetShaderValue(fxShader, fxResolutionLoc, resolution, 2);
+            }
+
+            SetShaderValue(scene->env.skyShader, scene->env.skyResolutionLoc, resolution, 2);
+            SetShaderValueiPBR(scene->env, scene->modeLoc, (int[1]){ mode }, 1);
+            SetShaderValuei(fxShader, fxVignetteLoc, (int[1]){ request->vignette }, 1);
+            UpdateEnvironmentValues(scene->env, request->camera, res);
+
+            BeginTextureMode(sceneTarget);
+
+                ClearBackground(DARKGRAY);
+
+                Begin3dModeRegion(request->camera, (Vector2){ request->width, request->height }, region, scene->env.skyShader, scene->skyProjectionLoc);
+
+                    DrawModelPBR(*sceneModel, sceneMat, (Vector3){ 0.0f, 0.0f, 0.0f }, (Vector3){ 0.0f, 1.0f, 0.0f }, 0.0f, (Vector3){ MODEL_SCALE, MODEL_SCALE, MODEL_SCALE });
+                    DrawSkybox(scene->env, request->camera);
+
+                End3dMode();
+
+            EndTextureMode();
+
+            BeginTextureMode(outputTarget);
+
+                BeginShaderMode(fxShader);
+
+                    DrawTexturePro(sceneTarget.texture, (Rectangle){ 0, 0, sceneTarget.texture.width, -sceneTarget.texture.height },
+                                   (Rectangle){ 0, 0, region.width, region.height }, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+
+                EndShaderMode();
+
+            EndTextureMode();
+
+            // Read back output (render textures are stored bottom to top)
+            Image image = GetTextureData(outputTarget.texture);
+            ImageFlipVertical(&image);
+            ImageFormat(&image, UNCOMPRESSED_R8G8B8A8);
+
+            SendRenderImage(server, request, image, cold, startTime);
+            UnloadImage(image);
+        }
+
+        ReportRenderServer(server, false);
+
+        // Keep window responsive and display answered requests
+        BeginDrawing();
+
+            ClearBackground(DARKGRAY);
+            DrawText(FormatText(UI_TEXT_SERVER_STATS, server->path, server->warmCount, server->coldCount), UI_MENU_PADDING, UI_MENU_PADDING, UI_TEXT_SIZE_H3, UI_COLOR_SECONDARY);
+
+        EndDrawing();
+    }
+
+    if (sceneTarget.id != 0)
+    {
+        UnloadRenderTexture(sceneTarget);
+        UnloadRenderTexture(outputTarget);
+    }
+
+    CloseRenderServer(server);
+}
+
+// Render default scene turntable on CPU and save frames as PNG files (no window required)
+// NOTE: same camera, model scale and lights than viewer, camera orbits around model once along all frames
+int RenderSoftTurntable(SoftOptions options)
+{
+    // Load environment HDR image and bake it on CPU
+    double loadStart = GetSoftTime();
+    Image hdr = LoadImage(PATH_TEXTURES_HDR);
+
+    if ((hdr.data == NULL) || (hdr.format != UNCOMPRESSED_R32G32B32))
+    {
+        TraceLog(LOG_WARNING, "[%s] Software rendering requires an HDR environment", PATH_TEXTURES_HDR);
+        UnloadImage(hdr);
+        return 1;
+    }
+
+    SoftEnvironment *softEnv = LoadSoftEnvironment(hdr, SOFT_CUBEMAP_SIZE, SOFT_PREFILTERED_SIZE);
+    UnloadImage(hdr);
+    ObserveLoadMetrics(METRICS_LOAD_ENVIRONMENT, GetSoftTime() - loadStart);
+
+    // Load model CPU data (raylib models are uploaded to GPU)
+    loadStart = GetSoftTime();
+    Mesh mesh = LoadMeshResource(PATH_MODEL);
+    ObserveLoadMetrics(METRICS_LOAD_MODEL, GetSoftTime() - loadStart);
+
+    if (mesh.vertexCount == 0)
+    {
+        UnloadSoftEnvironment(softEnv);
+        return 1;
+    }
+
+    // Load material maps as RGBA8 images
+    SoftMaterial softMat = SetupSoftMaterial((Color){ 255, 255, 255, 255 }, 255, 255);
+    Image maps[MAX_TEXTURES] = { 0 };
+    const char *mapsPaths[MAX_TEXTURES] = { 0 };
+    SoftProperty *properties[MAX_TEXTURES] = { &softMat.albedo, &softMat.normals, &softMat.metalness, &softMat.roughness, &softMat.ao, &softMat.emission, NULL };
+#if defined(PATH_TEXTURES_ALBEDO)
+    mapsPaths[PBR_ALBEDO] = PATH_TEXTURES_ALBEDO;
+#endif
+#if defined(PATH_TEXTURES_NORMALS)
+    mapsPaths[PBR_NORMALS] = PATH_TEXTURES_NORMALS;
+#endif
+#if defined(PATH_TEXTURES_METALNESS)
+    mapsPaths[PBR_METALNESS] = PATH_TEXTURES_METALNESS;
+#endif
+#if defined(PATH_TEXTURES_ROUGHNESS)
+    mapsPaths[PBR_ROUGHNESS] = PATH_TEXTURES_ROUGHNESS;
+#endif
+#if defined(PATH_TEXTURES_AO)
+    mapsPaths[PBR_AO] = PATH_TEXTURES_AO;
+#endif
+#if defined(PATH_TEXTURES_EMISSION)
+    mapsPaths[PBR_EMISSION] = PATH_TEXTURES_EMISSION;
+#endif
+
+    for (int i = 0; i < MAX_TEXTURES; i++)
+    {
+        if ((mapsPaths[i] == NULL) || (properties[i] == NULL)) continue;
+
+        maps[i] = LoadImage(mapsPaths[i]);
+
+        if (maps[i].data != NULL)
+        {
+            ImageFormat(&maps[i], UNCOMPRESSED_R8G8B8A8);
+            *properties[i] = LoadSoftProperty(maps[i]);
+        }
+    }
+
+    // Define viewer default lights
+    SoftLight softLights[MAX_LIGHTS] = {
+        { true, LIGHT_POINT, (Vector3){ LIGHT_DISTANCE, LIGHT_HEIGHT, 0.0f }, (Vector3){ 0.0f, 0.0f, 0.0f }, (Color){ 255, 0, 0, 255 } },
+        { true, LIGHT_POINT, (Vector3){ 0.0f, LIGHT_HEIGHT, LIGHT_DISTANCE }, (Vector3){ 0.0f, 0.0f, 0.0f }, (Color){ 0, 255, 0, 255 } },
+        { true, LIGHT_POINT, (Vector3){ -LIGHT_DISTANCE, LIGHT_HEIGHT, 0.0f }, (Vector3){ 0.0f, 0.0f, 0.0f }, (Color){ 0, 0, 255, 255 } },
+        { true, LIGHT_DIRECTIONAL, (Vector3){ 0.0f, LIGHT_HEIGHT*2.0f, -LIGHT_DISTANCE }, (Vector3){ 0.0f, 0.0f, 0.0f }, (Color){ 255, 0, 255, 255 } }
+    };
+
+    Camera softCamera = { 0 };
+    softCamera.target = (Vector3){ 0.0f, 0.5f, 0.0f };
+    softCamera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
+    softCamera.fovy = CAMERA_FOV;
+
+    // Render turntable frames (PNG encoding is not included in frame times)
+    SoftRenderer *renderer = LoadSoftRenderer(options.width, options.height, options.threads);
+    Matrix transform = MatrixScale(MODEL_SCALE, MODEL_SCALE, MODEL_SCALE);
+    float orbitRadius = sqrtf(2.0f)*3.5f;
+    float totalTime = 0.0f;
+
+    MakeGoldenDirectory(options.directory);
+
+    for (int i = 0; i < options.frames; i++)
+    {
+        float angle = PI*0.25f + 2.0f*PI*(float)i/(float)options.frames;
+        softCamera.position = (Vector3){ cosf(angle)*orbitRadius, 3.0f, sinf(angle)*orbitRadius };
+
+        BeginSoftFrame(renderer, softCamera, softEnv, softLights, MAX_LIGHTS);
+        DrawSoftMesh(renderer, mesh, transform, &softMat);
+        EndSoftFrame(renderer);
+        totalTime += renderer->frameTime;
+
+        Image image = GetSoftImage(renderer);
+        SaveImageAs(FormatText("%s/turntable_%03i.png", options.directory, i), image);
+        UnloadImage(image);
+    }
+
+    TraceLog(LOG_INFO, "Software turntable rendered: %i frames at %ix%i, %.2f ms per frame (%.2f FPS, %i threads)", options.frames, options.width, options.height,
+             totalTime/options.frames, 1000.0f*options.frames/totalTime, renderer->threadsCount);
+
+    UnloadSoftRenderer(renderer);
+    for (int i = 0; i < MAX_TEXTURES; i++) if (maps[i].data != NULL) UnloadImage(maps[i]);
+    UnloadMeshResource(mesh);
+    UnloadSoftEnvironment(softEnv);
+
+    return 0;
+}
+
+// Begin 3D mode for a region of an image (off-center projection, skybox included)
+// NOTE: region is in pixels of an image of given size, raylib Begin3dMode() uses window aspect ratio and whole view instead
+void Begin3dModeRegion(Camera camera, Vector2 size, Rectangle region, Shader skyShader, int skyProjectionLoc)
+{
+    // Whole image frustum at near plane (same values than raylib Begin3dMode())
+    double top = 0.01*tan(camera.fovy*0.5*DEG2RAD);
+    double right = top*size.x/size.y;
+
+    // Region frustum (image rows go from top to bottom)
+    double regionLeft = -right + 2.0*right*region.x/size.x;
+    double regionRight = -right + 2.0*right*(region.x + region.width)/size.x;
+    double regionTop = top - 2.0*top*region.y/size.y;
+    double regionBottom = top - 2.0*top*(region.y + region.height)/size.y;
+
+    rlglDraw();
+
+    rlMatrixMode(RL_PROJECTION);
+    rlPushMatrix();
+    rlLoadIdentity();
+    rlFrustum(regionLeft, regionRight, regionBottom, regionTop, 0.01, 1000.0);
+
+    rlMatrixMode(RL_MODELVIEW);
+    rlLoadIdentity();
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    rlMultMatrixf(MatrixToFloat(view));
+
+    rlEnableDepthTest();
+
+    // Skybox shader uses its own projection matrix
+    Matrix projection = MatrixFrustum(regionLeft, regionRight, regionBottom, regionTop, 0.01, 1000.0);
+    MatrixTranspose(&projection);
+    SetShaderValueMatrix(skyShader, skyProjectionLoc, projection);
+}
@@ -0,0 +1,636 @@
+/*******************************************************************************************
+*
+*   rPBR [archive] - Builds a resources archive from resources folder and benchmarks it
+*
+*   FEATURES:
+*       - Writes a single resources archive (pbrarchive.h) mapped by viewer at startup, so resources
+*         loading doesn't open, seek and read dozens of files (slow from network drives).
+*       - Directory index hashed by normalized resource path (same names used by viewer PATH_* defines).
+*       - Blobs aligned to ARCHIVE_ALIGNMENT bytes, compressed with LZ4 when it saves enough space
+*         (shaders, models and text files), stored uncompressed otherwise (PNG and HDR images).
+*       - Benchmark mode loads every archived resource from loose files and from archive, checks that
+*         contents match and reports loading times (run it after dropping file cache for cold times).
+*
+*   NOTES:
+*       Usage:
+*           rpbrarchive [--input <directory>] [--output <file.rpa>] [--stored]
+*           rpbrarchive --bench [--archive <file.rpa>] [--runs <count>]
+*       Run it from release folder: resources names are relative paths (resources/shaders/pbr.vs), like viewer
+*       PATH_* defines. Filter cache folder, packages and archives are not archived.
+*       Archive is written to a temporary file and renamed once complete, so a failed build keeps previous archive.
+*       Rebuild archive after editing resources (archived resources have priority over loose files).
+*
+*   DEPENDENCIES:
+*       raylib 1.8                          // Required for: TraceLog() and types used by pbrarchive.h
+*       pbrarchive.h                        // Required for: archive layout, HashResourceName(), LoadResourceData()
+*
+*   Use the following line to compile:
+*
+*   gcc -o rpbrarchive rpbrarchive.c -O2 -std=c99 -Iexternal/raylib/src -lraylib -lglfw3 -lopengl32 -lgdi32 -lpthread -lm
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+**********************************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#if !defined(_WIN32)
+    #define _POSIX_C_SOURCE 200809L             // Required for: clock_gettime()
+#endif
+
+#include "external/raylib/src/raylib.h"         // Required for: TraceLog(), SetTraceLog()
+#include "external/glad.h"                      // Required for: OpenGL API (used by pbrarchive.h shaders loading)
+#include "pbrmemory.h"                          // Required for: PBR_MALLOC(), PBR_FREE()
+#include "pbrarchive.h"                         // Required for: ArchiveHeader, ArchiveEntry, HashResourceName(), LoadResourceData()
+
+#include <stdio.h>                              // Required for: printf(), fopen(), fread(), fwrite(), fclose(), rename(), remove()
+#include <stdlib.h>                             // Required for: atoi(), qsort()
+#include <string.h>                             // Required for: strcmp(), strlen(), memcmp(), memset()
+
+#if defined(_WIN32)
+    #include <io.h>                             // Required for: _findfirst(), _findnext(), _findclose()
+
+    // NOTE: windows.h conflicts with raylib names, so required functions are declared here
+    #if !defined(_WINDOWS_)
+        __declspec(dllimport) int __stdcall QueryPerformanceCounter(long long *count);
+        __declspec(dllimport) int __stdcall QueryPerformanceFrequency(long long *frequency);
+    #endif
+#else
+    #include <time.h>                           // Required for: clock_gettime()
+    #include <dirent.h>                         // Required for: opendir(), readdir(), closedir()
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         BUILD_MAX_RESOURCES         4096                                    // Max archived resources
+#define         BUILD_MIN_SAVING            0.125                                   // Min compressed space saving to store a blob compressed
+#define         BUILD_HASH_BITS             16                                      // LZ4 compressor hash table size (positions)
+#define         BUILD_BENCH_RUNS            5                                       // Default benchmark runs
+
+#define         LZ4_MIN_MATCH               4                                       // LZ4 block format limits
+#define         LZ4_MATCH_LIMIT             12                                      // Last match must start 12 bytes before end
+#define         LZ4_LAST_LITERALS           5                                       // Last 5 bytes are always literals
+#define         LZ4_MAX_OFFSET              65535
+
+#define         PATH_ARCHIVE_INPUT          "resources"                             // Default folder to archive
+#define         PATH_ARCHIVE_CACHE          "resources/cache"                       // Filter cache folder (written at runtime, not archived)
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct BuildEntry {
+    char name[ARCHIVE_MAX_NAME];            // Normalized resource name
+    ArchiveEntry entry;                     // Entry written to directory (offset is set when writing)
+    unsigned char *data;                    // Blob contents (compressed or resource data)
+} BuildEntry;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+static int BuildArchive(const char *inputName, const char *outputName, bool stored);        // Build an archive from every resource in a folder
+static int BenchArchive(const char *archiveName, int runs);                                 // Benchmark loose files and archive loading of every archived resource
+static int ListResources(const char *folder, char (*names)[ARCHIVE_MAX_NAME], int count);   // Add resources files of a folder and its subfolders to names list
+static bool IsArchivedResource(const char *name);                                           // Check if a file must be archived (cache, packages and archives are skipped)
+static unsigned char *LoadFileData(const char *fileName, unsigned int *size);               // Load file data with stdio (loose files benchmark)
+static int CompressLZ4(const unsigned char *src, int srcSize, unsigned char *dst, int dstCapacity);    // Compress data into a LZ4 block (returns compressed size or 0 if it doesn't fit)
+static unsigned char *WriteSequenceLZ4(unsigned char *op, unsigned char *opEnd, const unsigned char *literals, int literalsCount, int offset, int matchLength);  // Write a LZ4 sequence (NULL if it doesn't fit)
+static unsigned long long ChecksumData(const unsigned char *data, unsigned int size);       // Sum data bytes (benchmark reads every byte)
+static int CompareNames(const void *a, const void *b);                                      // Compare resources names (archive order)
+static double GetSeconds(void);                                                             // Get monotonic time in seconds
+
+//----------------------------------------------------------------------------------
+// Main program
+//----------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    const char *inputName = PATH_ARCHIVE_INPUT;
+    const char *outputName = PATH_ARCHIVE;
+    bool stored = false;
+    bool bench = false;
+    int runs = BUILD_BENCH_RUNS;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--input") == 0) && (i + 1 < argc)) inputName = argv[++i];
+        else if (((strcmp(argv[i], "--output") == 0) || (strcmp(argv[i], "--archive") == 0)) && (i + 1 < argc)) outputName = argv[++i];
+        else if ((strcmp(argv[i], "--runs") == 0) && (i + 1 < argc)) runs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stored") == 0) stored = true;
+        else if (strcmp(argv[i], "--bench") == 0) bench = true;
+        else
+        {
+            printf("usage: rpbrarchive [--input <directory>] [--output <file.rpa>] [--stored]\n");
+            printf("       rpbrarchive --bench [--archive <file.rpa>] [--runs <count>]\n");
+            return 1;
+        }
+    }
+
+    if (runs < 1) runs = 1;
+
+    SetTraceLog(0);
+
+    return (bench ? BenchArchive(outputName, runs) : BuildArchive(inputName, outputName, stored));
+}
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Build an archive from every resource in a folder
+static int BuildArchive(const char *inputName, const char *outputName, bool stored)
+{
+    double startTime = GetSeconds();
+
+    // List resources in name order (archive contents don't depend on file system order)
+    char (*names)[ARCHIVE_MAX_NAME] = (char (*)[ARCHIVE_MAX_NAME])PBR_MALLOC(MEMORY_OTHER, BUILD_MAX_RESOURCES*ARCHIVE_MAX_NAME);
+    int count = ListResources(inputName, names, 0);
+
+    if (count <= 0)
+    {
+        printf("No resources found in %s (run it from release folder)\n", inputName);
+        PBR_FREE(names);
+        return 1;
+    }
+
+    qsort(names, count, ARCHIVE_MAX_NAME, CompareNames);
+
+    // Load and compress resources
+    BuildEntry *entries = (BuildEntry *)PBR_MALLOC(MEMORY_OTHER, count*sizeof(BuildEntry));
+    memset(entries, 0, count*sizeof(BuildEntry));
+    unsigned long long originalSize = 0;
+    unsigned int namesSize = 0;
+    bool success = true;
+
+    for (int i = 0; (i < count) && success; i++)
+    {
+        BuildEntry *build = &entries[i];
+        build->entry.hash = HashResourceName(names[i], build->name);
+        build->entry.nameOffset = namesSize;
+        namesSize += (unsigned int)strlen(build->name) + 1;
+
+        unsigned int size = 0;
+        unsigned char *data = LoadFileData(names[i], &size);
+
+        if (data == NULL)
+        {
+            printf("Resource %s could not be read\n", names[i]);
+            success = false;
+            break;
+        }
+
+        build->entry.originalSize = size;
+        build->entry.size = size;
+        build->entry.compression = ARCHIVE_STORED;
+        build->data = data;
+        originalSize += size;
+
+        if (!stored && (size > 0))
+        {
+            int capacity = (int)(size + size/255 + 16);
+            unsigned char *compressed = (unsigned char *)PBR_MALLOC(MEMORY_OTHER, capacity);
+            int compressedSize = CompressLZ4(data, (int)size, compressed, capacity);
+
+            // Keep compressed blob only when it saves enough space to pay decompression time
+            if ((compressedSize > 0) && (compressedSize <= (int)(size*(1.0 - BUILD_MIN_SAVING))))
+            {
+                build->entry.size = (unsigned int)compressedSize;
+                build->entry.compression = ARCHIVE_LZ4;
+                build->data = compressed;
+                PBR_FREE(data);
+            }
+            else PBR_FREE(compressed);
+        }
+    }
+
+    ArchiveHeader header = { 0 };
+    unsigned int *buckets = NULL;
+
+    if (success)
+    {
+        // Build directory index (at least twice entries count buckets keeps probing short)
+        memcpy(header.magic, ARCHIVE_MAGIC, 4);
+        header.version = ARCHIVE_VERSION;
+        header.entriesCount = count;
+        header.bucketsCount = 16;
+        header.namesSize = namesSize;
+        header.alignment = ARCHIVE_ALIGNMENT;
+        while (header.bucketsCount < (unsigned int)count*2) header.bucketsCount *= 2;
+
+        buckets = (unsigned int *)PBR_MALLOC(MEMORY_OTHER, header.bucketsCount*sizeof(unsigned int));
+        for (unsigned int i = 0; i < header.bucketsCount; i++) buckets[i] = ARCHIVE_EMPTY_BUCKET;
+
+        for (int i = 0; i < count; i++)
+        {
+            unsigned int bucket = (unsigned int)entries[i].entry.hash & (header.bucketsCount - 1);
+            while (buckets[bucket] != ARCHIVE_EMPTY_BUCKET) bucket = (bucket + 1) & (header.bucketsCount - 1);
+            buckets[bucket] = i;
+        }
+
+        // Calculate aligned blobs offsets after directory
+        unsigned long long offset = sizeof(ArchiveHeader) + header.bucketsCount*sizeof(unsigned int) + count*sizeof(ArchiveEntry) + namesSize;
+
+        for (int i = 0; i < count; i++)
+        {
+            offset = (offset + ARCHIVE_ALIGNMENT - 1)/ARCHIVE_ALIGNMENT*ARCHIVE_ALIGNMENT;
+            entries[i].entry.offset = offset;
+            offset += entries[i].entry.size;
+        }
+
+        header.size = offset;
+
+        // Write archive to a temporary file and replace previous archive once complete
+        FILE *file = fopen(FormatText("%s.tmp", outputName), "wb");
+        success = (file != NULL);
+
+        if (success)
+        {
+            static const unsigned char padding[ARCHIVE_ALIGNMENT] = { 0 };
+            unsigned long long position = 0;
+
+            success = (fwrite(&header, sizeof(ArchiveHeader), 1, file) == 1) && (fwrite(buckets, sizeof(unsigned int), header.bucketsCount, file) == header.bucketsCount);
+            for (int i = 0; (i < count) && success; i++) success = (fwrite(&entries[i].entry, sizeof(ArchiveEntry), 1, file) == 1);
+            for (int i = 0; (i < count) && success; i++) success = (fwrite(entries[i].name, 1, strlen(entries[i].name) + 1, file) == strlen(entries[i].name) + 1);
+
+            position = sizeof(ArchiveHeader) + header.bucketsCount*sizeof(unsigned int) + count*sizeof(ArchiveEntry) + namesSize;
+
+            for (int i = 0; (i < count) && success; i++)
+            {
+                size_t paddingSize = (size_t)(entries[i].entry.offset - position);
+                success = (fwrite(padding, 1, paddingSize, file) == paddingSize) && (fwrite(entries[i].data, 1, entries[i].entry.size, file) == entries[i].entry.size);
+                position = entries[i].entry.offset + entries[i].entry.size;
+            }
+
+            success = (fclose(file) == 0) && success;
+        }
+
+        if (success)
+        {
+            remove(outputName);
+            success = (rename(FormatText("%s.tmp", outputName), outputName) == 0);
+        }
+        else remove(FormatText("%s.tmp", outputName));
+
+        if (!success) printf("Archive %s could not be written\n", outputName);
+    }
+
+    if (success)
+    {
+        // Report archived resources
+        int compressedCount = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            ArchiveEntry *entry = &entries[i].entry;
+            printf("  %-6s %9.1f KB -> %9.1f KB  %s\n", ((entry->compression == ARCHIVE_LZ4) ? "lz4" : "stored"), entry->originalSize/1024.0, entry->size/1024.0, entries[i].name);
+            if (entry->compression == ARCHIVE_LZ4) compressedCount++;
+        }
+
+        printf("Archive %s written: %i resources (%i compressed), %.2f MB -> %.2f MB in %.2f s\n", outputName, count, compressedCount,
+               originalSize/1048576.0, header.size/1048576.0, GetSeconds() - startTime);
+    }
+
+    for (int i = 0; i < count; i++) if (entries[i].data != NULL) PBR_FREE(entries[i].data);
+    if (buckets != NULL) PBR_FREE(buckets);
+    PBR_FREE(entries);
+    PBR_FREE(names);
+
+    return (success ? 0 : 1);
+}
+
+// Benchmark loose files and archive loading of every archived resource
+// NOTE: first run reads from storage only if file cache was dropped before running benchmark, next runs are cached
+static int BenchArchive(const char *archiveName, int runs)
+{
+    // Map archive once to list its resources (listing is not measured)
+    if (!OpenResourceArchive(archiveName))
+    {
+        printf("Archive %s could not be opened (build it with rpbrarchive first)\n", archiveName);
+        return 1;
+    }
+
+    int count = archive.header->entriesCount;
+    char (*names)[ARCHIVE_MAX_NAME] = (char (*)[ARCHIVE_MAX_NAME])PBR_MALLOC(MEMORY_OTHER, count*ARCHIVE_MAX_NAME);
+    unsigned long long totalSize = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        strcpy(names[i], archive.names + archive.entries[i].nameOffset);
+        totalSize += archive.entries[i].originalSize;
+    }
+
+    CloseResourceArchive();
+
+    printf("%i resources (%.2f MB), %i runs\n\n", count, totalSize/1048576.0, runs);
+    printf("%-6s %12s %12s %14s\n", "run", "loose ms", "archive ms", "speedup");
+
+    // Read every resource from loose files, then from archive like viewer does (stored blobs are decoded from mapped memory)
+    // NOTE: every byte is read by a checksum, like image decoders and shader compilers read resources
+    double bestLoose = 1e30;
+    double bestArchive = 1e30;
+    unsigned long long looseChecksum = 0;
+    unsigned long long archiveChecksum = 0;
+
+    for (int run = 0; run < runs; run++)
+    {
+        double start = GetSeconds();
+
+        for (int i = 0; i < count; i++)
+        {
+            unsigned int size = 0;
+            unsigned char *data = LoadFileData(names[i], &size);
+
+            if (data != NULL)
+            {
+                looseChecksum += ChecksumData(data, size);
+                PBR_FREE(data);
+            }
+        }
+
+        double looseTime = GetSeconds() - start;
+        start = GetSeconds();
+        OpenResourceArchive(archiveName);
+
+        for (int i = 0; i < count; i++)
+        {
+            ArchiveEntry *entry = FindArchiveEntry(names[i]);
+            bool owned = false;
+            unsigned char *data = ((entry != NULL) ? GetArchiveData(entry, MEMORY_OTHER, &owned) : NULL);
+
+            if (data != NULL) archiveChecksum += ChecksumData(data, entry->originalSize);
+            if (owned) PBR_FREE(data);
+        }
+
+        CloseResourceArchive();
+        double archiveTime = GetSeconds() - start;
+
+        printf("%-6i %12.3f %12.3f %13.2fx\n", run + 1, looseTime*1000.0, archiveTime*1000.0, looseTime/archiveTime);
+        if (looseTime < bestLoose) bestLoose = looseTime;
+        if (archiveTime < bestArchive) bestArchive = archiveTime;
+    }
+
+    printf("%-6s %12.3f %12.3f %13.2fx\n", "best", bestLoose*1000.0, bestArchive*1000.0, bestLoose/bestArchive);
+    printf("\nper resource: loose %.1f us, archive %.1f us\n", bestLoose*1000000.0/count, bestArchive*1000000.0/count);
+
+    // Verify archived contents against loose files (after measured runs, so first run is not cached by verification)
+    int mismatches = 0;
+    OpenResourceArchive(archiveName);
+
+    for (int i = 0; i < count; i++)
+    {
+        unsigned int looseSize = 0;
+        unsigned int archivedSize = 0;
+        unsigned char *loose = LoadFileData(names[i], &looseSize);
+        unsigned char *archived = LoadResourceData(names[i], MEMORY_OTHER, &archivedSize);
+
+        if ((loose == NULL) || (archived == NULL) || (looseSize != archivedSize) || (memcmp(loose, archived, looseSize) != 0))
+        {
+            printf("  mismatch: %s (archive is outdated or loose file is missing)\n", names[i]);
+            mismatches++;
+        }
+
+        if (loose != NULL) PBR_FREE(loose);
+        UnloadResourceData(archived);
+    }
+
+    CloseResourceArchive();
+
+    if (looseChecksum != archiveChecksum) mismatches++;
+
+    printf("\nHINT: first run measures storage only if file cache is dropped before running benchmark:\n");
+#if defined(_WIN32)
+    printf("      copy release folder to another drive or reboot before running benchmark\n");
+#else
+    printf("      sync; echo 3 | sudo tee /proc/sys/vm/drop_caches\n");
+#endif
+    printf("HINT: run benchmark from a network drive (NFS, SMB) release folder to measure remote startup\n");
+
+    if (mismatches > 0) printf("\n%i archived resources don't match loose files\n", mismatches);
+
+    PBR_FREE(names);
+
+    return ((mismatches > 0) ? 1 : 0);
+}
+
+// Add resources files of a folder and its subfolders to names list
+// NOTE: returns updated names count (-1 if resources limit is exceeded)
+static int ListResources(const char *folder, char (*names)[ARCHIVE_MAX_NAME], int count)
+{
+    if (strcmp(folder, PATH_ARCHIVE_CACHE) == 0) return count;
+
+#if defined(_WIN32)
+    struct _finddata_t info = { 0 };
+    intptr_t handle = _findfirst(FormatText("%s/*", folder), &info);
+    if (handle == -1) return count;
+
+    do
+    {
+        const char *fileName = info.name;
+        bool folderEntry = ((info.attrib & _A_SUBDIR) != 0);
+#else
+    DIR *dir = opendir(folder);
+    if (dir == NULL) return count;
+
+    struct dirent *info = NULL;
+
+    while ((info = readdir(dir)) != NULL)
+    {
+        const char *fileName = info->d_name;
+        struct stat status = { 0 };
+        if (stat(FormatText("%s/%s", folder, fileName), &status) != 0) continue;
+        bool folderEntry = S_ISDIR(status.st_mode);
+#endif
+        char path[ARCHIVE_MAX_NAME] = { 0 };
+
+        if ((strcmp(fileName, ".") == 0) || (strcmp(fileName, "..") == 0)) continue;
+        if (snprintf(path, ARCHIVE_MAX_NAME, "%s/%s", folder, fileName) >= ARCHIVE_MAX_NAME) continue;
+
+        if (folderEntry) count = ListResources(path, names, count);
+        else if (IsArchivedResource(path) && (count >= 0))
+        {
+            if (count < BUILD_MAX_RESOURCES) strcpy(names[count++], path);
+            else count = -1;
+        }
+
+        if (count < 0) break;
+#if defined(_WIN32)
+    } while (_findnext(handle, &info) == 0);
+
+    _findclose(handle);
+#else
+    }
+
+    closedir(dir);
+#endif
+
+    if (count < 0) printf("Too many resources in %s (max %i)\n", folder, BUILD_MAX_RESOURCES);
+
+    return count;
+}
+
+// Check if a file must be archived (cache, packages and archives are skipped)
+static bool IsArchivedResource(const char *name)
+{
+    const char *extension = strrchr(name, '.');
+
+    return ((extension == NULL) || ((strcmp(extension, ".rpk") != 0) && (strcmp(extension, ".rpa") != 0) && (strcmp(extension, ".tmp") != 0)));
+}
+
+// Load file data with stdio (loose files benchmark)
+static unsigned char *LoadFileData(const char *fileName, unsigned int *size)
+{
+    FILE *file = fopen(fileName, "rb");
+    *size = 0;
+    if (file == NULL) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = (unsigned char *)PBR_MALLOC(MEMORY_OTHER, length + 1);
+    *size = (unsigned int)fread(data, 1, length, file);
+    data[*size] = '\0';
+    fclose(file);
+
+    return data;
+}
+
+// Compress data into a LZ4 block (returns compressed size or 0 if it doesn't fit)
+// NOTE: greedy parsing with a single position per hash, output is decoded by any LZ4 block decoder
+static int CompressLZ4(const unsigned char *src, int srcSize, unsigned char *dst, int dstCapacity)
+{
+    int *table = (int *)PBR_MALLOC(MEMORY_OTHER, (1 << BUILD_HASH_BITS)*sizeof(int));
+    for (int i = 0; i < (1 << BUILD_HASH_BITS); i++) table[i] = -1;
+
+    unsigned char *op = dst;
+    unsigned char *opEnd = dst + dstCapacity;
+    int anchor = 0;
+    int ip = 0;
+
+    while ((ip < srcSize - LZ4_MATCH_LIMIT) && (op != NULL))
+    {
+        unsigned int sequence = 0;
+        memcpy(&sequence, src + ip, 4);
+
+        unsigned int hash = (sequence*2654435761u) >> (32 - BUILD_HASH_BITS);
+        int reference = table[hash];
+        table[hash] = ip;
+
+        if ((reference >= 0) && (ip - reference <= LZ4_MAX_OFFSET) && (memcmp(src + reference, src + ip, LZ4_MIN_MATCH) == 0))
+        {
+            // Extend match (last literals must stay as literals)
+            int length = LZ4_MIN_MATCH;
+            while ((ip + length < srcSize - LZ4_LAST_LITERALS) && (src[reference + length] == src[ip + length])) length++;
+
+            op = WriteSequenceLZ4(op, opEnd, src + anchor, ip - anchor, ip - reference, length);
+            ip += length;
+            anchor = ip;
+        }
+        else ip++;
+    }
+
+    // Last sequence contains only literals
+    if (op != NULL) op = WriteSequenceLZ4(op, opEnd, src + anchor, srcSize - anchor, 0, 0);
+
+    PBR_FREE(table);
+
+    return ((op != NULL) ? (int)(op - dst) : 0);
+}
+
+// Write a LZ4 sequence (NULL if it doesn't fit)
+// NOTE: match length 0 writes a literals only sequence (last sequence of a block)
+static unsigned char *WriteSequenceLZ4(unsigned char *op, unsigned char *opEnd, const unsigned char *literals, int literalsCount, int offset, int matchLength)
+{
+    int matchCode = ((matchLength > 0) ? matchLength - LZ4_MIN_MATCH : 0);
+
+    // Worst case size: token, lengths bytes, literals and offset
+    if ((opEnd - op) < (1 + literalsCount/255 + 1 + literalsCount + 2 + matchCode/255 + 1)) return NULL;
+
+    *op++ = (unsigned char)((((literalsCount < 15) ? literalsCount : 15) << 4) | ((matchCode < 15) ? matchCode : 15));
+
+    if (literalsCount >= 15)
+    {
+        int remaining = literalsCount - 15;
+        for (; remaining >= 255; remaining -= 255) *op++ = 255;
+        *op++ = (unsigned char)remaining;
+    }
+
+    memcpy(op, literals, literalsCount);
+    op += literalsCount;
+
+    if (matchLength > 0)
+    {
+        *op++ = (unsigned char)(offset & 0xff);
+        *op++ = (unsigned char)(offset >> 8);
+
+        if (matchCode >= 15)
+        {
+            int remaining = matchCode - 15;
+            for (; remaining >= 255; remaining -= 255) *op++ = 255;
+            *op++ = (unsigned char)remaining;
+        }
+    }
+
+    return op;
+}
+
+// Sum data bytes (benchmark reads every byte)
+static unsigned long long ChecksumData(const unsigned char *data, unsigned int size)
+{
+    unsigned long long sum = 0;
+    unsigned int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+    {
+        unsigned long long value = 0;
+        memcpy(&value, data + i, 8);
+        sum += value;
+    }
+
+    for (; i < size; i++) sum += data[i];
+
+    return sum;
+}
+
+// Compare resources names (archive order)
+static int CompareNames(const void *a, const void *b)
+{
+    return strcmp((const char *)a, (const char *)b);
+}
+
+// Get monotonic time in seconds
+static double GetSeconds(void)
+{
+#if defined(_WIN32)
+    long long counter = 0;
+    long long frequency = 1;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+
+    return (double)counter/(double)frequency;
+#else
+    struct timespec time = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec/1000000000.0;
+#endif
+}
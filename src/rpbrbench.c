@@ -0,0 +1,487 @@
+/*******************************************************************************************
+*
+*   rPBR [bench] - CPU kernels microbenchmark tool
+*
+*   FEATURES:
+*       - Measures CPU hot paths of the viewer: PNG image decode, HDR image decode, OBJ mesh
+*         parsing, tangents generation and DrawModelPBR() model matrix computation.
+*       - Robust timing: warm-up runs, repeated samples, median and median absolute deviation (MAD).
+*       - Reports per kernel throughput (MB/s, vertices/s, matrices/s) and noisy kernels.
+*       - Writes results to a JSON file for trend tracking.
+*       - Compares two results files and reports significant regressions (exit code 1).
+*
+*   NOTES:
+*       Usage:
+*           rpbrbench [--samples count] [--output results.json]
+*           rpbrbench --compare base.json new.json
+*       Run it from release folder so bundled resources are found.
+*       OBJ parsing kernel includes mesh upload to GPU (raylib loads meshes into a VAO), so
+*       a small hidden window is created to provide an OpenGL context.
+*       A kernel change is significant when medians differ more than BENCH_SIGNIFICANCE times
+*       the sum of both MADs and more than BENCH_MIN_DELTA percent.
+*       For stable results pin the process to a core and lock CPU frequency (see printed hints).
+*
+*   DEPENDENCIES:
+*       raylib 1.8                          // Required for: image and mesh loading, matrix math, timing
+*       pbrmesh.h                           // Required for: GenerateTangents() (same tangents generation as rpbrcook)
+*
+*   Use the following line to compile:
+*
+*   gcc -o rpbrbench rpbrbench.c -O2 -std=c99 -lraylib -lglfw3 -lopengl32 -lgdi32 -lpthread -lm
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+**********************************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "external/raylib/src/raylib.h"     // Required for: LoadImage(), LoadMesh(), GetTime(), InitWindow()
+#include "external/raylib/src/raymath.h"    // Required for: MatrixScale(), MatrixRotate(), MatrixTranslate(), MatrixMultiply(), MatrixToFloat()
+#include "pbrmemory.h"                      // Required for: PBR_MALLOC(), PBR_FREE() (used by pbrmesh.h)
+#include "pbrmesh.h"                        // Required for: GenerateTangents()
+
+#include <stdio.h>                          // Required for: printf(), fopen(), fprintf(), fgets(), fclose()
+#include <stdlib.h>                         // Required for: calloc(), free(), qsort(), atoi()
+#include <string.h>                         // Required for: strcmp(), strstr(), strncpy(), strchr()
+#include <math.h>                           // Required for: fabs()
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         BENCH_WARMUP                3                                       // Runs discarded before sampling (caches, page faults, clocks)
+#define         BENCH_SAMPLES               15                                      // Default timed samples per kernel
+#define         BENCH_MAX_SAMPLES           256                                     // Max timed samples per kernel
+#define         BENCH_MAX_KERNELS           16                                      // Max kernels in a results file
+#define         BENCH_MATRICES              100000                                  // Model matrices computed per matrix kernel sample
+#define         BENCH_NOISY                 0.05                                    // Relative MAD considered too noisy
+#define         BENCH_SIGNIFICANCE          2.0                                     // MADs sum multiplier for significant changes
+#define         BENCH_MIN_DELTA             1.0                                     // Min percent difference for significant changes
+
+#define         PATH_BENCH_IMAGE            "resources/textures/cerberus/cerberus_albedo.png"   // PNG decode kernel input
+#define         PATH_BENCH_HDR              "resources/textures/hdr/pinetree.hdr"               // HDR decode kernel input
+#define         PATH_BENCH_MODEL            "resources/models/cerberus.obj"                     // OBJ parse and tangents kernels input
+#define         PATH_BENCH_RESULTS          "bench.json"                                        // Default results file path
+
+#if !defined(_glfw3_h_) && !defined(PBR_GLFW_WINDOW)
+    #define PBR_GLFW_WINDOW
+    typedef struct GLFWwindow GLFWwindow;
+    GLFWwindow *glfwGetCurrentContext(void);
+    void glfwHideWindow(GLFWwindow *window);
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct BenchResult {
+    char name[32];                          // Kernel name
+    char unit[16];                          // Throughput unit
+    int samples;                            // Timed samples count
+    double median;                          // Median sample time (milliseconds)
+    double mad;                             // Median absolute deviation of sample times (milliseconds)
+    double min;                             // Fastest sample time (milliseconds)
+    double throughput;                      // Work units per second at median time (in unit)
+} BenchResult;
+
+typedef struct BenchContext {
+    Mesh mesh;                              // Mesh used by tangents kernel
+    float *tangents;                        // Tangents kernel output (3 floats per vertex)
+    volatile float sink;                    // Keeps compiler from discarding kernels output
+} BenchContext;
+
+typedef double (*BenchKernel)(BenchContext *context);    // Runs a kernel once and returns processed work units
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+static double KernelImageDecode(BenchContext *context);                                    // Decode a PNG image (returns input megabytes)
+static double KernelHdrDecode(BenchContext *context);                                      // Decode a HDR image (returns input megabytes)
+static double KernelObjParse(BenchContext *context);                                       // Parse and load an OBJ mesh (returns vertices)
+static double KernelTangents(BenchContext *context);                                       // Generate mesh tangents as cooker does (returns vertices)
+static double KernelModelMatrix(BenchContext *context);                                    // Compute DrawModelPBR() model matrices (returns matrices)
+
+static BenchResult RunKernel(const char *name, const char *unit, BenchKernel kernel, BenchContext *context, int samples); // Warm-up, sample and summarize a kernel
+static int CompareTimes(const void *a, const void *b);                                      // Sort callback for sample times
+static double GetMedian(double *values, int count);                                         // Calculate median of values (sorts them)
+static double GetFileMegabytes(const char *fileName);                                       // Get file size in megabytes
+static void PrintPinningHints(void);                                                        // Print CPU frequency scaling and affinity hints
+static bool SaveResults(const char *fileName, BenchResult *results, int count, int samples);    // Write results to a JSON file
+static int LoadResults(const char *fileName, BenchResult *results);                         // Read results from a JSON file (returns kernels count)
+static int CompareResults(const char *baseName, const char *newName);                       // Print differences between two results files (returns regressions count)
+
+//----------------------------------------------------------------------------------
+// Main entry point
+//----------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    const char *outputName = PATH_BENCH_RESULTS;
+    int samples = BENCH_SAMPLES;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--compare") == 0) && (i + 2 < argc)) return ((CompareResults(argv[i + 1], argv[i + 2]) > 0) ? 1 : 0);
+        else if ((strcmp(argv[i], "--samples") == 0) && (i + 1 < argc)) samples = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc)) outputName = argv[++i];
+        else
+        {
+            printf("Usage: rpbrbench [--samples count] [--output results.json]\n");
+            printf("       rpbrbench --compare base.json new.json\n");
+            return 1;
+        }
+    }
+
+    if (samples < 1) samples = 1;
+    else if (samples > BENCH_MAX_SAMPLES) samples = BENCH_MAX_SAMPLES;
+
+    PrintPinningHints();
+
+    // Create a small hidden window to provide OpenGL context for meshes loading and timer
+    SetTraceLog(0);
+    InitWindow(64, 64, "rPBR - bench");
+    glfwHideWindow(glfwGetCurrentContext());
+
+    BenchContext context = { 0 };
+    context.mesh = LoadMesh(PATH_BENCH_MODEL);
+
+    if (context.mesh.vertexCount == 0)
+    {
+        printf("Benchmark resources not found (run it from release folder)\n");
+        CloseWindow();
+        return 1;
+    }
+
+    context.tangents = (float *)calloc(context.mesh.vertexCount*3, sizeof(float));
+
+    BenchResult results[BENCH_MAX_KERNELS] = { 0 };
+    int count = 0;
+
+    printf("%-16s %12s %12s %12s %16s\n", "kernel", "median ms", "mad ms", "min ms", "throughput");
+
+    results[count++] = RunKernel("image_decode", "MB/s", KernelImageDecode, &context, samples);
+    results[count++] = RunKernel("hdr_decode", "MB/s", KernelHdrDecode, &context, samples);
+    results[count++] = RunKernel("obj_parse", "vertices/s", KernelObjParse, &context, samples);
+    results[count++] = RunKernel("tangents", "vertices/s", KernelTangents, &context, samples);
+    results[count++] = RunKernel("model_matrix", "matrices/s", KernelModelMatrix, &context, samples);
+
+    free(context.tangents);
+    UnloadMesh(&context.mesh);
+    CloseWindow();
+
+    if (!SaveResults(outputName, results, count, samples))
+    {
+        printf("Results file %s could not be created\n", outputName);
+        return 1;
+    }
+
+    printf("Results saved to %s\n", outputName);
+
+    return 0;
+}
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Decode a PNG image (returns input megabytes)
+static double KernelImageDecode(BenchContext *context)
+{
+    Image image = LoadImage(PATH_BENCH_IMAGE);
+    context->sink += (float)image.width;
+    UnloadImage(image);
+
+    return GetFileMegabytes(PATH_BENCH_IMAGE);
+}
+
+// Decode a HDR image (returns input megabytes)
+static double KernelHdrDecode(BenchContext *context)
+{
+    Image image = LoadImage(PATH_BENCH_HDR);
+    context->sink += (float)image.width;
+    UnloadImage(image);
+
+    return GetFileMegabytes(PATH_BENCH_HDR);
+}
+
+// Parse and load an OBJ mesh (returns vertices)
+// NOTE: raylib uploads mesh to GPU while loading, so upload time is included
+static double KernelObjParse(BenchContext *context)
+{
+    Mesh mesh = LoadMesh(PATH_BENCH_MODEL);
+    int vertices = mesh.vertexCount;
+    context->sink += (float)vertices;
+    UnloadMesh(&mesh);
+
+    return (double)vertices;
+}
+
+// Generate mesh tangents as cooker does (returns vertices)
+// NOTE: welded vertices tangents from pbrmesh.h, weld hash table and temporary arrays allocation included
+static double KernelTangents(BenchContext *context)
+{
+    Mesh mesh = context->mesh;
+
+    if ((mesh.texcoords == NULL) || (mesh.normals == NULL)) return 0.0;
+
+    GenerateTangents(mesh, context->tangents);
+    context->sink += context->tangents[0];
+
+    return (double)mesh.vertexCount;
+}
+
+// Compute DrawModelPBR() model matrices (returns matrices)
+// NOTE: same operations as DrawModelPBR() and BindMaterialPBR() per drawn model
+static double KernelModelMatrix(BenchContext *context)
+{
+    Vector3 rotationAxis = { 0.0f, 1.0f, 0.0f };
+    float sum = 0.0f;
+
+    for (int i = 0; i < BENCH_MATRICES; i++)
+    {
+        float value = (float)(i%360);
+        Vector3 position = { value*0.01f, 0.0f, -value*0.01f };
+        Vector3 scale = { 1.0f + value*0.001f, 1.0f, 1.0f };
+
+        Matrix matScale = MatrixScale(scale.x, scale.y, scale.z);
+        Matrix matRotation = MatrixRotate(rotationAxis, value*DEG2RAD);
+        Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
+        Matrix transform = MatrixMultiply(MatrixMultiply(matScale, matRotation), matTranslation);
+
+        float *values = MatrixToFloat(transform);
+        sum += values[0] + values[12];
+    }
+
+    context->sink += sum;
+
+    return (double)BENCH_MATRICES;
+}
+
+// Warm-up, sample and summarize a kernel
+static BenchResult RunKernel(const char *name, const char *unit, BenchKernel kernel, BenchContext *context, int samples)
+{
+    BenchResult result = { 0 };
+    double times[BENCH_MAX_SAMPLES] = { 0 };
+    double deviations[BENCH_MAX_SAMPLES] = { 0 };
+    double units = 0.0;
+
+    strncpy(result.name, name, sizeof(result.name) - 1);
+    strncpy(result.unit, unit, sizeof(result.unit) - 1);
+    result.samples = samples;
+
+    for (int i = 0; i < BENCH_WARMUP; i++) kernel(context);
+
+    for (int i = 0; i < samples; i++)
+    {
+        double start = GetTime();
+        units = kernel(context);
+        times[i] = (GetTime() - start)*1000.0;
+    }
+
+    result.median = GetMedian(times, samples);
+    result.min = times[0];
+
+    for (int i = 0; i < samples; i++) deviations[i] = fabs(times[i] - result.median);
+    result.mad = GetMedian(deviations, samples);
+
+    if (result.median > 0.0) result.throughput = units/(result.median/1000.0);
+
+    printf("%-16s %12.3f %12.3f %12.3f %16.2f %s", result.name, result.median, result.mad, result.min, result.throughput, result.unit);
+    if ((result.median > 0.0) && (result.mad/result.median > BENCH_NOISY)) printf("  (noisy)");
+    printf("\n");
+
+    return result;
+}
+
+// Sort callback for sample times
+static int CompareTimes(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return ((x > y) - (x < y));
+}
+
+// Calculate median of values (sorts them)
+static double GetMedian(double *values, int count)
+{
+    qsort(values, count, sizeof(double), CompareTimes);
+
+    return ((count%2 == 1) ? values[count/2] : 0.5*(values[count/2 - 1] + values[count/2]));
+}
+
+// Get file size in megabytes
+static double GetFileMegabytes(const char *fileName)
+{
+    double megabytes = 0.0;
+    FILE *file = fopen(fileName, "rb");
+
+    if (file != NULL)
+    {
+        fseek(file, 0, SEEK_END);
+        megabytes = (double)ftell(file)/(1024.0*1024.0);
+        fclose(file);
+    }
+
+    return megabytes;
+}
+
+// Print CPU frequency scaling and affinity hints
+static void PrintPinningHints(void)
+{
+#if defined(__linux__)
+    char governor[32] = { 0 };
+    FILE *file = fopen("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor", "r");
+
+    if (file != NULL)
+    {
+        if (fgets(governor, sizeof(governor), file) != NULL)
+        {
+            char *newLine = strchr(governor, '\n');
+            if (newLine != NULL) *newLine = '\0';
+        }
+
+        fclose(file);
+    }
+
+    if ((governor[0] != '\0') && (strcmp(governor, "performance") != 0))
+    {
+        printf("HINT: CPU frequency governor is '%s', lock it for stable results:\n", governor);
+        printf("      sudo cpupower frequency-set --governor performance\n");
+    }
+
+    printf("HINT: pin benchmark to a single core: taskset -c 2 ./rpbrbench\n");
+#elif defined(_WIN32)
+    printf("HINT: select 'High performance' power plan and pin benchmark to a single core:\n");
+    printf("      start /affinity 4 rpbrbench.exe\n");
+#endif
+    printf("HINT: disable turbo boost and close background applications for lower variance\n\n");
+}
+
+// Write results to a JSON file
+// NOTE: one kernel per line, so LoadResults() can read it back without a full JSON parser
+static bool SaveResults(const char *fileName, BenchResult *results, int count, int samples)
+{
+    FILE *file = fopen(fileName, "w");
+
+    if (file == NULL) return false;
+
+    fprintf(file, "{\n");
+    fprintf(file, "    \"tool\": \"rpbrbench\",\n");
+    fprintf(file, "    \"version\": 1,\n");
+    fprintf(file, "    \"warmup\": %i,\n", BENCH_WARMUP);
+    fprintf(file, "    \"samples\": %i,\n", samples);
+    fprintf(file, "    \"kernels\": [\n");
+
+    for (int i = 0; i < count; i++)
+    {
+        fprintf(file, "        { \"name\": \"%s\", \"unit\": \"%s\", \"samples\": %i, \"median_ms\": %.6f, \"mad_ms\": %.6f, \"min_ms\": %.6f, \"throughput\": %.3f }%s\n",
+                results[i].name, results[i].unit, results[i].samples, results[i].median, results[i].mad, results[i].min, results[i].throughput, ((i < count - 1) ? "," : ""));
+    }
+
+    fprintf(file, "    ]\n");
+    fprintf(file, "}\n");
+    fclose(file);
+
+    return true;
+}
+
+// Read results from a JSON file (returns kernels count)
+static int LoadResults(const char *fileName, BenchResult *results)
+{
+    FILE *file = fopen(fileName, "r");
+    char line[512] = { 0 };
+    int count = 0;
+
+    if (file == NULL) return 0;
+
+    while ((count < BENCH_MAX_KERNELS) && (fgets(line, sizeof(line), file) != NULL))
+    {
+        BenchResult result = { 0 };
+        char *name = strstr(line, "\"name\": \"");
+        char *median = strstr(line, "\"median_ms\": ");
+        char *mad = strstr(line, "\"mad_ms\": ");
+        char *throughput = strstr(line, "\"throughput\": ");
+
+        if ((name == NULL) || (median == NULL) || (mad == NULL) || (throughput == NULL)) continue;
+
+        sscanf(name, "\"name\": \"%31[^\"]\"", result.name);
+        sscanf(median, "\"median_ms\": %lf", &result.median);
+        sscanf(mad, "\"mad_ms\": %lf", &result.mad);
+        sscanf(throughput, "\"throughput\": %lf", &result.throughput);
+
+        char *unit = strstr(line, "\"unit\": \"");
+        if (unit != NULL) sscanf(unit, "\"unit\": \"%15[^\"]\"", result.unit);
+
+        results[count++] = result;
+    }
+
+    fclose(file);
+
+    return count;
+}
+
+// Print differences between two results files (returns regressions count)
+static int CompareResults(const char *baseName, const char *newName)
+{
+    BenchResult base[BENCH_MAX_KERNELS] = { 0 };
+    BenchResult current[BENCH_MAX_KERNELS] = { 0 };
+    int baseCount = LoadResults(baseName, base);
+    int currentCount = LoadResults(newName, current);
+    int regressions = 0;
+
+    if ((baseCount == 0) || (currentCount == 0))
+    {
+        printf("Results files %s and %s could not be read\n", baseName, newName);
+        return 1;
+    }
+
+    printf("%-16s %12s %12s %10s  %s\n", "kernel", "base ms", "new ms", "delta", "verdict");
+
+    for (int i = 0; i < currentCount; i++)
+    {
+        BenchResult *previous = NULL;
+
+        for (int k = 0; k < baseCount; k++)
+        {
+            if (strcmp(base[k].name, current[i].name) == 0) previous = &base[k];
+        }
+
+        if (previous == NULL)
+        {
+            printf("%-16s %12s %12.3f %10s  new kernel\n", current[i].name, "-", current[i].median, "-");
+            continue;
+        }
+
+        double difference = current[i].median - previous->median;
+        double delta = ((previous->median > 0.0) ? 100.0*difference/previous->median : 0.0);
+        bool significant = ((fabs(difference) > BENCH_SIGNIFICANCE*(previous->mad + current[i].mad)) && (fabs(delta) > BENCH_MIN_DELTA));
+
+        const char *verdict = "unchanged";
+        if (significant && (difference > 0.0)) { verdict = "REGRESSION"; regressions++; }
+        else if (significant) verdict = "improvement";
+
+        printf("%-16s %12.3f %12.3f %+9.2f%%  %s\n", current[i].name, previous->median, current[i].median, delta, verdict);
+    }
+
+    printf("\n%i regressions found\n", regressions);
+
+    return regressions;
+}
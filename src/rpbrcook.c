@@ -0,0 +1,887 @@
+/*******************************************************************************************
+*
+*   rPBR [cook] - Cooks a model, its texture maps and an HDR environment into a package
+*
+*   FEATURES:
+*       - Writes a single package (pbrpackage.h) opened by the viewer with one memory map and no decoding.
+*       - Model cooked to vertex streams ready to upload with generated tangents (welded vertices).
+*       - Texture maps decoded, complete mipmaps chains generated (normals renormalized) and compressed:
+*         albedo and emission to DXT1 (DXT5 with transparency), normals to DXT1, other maps single channel.
+*       - Roughness mipmaps filtered with normal map variance (same filter used by viewer).
+*       - Environment cubemap, irradiance, prefilter and BRDF LUT baked on GPU and read back.
+*       - Incremental: each entry stores a dependencies hash (source files contents, cook version and settings),
+*         entries which didn't change are copied from previous package without cooking them again.
+*       - Texture maps cooked in parallel by worker threads while model and environment are cooked on main thread.
+*
+*   NOTES:
+*       Usage:
+*           rpbrcook [--model <file.obj>] [--hdr <file.hdr>] [--textures <prefix>] [--output <file.rpk>]
+*                    [--threads <count>] [--force]
+*       Texture maps are loaded from <prefix>_albedo.png, <prefix>_normals.png... (missing maps are skipped).
+*       Without arguments default viewer scene (cerberus model and pinetree environment) is cooked.
+*       Run it from release folder so environment shaders are found. A small hidden window is created
+*       to provide an OpenGL context (model loading and environment bake).
+*       Package is written to a temporary file and renamed once complete, so a failed cook keeps previous package.
+*       Bump COOK_VERSION when cooked data changes, so every entry is cooked again.
+*
+*   DEPENDENCIES:
+*       raylib 1.8                          // Required for: image and mesh loading, window and OpenGL context
+*       pbrcore.h                           // Required for: LoadEnvironment(), UnloadEnvironment()
+*       pbrfilter.h                         // Required for: FilterRoughnessRows()
+*       pbrpackage.h                        // Required for: package layout, OpenPackage(), ClosePackage()
+*       pbrmesh.h                           // Required for: GenerateTangents()
+*       pthreads                            // Required for: texture maps cooking worker threads
+*
+*   Use the following line to compile:
+*
+*   gcc -o rpbrcook rpbrcook.c -O2 -std=c99 -Iexternal/raylib/src -lraylib -lglfw3 -lopengl32 -lgdi32 -lpthread -lm
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+**********************************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "external/raylib/src/raylib.h"         // Required for: LoadImage(), LoadMesh(), InitWindow(), GetTime()
+#include "external/raylib/src/rlgl.h"           // Required for: OpenGL context initialization (used by pbrcore.h)
+#include "pbrcore.h"                            // Required for: LoadEnvironment(), UnloadEnvironment()
+#include "pbrfilter.h"                          // Required for: FilterRoughnessRows()
+#include "pbrpackage.h"                         // Required for: PackageHeader, PackageEntry, OpenPackage(), ClosePackage()
+#include "pbrmesh.h"                            // Required for: GenerateTangents()
+
+#include <stdio.h>                              // Required for: printf(), fopen(), fread(), fwrite(), fclose(), rename(), remove()
+#include <stdlib.h>                             // Required for: atoi(), free()
+#include <string.h>                             // Required for: strcmp(), memcpy(), memset()
+#include <math.h>                               // Required for: sqrtf(), fabsf()
+#include <pthread.h>                            // Required for: pthread_create(), pthread_join(), pthread_mutex_lock()
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         COOK_VERSION                1                                       // Cooked data version (included in every dependencies hash)
+#define         COOK_THREADS                4                                       // Default texture maps cooking threads
+#define         COOK_MAX_THREADS            16                                      // Max texture maps cooking threads
+#define         COOK_MAX_PATH               512                                     // Max paths length
+#define         COOK_TEXTURES               7                                       // Texture maps per material (TypePBR)
+#define         COOK_THUMBNAIL_SIZE         256                                     // Max stored thumbnail dimensions (first mipmap level that fits)
+
+#define         CUBEMAP_SIZE                1024                                    // Same environment sizes than viewer
+#define         IRRADIANCE_SIZE             32
+#define         PREFILTERED_SIZE            256
+#define         BRDF_SIZE                   512
+
+#define         PATH_COOK_MODEL             "resources/models/cerberus.obj"                 // Default model to cook
+#define         PATH_COOK_HDR               "resources/textures/hdr/pinetree.hdr"           // Default HDR environment to cook
+#define         PATH_COOK_TEXTURES          "resources/textures/cerberus/cerberus"          // Default texture maps prefix to cook
+#define         PATH_COOK_OUTPUT            "resources/cerberus.rpk"                        // Default package path
+
+#if !defined(_glfw3_h_) && !defined(PBR_GLFW_WINDOW)
+    #define PBR_GLFW_WINDOW
+    typedef struct GLFWwindow GLFWwindow;
+    GLFWwindow *glfwGetCurrentContext(void);
+    void glfwHideWindow(GLFWwindow *window);
+#endif
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct CookEntry {
+    PackageEntry entry;                     // Entry written to package table (offset is set when writing)
+    unsigned char *data;                    // Blob contents (cooked or inside previous package)
+    bool cooked;                            // Blob cooked by this run (released after writing)
+    bool failed;                            // Entry could not be cooked (not written)
+    char source[COOK_MAX_PATH];             // Main source file
+    double time;                            // Cooking time in seconds
+} CookEntry;
+
+typedef struct CookQueue {
+    CookEntry *entries;                     // Package entries (texture and thumbnail entries of a map are consecutive)
+    int *jobs;                              // Texture entries indices to cook
+    int jobsCount;
+    int next;                               // Next job to take
+    char normals[COOK_MAX_PATH];            // Normal map path used by roughness filter (empty if there is no normal map)
+    pthread_mutex_t mutex;
+} CookQueue;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static const char *cookMapNames[COOK_TEXTURES] = { "albedo", "normals", "metalness", "roughness", "ao", "emission", "height" };   // Texture maps files suffixes (TypePBR order)
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+static void *CookTextureThread(void *arg);                                                  // Take and cook texture jobs until queue is empty
+static void CookTexture(CookEntry *texture, CookEntry *thumbnail, const char *normals);     // Cook a texture map mipmaps chain and its thumbnail
+static void CookMesh(CookEntry *mesh);                                                      // Cook model vertex streams with generated tangents
+static void CookEnvironment(CookEntry *environment);                                        // Bake environment and read its textures back
+static void DownsampleLevel(Color *src, int srcWidth, int srcHeight, Color *dst, int width, int height, bool normals);   // Box filter a mipmap level from previous one
+static void CompressLevel(Color *pixels, int width, int height, int format, unsigned char *output);     // Compress or convert a mipmap level to package format
+static void CompressColorBlock(Color *block, unsigned char *output);                        // Compress a 4x4 block colors (DXT1 block)
+static void CompressAlphaBlock(Color *block, unsigned char *output);                        // Compress a 4x4 block alpha (DXT5 alpha block)
+static unsigned short PackColor565(Color color);                                            // Quantize a color to RGB565
+static Color UnpackColor565(unsigned short value);                                          // Expand a RGB565 color to 8 bits per channel
+static unsigned long long HashBytes(unsigned long long hash, const void *data, size_t size);   // Accumulate bytes into a FNV-1a 64 bits hash
+static bool HashFile(unsigned long long *hash, const char *fileName);                       // Accumulate file contents into a FNV-1a 64 bits hash (false if missing)
+static bool WritePackage(const char *fileName, CookEntry *entries, int count);              // Write package to a temporary file and rename it
+static void PrintEntry(CookEntry *entry, const char *state);                                // Print an entry cooking result
+
+//----------------------------------------------------------------------------------
+// Main entry point
+//----------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    const char *modelName = PATH_COOK_MODEL;
+    const char *hdrName = PATH_COOK_HDR;
+    const char *texturesPrefix = PATH_COOK_TEXTURES;
+    const char *outputName = PATH_COOK_OUTPUT;
+    int threadsCount = COOK_THREADS;
+    bool force = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--model") == 0) && (i + 1 < argc)) modelName = argv[++i];
+        else if ((strcmp(argv[i], "--hdr") == 0) && (i + 1 < argc)) hdrName = argv[++i];
+        else if ((strcmp(argv[i], "--textures") == 0) && (i + 1 < argc)) texturesPrefix = argv[++i];
+        else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc)) outputName = argv[++i];
+        else if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc)) threadsCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--force") == 0) force = true;
+        else
+        {
+            printf("usage: rpbrcook [--model <file.obj>] [--hdr <file.hdr>] [--textures <prefix>] [--output <file.rpk>]\n");
+            printf("                [--threads <count>] [--force]\n");
+            return 1;
+        }
+    }
+
+    if (threadsCount < 1) threadsCount = 1;
+    if (threadsCount > COOK_MAX_THREADS) threadsCount = COOK_MAX_THREADS;
+
+    // Create a hidden window to provide an OpenGL context
+    SetTraceLog(0);
+    InitWindow(64, 64, "rPBR - cook");
+    glfwHideWindow(glfwGetCurrentContext());
+
+    double startTime = GetTime();
+    unsigned int version = COOK_VERSION;
+    unsigned long long seed = HashBytes(14695981039346656037ull, &version, sizeof(version));
+
+    // Calculate entries dependencies hashes from sources contents and settings
+    CookEntry entries[PACKAGE_MAX_ENTRIES] = { 0 };
+    CookQueue queue = { 0 };
+    int jobs[COOK_TEXTURES] = { 0 };
+    int count = 0;
+    bool success = true;
+
+    if (texturesPrefix[0] != '\0')
+    {
+        unsigned long long normalsHash = 0;
+        snprintf(queue.normals, COOK_MAX_PATH, "%s_%s.png", texturesPrefix, cookMapNames[PBR_NORMALS]);
+        if (!HashFile(&normalsHash, queue.normals)) queue.normals[0] = '\0';
+
+        for (int i = 0; i < COOK_TEXTURES; i++)
+        {
+            CookEntry *texture = &entries[count];
+            snprintf(texture->source, COOK_MAX_PATH, "%s_%s.png", texturesPrefix, cookMapNames[i]);
+
+            texture->entry.type = PACKAGE_TEXTURE;
+            texture->entry.slot = i;
+            texture->entry.hash = HashBytes(seed, &texture->entry.slot, sizeof(texture->entry.slot));
+            if (!HashFile(&texture->entry.hash, texture->source)) continue;
+
+            // Filtered roughness depends on normal map too
+            if ((i == PBR_ROUGHNESS) && (queue.normals[0] != '\0')) texture->entry.hash = HashBytes(texture->entry.hash, &normalsHash, sizeof(normalsHash));
+
+            // Thumbnail is cooked with its texture
+            entries[count + 1] = *texture;
+            entries[count + 1].entry.type = PACKAGE_THUMBNAIL;
+            jobs[queue.jobsCount++] = count;
+            count += 2;
+        }
+    }
+
+    if (modelName[0] != '\0')
+    {
+        CookEntry *mesh = &entries[count];
+        snprintf(mesh->source, COOK_MAX_PATH, "%s", modelName);
+        mesh->entry.type = PACKAGE_MESH;
+        mesh->entry.hash = seed;
+
+        if (HashFile(&mesh->entry.hash, mesh->source)) count++;
+        else
+        {
+            printf("error: model %s not found\n", modelName);
+            success = false;
+        }
+    }
+
+    if (hdrName[0] != '\0')
+    {
+        CookEntry *environment = &entries[count];
+        const char *shaders[7] = { PATH_CUBE_VS, PATH_CUBE_FS, PATH_SKYBOX_VS, PATH_IRRADIANCE_FS, PATH_PREFILTER_FS, PATH_BRDF_VS, PATH_BRDF_FS };
+        int sizes[4] = { CUBEMAP_SIZE, IRRADIANCE_SIZE, PREFILTERED_SIZE, BRDF_SIZE };
+
+        snprintf(environment->source, COOK_MAX_PATH, "%s", hdrName);
+        environment->entry.type = PACKAGE_ENVIRONMENT;
+        environment->entry.hash = HashBytes(seed, sizes, sizeof(sizes));
+
+        // Baked data depends on bake shaders too (missing compute shader only changes bake path)
+        for (int i = 0; i < 7; i++) HashFile(&environment->entry.hash, shaders[i]);
+        HashFile(&environment->entry.hash, PATH_BAKE_CS);
+
+        if (HashFile(&environment->entry.hash, environment->source)) count++;
+        else
+        {
+            printf("error: environment %s not found\n", hdrName);
+            success = false;
+        }
+    }
+
+    if (!success || (count == 0))
+    {
+        CloseWindow();
+        return 1;
+    }
+
+    // Reuse entries from previous package when their dependencies didn't change
+    Package previous = { 0 };
+    FILE *file = fopen(outputName, "rb");
+
+    if (file != NULL)
+    {
+        fclose(file);
+        previous = OpenPackage(outputName);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        PackageEntry *old = FindPackageEntry(previous, entries[i].entry.type, entries[i].entry.slot);
+
+        if (!force && (old != NULL) && (old->hash == entries[i].entry.hash))
+        {
+            entries[i].entry = *old;
+            entries[i].data = previous.file.data + old->offset;
+        }
+    }
+
+    // Texture and thumbnail entries are cooked together, so both are cooked again if any of them changed
+    for (int i = 0; i < queue.jobsCount; i++)
+    {
+        if ((entries[jobs[i]].data == NULL) || (entries[jobs[i] + 1].data == NULL)) entries[jobs[i]].data = entries[jobs[i] + 1].data = NULL;
+    }
+
+    int reused = 0;
+    for (int i = 0; i < count; i++) if (entries[i].data != NULL) reused++;
+
+    if ((reused == count) && (previous.entriesCount == count))
+    {
+        printf("%s is up to date (%i entries)\n", outputName, count);
+        ClosePackage(&previous);
+        CloseWindow();
+        return 0;
+    }
+
+    // Cook texture maps in worker threads (texture and thumbnail entries are reused together)
+    pthread_t threads[COOK_MAX_THREADS];
+    int workers = 0;
+
+    queue.entries = entries;
+    queue.jobs = jobs;
+    for (int i = 0; i < queue.jobsCount; i++) if (entries[jobs[i]].data != NULL) jobs[i--] = jobs[--queue.jobsCount];
+    pthread_mutex_init(&queue.mutex, NULL);
+
+    workers = ((queue.jobsCount < threadsCount) ? queue.jobsCount : threadsCount);
+    for (int i = 0; i < workers; i++) pthread_create(&threads[i], NULL, CookTextureThread, &queue);
+
+    // Cook model and environment on main thread meanwhile (OpenGL context)
+    for (int i = 0; i < count; i++)
+    {
+        if (entries[i].data != NULL) continue;
+
+        if (entries[i].entry.type == PACKAGE_MESH) CookMesh(&entries[i]);
+        else if (entries[i].entry.type == PACKAGE_ENVIRONMENT) CookEnvironment(&entries[i]);
+    }
+
+    for (int i = 0; i < workers; i++) pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&queue.mutex);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (entries[i].failed) success = false;
+        PrintEntry(&entries[i], (entries[i].failed ? "failed" : (entries[i].cooked ? "cooked" : "reused")));
+    }
+
+    // Write package (previous package is still mapped, reused blobs are copied from it)
+    if (success) success = WritePackage(outputName, entries, count);
+    ClosePackage(&previous);
+
+    if (success)
+    {
+        remove(outputName);
+        success = (rename(FormatText("%s.tmp", outputName), outputName) == 0);
+    }
+    else remove(FormatText("%s.tmp", outputName));
+
+    if (success) printf("%s written: %i entries (%i reused) in %.2f s\n", outputName, count, reused, GetTime() - startTime);
+    else printf("error: %s could not be cooked\n", outputName);
+
+    for (int i = 0; i < count; i++) if (entries[i].cooked) PBR_FREE(entries[i].data);
+
+    CloseWindow();
+
+    return (success ? 0 : 1);
+}
+
+//----------------------------------------------------------------------------------
+// Functions Definition
+//----------------------------------------------------------------------------------
+// Take and cook texture jobs until queue is empty
+static void *CookTextureThread(void *arg)
+{
+    CookQueue *queue = (CookQueue *)arg;
+
+    while (true)
+    {
+        pthread_mutex_lock(&queue->mutex);
+        int job = ((queue->next < queue->jobsCount) ? queue->jobs[queue->next++] : -1);
+        pthread_mutex_unlock(&queue->mutex);
+
+        if (job < 0) break;
+
+        CookTexture(&queue->entries[job], &queue->entries[job + 1], ((queue->entries[job].entry.slot == PBR_ROUGHNESS) ? queue->normals : NULL));
+    }
+
+    return NULL;
+}
+
+// Cook a texture map mipmaps chain and its thumbnail
+// NOTE: roughness levels are filtered from base level with normal map variance, like viewer specular filter
+static void CookTexture(CookEntry *texture, CookEntry *thumbnail, const char *normals)
+{
+    double startTime = GetTime();
+    Image image = LoadImage(texture->source);
+
+    if (image.data == NULL)
+    {
+        texture->failed = true;
+        thumbnail->failed = true;
+        return;
+    }
+
+    int type = texture->entry.slot;
+    int width = image.width;
+    int height = image.height;
+    int levels = GetPackageMipmapsCount(width, height);
+    Color *pixels = GetImageData(image);
+    UnloadImage(image);
+
+    // Generate mipmaps chain from previous levels
+    Color *chain[FILTER_MAX_LEVELS] = { 0 };
+    int widths[FILTER_MAX_LEVELS] = { 0 };
+    int heights[FILTER_MAX_LEVELS] = { 0 };
+    if (levels > FILTER_MAX_LEVELS) levels = FILTER_MAX_LEVELS;
+
+    chain[0] = pixels;
+    widths[0] = width;
+    heights[0] = height;
+
+    for (int i = 1; i < levels; i++)
+    {
+        widths[i] = ((widths[i - 1] > 1) ? widths[i - 1]/2 : 1);
+        heights[i] = ((heights[i - 1] > 1) ? heights[i - 1]/2 : 1);
+        chain[i] = (Color *)PBR_MALLOC(MEMORY_TEXTURES, widths[i]*heights[i]*sizeof(Color));
+        DownsampleLevel(chain[i - 1], widths[i - 1], heights[i - 1], chain[i], widths[i], heights[i], (type == PBR_NORMALS));
+    }
+
+    // Choose package format from map type
+    int format = UNCOMPRESSED_GRAYSCALE;
+
+    if ((type == PBR_ALBEDO) || (type == PBR_EMISSION))
+    {
+        format = COMPRESSED_DXT1_RGB;
+        for (int i = 0; i < width*height; i++) if (pixels[i].a < 255) { format = COMPRESSED_DXT5_RGBA; break; }
+    }
+    else if (type == PBR_NORMALS) format = COMPRESSED_DXT1_RGB;
+
+    size_t size = 0;
+    for (int i = 0; i < levels; i++) size += GetPackageLevelSize(widths[i], heights[i], format);
+    texture->data = (unsigned char *)PBR_MALLOC(MEMORY_TEXTURES, size);
+
+    // Compress levels (roughness levels are filtered instead of downsampled)
+    Image normalsImage = { 0 };
+    Color *normalsPixels = NULL;
+
+    if ((type == PBR_ROUGHNESS) && (normals != NULL) && (normals[0] != '\0'))
+    {
+        normalsImage = LoadImage(normals);
+        if (normalsImage.data != NULL) normalsPixels = GetImageData(normalsImage);
+    }
+
+    unsigned char *output = texture->data;
+
+    for (int i = 0; i < levels; i++)
+    {
+        if (type == PBR_ROUGHNESS) FilterRoughnessRows(pixels, width, height, normalsPixels, normalsImage.width, normalsImage.height, output, widths[i], heights[i], 0, heights[i]);
+        else CompressLevel(chain[i], widths[i], heights[i], format, output);
+
+        output += GetPackageLevelSize(widths[i], heights[i], format);
+    }
+
+    if (normalsImage.data != NULL) UnloadImage(normalsImage);
+    free(normalsPixels);
+
+    texture->entry.params[0] = width;
+    texture->entry.params[1] = height;
+    texture->entry.params[2] = levels;
+    texture->entry.params[3] = format;
+    texture->entry.size = size;
+    texture->cooked = true;
+
+    // Store first level which fits thumbnail size (compressed textures can't be read back by viewer)
+    int level = 0;
+    while ((level < (levels - 1)) && ((widths[level] > COOK_THUMBNAIL_SIZE) || (heights[level] > COOK_THUMBNAIL_SIZE))) level++;
+
+    thumbnail->entry.params[0] = widths[level];
+    thumbnail->entry.params[1] = heights[level];
+    thumbnail->entry.size = widths[level]*heights[level]*sizeof(Color);
+    thumbnail->data = (unsigned char *)PBR_MALLOC(MEMORY_TEXTURES, thumbnail->entry.size);
+    memcpy(thumbnail->data, chain[level], thumbnail->entry.size);
+    thumbnail->cooked = true;
+
+    free(pixels);
+    for (int i = 1; i < levels; i++) PBR_FREE(chain[i]);
+
+    texture->time = GetTime() - startTime;
+    thumbnail->time = texture->time;
+}
+
+// Cook model vertex streams with generated tangents
+static void CookMesh(CookEntry *mesh)
+{
+    double startTime = GetTime();
+    Mesh source = LoadMesh(mesh->source);
+
+    if (source.vertexCount == 0)
+    {
+        mesh->failed = true;
+        return;
+    }
+
+    // Expand indexed meshes (viewer draws meshes without indices)
+    int count = ((source.indices != NULL) ? source.triangleCount*3 : source.vertexCount);
+    int components[4] = { 3, 2, 3, 3 };
+    float *streams[4] = { source.vertices, source.texcoords, source.normals, NULL };
+
+    mesh->entry.size = (unsigned long long)count*11*sizeof(float);
+    mesh->entry.params[0] = count;
+    mesh->data = (unsigned char *)PBR_CALLOC(MEMORY_MODEL, 1, mesh->entry.size);
+    mesh->cooked = true;
+
+    float *tangents = (float *)PBR_CALLOC(MEMORY_MODEL, source.vertexCount*3, sizeof(float));
+    GenerateTangents(source, tangents);
+    streams[3] = tangents;
+
+    float *output = (float *)mesh->data;
+
+    for (int k = 0; k < 4; k++)
+    {
+        if (streams[k] != NULL)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                int index = ((source.indices != NULL) ? source.indices[i] : i);
+                memcpy(&output[i*components[k]], &streams[k][index*components[k]], components[k]*sizeof(float));
+            }
+        }
+
+        output += count*components[k];
+    }
+
+    PBR_FREE(tangents);
+    UnloadMesh(&source);
+
+    mesh->time = GetTime() - startTime;
+}
+
+// Bake environment and read its textures back
+// NOTE: cubemap keeps its complete mipmaps chain (prefilter source levels), prefilter keeps MAX_MIPMAP_LEVELS levels
+static void CookEnvironment(CookEntry *environment)
+{
+    double startTime = GetTime();
+    Environment env = LoadEnvironment(environment->source, CUBEMAP_SIZE, IRRADIANCE_SIZE, PREFILTERED_SIZE, BRDF_SIZE);
+
+    if (env.cubemapId == 0)
+    {
+        environment->failed = true;
+        return;
+    }
+
+    // Calculate levels to read back, faces of each level are stored consecutively
+    unsigned int ids[3] = { env.cubemapId, env.irradianceId, env.prefilterId };
+    int sizes[3] = { CUBEMAP_SIZE, IRRADIANCE_SIZE, PREFILTERED_SIZE };
+    int levels[3] = { GetPackageMipmapsCount(CUBEMAP_SIZE, CUBEMAP_SIZE), 1, MAX_MIPMAP_LEVELS };
+    size_t size = BRDF_SIZE*BRDF_SIZE*4;
+
+    for (int k = 0; k < 3; k++)
+    {
+        for (int i = 0; i < levels[k]; i++) size += 6*(size_t)(sizes[k] >> i)*(sizes[k] >> i)*6;
+    }
+
+    environment->data = (unsigned char *)PBR_MALLOC(MEMORY_ENVIRONMENT, size);
+    environment->entry.size = size;
+    environment->entry.params[0] = CUBEMAP_SIZE;
+    environment->entry.params[1] = IRRADIANCE_SIZE;
+    environment->entry.params[2] = PREFILTERED_SIZE;
+    environment->entry.params[3] = BRDF_SIZE;
+    environment->cooked = true;
+
+    unsigned char *output = environment->data;
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    for (int k = 0; k < 3; k++)
+    {
+        BindTextureGL(0, GL_TEXTURE_CUBE_MAP, ids[k]);
+
+        for (int i = 0; i < levels[k]; i++)
+        {
+            for (int face = 0; face < 6; face++)
+            {
+                glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, i, GL_RGB, GL_HALF_FLOAT, output);
+                output += (size_t)(sizes[k] >> i)*(sizes[k] >> i)*6;
+            }
+        }
+    }
+
+    BindTextureGL(0, GL_TEXTURE_CUBE_MAP, 0);
+    BindTextureGL(0, GL_TEXTURE_2D, env.brdfId);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_HALF_FLOAT, output);
+    BindTextureGL(0, GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    UnloadEnvironment(env);
+
+    environment->time = GetTime() - startTime;
+}
+
+// Box filter a mipmap level from previous one
+// NOTE: odd dimensions clamp last row and column, normal map texels are averaged as vectors and renormalized
+static void DownsampleLevel(Color *src, int srcWidth, int srcHeight, Color *dst, int width, int height, bool normals)
+{
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+            for (int j = 0; j < 2; j++)
+            {
+                for (int i = 0; i < 2; i++)
+                {
+                    int sx = ((x*2 + i < srcWidth) ? x*2 + i : srcWidth - 1);
+                    int sy = ((y*2 + j < srcHeight) ? y*2 + j : srcHeight - 1);
+                    Color color = src[sy*srcWidth + sx];
+
+                    if (normals)
+                    {
+                        float normal[3] = { color.r/127.5f - 1.0f, color.g/127.5f - 1.0f, color.b/127.5f - 1.0f };
+                        float length = sqrtf(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+                        if (length > 0.0f) for (int c = 0; c < 3; c++) sum[c] += normal[c]/length;
+                    }
+                    else
+                    {
+                        sum[0] += color.r;
+                        sum[1] += color.g;
+                        sum[2] += color.b;
+                    }
+
+                    sum[3] += color.a;
+                }
+            }
+
+            Color *color = &dst[y*width + x];
+
+            if (normals)
+            {
+                float length = sqrtf(sum[0]*sum[0] + sum[1]*sum[1] + sum[2]*sum[2]);
+                if (length <= 0.0f) { sum[2] = 1.0f; length = 1.0f; }
+
+                color->r = (unsigned char)((sum[0]/length*0.5f + 0.5f)*255.0f + 0.5f);
+                color->g = (unsigned char)((sum[1]/length*0.5f + 0.5f)*255.0f + 0.5f);
+                color->b = (unsigned char)((sum[2]/length*0.5f + 0.5f)*255.0f + 0.5f);
+            }
+            else
+            {
+                color->r = (unsigned char)(sum[0]/4.0f + 0.5f);
+                color->g = (unsigned char)(sum[1]/4.0f + 0.5f);
+                color->b = (unsigned char)(sum[2]/4.0f + 0.5f);
+            }
+
+            color->a = (unsigned char)(sum[3]/4.0f + 0.5f);
+        }
+    }
+}
+
+// Compress or convert a mipmap level to package format
+// NOTE: blocks overlapping level borders (levels smaller than 4x4) repeat last row and column
+static void CompressLevel(Color *pixels, int width, int height, int format, unsigned char *output)
+{
+    if (format == UNCOMPRESSED_GRAYSCALE)
+    {
+        for (int i = 0; i < width*height; i++) output[i] = pixels[i].r;
+        return;
+    }
+
+    for (int by = 0; by < height; by += 4)
+    {
+        for (int bx = 0; bx < width; bx += 4)
+        {
+            Color block[16];
+
+            for (int y = 0; y < 4; y++)
+            {
+                for (int x = 0; x < 4; x++) block[y*4 + x] = pixels[((by + y < height) ? by + y : height - 1)*width + ((bx + x < width) ? bx + x : width - 1)];
+            }
+
+            if (format == COMPRESSED_DXT5_RGBA)
+            {
+                CompressAlphaBlock(block, output);
+                output += 8;
+            }
+
+            CompressColorBlock(block, output);
+            output += 8;
+        }
+    }
+}
+
+// Compress a 4x4 block colors (DXT1 block)
+// NOTE: endpoints are block colors with min and max projection on principal axis (covariance power iteration)
+static void CompressColorBlock(Color *block, unsigned char *output)
+{
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; i++) { mean[0] += block[i].r/16.0f; mean[1] += block[i].g/16.0f; mean[2] += block[i].b/16.0f; }
+
+    float covariance[6] = { 0.0f };
+
+    for (int i = 0; i < 16; i++)
+    {
+        float r = block[i].r - mean[0], g = block[i].g - mean[1], b = block[i].b - mean[2];
+        covariance[0] += r*r; covariance[1] += r*g; covariance[2] += r*b;
+        covariance[3] += g*g; covariance[4] += g*b; covariance[5] += b*b;
+    }
+
+    // Start from covariance column of channel with highest variance (never orthogonal to principal axis)
+    int channel = ((covariance[0] >= covariance[3]) ? ((covariance[0] >= covariance[5]) ? 0 : 2) : ((covariance[3] >= covariance[5]) ? 1 : 2));
+    float columns[3][3] = { { covariance[0], covariance[1], covariance[2] }, { covariance[1], covariance[3], covariance[4] }, { covariance[2], covariance[4], covariance[5] } };
+    float axis[3] = { columns[channel][0], columns[channel][1], columns[channel][2] };
+
+    for (int k = 0; k < 8; k++)
+    {
+        float x = covariance[0]*axis[0] + covariance[1]*axis[1] + covariance[2]*axis[2];
+        float y = covariance[1]*axis[0] + covariance[3]*axis[1] + covariance[4]*axis[2];
+        float z = covariance[2]*axis[0] + covariance[4]*axis[1] + covariance[5]*axis[2];
+        float scale = fmaxf(fabsf(x), fmaxf(fabsf(y), fabsf(z)));
+
+        if (scale <= 0.0f) break;
+        axis[0] = x/scale; axis[1] = y/scale; axis[2] = z/scale;
+    }
+
+    int minIndex = 0, maxIndex = 0;
+    float minProjection = 0.0f, maxProjection = 0.0f;
+
+    for (int i = 0; i < 16; i++)
+    {
+        float projection = block[i].r*axis[0] + block[i].g*axis[1] + block[i].b*axis[2];
+
+        if ((i == 0) || (projection < minProjection)) { minProjection = projection; minIndex = i; }
+        if ((i == 0) || (projection > maxProjection)) { maxProjection = projection; maxIndex = i; }
+    }
+
+    unsigned short color0 = PackColor565(block[maxIndex]);
+    unsigned short color1 = PackColor565(block[minIndex]);
+
+    if (color0 < color1)
+    {
+        unsigned short temp = color0;
+        color0 = color1;
+        color1 = temp;
+    }
+
+    // Four colors palette (color0 > color1), equal endpoints use first color for every texel
+    Color palette[4] = { UnpackColor565(color0), UnpackColor565(color1) };
+    palette[2] = (Color){ (2*palette[0].r + palette[1].r)/3, (2*palette[0].g + palette[1].g)/3, (2*palette[0].b + palette[1].b)/3, 255 };
+    palette[3] = (Color){ (palette[0].r + 2*palette[1].r)/3, (palette[0].g + 2*palette[1].g)/3, (palette[0].b + 2*palette[1].b)/3, 255 };
+
+    unsigned int indices = 0;
+
+    for (int i = 0; (i < 16) && (color0 != color1); i++)
+    {
+        int best = 0;
+        int bestDistance = 0;
+
+        for (int k = 0; k < 4; k++)
+        {
+            int r = block[i].r - palette[k].r, g = block[i].g - palette[k].g, b = block[i].b - palette[k].b;
+            int distance = r*r + g*g + b*b;
+
+            if ((k == 0) || (distance < bestDistance))
+            {
+                bestDistance = distance;
+                best = k;
+            }
+        }
+
+        indices |= (unsigned int)best << (i*2);
+    }
+
+    output[0] = color0 & 0xff;
+    output[1] = color0 >> 8;
+    output[2] = color1 & 0xff;
+    output[3] = color1 >> 8;
+    for (int i = 0; i < 4; i++) output[4 + i] = (indices >> (i*8)) & 0xff;
+}
+
+// Compress a 4x4 block alpha (DXT5 alpha block)
+// NOTE: uses eight values mode between block min and max alpha
+static void CompressAlphaBlock(Color *block, unsigned char *output)
+{
+    int alpha0 = 0, alpha1 = 255;
+
+    for (int i = 0; i < 16; i++)
+    {
+        if (block[i].a > alpha0) alpha0 = block[i].a;
+        if (block[i].a < alpha1) alpha1 = block[i].a;
+    }
+
+    int palette[8] = { alpha0, alpha1 };
+    for (int k = 1; k < 7; k++) palette[k + 1] = ((7 - k)*alpha0 + k*alpha1)/7;
+
+    unsigned long long indices = 0;
+
+    for (int i = 0; (i < 16) && (alpha0 != alpha1); i++)
+    {
+        int best = 0;
+
+        for (int k = 1; k < 8; k++) if (abs(block[i].a - palette[k]) < abs(block[i].a - palette[best])) best = k;
+
+        indices |= (unsigned long long)best << (i*3);
+    }
+
+    output[0] = (unsigned char)alpha0;
+    output[1] = (unsigned char)alpha1;
+    for (int i = 0; i < 6; i++) output[2 + i] = (indices >> (i*8)) & 0xff;
+}
+
+// Quantize a color to RGB565
+static unsigned short PackColor565(Color color)
+{
+    return (unsigned short)((((color.r*31 + 127)/255) << 11) | (((color.g*63 + 127)/255) << 5) | ((color.b*31 + 127)/255));
+}
+
+// Expand a RGB565 color to 8 bits per channel
+static Color UnpackColor565(unsigned short value)
+{
+    int r = (value >> 11) & 0x1f, g = (value >> 5) & 0x3f, b = value & 0x1f;
+
+    return (Color){ (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255 };
+}
+
+// Accumulate bytes into a FNV-1a 64 bits hash
+static unsigned long long HashBytes(unsigned long long hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i])*1099511628211ull;
+
+    return hash;
+}
+
+// Accumulate file contents into a FNV-1a 64 bits hash (false if missing)
+static bool HashFile(unsigned long long *hash, const char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return false;
+
+    unsigned char buffer[65536];
+    size_t read = 0;
+
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) *hash = HashBytes(*hash, buffer, read);
+    fclose(file);
+
+    return true;
+}
+
+// Write package to a temporary file and rename it
+// NOTE: renamed by caller once previous package is unmapped (Windows can't replace mapped files)
+static bool WritePackage(const char *fileName, CookEntry *entries, int count)
+{
+    // Lay out blobs after entries table
+    PackageHeader header = { 0 };
+    PackageEntry table[PACKAGE_MAX_ENTRIES] = { 0 };
+    unsigned long long offset = (sizeof(PackageHeader) + count*sizeof(PackageEntry) + PACKAGE_ALIGNMENT - 1)/PACKAGE_ALIGNMENT*PACKAGE_ALIGNMENT;
+
+    for (int i = 0; i < count; i++)
+    {
+        table[i] = entries[i].entry;
+        table[i].offset = offset;
+        offset = (offset + table[i].size + PACKAGE_ALIGNMENT - 1)/PACKAGE_ALIGNMENT*PACKAGE_ALIGNMENT;
+    }
+
+    memcpy(header.magic, PACKAGE_MAGIC, 4);
+    header.version = PACKAGE_VERSION;
+    header.entriesCount = count;
+    header.alignment = PACKAGE_ALIGNMENT;
+    header.size = offset;
+
+    FILE *file = fopen(FormatText("%s.tmp", fileName), "wb");
+    if (file == NULL) return false;
+
+    static const unsigned char padding[PACKAGE_ALIGNMENT] = { 0 };
+    unsigned long long written = fwrite(&header, 1, sizeof(PackageHeader), file);
+    written += fwrite(table, 1, count*sizeof(PackageEntry), file);
+
+    for (int i = 0; i < count; i++)
+    {
+        written += fwrite(padding, 1, table[i].offset - written, file);
+        written += fwrite(entries[i].data, 1, table[i].size, file);
+    }
+
+    written += fwrite(padding, 1, header.size - written, file);
+
+    return ((fclose(file) == 0) && (written == header.size));
+}
+
+// Print an entry cooking result
+static void PrintEntry(CookEntry *entry, const char *state)
+{
+    const char *formats[] = { "R8", "RGBA8", "DXT1", "DXT5" };
+    int format = ((entry->entry.params[3] == UNCOMPRESSED_R8G8B8A8) ? 1 : ((entry->entry.params[3] == COMPRESSED_DXT1_RGB) ? 2 : ((entry->entry.params[3] == COMPRESSED_DXT5_RGBA) ? 3 : 0)));
+
+    switch (entry->entry.type)
+    {
+        case PACKAGE_MESH: printf("  %-7s mesh        %-10i vertices                %7.2f MB  %6.2f s  %s\n", state, entry->entry.params[0], entry->entry.size/1048576.0, entry->time, entry->source); break;
+        case PACKAGE_TEXTURE: printf("  %-7s %-11s %4ix%-5i %-5s %2i mipmaps    %7.2f MB  %6.2f s  %s\n", state, cookMapNames[entry->entry.slot], entry->entry.params[0], entry->entry.params[1], formats[format], entry->entry.params[2], entry->entry.size/1048576.0, entry->time, entry->source); break;
+        case PACKAGE_ENVIRONMENT: printf("  %-7s environment %4ix%-5i RGB16F               %7.2f MB  %6.2f s  %s\n", state, entry->entry.params[0], entry->entry.params[0], entry->entry.size/1048576.0, entry->time, entry->source); break;
+        default: break;
+    }
+}
@@ -0,0 +1,673 @@
+/*******************************************************************************************
+*
+*   rPBR [farm] - Distributed frame rendering across local render server processes
+*
+*   FEATURES:
+*       - Splits a turntable animation (frames) or a high resolution still (tiles) in jobs rendered
+*         by N rPBR render servers (rpbr --serve), spawned on this machine or already running.
+*       - Workers keep environments, models, textures and shaders cached, so assets are loaded once per worker.
+*       - Dynamic scheduling with work stealing: each worker owns a contiguous jobs range (nearby cameras
+*         and tiles), idle workers steal half of the remaining range of the busiest worker.
+*       - Several requests in flight per worker hide coordinator round trips.
+*       - Jobs of a worker which dies are given back to other workers.
+*       - Frames are written as numbered PNG files. Tiles are rendered with a guard band (post-processing
+*         effects sample neighbour pixels), stitched, vignette is applied once and still is written as PNG.
+*       - Scaling mode renders same job with 1, 2, 4... workers and reports speedup and efficiency.
+*
+*   NOTES:
+*       Usage:
+*           rpbrfarm --model <file.obj> --hdr <file.hdr> [--textures <prefix>] [--mode <name>] [--size <width>x<height>]
+*                    (--frames <count> --output <directory> | --tile <pixels> --output <file.png>)
+*                    [--workers <count>] [--rpbr <path>] [--connect <socket,socket...>] [--scaling]
+*       Run it from release folder, workers are started in current directory and load resources from it.
+*       Each worker has its own OpenGL context and all of them share the GPU: when GPU is saturated
+*       adding workers only scales CPU work (read back, PNG encoding, uploads and draw calls submission).
+*       Startup time (window, default scene and first assets load) is reported apart from render time.
+*       Only available on POSIX systems (processes and Unix domain sockets).
+*
+*   DEPENDENCIES:
+*       raylib 1.8                          // Required for: SaveImageAs()
+*       POSIX                               // Required for: fork(), execl(), Unix domain sockets, select()
+*
+*   Use the following line to compile:
+*
+*   gcc -o rpbrfarm rpbrfarm.c -O2 -std=c99 -lraylib -lglfw3 -lGL -lm -lpthread -ldl -lX11
+*
+*   LICENSE: zlib/libpng
+*
+*   rPBR is licensed under an unmodified zlib/libpng license, which is an OSI-certified,
+*   BSD-like license that allows static linking with closed source software:
+*
+*   Copyright (c) 2017-2020 Victor Fisac
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+**********************************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#define _POSIX_C_SOURCE 200809L             // Required for: kill(), nanosleep(), clock_gettime()
+
+#include "external/raylib/src/raylib.h"     // Required for: Image, SaveImageAs()
+
+#include <stdio.h>                          // Required for: printf(), snprintf(), fopen(), fwrite(), fclose()
+#include <stdlib.h>                         // Required for: calloc(), free(), atoi()
+#include <string.h>                         // Required for: strcmp(), strncpy(), strchr(), memcpy(), memmove()
+#include <math.h>                           // Required for: cosf(), sinf(), sqrtf()
+#include <time.h>                           // Required for: clock_gettime(), nanosleep()
+#include <signal.h>                         // Required for: kill(), signal()
+#include <fcntl.h>                          // Required for: open()
+#include <unistd.h>                         // Required for: fork(), execl(), dup2(), close(), unlink(), sysconf()
+#include <sys/wait.h>                       // Required for: waitpid()
+#include <sys/stat.h>                       // Required for: mkdir()
+#include <sys/socket.h>                     // Required for: socket(), connect(), send(), recv()
+#include <sys/select.h>                     // Required for: select()
+#include <sys/un.h>                         // Required for: struct sockaddr_un
+
+//----------------------------------------------------------------------------------
+// Defines
+//----------------------------------------------------------------------------------
+#define         FARM_MAX_WORKERS            64                                      // Max worker processes
+#define         FARM_PIPELINE               2                                       // Requests in flight per worker
+#define         FARM_TILE_GUARD             16                                      // Tile guard band in pixels (FXAA span and bloom radius)
+#define         FARM_START_TIMEOUT          60.0                                    // Max seconds waiting for a worker socket
+#define         FARM_MAX_PATH               512                                     // Max paths length
+#define         FARM_DEFAULT_WIDTH          1280                                    // Default output width
+#define         FARM_DEFAULT_HEIGHT         720                                     // Default output height
+
+#define         VIGNETTE_RADIUS             0.75f                                   // Same values than postfx.fs vignette
+#define         VIGNETTE_SOFTNESS           0.9f
+#define         VIGNETTE_OPACITY            0.7f
+
+//----------------------------------------------------------------------------------
+// Structs and enums
+//----------------------------------------------------------------------------------
+typedef struct FarmJob {
+    Rectangle tile;                         // Tile written to output (tiles mode)
+    Rectangle region;                       // Rendered region (tile with guard band)
+    bool done;                              // Result received
+} FarmJob;
+
+typedef struct FarmWorker {
+    int socket;                             // Render server connection (-1 if worker is gone)
+    pid_t pid;                              // Spawned process (0 if server was already running, -1 if spawn failed)
+    char path[108];                         // Render server socket path
+    int *jobs;                              // Owned jobs indices (front is popped by owner, back is stolen)
+    int head;                               // Next owned job
+    int tail;                               // Owned jobs end
+    int inFlight[FARM_PIPELINE];            // Requested jobs waiting for result
+    int inFlightCount;
+    int completed;                          // Results received
+    int stolen;                             // Jobs stolen from other workers
+    int cold;                               // Results which loaded assets
+} FarmWorker;
+
+typedef struct FarmOptions {
+    const char *model;                      // Model file path
+    const char *hdr;                        // HDR environment file path
+    const char *textures;                   // Texture maps prefix (NULL for none)
+    const char *mode;                       // Render mode name
+    const char *output;                     // Frames directory or still file path
+    const char *rpbr;                       // rPBR executable path
+    char *connect;                          // Running servers sockets (comma separated)
+    int width;                              // Output width
+    int height;                             // Output height
+    int frames;                             // Turntable frames (0 in tiles mode)
+    int tileSize;                           // Tile dimensions (0 in frames mode)
+    int workers;                            // Workers count
+    bool scaling;                           // Run scaling measurement
+} FarmOptions;
+
+typedef struct FarmResult {
+    double startupTime;                     // Seconds until all workers accepted connections
+    double renderTime;                      // Seconds from first request to last result
+    int failed;                             // Jobs answered with an error
+    int steals;                             // Work stealing operations
+} FarmResult;
+
+//----------------------------------------------------------------------------------
+// Functions Declaration
+//----------------------------------------------------------------------------------
+static FarmResult RunFarm(FarmOptions *options, int workersCount, bool writeOutput);        // Start workers, render all jobs and write output
+static void SpawnWorker(FarmWorker *worker, FarmOptions *options, int index, const char *connectPath);  // Spawn render server process (or use running one)
+static bool ConnectWorker(FarmWorker *worker);                                              // Connect to worker render server, waiting for it to start
+static void StopWorker(FarmWorker *worker);                                                 // Disconnect from worker and stop it if it was spawned
+static int NextJob(FarmWorker *workers, int count, int index, int *steals);                 // Pop an owned job or steal half of busiest worker range
+static bool SendJob(FarmWorker *worker, FarmOptions *options, FarmJob *jobs, int job);      // Send a job render request
+static int ReceiveResult(FarmWorker *worker, FarmOptions *options, FarmJob *jobs, unsigned char *pixels, bool writeOutput, int *failed);   // Read a result and store it (returns job or -1 if worker is gone)
+static void ApplyVignette(unsigned char *pixels, int width, int height);                    // Apply postfx.fs vignette to stitched still
+static bool ReceiveBytes(int socket, void *data, int size);                                 // Read exactly size bytes
+static double GetSeconds(void);                                                             // Get monotonic time in seconds
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    FarmOptions options = { 0 };
+    options.mode = "default";
+    options.rpbr = "./rpbr";
+    options.width = FARM_DEFAULT_WIDTH;
+    options.height = FARM_DEFAULT_HEIGHT;
+    options.workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc - 1; i++)
+    {
+        if (strcmp(argv[i], "--model") == 0) options.model = argv[++i];
+        else if (strcmp(argv[i], "--hdr") == 0) options.hdr = argv[++i];
+        else if (strcmp(argv[i], "--textures") == 0) options.textures = argv[++i];
+        else if (strcmp(argv[i], "--mode") == 0) options.mode = argv[++i];
+        else if (strcmp(argv[i], "--output") == 0) options.output = argv[++i];
+        else if (strcmp(argv[i], "--rpbr") == 0) options.rpbr = argv[++i];
+        else if (strcmp(argv[i], "--connect") == 0) options.connect = argv[++i];
+        else if (strcmp(argv[i], "--frames") == 0) options.frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--tile") == 0) options.tileSize = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--workers") == 0) options.workers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--size") == 0) sscanf(argv[++i], "%dx%d", &options.width, &options.height);
+    }
+
+    for (int i = 1; i < argc; i++) if (strcmp(argv[i], "--scaling") == 0) options.scaling = true;
+
+    if ((options.model == NULL) || (options.hdr == NULL) || (options.output == NULL) || ((options.frames <= 0) && (options.tileSize <= 0)))
+    {
+        printf("usage: rpbrfarm --model <file.obj> --hdr <file.hdr> [--textures <prefix>] [--mode <name>] [--size <width>x<height>]\n");
+        printf("                (--frames <count> --output <directory> | --tile <pixels> --output <file.png>)\n");
+        printf("                [--workers <count>] [--rpbr <path>] [--connect <socket,socket...>] [--scaling]\n");
+        return 1;
+    }
+
+    if (options.workers < 1) options.workers = 1;
+    if (options.workers > FARM_MAX_WORKERS) options.workers = FARM_MAX_WORKERS;
+    if (options.frames > 0) options.tileSize = 0;
+
+    // Worker processes can close their socket while a request is being sent
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!options.scaling)
+    {
+        FarmResult result = RunFarm(&options, options.workers, true);
+
+        printf("Rendered with %i workers: %.2f s startup, %.2f s render, %i steals, %i failed jobs\n",
+               options.workers, result.startupTime, result.renderTime, result.steals, result.failed);
+
+        return (result.failed > 0) ? 1 : 0;
+    }
+
+    // Scaling measurement: same job with 1, 2, 4... workers (output is written by last run)
+    double baseTime = 0.0;
+    int failed = 0;
+
+    printf("workers  startup (s)  render (s)  speedup  efficiency  steals\n");
+
+    for (int count = 1; count <= options.workers; count = ((count*2 > options.workers) && (count < options.workers)) ? options.workers : count*2)
+    {
+        FarmResult result = RunFarm(&options, count, (count == options.workers));
+
+        if (count == 1) baseTime = result.renderTime;
+        double speedup = (result.renderTime > 0.0) ? baseTime/result.renderTime : 0.0;
+
+        printf("%7i  %11.2f  %10.2f  %6.2fx  %9.1f%%  %6i\n", count, result.startupTime, result.renderTime, speedup, 100.0*speedup/count, result.steals);
+        failed += result.failed;
+    }
+
+    return (failed > 0) ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Start workers, render all jobs and write output
+// NOTE: render time starts once all workers are connected, so it does not include processes startup
+static FarmResult RunFarm(FarmOptions *options, int workersCount, bool writeOutput)
+{
+    FarmResult result = { 0 };
+    FarmWorker workers[FARM_MAX_WORKERS] = { 0 };
+    char *connectPaths[FARM_MAX_WORKERS] = { 0 };
+    unsigned char *pixels = NULL;
+
+    // Split running servers sockets list (workers count is limited to listed sockets)
+    if (options->connect != NULL)
+    {
+        static char list[FARM_MAX_WORKERS*108];
+        int listed = 0;
+        strncpy(list, options->connect, sizeof(list) - 1);
+
+        for (char *path = list; (path != NULL) && (listed < FARM_MAX_WORKERS); listed++)
+        {
+            connectPaths[listed] = path;
+            path = strchr(path, ',');
+            if (path != NULL) *path++ = '\0';
+        }
+
+        if (workersCount > listed) workersCount = listed;
+    }
+
+    // Define jobs: turntable frames or image tiles with guard band
+    int jobsCount = 0;
+    int columns = 0;
+    FarmJob *jobs = NULL;
+
+    if (options->frames > 0)
+    {
+        jobsCount = options->frames;
+        jobs = (FarmJob *)calloc(jobsCount, sizeof(FarmJob));
+        if (writeOutput) mkdir(options->output, 0755);
+    }
+    else
+    {
+        columns = (options->width + options->tileSize - 1)/options->tileSize;
+        int rows = (options->height + options->tileSize - 1)/options->tileSize;
+        jobsCount = columns*rows;
+        jobs = (FarmJob *)calloc(jobsCount, sizeof(FarmJob));
+        pixels = (unsigned char *)calloc(options->width*options->height, 4);
+
+        for (int i = 0; i < jobsCount; i++)
+        {
+            Rectangle tile = { (i%columns)*options->tileSize, (i/columns)*options->tileSize, options->tileSize, options->tileSize };
+            if (tile.x + tile.width > options->width) tile.width = options->width - tile.x;
+            if (tile.y + tile.height > options->height) tile.height = options->height - tile.y;
+
+            int left = (tile.x > FARM_TILE_GUARD) ? (tile.x - FARM_TILE_GUARD) : 0;
+            int top = (tile.y > FARM_TILE_GUARD) ? (tile.y - FARM_TILE_GUARD) : 0;
+            int right = (tile.x + tile.width + FARM_TILE_GUARD < options->width) ? (tile.x + tile.width + FARM_TILE_GUARD) : options->width;
+            int bottom = (tile.y + tile.height + FARM_TILE_GUARD < options->height) ? (tile.y + tile.height + FARM_TILE_GUARD) : options->height;
+
+            jobs[i].tile = tile;
+            jobs[i].region = (Rectangle){ left, top, right - left, bottom - top };
+        }
+    }
+
+    // Start workers (all processes load at the same time) and give each one a contiguous jobs range
+    double startTime = GetSeconds();
+    int alive = 0;
+
+    for (int i = 0; i < workersCount; i++) SpawnWorker(&workers[i], options, i, connectPaths[i]);
+
+    for (int i = 0; i < workersCount; i++)
+    {
+        workers[i].jobs = (int *)calloc(jobsCount, sizeof(int));
+        workers[i].head = jobsCount*i/workersCount;
+        workers[i].tail = jobsCount*(i + 1)/workersCount;
+        for (int j = workers[i].head; j < workers[i].tail; j++) workers[i].jobs[j] = j;
+
+        if (ConnectWorker(&workers[i])) alive++;
+        else
+        {
+            // Unavailable worker range is left to be stolen
+            workers[i].socket = -1;
+            printf("[%s] Worker could not be started\n", workers[i].path);
+        }
+    }
+
+    result.startupTime = GetSeconds() - startTime;
+    startTime = GetSeconds();
+
+    int completed = 0;
+
+    while ((completed < jobsCount) && (alive > 0))
+    {
+        // Keep workers pipelines full
+        for (int i = 0; i < workersCount; i++)
+        {
+            while ((workers[i].socket >= 0) && (workers[i].inFlightCount < FARM_PIPELINE))
+            {
+                int job = NextJob(workers, workersCount, i, &result.steals);
+                if (job < 0) break;
+
+                workers[i].inFlight[workers[i].inFlightCount++] = job;
+                if (!SendJob(&workers[i], options, jobs, job)) break;
+            }
+        }
+
+        // Wait for results
+        fd_set readable;
+        int maxSocket = -1;
+        struct timeval wait = { 1, 0 };
+        FD_ZERO(&readable);
+
+        for (int i = 0; i < workersCount; i++)
+        {
+            if ((workers[i].socket < 0) || (workers[i].inFlightCount == 0)) continue;
+            FD_SET(workers[i].socket, &readable);
+            if (workers[i].socket > maxSocket) maxSocket = workers[i].socket;
+        }
+
+        if ((maxSocket < 0) || (select(maxSocket + 1, &readable, NULL, NULL, &wait) <= 0)) continue;
+
+        for (int i = 0; i < workersCount; i++)
+        {
+            if ((workers[i].socket < 0) || !FD_ISSET(workers[i].socket, &readable)) continue;
+
+            if (ReceiveResult(&workers[i], options, jobs, pixels, writeOutput, &result.failed) >= 0) completed++;
+            else
+            {
+                // Worker is gone: its in flight jobs go back to its range, so they are stolen by other workers
+                printf("[%s] Worker stopped, %i jobs rescheduled\n", workers[i].path, workers[i].inFlightCount + workers[i].tail - workers[i].head);
+
+                int remaining = workers[i].tail - workers[i].head;
+                memmove(workers[i].jobs, workers[i].jobs + workers[i].head, remaining*sizeof(int));
+                workers[i].head = 0;
+                workers[i].tail = remaining;
+
+                for (int j = 0; j < workers[i].inFlightCount; j++) workers[i].jobs[workers[i].tail++] = workers[i].inFlight[j];
+                workers[i].inFlightCount = 0;
+                StopWorker(&workers[i]);
+                alive--;
+            }
+        }
+    }
+
+    result.renderTime = GetSeconds() - startTime;
+    if (completed < jobsCount) result.failed += jobsCount - completed;
+
+    // Print per worker balance
+    for (int i = 0; i < workersCount; i++)
+    {
+        printf("    worker %2i: %4i jobs (%i stolen, %i cold)\n", i, workers[i].completed, workers[i].stolen, workers[i].cold);
+        StopWorker(&workers[i]);
+        free(workers[i].jobs);
+    }
+
+    // Write stitched still
+    if ((pixels != NULL) && writeOutput)
+    {
+        ApplyVignette(pixels, options->width, options->height);
+
+        Image image = { pixels, options->width, options->height, 1, UNCOMPRESSED_R8G8B8A8 };
+        SaveImageAs(options->output, image);
+    }
+
+    free(pixels);
+    free(jobs);
+
+    return result;
+}
+
+// Spawn render server process (or use running one)
+static void SpawnWorker(FarmWorker *worker, FarmOptions *options, int index, const char *connectPath)
+{
+    worker->socket = -1;
+
+    if (connectPath != NULL) strncpy(worker->path, connectPath, sizeof(worker->path) - 1);
+    else
+    {
+        snprintf(worker->path, sizeof(worker->path), "/tmp/rpbrfarm-%i-%i.sock", (int)getpid(), index);
+        unlink(worker->path);
+
+        worker->pid = fork();
+
+        if (worker->pid == 0)
+        {
+            // Worker logs are discarded, coordinator prints its own progress
+            int null = open("/dev/null", O_WRONLY);
+            dup2(null, 1);
+            dup2(null, 2);
+            execl(options->rpbr, options->rpbr, "--serve", worker->path, (char *)NULL);
+            _exit(127);
+        }
+    }
+}
+
+// Connect to worker render server, waiting for it to start
+static bool ConnectWorker(FarmWorker *worker)
+{
+    struct sockaddr_un address = { 0 };
+    if (worker->pid < 0) return false;
+
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, worker->path, sizeof(address.sun_path) - 1);
+
+    // Spawned workers create their socket once window and default scene are loaded
+    double startTime = GetSeconds();
+    struct timespec retry = { 0, 100000000 };
+
+    while ((GetSeconds() - startTime) < FARM_START_TIMEOUT)
+    {
+        int socketId = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (connect(socketId, (struct sockaddr *)&address, sizeof(address)) == 0)
+        {
+            worker->socket = socketId;
+            return true;
+        }
+
+        close(socketId);
+
+        // Spawned process exited before listening
+        if ((worker->pid > 0) && (waitpid(worker->pid, NULL, WNOHANG) == worker->pid))
+        {
+            worker->pid = 0;
+            return false;
+        }
+
+        nanosleep(&retry, NULL);
+    }
+
+    return false;
+}
+
+// Disconnect from worker and stop it if it was spawned
+static void StopWorker(FarmWorker *worker)
+{
+    if (worker->socket >= 0) close(worker->socket);
+    worker->socket = -1;
+
+    if (worker->pid > 0)
+    {
+        kill(worker->pid, SIGTERM);
+        waitpid(worker->pid, NULL, 0);
+        unlink(worker->path);
+        worker->pid = 0;
+    }
+}
+
+// Pop an owned job or steal half of busiest worker range
+// NOTE: stolen jobs come from the back of the victim range, so both workers keep contiguous ranges
+static int NextJob(FarmWorker *workers, int count, int index, int *steals)
+{
+    FarmWorker *worker = &workers[index];
+
+    if (worker->head == worker->tail)
+    {
+        int victim = -1;
+        int remaining = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            if ((i != index) && ((workers[i].tail - workers[i].head) > remaining))
+            {
+                remaining = workers[i].tail - workers[i].head;
+                victim = i;
+            }
+        }
+
+        if (victim < 0) return -1;
+
+        // Steal half of victim remaining range (at least one job)
+        int stolen = (remaining + 1)/2;
+        worker->head = 0;
+        worker->tail = stolen;
+        memcpy(worker->jobs, workers[victim].jobs + workers[victim].tail - stolen, stolen*sizeof(int));
+        workers[victim].tail -= stolen;
+        worker->stolen += stolen;
+        (*steals)++;
+    }
+
+    return worker->jobs[worker->head++];
+}
+
+// Send a job render request
+static bool SendJob(FarmWorker *worker, FarmOptions *options, FarmJob *jobs, int job)
+{
+    char request[FARM_MAX_PATH*4] = { 0 };
+    int length = 0;
+
+    length += snprintf(request + length, sizeof(request) - length, "id %i\nmodel %s\nhdr %s\nmode %s\nsize %ix%i\n", job, options->model, options->hdr, options->mode, options->width, options->height);
+    if (options->textures != NULL) length += snprintf(request + length, sizeof(request) - length, "textures %s\n", options->textures);
+
+    if (options->frames > 0)
+    {
+        // Turntable camera orbits around model starting from viewer default camera
+        float angle = 0.785398f + 6.283185f*job/options->frames;
+        float radius = sqrtf(3.5f*3.5f + 3.5f*3.5f);
+        length += snprintf(request + length, sizeof(request) - length, "camera %f 3.0 %f 0.0 0.5 0.0\n\n", radius*cosf(angle), radius*sinf(angle));
+    }
+    else
+    {
+        Rectangle region = jobs[job].region;
+        length += snprintf(request + length, sizeof(request) - length, "region %i %i %i %i\nvignette 0\nformat raw\n\n", region.x, region.y, region.width, region.height);
+    }
+
+    for (int sent = 0; sent < length;)
+    {
+        int count = (int)send(worker->socket, request + sent, length - sent, 0);
+        if (count <= 0) return false;
+        sent += count;
+    }
+
+    return true;
+}
+
+// Read a result and store it (returns job or -1 if worker is gone)
+static int ReceiveResult(FarmWorker *worker, FarmOptions *options, FarmJob *jobs, unsigned char *pixels, bool writeOutput, int *failed)
+{
+    char header[256] = { 0 };
+    int length = 0;
+
+    // Read header line
+    while (length < (int)sizeof(header) - 1)
+    {
+        if (!ReceiveBytes(worker->socket, header + length, 1)) return -1;
+        if (header[length] == '\n') break;
+        length++;
+    }
+
+    header[length] = '\0';
+
+    int job = -1;
+    int size = 0;
+    float milliseconds = 0.0f;
+    char state[8] = { 0 };
+
+    if (sscanf(header, "OK %i %i %f %7s", &job, &size, &milliseconds, state) == 4)
+    {
+        unsigned char *data = (unsigned char *)malloc(size);
+
+        if (!ReceiveBytes(worker->socket, data, size))
+        {
+            free(data);
+            return -1;
+        }
+
+        if (strcmp(state, "cold") == 0) worker->cold++;
+
+        if (options->frames > 0)
+        {
+            if (writeOutput)
+            {
+                char path[FARM_MAX_PATH] = { 0 };
+                snprintf(path, sizeof(path), "%s/frame_%04i.png", options->output, job);
+
+                FILE *file = fopen(path, "wb");
+                if (file != NULL)
+                {
+                    fwrite(data, 1, size, file);
+                    fclose(file);
+                }
+            }
+        }
+        else if (size == jobs[job].region.width*jobs[job].region.height*4)
+        {
+            // Copy tile without guard band into still
+            Rectangle tile = jobs[job].tile;
+            Rectangle region = jobs[job].region;
+
+            for (int y = 0; y < tile.height; y++)
+            {
+                memcpy(pixels + ((tile.y + y)*options->width + tile.x)*4, data + ((tile.y - region.y + y)*region.width + (tile.x - region.x))*4, tile.width*4);
+            }
+        }
+
+        free(data);
+    }
+    else if (sscanf(header, "ERROR %i", &job) == 1)
+    {
+        printf("[%s] Job %i failed: %s\n", worker->path, job, header);
+        (*failed)++;
+    }
+    else return -1;
+
+    // Remove job from in flight requests
+    for (int i = 0; i < worker->inFlightCount; i++)
+    {
+        if (worker->inFlight[i] == job)
+        {
+            worker->inFlight[i] = worker->inFlight[--worker->inFlightCount];
+            break;
+        }
+    }
+
+    jobs[job].done = true;
+    worker->completed++;
+
+    return job;
+}
+
+// Apply postfx.fs vignette to stitched still
+// NOTE: tiles are rendered without vignette because it depends on whole image coordinates
+static void ApplyVignette(unsigned char *pixels, int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            float dx = (x + 0.5f)/width - 0.5f;
+            float dy = (y + 0.5f)/height - 0.5f;
+            float t = (sqrtf(dx*dx + dy*dy) - VIGNETTE_RADIUS)/(-VIGNETTE_SOFTNESS);
+            t = (t < 0.0f) ? 0.0f : ((t > 1.0f) ? 1.0f : t);
+
+            float vignette = t*t*(3.0f - 2.0f*t);
+            float factor = 1.0f - VIGNETTE_OPACITY + VIGNETTE_OPACITY*vignette;
+            unsigned char *pixel = pixels + (y*width + x)*4;
+
+            for (int c = 0; c < 3; c++) pixel[c] = (unsigned char)(pixel[c]*factor + 0.5f);
+            pixel[3] = 255;
+        }
+    }
+}
+
+// Read exactly size bytes
+static bool ReceiveBytes(int socket, void *data, int size)
+{
+    for (int received = 0; received < size;)
+    {
+        int count = (int)recv(socket, (char *)data + received, size - received, 0);
+        if (count <= 0) return false;
+        received += count;
+    }
+
+    return true;
+}
+
+// Get monotonic time in seconds
+static double GetSeconds(void)
+{
+    struct timespec time = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec/1000000000.0;
+}